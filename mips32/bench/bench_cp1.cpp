@@ -0,0 +1,246 @@
+#include "../src/cp1.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace mips32;
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+// The instructions of a run, cycled through
+constexpr std::uint32_t stream_size{ 4096 };
+
+constexpr std::uint32_t operations{ 1u << 22 };
+
+enum class Mix
+{
+  ARITHMETIC, // ADD, SUB, MUL, MADDF
+  DIVIDE,     // DIV, SQRT, RECIP, RSQRT
+  CONVERT,    // CVT.S.D or CVT.D.S, ROUND.W, TRUNC.L, CVT.W
+  COMPARE,    // CMP.EQ, CMP.LT, CMP.LE, CMP.UN
+};
+
+struct Benchmark
+{
+  Mix  mix;
+  bool double_; // D, otherwise S
+  bool soft;    // CP1::set_soft_float
+
+  std::string name() const
+  {
+    static char const *const mixes[] = { "arithmetic", "divide", "convert", "compare" };
+
+    return std::string( mixes[int( mix )] ) + ( double_ ? "/d" : "/s" ) + ( soft ? "/soft" : "/hard" );
+  }
+};
+
+constexpr std::uint32_t cop1( std::uint32_t fmt, std::uint32_t ft, std::uint32_t fs, std::uint32_t fd, std::uint32_t function )
+{
+  return 0x4400'0000 | fmt << 21 | ft << 16 | fs << 11 | fd << 6 | function;
+}
+
+/**
+ * The instructions read $f8 to $f31, which are never written, and write $f0 to $f7:
+ * the operands stay the same on every run, normal and positive.
+ **/
+std::vector<std::uint32_t> stream_of( Benchmark const &benchmark )
+{
+  static std::uint32_t const functions[][4] = {
+      { 0x00, 0x01, 0x02, 0x18 },
+      { 0x03, 0x04, 0x15, 0x16 },
+      { 0x20, 0x0C, 0x09, 0x24 },
+      { 0x02, 0x04, 0x06, 0x01 },
+  };
+
+  auto const compare = benchmark.mix == Mix::COMPARE;
+  std::uint32_t const fmt = ( compare ? 0x14 : 0x10 ) + benchmark.double_;
+
+  std::vector<std::uint32_t> stream( stream_size );
+  std::uint32_t seed = 0x1234'5678;
+
+  for ( std::uint32_t i = 0; i < stream_size; ++i )
+  {
+    seed = seed * 1'664'525 + 1'013'904'223;
+
+    auto function = functions[int( benchmark.mix )][i % 4];
+
+    // CVT.D.S of S, CVT.S.D of D
+    if ( benchmark.mix == Mix::CONVERT && function == 0x20 && !benchmark.double_ )
+      function = 0x21;
+
+    stream[i] = cop1( fmt, 8 + ( seed >> 8 ) % 24, 8 + ( seed >> 16 ) % 24, ( seed >> 24 ) % 8, function );
+  }
+
+  return stream;
+}
+
+void load_operands( CP1 &cp1, bool double_ )
+{
+  for ( std::uint32_t reg = 8; reg < 32; ++reg )
+  {
+    auto const value = 1.0 + reg / 64.0;
+    std::uint64_t bits = 0;
+
+    if ( double_ )
+    {
+      std::memcpy( &bits, &value, sizeof( value ) );
+    }
+    else
+    {
+      auto const single = float( value );
+      std::memcpy( &bits, &single, sizeof( single ) );
+    }
+
+    cp1.mtc1( reg, std::uint32_t( bits ) );
+    cp1.mthc1( reg, std::uint32_t( bits >> 32 ) );
+  }
+}
+
+// A sink the instructions can't be optimized away into
+volatile std::uint32_t sink;
+
+double run( Benchmark const &benchmark, std::vector<std::uint32_t> const &stream )
+{
+  CP1 cp1;
+  cp1.reset();
+  cp1.set_soft_float( benchmark.soft );
+
+  load_operands( cp1, benchmark.double_ );
+
+  std::uint32_t exceptions = 0;
+
+  auto const start = Clock::now();
+  for ( std::uint32_t i = 0; i < operations; ++i )
+    exceptions |= cp1.execute( stream[i % stream_size] );
+  auto const stop = Clock::now();
+
+  sink = exceptions | cp1.read( 31 );
+
+  return std::chrono::duration<double>( stop - start ).count();
+}
+
+std::vector<Benchmark> every_benchmark()
+{
+  std::vector<Benchmark> benchmarks;
+
+  for ( auto const mix : { Mix::ARITHMETIC, Mix::DIVIDE, Mix::CONVERT, Mix::COMPARE } )
+  {
+    for ( auto const double_ : { false, true } )
+    {
+      for ( auto const soft : { false, true } )
+        benchmarks.push_back( { mix, double_, soft } );
+    }
+  }
+
+  return benchmarks;
+}
+
+void usage( char const *program )
+{
+  std::fprintf( stderr, "Usage: %s [--repetitions N] [--list] [filter...]\n", program );
+}
+} // namespace
+
+/**
+ * Drives CP1::execute directly with streams of S or D instructions, on the host FPU or in software,
+ * to time the decoding and the dispatch of every instruction along with its operation.
+ * Prints as JSON, per benchmark named "mix/format/mode":
+ *
+ *  { "benchmarks": [ { "name": ..., "operations": ..., "seconds": [ every run ... ],
+ *                      "median_seconds": ..., "ns_per_instruction": ... }, ... ] }
+ *
+ * The runs of two builds can be compared by mips32-benchcmp. Only the benchmarks whose name
+ * contains a filter are run, if any.
+ **/
+int main( int argc, char **argv )
+{
+  std::uint32_t repetitions = 5;
+  std::vector<std::string_view> filters;
+
+  auto const benchmarks = every_benchmark();
+
+  for ( int i = 1; i < argc; ++i )
+  {
+    std::string_view const arg{ argv[i] };
+
+    if ( arg == "--repetitions" && i + 1 < argc )
+    {
+      repetitions = std::uint32_t( std::strtoul( argv[++i], nullptr, 10 ) );
+      if ( !repetitions )
+      {
+        usage( argv[0] );
+        return 1;
+      }
+    }
+    else if ( arg == "--list" )
+    {
+      for ( auto const &benchmark : benchmarks )
+        std::printf( "%s\n", benchmark.name().c_str() );
+      return 0;
+    }
+    else if ( arg.substr( 0, 2 ) == "--" )
+    {
+      usage( argv[0] );
+      return 1;
+    }
+    else
+    {
+      filters.push_back( arg );
+    }
+  }
+
+  std::printf( "{\n  \"benchmarks\": [" );
+  bool first = true;
+
+  for ( auto const &benchmark : benchmarks )
+  {
+    auto const name = benchmark.name();
+
+    if ( !filters.empty() && std::none_of( filters.begin(), filters.end(), [&name]( std::string_view filter ) {
+           return name.find( filter ) != std::string::npos;
+         } ) )
+      continue;
+
+    auto const stream = stream_of( benchmark );
+
+    std::vector<double> runs;
+    for ( std::uint32_t i = 0; i < repetitions; ++i )
+      runs.push_back( run( benchmark, stream ) );
+
+    std::string seconds;
+    for ( auto const r : runs )
+    {
+      char number[32];
+      std::snprintf( number, sizeof( number ), "%s%.6f", seconds.empty() ? "" : ", ", r );
+      seconds += number;
+    }
+
+    std::sort( runs.begin(), runs.end() );
+    auto const median = runs[runs.size() / 2];
+
+    std::printf( "%s\n    {\n"
+                 "      \"name\": \"%s\",\n"
+                 "      \"operations\": %u,\n"
+                 "      \"seconds\": [%s],\n"
+                 "      \"median_seconds\": %.6f,\n"
+                 "      \"ns_per_instruction\": %.3f\n"
+                 "    }",
+                 first ? "" : ",", name.c_str(), operations, seconds.c_str(), median, median * 1e9 / operations );
+    std::fflush( stdout );
+
+    first = false;
+  }
+
+  std::printf( "\n  ]\n}\n" );
+
+  return 0;
+}
@@ -0,0 +1,345 @@
+#include "../src/mmu.hpp"
+#include "../src/ram.hpp"
+#include "../src/ram_io.hpp"
+
+#include <mips32/literals.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace mips32;
+using namespace mips32::literals;
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+// The allocation limit of every RAM
+constexpr std::uint32_t alloc_limit{ 16 * RAM::block_size };
+
+// kseg0, where the MMU grants the kernel the addresses as they are
+constexpr std::uint32_t base_address{ 0x8000'0000 };
+
+// The bytes of an access through RAMIO
+constexpr std::uint32_t io_size{ 64 };
+
+enum class Target
+{
+  RAM,         // RAM::operator[]
+  MMU,         // MMU::access
+  RAMIO_READ,  // RAMIO::read
+  RAMIO_WRITE, // RAMIO::write
+};
+
+enum class Pattern
+{
+  SEQUENTIAL,
+  STRIDED,        // 4 KB + 4 bytes apart, a page apart
+  RANDOM,
+  BLOCK_CROSSING, // from the end of a block to the beginning of the next one
+};
+
+struct Benchmark
+{
+  Target        target;
+  Pattern       pattern;
+  std::uint32_t resident; // Bytes of the blocks accessed
+
+  std::string name() const
+  {
+    static char const *const targets[] = { "ram", "mmu", "ramio_read", "ramio_write" };
+    static char const *const patterns[] = { "sequential", "strided", "random", "block_crossing" };
+
+    auto const *size = resident < alloc_limit ? "below" : resident == alloc_limit ? "at" : "above";
+
+    return std::string( targets[int( target )] ) + '/' + patterns[int( pattern )] + '/' + size;
+  }
+
+  // Every access beyond the limit but the sequential ones could swap, they're fewer
+  std::uint32_t operations() const
+  {
+    return resident > alloc_limit && pattern != Pattern::SEQUENTIAL ? 4096 : 1u << 20;
+  }
+
+  std::uint32_t access_size() const { return target == Target::RAMIO_READ || target == Target::RAMIO_WRITE ? io_size : 4; }
+};
+
+// The addresses of the accesses of `benchmark`, the same on every run
+std::vector<std::uint32_t> addresses_of( Benchmark const &benchmark )
+{
+  auto const count = benchmark.operations();
+  auto const size = benchmark.access_size();
+  auto const blocks = benchmark.resident / RAM::block_size;
+
+  std::vector<std::uint32_t> addresses( count );
+  std::uint32_t seed = 0x1234'5678;
+
+  for ( std::uint32_t i = 0; i < count; ++i )
+  {
+    std::uint32_t offset = 0;
+
+    switch ( benchmark.pattern )
+    {
+    case Pattern::SEQUENTIAL: offset = i * size % benchmark.resident; break;
+    case Pattern::STRIDED: offset = std::uint32_t( i * std::uint64_t( 4_KB + 4 ) % ( benchmark.resident - size ) ) & ~3u; break;
+    case Pattern::RANDOM:
+      seed = seed * 1'664'525 + 1'013'904'223;
+      offset = ( seed >> 4 ) % ( benchmark.resident - size ) & ~3u;
+      break;
+    case Pattern::BLOCK_CROSSING:
+    {
+      // The last bytes of a block, then the first ones of the next, an access of RAMIO crosses the border
+      auto const border = ( i / 2 % ( blocks - 1 ) + 1 ) * RAM::block_size;
+      offset = i % 2 ? border : border - ( size == 4 ? 4 : size / 2 );
+      break;
+    }
+    }
+
+    addresses[i] = base_address + offset;
+  }
+
+  return addresses;
+}
+
+// A RAM holding the blocks of the resident set, as many as the limit allows
+struct Fixture
+{
+  explicit Fixture( Benchmark const &benchmark )
+    : ram( alloc_limit ), mmu( ram, { { 0x8000'0000, 0x3FFF'FFFF, MMU::Segment::KERNEL } } ), io( ram )
+  {
+    for ( std::uint32_t offset = 0; offset < benchmark.resident; offset += RAM::block_size )
+      ram[base_address + offset] = offset;
+  }
+
+  RAM   ram;
+  MMU   mmu;
+  RAMIO io;
+};
+
+// A sink the accesses can't be optimized away into
+volatile std::uint32_t sink;
+
+inline void access( Target target, Fixture &fixture, std::uint32_t address, char *buffer )
+{
+  switch ( target )
+  {
+  case Target::RAM: sink = fixture.ram[address]; break;
+  case Target::MMU: sink = *fixture.mmu.access( address, MMU::Segment::KERNEL ); break;
+  case Target::RAMIO_READ: sink = std::uint32_t( fixture.io.read( address, io_size ).size() ); break;
+  case Target::RAMIO_WRITE: fixture.io.write( address, buffer, io_size ); break;
+  }
+}
+
+// Of a run of a benchmark
+struct Run
+{
+  double     seconds = 0;       // Of every access, timed as a whole
+  RAM::Faults faults;           // Of the accesses timed as a whole
+  std::vector<double> latencies; // Of every access, timed one by one, ns
+};
+
+// The cost of reading the clock, subtracted from the latencies
+double clock_overhead()
+{
+  std::vector<double> samples( 1001 );
+
+  for ( auto &sample : samples )
+  {
+    auto const start = Clock::now();
+    sample = std::chrono::duration<double, std::nano>( Clock::now() - start ).count();
+  }
+
+  std::nth_element( samples.begin(), samples.begin() + samples.size() / 2, samples.end() );
+  return samples[samples.size() / 2];
+}
+
+/**
+ * Times the accesses as a whole, for the throughput, then one by one, for the latencies,
+ * on a new RAM each time: the swap files of a run don't change the next one.
+ **/
+Run run( Benchmark const &benchmark, std::vector<std::uint32_t> const &addresses, double overhead )
+{
+  char buffer[io_size]{};
+  Run result;
+
+  {
+    Fixture fixture( benchmark );
+    auto const before = fixture.ram.faults();
+
+    auto const start = Clock::now();
+    for ( auto const address : addresses )
+      access( benchmark.target, fixture, address, buffer );
+    auto const stop = Clock::now();
+
+    auto const &after = fixture.ram.faults();
+
+    result.seconds = std::chrono::duration<double>( stop - start ).count();
+    result.faults = { after.allocations - before.allocations, after.swap_ins - before.swap_ins, after.swap_outs - before.swap_outs };
+  }
+
+  {
+    Fixture fixture( benchmark );
+    result.latencies.reserve( addresses.size() );
+
+    for ( auto const address : addresses )
+    {
+      auto const start = Clock::now();
+      access( benchmark.target, fixture, address, buffer );
+      auto const stop = Clock::now();
+
+      result.latencies.push_back( std::max( 0.0, std::chrono::duration<double, std::nano>( stop - start ).count() - overhead ) );
+    }
+  }
+
+  return result;
+}
+
+// `sorted` isn't empty
+double percentile( std::vector<double> const &sorted, double p )
+{
+  auto const index = std::size_t( p * double( sorted.size() - 1 ) + 0.5 );
+  return sorted[std::min( index, sorted.size() - 1 )];
+}
+
+std::vector<Benchmark> every_benchmark()
+{
+  std::vector<Benchmark> benchmarks;
+
+  for ( auto const target : { Target::RAM, Target::MMU, Target::RAMIO_READ, Target::RAMIO_WRITE } )
+  {
+    for ( auto const pattern : { Pattern::SEQUENTIAL, Pattern::STRIDED, Pattern::RANDOM, Pattern::BLOCK_CROSSING } )
+    {
+      for ( auto const resident : { alloc_limit / 2, alloc_limit, alloc_limit * 2 } )
+        benchmarks.push_back( { target, pattern, resident } );
+    }
+  }
+
+  return benchmarks;
+}
+
+void usage( char const *program )
+{
+  std::fprintf( stderr, "Usage: %s [--repetitions N] [--list] [filter...]\n", program );
+}
+} // namespace
+
+/**
+ * Drives RAM::operator[], MMU::access, RAMIO::read and RAMIO::write directly, with the accesses
+ * sequential, strided, random and crossing the blocks, over resident sets below, at and above
+ * the allocation limit of 1 MB. Prints as JSON, per benchmark named "target/pattern/size":
+ *
+ *  { "benchmarks": [ { "name": ..., "operations": ..., "seconds": [ every run ... ],
+ *                      "median_seconds": ..., "operations_per_second": ...,
+ *                      "latency_ns": { "p50": ..., "p90": ..., "p99": ..., "p999": ..., "max": ... },
+ *                      "ram": { "allocations": ..., "swap_ins": ..., "swap_outs": ... } }, ... ] }
+ *
+ * The latencies are of every access of every run, without the cost of reading the clock.
+ * The faults are of the median run. Only the benchmarks whose name contains a filter are run, if any.
+ **/
+int main( int argc, char **argv )
+{
+  std::uint32_t repetitions = 5;
+  std::vector<std::string_view> filters;
+
+  auto const benchmarks = every_benchmark();
+
+  for ( int i = 1; i < argc; ++i )
+  {
+    std::string_view const arg{ argv[i] };
+
+    if ( arg == "--repetitions" && i + 1 < argc )
+    {
+      repetitions = std::uint32_t( std::strtoul( argv[++i], nullptr, 10 ) );
+      if ( !repetitions )
+      {
+        usage( argv[0] );
+        return 1;
+      }
+    }
+    else if ( arg == "--list" )
+    {
+      for ( auto const &benchmark : benchmarks )
+        std::printf( "%s\n", benchmark.name().c_str() );
+      return 0;
+    }
+    else if ( arg.substr( 0, 2 ) == "--" )
+    {
+      usage( argv[0] );
+      return 1;
+    }
+    else
+    {
+      filters.push_back( arg );
+    }
+  }
+
+  auto const overhead = clock_overhead();
+
+  std::printf( "{\n  \"clock_overhead_ns\": %.1f,\n  \"benchmarks\": [", overhead );
+  bool first = true;
+
+  for ( auto const &benchmark : benchmarks )
+  {
+    auto const name = benchmark.name();
+
+    if ( !filters.empty() && std::none_of( filters.begin(), filters.end(), [&name]( std::string_view filter ) {
+           return name.find( filter ) != std::string::npos;
+         } ) )
+      continue;
+
+    auto const addresses = addresses_of( benchmark );
+
+    std::vector<Run> runs;
+    std::vector<double> latencies;
+
+    for ( std::uint32_t i = 0; i < repetitions; ++i )
+    {
+      runs.push_back( run( benchmark, addresses, overhead ) );
+
+      auto &run_latencies = runs.back().latencies;
+      latencies.insert( latencies.end(), run_latencies.begin(), run_latencies.end() );
+      run_latencies = {};
+    }
+
+    std::string seconds;
+    for ( auto const &r : runs )
+    {
+      char number[32];
+      std::snprintf( number, sizeof( number ), "%s%.6f", seconds.empty() ? "" : ", ", r.seconds );
+      seconds += number;
+    }
+
+    std::sort( runs.begin(), runs.end(), []( Run const &l, Run const &r ) { return l.seconds < r.seconds; } );
+    auto const &median = runs[runs.size() / 2];
+
+    std::sort( latencies.begin(), latencies.end() );
+
+    std::printf( "%s\n    {\n"
+                 "      \"name\": \"%s\",\n"
+                 "      \"operations\": %u,\n"
+                 "      \"seconds\": [%s],\n"
+                 "      \"median_seconds\": %.6f,\n"
+                 "      \"operations_per_second\": %.0f,\n"
+                 "      \"latency_ns\": { \"p50\": %.1f, \"p90\": %.1f, \"p99\": %.1f, \"p999\": %.1f, \"max\": %.1f },\n"
+                 "      \"ram\": { \"allocations\": %llu, \"swap_ins\": %llu, \"swap_outs\": %llu }\n"
+                 "    }",
+                 first ? "" : ",", name.c_str(), benchmark.operations(), seconds.c_str(), median.seconds,
+                 benchmark.operations() / median.seconds, percentile( latencies, 0.5 ), percentile( latencies, 0.9 ),
+                 percentile( latencies, 0.99 ), percentile( latencies, 0.999 ), latencies.back(),
+                 ( unsigned long long )median.faults.allocations, ( unsigned long long )median.faults.swap_ins,
+                 ( unsigned long long )median.faults.swap_outs );
+    std::fflush( stdout );
+
+    first = false;
+  }
+
+  std::printf( "\n  ]\n}\n" );
+
+  return 0;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <mips32/export.hpp>
+#include <mips32/io_device.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace mips32
+{
+/**
+ * IODevice decorator that moves the guest's output off the simulating thread.
+ *
+ * Every print becomes a record pushed into a single-producer/single-consumer
+ * lock-free ring, drained by a dedicated thread that forwards it to `device`.
+ * When the ring is full, the simulating thread waits for a free slot.
+ * Strings are split into records of at most `Record::text_size` characters.
+ *
+ * The input requests wait until every record has been forwarded,
+ * then they're served by `device` on the simulating thread.
+ *
+ * Only one thread can print and read, usually the one running the CPU.
+ * `device` must not be used by anyone else while wrapped.
+ **/
+class MIPS32_EXPORT AsyncIODevice : public IODevice
+{
+public:
+  static inline constexpr std::uint32_t default_capacity{ 4096 };
+
+  // `capacity` is the number of records, rounded up to a power of 2.
+  explicit AsyncIODevice( IODevice *device, std::uint32_t capacity = default_capacity ) noexcept;
+
+  AsyncIODevice( AsyncIODevice const & ) = delete;
+  AsyncIODevice &operator=( AsyncIODevice const & ) = delete;
+
+  // Forwards the pending records and stops the thread.
+  ~AsyncIODevice() override;
+
+  void print_integer( std::uint32_t value ) noexcept override;
+  void print_float( float value ) noexcept override;
+  void print_double( double value ) noexcept override;
+  void print_string( char const *string ) noexcept override;
+  void print_string( char const *string, std::uint32_t length ) noexcept override;
+
+  void read_integer( std::uint32_t *value ) noexcept override;
+  void read_float( float *value ) noexcept override;
+  void read_double( double *value ) noexcept override;
+  void read_string( char *string, std::uint32_t max_count ) noexcept override;
+
+  // Waits until every record has been forwarded, and `device` flushed.
+  void flush() noexcept override;
+
+private:
+  struct Record
+  {
+    static inline constexpr std::uint32_t text_size{ 112 };
+
+    enum class Kind : std::uint32_t
+    {
+      INTEGER,
+      FLOAT,
+      DOUBLE,
+      STRING,
+      FLUSH,
+    };
+
+    Kind          kind;
+    std::uint32_t length; // of `text`, without the terminator
+    union
+    {
+      std::uint32_t integer;
+      float         f;
+      double        d;
+    };
+    char text[text_size];
+  };
+
+  static_assert( sizeof( Record ) == 128, "A Record spans 2 cache lines." );
+
+  // Returns the next free slot, waiting if the ring is full.
+  Record &acquire() noexcept;
+
+  // Publishes the slot returned by `acquire`.
+  void publish() noexcept;
+
+  void drain() noexcept;
+
+  IODevice                 *device;
+  std::unique_ptr<Record[]> ring;
+  std::uint32_t             mask;
+
+  // `head` is written only by the producer, `tail` only by the consumer
+  alignas( 64 ) std::atomic<std::uint32_t> head{ 0 };
+  alignas( 64 ) std::atomic<std::uint32_t> tail{ 0 };
+
+  // Used only to put the consumer to sleep when the ring is empty
+  alignas( 64 ) std::atomic<bool> sleeping{ false };
+  std::atomic<bool>       stopping{ false };
+  std::mutex              mutex;
+  std::condition_variable wake_up;
+
+  std::thread consumer;
+};
+} // namespace mips32
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <mips32/export.hpp>
+#include <mips32/io_device.hpp>
+
+#include <cstdint>
+#include <memory>
+
+namespace mips32
+{
+/**
+ * IODevice decorator that batches the guest's output.
+ *
+ * Every print is formatted as text and appended to a buffer,
+ * which is written out only when:
+ * - it's full
+ * - the guest requests an input, to preserve the ordering
+ * - the guest exits, or the CPU stops
+ * - `flush` is called
+ *
+ * The output goes to the file descriptor `fd`, if valid,
+ * otherwise to the wrapped device as a single `print_string`.
+ * The input requests are forwarded to the wrapped device.
+ *
+ * The integers are printed as signed, the floats and doubles
+ * with the shortest representation that round-trips.
+ **/
+class MIPS32_EXPORT BufferedIODevice : public IODevice
+{
+public:
+  static inline constexpr std::uint32_t default_capacity{ 64 * 1024 };
+
+  // `device` can be nullptr if `fd` is valid, the input requests are then ignored.
+  explicit BufferedIODevice( IODevice *device, int fd = -1, std::uint32_t capacity = default_capacity ) noexcept;
+
+  BufferedIODevice( BufferedIODevice const & ) = delete;
+  BufferedIODevice &operator=( BufferedIODevice const & ) = delete;
+
+  ~BufferedIODevice() override;
+
+  void print_integer( std::uint32_t value ) noexcept override;
+  void print_float( float value ) noexcept override;
+  void print_double( double value ) noexcept override;
+  void print_string( char const *string ) noexcept override;
+  void print_string( char const *string, std::uint32_t length ) noexcept override;
+
+  void read_integer( std::uint32_t *value ) noexcept override;
+  void read_float( float *value ) noexcept override;
+  void read_double( double *value ) noexcept override;
+  void read_string( char *string, std::uint32_t max_count ) noexcept override;
+
+  void flush() noexcept override;
+
+private:
+  void append( char const *data, std::uint32_t length ) noexcept;
+
+  // Writes `length` bytes, `data[length]` must be '\0'.
+  void output( char const *data, std::uint32_t length ) noexcept;
+
+  IODevice               *device;
+  int                     fd;
+  std::unique_ptr<char[]> buffer; // `capacity` + 1 for the terminator
+  std::uint32_t           capacity;
+  std::uint32_t           size{ 0 };
+};
+} // namespace mips32
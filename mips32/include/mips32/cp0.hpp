@@ -9,7 +9,8 @@ class CP0
   friend class MachineInspector;
 
 public:
-  void reset() noexcept;
+  // `cpu_num` is the number of the CPU in a multi-core machine, stored in EBase.
+  void reset( std::uint32_t cpu_num = 0 ) noexcept;
 
   void write( std::uint32_t reg, std::uint32_t sel, std::uint32_t data ) noexcept;
 
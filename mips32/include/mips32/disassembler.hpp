@@ -0,0 +1,27 @@
+#pragma once
+
+#include <mips32/export.hpp>
+
+#include <cstdint>
+
+namespace mips32
+{
+// The longest text written by `disassemble`, the terminating NUL included.
+inline constexpr std::uint32_t disassembly_max_size{ 48 };
+
+/**
+ * Writes the instruction `word`, fetched at `pc`, as assembly into `buffer`, NUL terminated,
+ * e.g. "ADDIU $8, $9, -1" or "BNE $8, $0, 0xBFC00008": the targets of the branches are absolute.
+ * The words that the CPU doesn't execute are written as "RESERVED 0x12345678".
+ *
+ * The instructions are decoded by tables built at compile time, like the CPU does,
+ * and nothing is allocated: it's meant for the traces and the profiles of millions of instructions.
+ *
+ * Returns the length of the whole text, like snprintf: the text written is truncated
+ * to `size - 1` characters if `buffer` is smaller than `disassembly_max_size`.
+ **/
+MIPS32_EXPORT std::uint32_t disassemble( std::uint32_t word, std::uint32_t pc, char *buffer, std::uint32_t size ) noexcept;
+
+// The mnemonic of the instruction `word`, e.g. "ADDIU" or "ADD.S", "RESERVED" if the CPU doesn't execute it.
+MIPS32_EXPORT char const *mnemonic( std::uint32_t word ) noexcept;
+} // namespace mips32
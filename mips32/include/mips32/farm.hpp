@@ -0,0 +1,78 @@
+#pragma once
+
+#include <mips32/export.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mips32
+{
+inline namespace v0
+{
+class FarmImpl;
+}
+
+/**
+ * Runs batches of independent guest programs on a pool of host threads.
+ *
+ * Every job gets its own single-core Machine, with its own RAM,
+ * so its own swap files, and a NativeFileHandler.
+ * The guest reads its input from the job, and its output is collected,
+ * formatted like `BufferedIODevice` does.
+ *
+ * The jobs are scheduled by work stealing: each worker starts with
+ * a contiguous share of the batch, which it runs in order,
+ * and once it's done steals the second half of the share of another worker,
+ * so the workers with shorter jobs help the others until the batch is over.
+ *
+ * Not thread-safe, a Farm runs a batch at a time.
+ **/
+class MIPS32_EXPORT Farm
+{
+public:
+  struct Job
+  {
+    std::string   executable;                   // path of the executable, see `Machine::load_file`
+    std::string   input;                        // read by the guest, see below
+    std::uint32_t ram_alloc_limit{ 1024 * 1024 }; // see `Machine`, a multiple of 64 KB
+    std::uint64_t instruction_limit{ 0 };       // the guest is stopped with the exit code LIMIT, 0 is unlimited
+  };
+
+  /**
+   * The read syscalls consume the input in order:
+   * - integers, floats and doubles skip the white spaces, then parse a number, 0 if there's none
+   * - strings read a line, '\n' included, up to the length requested, like MARS
+   * - characters read a single character
+   **/
+
+  struct Result
+  {
+    bool          failed{ true };     // the executable couldn't be loaded, nothing has run
+    std::uint32_t exit_code{ 0 };     // returned by `Machine::start`
+    std::uint32_t exit_value{ 0 };    // $a0 of the syscall 17, 0 otherwise
+    std::string   output;
+    std::uint64_t instructions{ 0 };  // retired
+    std::uint64_t microseconds{ 0 };  // from the creation of the Machine to its exit
+    std::uint32_t worker{ 0 };        // that has run the job
+    bool          stolen{ false };    // from the share of another worker
+  };
+
+  // `workers` is the size of the pool, 0 means one per host core.
+  explicit Farm( std::uint32_t workers = 0 ) noexcept;
+
+  Farm( Farm const & ) = delete;
+  Farm &operator=( Farm const & ) = delete;
+
+  ~Farm();
+
+  std::uint32_t workers() const noexcept;
+
+  // Runs every job, the calling thread being one of the workers.
+  // Returns when the batch is over, the results are in the order of the jobs.
+  std::vector<Result> run( std::vector<Job> const &jobs ) noexcept;
+
+private:
+  FarmImpl *_impl;
+};
+} // namespace mips32
@@ -5,6 +5,13 @@
 namespace mips32
 {
 
+// A contiguous region of host memory, part of a guest buffer.
+struct FileSpan
+{
+  char         *data;
+  std::uint32_t size;
+};
+
 /**
  * File Handler Interface
  * 
@@ -50,6 +57,70 @@ public:
   // Close a file
   virtual void close( std::uint32_t fd ) noexcept = 0;
 
+  // Requests to fill the `count` spans in order, by reading from the file `fd`,
+  // like the POSIX `readv`. The spans point directly into the guest's memory.
+  //
+  // Returns the number of bytes read, negative if error
+  //
+  // By default, calls `read` for each span, until one isn't filled completely.
+  virtual std::uint32_t readv( std::uint32_t fd, FileSpan const *spans, std::uint32_t count ) noexcept
+  {
+    std::uint32_t total = 0;
+
+    for ( auto const *span = spans; span != spans + count; ++span )
+    {
+      auto const result = read( fd, span->data, span->size );
+
+      if ( std::int32_t( result ) < 0 )
+        return total ? total : result;
+
+      total += result;
+
+      if ( result < span->size )
+        break;
+    }
+
+    return total;
+  }
+
+  // Requests to write the `count` spans in order into the file `fd`,
+  // like the POSIX `writev`. The spans point directly into the guest's memory.
+  //
+  // Returns the number of bytes written, negative if error
+  //
+  // By default, calls `write` for each span, until one isn't written completely.
+  virtual std::uint32_t writev( std::uint32_t fd, FileSpan const *spans, std::uint32_t count ) noexcept
+  {
+    std::uint32_t total = 0;
+
+    for ( auto const *span = spans; span != spans + count; ++span )
+    {
+      auto const result = write( fd, span->data, span->size );
+
+      if ( std::int32_t( result ) < 0 )
+        return total ? total : result;
+
+      total += result;
+
+      if ( result < span->size )
+        break;
+    }
+
+    return total;
+  }
+
+  // Requests the OS handle of the file `fd`, a file descriptor or a `HANDLE` on Windows,
+  // used to map the file into the guest's memory. It must be open for reading,
+  // and stay valid until the syscall returns.
+  //
+  // Returns -1 if the file can't be mapped
+  //
+  // By default, no file can be mapped.
+  virtual std::intptr_t native_handle( std::uint32_t /*fd*/ ) noexcept
+  {
+    return -1;
+  }
+
   virtual ~FileHandler()
   {}
 };
@@ -39,6 +39,17 @@ public:
   // !#!#!#
   virtual void print_string( char const *string ) noexcept = 0;
 
+  // Writes a string of `length` characters to the device.
+  // `string` is null terminated, `string[length]` is always '\0'.
+  //
+  // The CPU calls this one, by default it calls `print_string( string )`.
+  // It could point directly to the guest's memory, it must not be modified.
+  virtual void print_string( char const *string, std::uint32_t length ) noexcept
+  {
+    ( void )length;
+    print_string( string );
+  }
+
   // Reads an integer from the device and stores it inside `value`
   // `value` is guaranteed to point to a valid address.
   virtual void read_integer( std::uint32_t *value ) noexcept = 0;
@@ -59,6 +70,11 @@ public:
   // !#!#!#
   virtual void read_string( char *string, std::uint32_t max_count ) noexcept = 0;
 
+  // Writes any buffered output.
+  // Called by the CPU when it stops executing instructions, e.g. the guest exited.
+  virtual void flush() noexcept
+  {}
+
   virtual ~IODevice()
   {}
 };
@@ -1,11 +1,6 @@
 #pragma once
 
-#ifdef _MSC_VER
-#  define MIPS32_EXPORT __declspec(dllexport)
-#else
-#  define MIPS32_EXPORT
-#endif
-
+#include <mips32/export.hpp>
 #include <mips32/io_device.hpp>
 #include <mips32/file_handler.hpp>
 #include <mips32/machine_inspector.hpp>
@@ -25,11 +20,17 @@ class MachineImpl;
  * 
  * Simulates a machine with a RAM and a MIPS32 CPU.
  * 
+ * A machine with more cores runs each CPU on its own thread, sharing the RAM,
+ * the IODevice and the FileHandler. The syscalls are serialized.
+ * Every core reads its number from EBase, the CPUNum field, and can interrupt
+ * another one with the syscall 19, $a0 = number of the core.
+ * 
  **/
 class MIPS32_EXPORT Machine
 {
 public:
-  Machine( std::uint32_t ram_alloc_limit, IODevice* io_device, FileHandler* file_handler ) noexcept;
+  // With more than one core, the RAM is shared and the allocation limit is ignored: it never swaps.
+  Machine( std::uint32_t ram_alloc_limit, IODevice* io_device, FileHandler* file_handler, std::uint32_t cores = 1 ) noexcept;
 
   // Movable only
   Machine( Machine const& ) = delete;
@@ -38,16 +39,36 @@ public:
   ~Machine();
 
   /**
-   * Loads an executable
+   * Loads an executable, and sets every CPU to start from its entry point
    * 
    * For the Executable File Format, read `executable_format.md` on the repository
+   * ELF32 executables for little-endian MIPS are supported too
    * 
    * `data` must point to a valid memory region
+   * 
+   * Returns:
+   * `true`  - in case of *failure*, nothing has been loaded
+   * `false` - in case of success
    **/
   bool load( void const * data ) noexcept;
 
+  /**
+   * Loads the executable file `path`, see `load`
+   * 
+   * The file is mapped in memory and the sections are not copied,
+   * the RAM reads them copy-on-write the first time they're accessed,
+   * and the zero-filled ones, like `.bss`, aren't allocated until then
+   **/
+  bool load_file( char const * path ) noexcept;
+
+  // Inspects the RAM and the first core.
   MachineInspector get_inspector() noexcept;
 
+  // Inspects the RAM and the core number `core`, that must exist.
+  MachineInspector get_inspector( std::uint32_t core ) noexcept;
+
+  std::uint32_t cores() const noexcept;
+
   /**
    * Signals the CPU to start executing instructions.
    * 
@@ -55,7 +76,11 @@ public:
    * - the break instruction is executed
    * - an interrupt/exception is triggered
    * - the exit syscall is called
+   * - the instruction limit is reached, see `MachineInspector::CPU_retire_limit`
    * - manually called stop()
+   * 
+   * With more cores, the first one that returns stops the others,
+   * its exit code is returned once every core has stopped.
    **/
   std::uint32_t start() noexcept;
 
@@ -65,7 +90,8 @@ public:
   void stop() noexcept;
 
   /**
-   * Execute 1 instruction
+   * Execute 1 instruction, on each core in order
+   * Returns the first exit code that isn't NONE, if any
    **/
   std::uint32_t single_step() noexcept;
 
@@ -75,6 +101,69 @@ public:
    **/
   void reset() noexcept;
 
+  /**
+   * Fork server, runs the same program many times from the same point, e.g. with different inputs.
+   *
+   * `capture` runs until the CPU is about to execute the instruction at `pc`, then takes the golden state:
+   * the registers, while the RAM starts recording every 4 KB page before its first write.
+   * The input can be injected before every run, through the MachineInspector or the IODevice.
+   *
+   * `rewind` restores the golden state: the registers, and the pages written since the capture,
+   * or the last rewind, the cost is proportional to the memory touched, not to the RAM size.
+   * The IODevice and the FileHandler aren't rewound.
+   *
+   * The golden state is discarded by `load`, `load_file`, or restoring the RAM with the MachineInspector.
+   * Only a machine with a single core can capture.
+   *
+   * Returns:
+   * `true`  - in case of *failure*, the CPU has stopped before reaching `pc`, or there's nothing to rewind
+   * `false` - in case of success
+   **/
+  bool capture( std::uint32_t pc ) noexcept;
+  bool rewind() noexcept;
+
+  /**
+   * Edge coverage, for the coverage-guided fuzzers.
+   *
+   * Every branch or jump taken, and every exception, increments the counter of its edge,
+   * found hashing the PC of the instruction and the target, like AFL: the counters wrap skipping 0.
+   * `size` must be a power of 2, the map can be a shared memory segment read by the fuzzer,
+   * e.g. the 64 KB of AFL's `__AFL_SHM_ID`. The map isn't cleared, nor rewound.
+   *
+   * `nullptr` detaches the map, and the CPU is back to a loop compiled without the instrumentation.
+   * Only a machine with a single core can be covered.
+   *
+   * Returns:
+   * `true`  - in case of *failure*
+   * `false` - in case of success
+   **/
+  bool attach_coverage( std::uint8_t *map, std::uint32_t size ) noexcept;
+
+  /**
+   * Execution trace, to understand a failure after it has happened.
+   *
+   * Every instruction retired from now on is appended to the file `path`, see `TraceReader`:
+   * its PC and word, the registers and the memory words it has changed.
+   * The records are delta-encoded, then compressed and written in blocks by a background thread.
+   *
+   * `nullptr` stops the trace, the file is complete only then, or when the Machine is destroyed.
+   * Tracing another file stops the current one first.
+   * Only a machine with a single core can be traced.
+   *
+   * Returns:
+   * `true`  - in case of *failure*, the file couldn't be created, or the stopped trace couldn't be written
+   * `false` - in case of success
+   **/
+  bool trace( char const *path ) noexcept;
+
+  /**
+   * Raises the inter-processor interrupt of the core number `core`, Cause IP2.
+   * It stays pending until enabled by Status IE and IM2, ERET clears the bit once serviced,
+   * unless another IPI was raised meanwhile.
+   * Thread-safe.
+   **/
+  void interrupt( std::uint32_t core ) noexcept;
+
   // Used to modify the handlers to perform I/O
   // Returns the previous handler
   IODevice* swap_iodevice( IODevice *device ) noexcept;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <mips32/cp0.hpp>
 #include <mips32/fpr.hpp>
 #include <mips32/header.hpp>
 
@@ -12,7 +13,6 @@ namespace mips32
 {
 
 class RAM;
-class CP0;
 class CP1;
 class CPU;
 
@@ -95,11 +95,34 @@ public:
   std::vector<std::uint32_t> RAM_allocated_addresses() const noexcept;
   std::vector<std::uint32_t> RAM_swapped_addresses() const noexcept;
 
+  // Blocks of the restored snapshot found corrupted: the RAW blocks swapped aren't read on restore,
+  // they're checked when first used, then used as new blocks if corrupted.
+  std::vector<std::uint32_t> RAM_corrupted_addresses() const noexcept;
+
+  // Checks now every block of the restored snapshot not yet used, see `RAM_corrupted_addresses`.
+  // Returns:
+  // `true`  - if a block of the snapshot is corrupted
+  // `false` - otherwise
+  bool RAM_verify() noexcept;
+
+  // Blocks faulted in by the RAM since its construction: allocated when first touched,
+  // loaded back from the disk, and written to the disk to make room for another one
+  struct RAMFaults
+  {
+    std::uint64_t allocations;
+    std::uint64_t swap_ins;
+    std::uint64_t swap_outs;
+  };
+
+  RAMFaults RAM_faults() const noexcept;
+
   // Read `count` bytes from the RAM starting at `address`.
   // If you want to read a string with unspecified length, call `RAM_read(0xABCD'1234, -1, true)`
   // 
   // For space reasons, if the RAM doesn't contain a block in the range [address, address + count),
   // the function immediately returns, so it may contain partial data
+  // 
+  // The CPU must not be running, otherwise see `CPU_sample`
   std::vector<char> RAM_read( std::uint32_t address, std::uint32_t count, bool read_string = false ) noexcept;
 
   // Writes exactly `count` bytes from `src` to `address`
@@ -132,6 +155,11 @@ public:
   std::uint32_t CP1_fir() const noexcept;
   std::uint32_t CP1_fcsr() const noexcept;
 
+  // The soft-float mode computes the results and FCSR the same on every host, at a cost.
+  // Off by default, it isn't changed by a reset nor saved with the state, set it only while the CPU isn't running.
+  bool CP1_soft_float() const noexcept;
+  void CP1_soft_float( bool enabled ) noexcept;
+
   /* * * *
    *     *
    * CPU *
@@ -148,6 +176,95 @@ public:
   std::uint32_t CPU_read_exit_code() const noexcept;
   void          CPU_write_exit_code( std::uint32_t value ) noexcept;
 
+  // Instructions executed since the last reset, the ones raising an exception included
+  std::uint64_t CPU_retired() const noexcept;
+
+  // Once the retired instructions reach the limit, the CPU stops with the exit code LIMIT
+  // Unlimited by default, it isn't changed by a reset
+  std::uint64_t& CPU_retire_limit() noexcept;
+
+  // The heap grown by sbrk, [begin, program_break)
+  struct HeapInfo
+  {
+    std::uint32_t begin;
+    std::uint32_t program_break;
+    std::uint32_t high_water; // highest program break ever reached
+  };
+
+  HeapInfo CPU_heap_info() const noexcept;
+
+  // Registers of the CPU and its coprocessors, with the heap
+  struct CPUState
+  {
+    std::uint32_t                 pc;
+    std::array<std::uint32_t, 32> gpr;
+    CP0                           cp0;
+    std::array<FPR, 32>           fpr;
+    std::uint32_t                 fcsr;
+    HeapInfo                      heap;
+  };
+
+  CPUState CPU_state() const noexcept;
+
+  // The LL reservation is cleared, the exit code and the retired instructions are left untouched
+  void CPU_restore( CPUState const &state ) noexcept;
+
+  // The last instructions fetched by the CPU, and the last memory accesses, oldest first
+  struct FlightRecord
+  {
+    struct Instruction
+    {
+      std::uint32_t pc;
+      std::uint32_t word;
+    };
+
+    struct Access
+    {
+      std::uint32_t pc; // of the instruction
+      std::uint32_t address;
+      bool          store;
+    };
+
+    std::vector<Instruction> instructions;
+    std::vector<Access>      accesses;
+  };
+
+  // Keeps the last `instructions` instructions, and the last `accesses` accesses, rounded up to a power of 2,
+  // 0 disables the recording. The last 64 instructions are kept by default.
+  // The record is cleared. The CPU must not be running.
+  void CPU_flight_recorder( std::uint32_t instructions, std::uint32_t accesses = 0 ) noexcept;
+
+  /**
+   * Returns the flight record, e.g. the instructions leading to an exception.
+   * The instruction raising it is the last one.
+   *
+   * It can be called by any thread, also while the CPU is running on another one,
+   * without waiting for it: the entries overwritten meanwhile are dropped.
+   **/
+  FlightRecord CPU_flight_record() const noexcept;
+
+  // Registers and memory of the CPU, taken at the same instruction boundary
+  struct CPUSample
+  {
+    std::uint32_t                 pc;
+    std::array<std::uint32_t, 32> gpr;
+    std::vector<char>             memory; // may contain partial data, see `RAM_read`
+  };
+
+  /**
+   * Samples the CPU, and `count` bytes of the RAM at `address`, into `sample`.
+   *
+   * It can be called by any thread, also while the CPU is running on another one,
+   * which isn't stopped: it answers between two instructions, as soon as it notices the request,
+   * with a single atomic load per instruction. Otherwise the sample is taken by the caller.
+   * The samples of the same CPU are serialized.
+   *
+   * Returns:
+   * `true`  - in case of *failure*, the CPU hasn't answered within `timeout_ms`, e.g. it's blocked by a syscall
+   * `false` - in case of success
+   **/
+  bool CPU_sample( CPUSample &sample, std::uint32_t address = 0, std::uint32_t count = 0, std::uint32_t timeout_ms = 100 ) noexcept;
+
 private:
   RAM *ram;
   CP0 *cp0;
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <mips32/export.hpp>
+#include <mips32/file_handler.hpp>
+
+#include <cstdint>
+
+namespace mips32
+{
+inline namespace v0
+{
+class NativeFileHandlerImpl;
+}
+
+/**
+ * FileHandler backed by the host's files.
+ *
+ * The descriptors are indices into a table, the closed ones are reused.
+ * The reads are buffered: when the guest reads sequentially,
+ * the next chunk of the file is read ahead while it consumes the current one.
+ * The small writes are coalesced into chunks, written while the guest goes on.
+ *
+ * On Linux the background transfers are submitted to io_uring, when available,
+ * otherwise every transfer is a blocking `pread`/`pwrite`.
+ *
+ * The flags are the ones of the C `fopen`.
+ * `open` returns -1 in case of failure.
+ **/
+class MIPS32_EXPORT NativeFileHandler : public FileHandler
+{
+public:
+  // `use_io_uring` can be false to always use blocking transfers.
+  explicit NativeFileHandler( bool use_io_uring = true ) noexcept;
+
+  NativeFileHandler( NativeFileHandler const & ) = delete;
+  NativeFileHandler &operator=( NativeFileHandler const & ) = delete;
+
+  // Closes every file still open.
+  ~NativeFileHandler() override;
+
+  std::uint32_t open( char const *name, char const *flags ) noexcept override;
+  std::uint32_t read( std::uint32_t fd, char *dst, std::uint32_t count ) noexcept override;
+  std::uint32_t write( std::uint32_t fd, char const *src, std::uint32_t count ) noexcept override;
+  void          close( std::uint32_t fd ) noexcept override;
+
+  // The pending writes are completed first.
+  std::intptr_t native_handle( std::uint32_t fd ) noexcept override;
+
+  // Returns true if the background transfers are submitted to io_uring.
+  bool uses_io_uring() const noexcept;
+
+private:
+  NativeFileHandlerImpl *_impl;
+};
+} // namespace mips32
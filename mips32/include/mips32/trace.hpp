@@ -0,0 +1,74 @@
+#pragma once
+
+#include <mips32/export.hpp>
+#include <mips32/fpr.hpp>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace mips32
+{
+inline namespace v0
+{
+class TraceReaderImpl;
+}
+
+/**
+ * Reads an execution trace written by `Machine::trace`.
+ *
+ * The file starts with the registers of the CPU when the trace has started,
+ * followed by a record per instruction retired, in blocks compressed independently,
+ * each one checked by a CRC-32, and ends with the number of records written.
+ * The records are delta-encoded: a PC that follows the previous one, the word of
+ * an instruction seen recently at the same PC and the registers left untouched aren't stored,
+ * so they're decoded in order, replaying the state of the registers.
+ *
+ * The memory written by the syscalls isn't traced, their results in the registers are.
+ **/
+class MIPS32_EXPORT TraceReader
+{
+public:
+  // A memory word changed by an instruction
+  struct Store
+  {
+    std::uint32_t address; // word aligned
+    std::uint32_t value;   // after the instruction
+  };
+
+  struct Record
+  {
+    std::uint64_t index;                  // from the beginning of the trace
+    std::uint32_t pc;
+    std::uint32_t word;
+    std::uint32_t gpr_changed;            // bit `n` is set if the instruction has changed the GPR `n`
+    std::uint32_t fpr_changed;            // bit `n` is set if the instruction has changed the FPR `n`
+    std::array<std::uint32_t, 32> gpr;    // after the instruction
+    std::array<FPR, 32>           fpr;    // after the instruction
+    std::vector<Store>            stores;
+  };
+
+  explicit TraceReader( char const *path ) noexcept;
+
+  TraceReader( TraceReader const & ) = delete;
+  TraceReader &operator=( TraceReader const & ) = delete;
+
+  ~TraceReader();
+
+  // Registers when the trace has started, `index` is 0 and nothing has changed yet.
+  Record const &initial_state() const noexcept;
+
+  // Reads the next record into `record`.
+  // Returns:
+  // `true`  - at the end of the trace, or in case of *failure*, see `failed`
+  // `false` - in case of success
+  bool read( Record &record ) noexcept;
+
+  // The file can't be read, or it's truncated or corrupted.
+  // A trace that hasn't been stopped is truncated, its complete blocks are still readable.
+  bool failed() const noexcept;
+
+private:
+  TraceReaderImpl *_impl;
+};
+} // namespace mips32
@@ -0,0 +1,214 @@
+#include <mips32/async_io_device.hpp>
+
+#include <cassert>
+#include <cstring>
+#include <new>
+
+namespace mips32
+{
+// Iterations spent polling an empty ring before the consumer goes to sleep
+constexpr int spins_before_sleeping{ 64 };
+
+constexpr std::uint32_t round_up_to_power_of_2( std::uint32_t value ) noexcept
+{
+  std::uint32_t power = 1;
+  while ( power < value )
+    power <<= 1;
+  return power;
+}
+
+AsyncIODevice::AsyncIODevice( IODevice *device, std::uint32_t capacity ) noexcept
+    : device( device )
+    , ring( new ( std::nothrow ) Record[round_up_to_power_of_2( capacity ? capacity : 1 )] )
+    , mask( round_up_to_power_of_2( capacity ? capacity : 1 ) - 1 )
+{
+  assert( device && "There's no device to forward to." );
+  assert( ring && "Couldn't allocate the ring." );
+
+  consumer = std::thread( [this]() { drain(); } );
+}
+
+AsyncIODevice::~AsyncIODevice()
+{
+  flush();
+
+  {
+    std::lock_guard lock( mutex );
+    stopping.store( true );
+  }
+  wake_up.notify_one();
+
+  consumer.join();
+}
+
+void AsyncIODevice::print_integer( std::uint32_t value ) noexcept
+{
+  auto &record = acquire();
+  record.kind = Record::Kind::INTEGER;
+  record.integer = value;
+  publish();
+}
+
+void AsyncIODevice::print_float( float value ) noexcept
+{
+  auto &record = acquire();
+  record.kind = Record::Kind::FLOAT;
+  record.f = value;
+  publish();
+}
+
+void AsyncIODevice::print_double( double value ) noexcept
+{
+  auto &record = acquire();
+  record.kind = Record::Kind::DOUBLE;
+  record.d = value;
+  publish();
+}
+
+void AsyncIODevice::print_string( char const *string ) noexcept
+{
+  print_string( string, ( std::uint32_t )std::strlen( string ) );
+}
+
+void AsyncIODevice::print_string( char const *string, std::uint32_t length ) noexcept
+{
+  constexpr std::uint32_t max_length = Record::text_size - 1;
+
+  do
+  {
+    auto const chunk = length < max_length ? length : max_length;
+
+    auto &record = acquire();
+    record.kind = Record::Kind::STRING;
+    record.length = chunk;
+    std::memcpy( record.text, string, chunk );
+    record.text[chunk] = '\0';
+    publish();
+
+    string += chunk;
+    length -= chunk;
+  } while ( length );
+}
+
+void AsyncIODevice::read_integer( std::uint32_t *value ) noexcept
+{
+  flush();
+  device->read_integer( value );
+}
+
+void AsyncIODevice::read_float( float *value ) noexcept
+{
+  flush();
+  device->read_float( value );
+}
+
+void AsyncIODevice::read_double( double *value ) noexcept
+{
+  flush();
+  device->read_double( value );
+}
+
+void AsyncIODevice::read_string( char *string, std::uint32_t max_count ) noexcept
+{
+  flush();
+  device->read_string( string, max_count );
+}
+
+void AsyncIODevice::flush() noexcept
+{
+  acquire().kind = Record::Kind::FLUSH;
+  publish();
+
+  // The consumer is idle once it has caught up, `device` can be used from here
+  auto const last = head.load( std::memory_order_relaxed );
+  while ( tail.load( std::memory_order_acquire ) != last )
+    std::this_thread::yield();
+}
+
+AsyncIODevice::Record &AsyncIODevice::acquire() noexcept
+{
+  auto const current = head.load( std::memory_order_relaxed );
+
+  // Backpressure, the consumer is surely awake
+  while ( current - tail.load( std::memory_order_acquire ) > mask )
+    std::this_thread::yield();
+
+  return ring[current & mask];
+}
+
+/**
+ * Both the store of `head` and the load of `sleeping` are sequentially consistent,
+ * as the consumer's store of `sleeping` and load of `head`:
+ * either the producer sees the consumer asleep, or the consumer sees the new record.
+ **/
+void AsyncIODevice::publish() noexcept
+{
+  head.store( head.load( std::memory_order_relaxed ) + 1 );
+
+  if ( sleeping.load() )
+  {
+    {
+      std::lock_guard lock( mutex );
+    }
+    wake_up.notify_one();
+  }
+}
+
+void AsyncIODevice::drain() noexcept
+{
+  int spins = 0;
+
+  while ( true )
+  {
+    auto current = tail.load( std::memory_order_relaxed );
+    auto const last = head.load( std::memory_order_acquire );
+
+    if ( current == last )
+    {
+      if ( stopping.load() )
+        return;
+
+      if ( ++spins < spins_before_sleeping )
+      {
+        std::this_thread::yield();
+        continue;
+      }
+
+      std::unique_lock lock( mutex );
+      sleeping.store( true );
+      wake_up.wait( lock, [&]() { return head.load() != current || stopping.load(); } );
+      sleeping.store( false );
+
+      spins = 0;
+      continue;
+    }
+
+    for ( ; current != last; ++current )
+    {
+      auto const &record = ring[current & mask];
+
+      switch ( record.kind )
+      {
+      case Record::Kind::INTEGER:
+        device->print_integer( record.integer );
+        break;
+      case Record::Kind::FLOAT:
+        device->print_float( record.f );
+        break;
+      case Record::Kind::DOUBLE:
+        device->print_double( record.d );
+        break;
+      case Record::Kind::STRING:
+        device->print_string( record.text, record.length );
+        break;
+      case Record::Kind::FLUSH:
+        device->flush();
+        break;
+      }
+
+      // The slot can be reused as soon as it's been forwarded
+      tail.store( current + 1, std::memory_order_release );
+    }
+  }
+}
+} // namespace mips32
@@ -0,0 +1,155 @@
+#include <mips32/buffered_io_device.hpp>
+
+#include <fmt/compile.h>
+
+#include <cassert>
+#include <cstring>
+#include <new>
+
+#ifdef _MSC_VER
+#  include <io.h>
+#else
+#  include <unistd.h>
+#endif
+
+namespace mips32
+{
+// Large enough for any integer, float or double printed as "{}"
+constexpr std::uint32_t max_number_length{ 32 };
+
+BufferedIODevice::BufferedIODevice( IODevice *device, int fd, std::uint32_t capacity ) noexcept
+    : device( device )
+    , fd( fd )
+    , buffer( new ( std::nothrow ) char[std::size_t( capacity ) + 1] )
+    , capacity( capacity )
+{
+  assert( buffer && "Couldn't allocate the output buffer." );
+  assert( capacity >= max_number_length && "The buffer can't hold a single number." );
+  assert( ( device || fd >= 0 ) && "There's no output." );
+}
+
+BufferedIODevice::~BufferedIODevice()
+{
+  flush();
+}
+
+void BufferedIODevice::print_integer( std::uint32_t value ) noexcept
+{
+  char number[max_number_length];
+  auto const *end = fmt::format_to( number, FMT_COMPILE( "{}" ), ( std::int32_t )value );
+  append( number, std::uint32_t( end - number ) );
+}
+
+void BufferedIODevice::print_float( float value ) noexcept
+{
+  char number[max_number_length];
+  auto const *end = fmt::format_to( number, FMT_COMPILE( "{}" ), value );
+  append( number, std::uint32_t( end - number ) );
+}
+
+void BufferedIODevice::print_double( double value ) noexcept
+{
+  char number[max_number_length];
+  auto const *end = fmt::format_to( number, FMT_COMPILE( "{}" ), value );
+  append( number, std::uint32_t( end - number ) );
+}
+
+void BufferedIODevice::print_string( char const *string ) noexcept
+{
+  append( string, ( std::uint32_t )std::strlen( string ) );
+}
+
+void BufferedIODevice::print_string( char const *string, std::uint32_t length ) noexcept
+{
+  append( string, length );
+}
+
+void BufferedIODevice::read_integer( std::uint32_t *value ) noexcept
+{
+  flush();
+  if ( device )
+    device->read_integer( value );
+}
+
+void BufferedIODevice::read_float( float *value ) noexcept
+{
+  flush();
+  if ( device )
+    device->read_float( value );
+}
+
+void BufferedIODevice::read_double( double *value ) noexcept
+{
+  flush();
+  if ( device )
+    device->read_double( value );
+}
+
+void BufferedIODevice::read_string( char *string, std::uint32_t max_count ) noexcept
+{
+  flush();
+  if ( device )
+    device->read_string( string, max_count );
+}
+
+void BufferedIODevice::flush() noexcept
+{
+  if ( !size )
+    return;
+
+  buffer[size] = '\0';
+  output( buffer.get(), size );
+  size = 0;
+
+  if ( device )
+    device->flush();
+}
+
+void BufferedIODevice::append( char const *data, std::uint32_t length ) noexcept
+{
+  if ( length > capacity - size )
+    flush();
+
+  // Too big to be buffered, it's copied once to be terminated
+  if ( length > capacity )
+  {
+    while ( length )
+    {
+      auto const chunk = length < capacity ? length : capacity;
+      std::memcpy( buffer.get(), data, chunk );
+      buffer[chunk] = '\0';
+      output( buffer.get(), chunk );
+
+      data += chunk;
+      length -= chunk;
+    }
+    return;
+  }
+
+  std::memcpy( buffer.get() + size, data, length );
+  size += length;
+}
+
+void BufferedIODevice::output( char const *data, std::uint32_t length ) noexcept
+{
+  if ( fd < 0 )
+  {
+    device->print_string( data, length );
+    return;
+  }
+
+  while ( length )
+  {
+#ifdef _MSC_VER
+    auto const written = ::_write( fd, data, length );
+#else
+    auto const written = ::write( fd, data, length );
+#endif
+    if ( written <= 0 )
+      return;
+
+    data += written;
+    length -= ( std::uint32_t )written;
+  }
+}
+} // namespace mips32
@@ -5,7 +5,7 @@
 
 namespace mips32
 {
-void CP0::reset() noexcept
+void CP0::reset( std::uint32_t cpu_num ) noexcept
 {
   *this = {};
 
@@ -44,9 +44,9 @@ void CP0::reset() noexcept
   /*
   EBase
   31   -> 1
-  9..0 -> # CPU -> 0
+  9..0 -> # CPU -> cpu_num
   */
-  e_base = 0x8000'0000;
+  e_base = 0x8000'0000 | cpu_num & 0x3FF;
 
   /*
   Config
@@ -1,10 +1,13 @@
 #include "cp1.hpp"
 
+#include "ieee754.hpp"
+
 #include <cassert>
 #include <cfenv>
 #include <cmath>
 #include <cstring>
 #include <limits>
+#include <type_traits>
 
 #include <pmmintrin.h>
 #include <xmmintrin.h>
@@ -42,6 +45,32 @@ inline constexpr std::uint64_t CMP_FALSE{ 0 };
 
 namespace mips32
 {
+// The fields of FPR holding a T, and for float and double the integer of the same width
+template <typename T>
+struct Format;
+
+template <>
+struct Format<float>
+{
+  static constexpr auto value = &FPR::f;
+  static constexpr auto bits = &FPR::i32;
+};
+template <>
+struct Format<double>
+{
+  static constexpr auto value = &FPR::d;
+  static constexpr auto bits = &FPR::i64;
+};
+template <>
+struct Format<std::int32_t>
+{
+  static constexpr auto value = &FPR::i32;
+};
+template <>
+struct Format<std::int64_t>
+{
+  static constexpr auto value = &FPR::i64;
+};
 
 CP1::CP1() noexcept
 {
@@ -78,44 +107,83 @@ void CP1::set_flags( std::uint32_t flag ) noexcept
 }
 void CP1::set_cause( std::uint32_t data ) noexcept
 {
-  fcsr |= ( data & 0x2F ) << 12;
+  fcsr |= ( data & 0x3F ) << 12;
 }
 
-bool CP1::handle_fpu_ex() noexcept
+// The exceptions raised by the host FPU, as the bits of the Cause field
+std::uint32_t host_exceptions() noexcept
 {
-  if ( !std::fetestexcept( FE_ALL_EXCEPT ) ) return false;
+  auto const raised = std::fetestexcept( FE_ALL_EXCEPT );
 
-  static constexpr std::array<std::uint32_t, 5> _flags{
-      INVALID,
-      DIVBYZERO,
-      OVERFLOW_,
-      UNDERFLOW_,
-      INEXACT,
-  };
+  return ( raised & FE_INVALID ? std::uint32_t{ CP1::INVALID } : 0 ) |
+         ( raised & FE_DIVBYZERO ? std::uint32_t{ CP1::DIVBYZERO } : 0 ) |
+         ( raised & FE_OVERFLOW ? std::uint32_t{ CP1::OVERFLOW_ } : 0 ) |
+         ( raised & FE_UNDERFLOW ? std::uint32_t{ CP1::UNDERFLOW_ } : 0 ) |
+         ( raised & FE_INEXACT ? std::uint32_t{ CP1::INEXACT } : 0 );
+}
 
-  std::uint32_t ex{ 0 };
+bool CP1::trap_fpu_ex( void const *result ) noexcept
+{
+  // Reading the result orders its operation before the check
+  static_cast<void>( *static_cast<unsigned char const volatile *>( result ) );
+
+  auto const raised = host_exceptions();
+  if ( !raised ) return false;
 
-  switch ( std::fetestexcept( FE_ALL_EXCEPT ) )
-  {
-  case FE_INVALID: ex = 0; break;
-  case FE_DIVBYZERO: ex = 1; break;
-  case FE_OVERFLOW: ex = 2; break;
-  case FE_UNDERFLOW: ex = 3; break;
-  case FE_INEXACT: ex = 4; break;
-  }
   std::feclearexcept( FE_ALL_EXCEPT );
 
-  set_cause( _flags[ex] );
+  return raise_fpu_ex( raised );
+}
 
-  if ( enable() & _flags[ex] )
-  {
+bool CP1::raise_fpu_ex( std::uint32_t raised ) noexcept
+{
+  if ( !raised ) return false;
+
+  set_cause( raised );
+
+  if ( enable() & raised )
     return true; // Trap
-  }
-  else
-  {
-    set_cause( _flags[ex] );
-    return false;
-  }
+
+  set_flags( raised );
+  return false;
+}
+
+void CP1::sync_flags() noexcept
+{
+  // The host FPU computes only the fast paths, which can't change FCSR
+  if ( soft ) return;
+
+  auto const raised = host_exceptions();
+  if ( !raised ) return;
+
+  std::feclearexcept( FE_ALL_EXCEPT );
+
+  set_cause( raised );
+  set_flags( raised );
+}
+
+void CP1::clear_host_flags() noexcept
+{
+  std::feclearexcept( FE_ALL_EXCEPT );
+}
+
+void CP1::bind_host_fpu() noexcept
+{
+  set_round_mode();
+
+  set_denormal_flush();
+
+  clear_host_flags();
+}
+
+void CP1::set_soft_float( bool enabled ) noexcept
+{
+  // The exceptions raised by the host FPU until now belong to the hard-float mode
+  sync_flags();
+
+  soft = enabled;
+
+  bind_host_fpu();
 }
 
 constexpr std::uint32_t fmt( std::uint32_t word ) noexcept
@@ -152,9 +220,71 @@ bool valid_fmt( std::uint32_t word ) noexcept
   }
 }
 
+// The soft-float mode computes the rounding and the exceptions of FCSR itself, see `ieee754.hpp`
+ieee754::Environment environment_of( std::uint32_t fcsr ) noexcept
+{
+  constexpr std::uint32_t inexact_flag{ CP1::INEXACT << 2 };
+  constexpr std::uint32_t inexact_enable{ CP1::INEXACT << 7 };
+  constexpr std::uint32_t inexact_cause{ CP1::INEXACT << 12 };
+
+  return { fcsr & 0x3, ( fcsr & ( 1 << 24 ) ) != 0,
+           ( fcsr & ( inexact_flag | inexact_enable | inexact_cause ) ) == ( inexact_flag | inexact_cause ) };
+}
+
+// The operations of the soft-float instructions, of fs, of fs and ft, or of fs, ft and fd
+struct SoftAdd
+{
+  template <typename T>
+  static T apply( T fs, T ft, ieee754::Environment &env ) noexcept { return ieee754::add( fs, ft, env ); }
+};
+struct SoftSub
+{
+  template <typename T>
+  static T apply( T fs, T ft, ieee754::Environment &env ) noexcept { return ieee754::sub( fs, ft, env ); }
+};
+struct SoftMul
+{
+  template <typename T>
+  static T apply( T fs, T ft, ieee754::Environment &env ) noexcept { return ieee754::mul( fs, ft, env ); }
+};
+struct SoftDiv
+{
+  template <typename T>
+  static T apply( T fs, T ft, ieee754::Environment &env ) noexcept { return ieee754::div( fs, ft, env ); }
+};
+struct SoftSqrt
+{
+  template <typename T>
+  static T apply( T fs, ieee754::Environment &env ) noexcept { return ieee754::sqrt( fs, env ); }
+};
+struct SoftRecip
+{
+  template <typename T>
+  static T apply( T fs, ieee754::Environment &env ) noexcept { return ieee754::div( T( 1 ), fs, env ); }
+};
+struct SoftRsqrt
+{
+  template <typename T>
+  static T apply( T fs, ieee754::Environment &env ) noexcept
+  {
+    return ieee754::div( T( 1 ), ieee754::sqrt( fs, env ), env );
+  }
+};
+struct SoftMaddf
+{
+  template <typename T>
+  static T apply( T fs, T ft, T fd, ieee754::Environment &env ) noexcept { return ieee754::fma( fs, ft, fd, env ); }
+};
+struct SoftMsubf
+{
+  template <typename T>
+  static T apply( T fs, T ft, T fd, ieee754::Environment &env ) noexcept { return ieee754::fms( fs, ft, fd, env ); }
+};
+
 void CP1::set_round_mode() noexcept
 {
-  switch ( round() )
+  // The fast paths of the soft-float mode expect the host FPU to round to nearest
+  switch ( soft ? ROUND_NEAREST : round() )
   {
   case ROUND_NEAREST: std::fesetround( FE_TONEAREST ); break;
   case ROUND_ZERO: std::fesetround( FE_TOWARDZERO ); break;
@@ -165,7 +295,8 @@ void CP1::set_round_mode() noexcept
 
 void CP1::set_denormal_flush() noexcept
 {
-  if ( fcsr & ( 1 << 24 ) )
+  // The soft-float mode flushes the subnormals itself
+  if ( !soft && fcsr & ( 1 << 24 ) )
   {
     _MM_SET_FLUSH_ZERO_MODE( _MM_FLUSH_ZERO_ON );
     _MM_SET_DENORMALS_ZERO_MODE( _MM_DENORMALS_ZERO_ON );
@@ -177,6 +308,11 @@ void CP1::set_denormal_flush() noexcept
   }
 }
 
+std::array<FPR, 32> const &CP1::registers() const noexcept
+{
+  return fpr;
+}
+
 void CP1::reset() noexcept
 {
   std::memset( fpr.data(), 0, sizeof( FPR ) * fpr.size() );
@@ -211,6 +347,9 @@ std::uint32_t CP1::read( std::uint32_t reg ) noexcept
 {
   assert( ( reg == 0 || reg == 31 || reg == 26 || reg == 28 ) && "Unimplemented Coprocessor 1 Register." );
 
+  if ( reg != 0 )
+    sync_flags();
+
   if ( reg == 0 )
     return fir;
   else if ( reg == 31 )
@@ -227,7 +366,11 @@ void CP1::write( std::uint32_t reg, std::uint32_t data ) noexcept
 
   if ( reg == 0 )
     return; // fir is read only
-  else if ( reg == 31 )
+
+  // The exceptions raised until now belong to the old value
+  sync_flags();
+
+  if ( reg == 31 )
     fcsr = fcsr & ~0x0163'FFFF | data & 0x0163'FFFF;
   else if ( reg == 26 )
     fcsr = fcsr & ~0x0003'F07C | data & 0x0003'F07C;
@@ -245,46 +388,52 @@ CP1::Exception CP1::execute( std::uint32_t word ) noexcept
 
   assert( valid_fmt( word ) && "Invalid format!" );
 
-  static constexpr std::array<int ( CP1::* )( std::uint32_t ) noexcept, 64>
-    fmt_S_D_fn_table{
-        &CP1::add,
-        &CP1::sub,
-        &CP1::mul,
-        &CP1::div,
-        &CP1::sqrt,
-        &CP1::abs,
-        &CP1::mov,
-        &CP1::neg,
-        &CP1::round_l,
-        &CP1::trunc_l,
-        &CP1::ceil_l,
-        &CP1::floor_l,
-        &CP1::round_w,
-        &CP1::trunc_w,
-        &CP1::ceil_w,
-        &CP1::floor_w,
-        &CP1::sel,
+  using Instruction = int ( CP1::* )( std::uint32_t ) noexcept;
+
+  // The instructions of S or D, every one specialized for float or double: no format is decoded again
+  constexpr auto fmt_S_D_fn_table = []( auto format ) constexpr
+  {
+    using T = decltype( format );
+
+    return std::array<Instruction, 64>{
+        &CP1::add<T>,
+        &CP1::sub<T>,
+        &CP1::mul<T>,
+        &CP1::div<T>,
+        &CP1::sqrt<T>,
+        &CP1::abs<T>,
+        &CP1::mov<T>,
+        &CP1::neg<T>,
+        &CP1::round_l<T>,
+        &CP1::trunc_l<T>,
+        &CP1::ceil_l<T>,
+        &CP1::floor_l<T>,
+        &CP1::round_w<T>,
+        &CP1::trunc_w<T>,
+        &CP1::ceil_w<T>,
+        &CP1::floor_w<T>,
+        &CP1::sel<T>,
         &CP1::reserved, // MOVCF
         &CP1::reserved, // MOVZ
         &CP1::reserved, // MOVN
-        &CP1::seleqz,
-        &CP1::recip,
-        &CP1::rsqrt,
-        &CP1::selnez,
-        &CP1::maddf,
-        &CP1::msubf,
-        &CP1::rint,
-        &CP1::class_,
-        &CP1::min,
-        &CP1::max,
-        &CP1::mina,
-        &CP1::maxa,
-        &CP1::cvt_s,
-        &CP1::cvt_d,
+        &CP1::seleqz<T>,
+        &CP1::recip<T>,
+        &CP1::rsqrt<T>,
+        &CP1::selnez<T>,
+        &CP1::maddf<T>,
+        &CP1::msubf<T>,
+        &CP1::rint<T>,
+        &CP1::class_<T>,
+        &CP1::min<T>,
+        &CP1::max<T>,
+        &CP1::mina<T>,
+        &CP1::maxa<T>,
+        &CP1::cvt<float, T>,
+        &CP1::cvt<double, T>,
         &CP1::reserved, // *
         &CP1::reserved, // *
-        &CP1::cvt_w,
-        &CP1::cvt_l,
+        &CP1::cvt_w<T>,
+        &CP1::cvt_l<T>,
         &CP1::reserved, // *
         &CP1::reserved, // *
         &CP1::reserved,
@@ -312,18 +461,24 @@ CP1::Exception CP1::execute( std::uint32_t word ) noexcept
         &CP1::reserved,
         &CP1::reserved,
         &CP1::reserved,
+    };
   };
 
-  static constexpr std::array<int ( CP1::* )( std::uint32_t ) noexcept, 64>
-    fmt_W_L_fn_table{
-        &CP1::cmp_af,
-        &CP1::cmp_un,
-        &CP1::cmp_eq,
-        &CP1::cmp_ueq,
-        &CP1::cmp_lt,
-        &CP1::cmp_ult,
-        &CP1::cmp_le,
-        &CP1::cmp_ule,
+  // The instructions of W or L: CMP.condn.S or CMP.condn.D, and the conversions of std::int32_t or std::int64_t
+  constexpr auto fmt_W_L_fn_table = []( auto format, auto integer ) constexpr
+  {
+    using T = decltype( format );
+    using I = decltype( integer );
+
+    return std::array<Instruction, 64>{
+        &CP1::cmp_af<T>,
+        &CP1::cmp_un<T>,
+        &CP1::cmp_eq<T>,
+        &CP1::cmp_ueq<T>,
+        &CP1::cmp_lt<T>,
+        &CP1::cmp_ult<T>,
+        &CP1::cmp_le<T>,
+        &CP1::cmp_ule<T>,
         &CP1::unimplemented, // CMP.SAF.fmt
         &CP1::unimplemented, // CMP.SUN.fmt
         &CP1::unimplemented, // CMP.SEQ.fmt
@@ -333,9 +488,9 @@ CP1::Exception CP1::execute( std::uint32_t word ) noexcept
         &CP1::unimplemented, // CMP.SLE.fmt
         &CP1::unimplemented, // CMP.SULE.fmt
         &CP1::reserved,
-        &CP1::cmp_or,
-        &CP1::cmp_une,
-        &CP1::cmp_ne,
+        &CP1::cmp_or<T>,
+        &CP1::cmp_une<T>,
+        &CP1::cmp_ne<T>,
         &CP1::reserved,
         &CP1::reserved,
         &CP1::reserved,
@@ -348,8 +503,8 @@ CP1::Exception CP1::execute( std::uint32_t word ) noexcept
         &CP1::reserved,
         &CP1::reserved,
         &CP1::reserved,
-        &CP1::cvt_s,
-        &CP1::cvt_d,
+        &CP1::cvt<float, I>,
+        &CP1::cvt<double, I>,
         &CP1::reserved,
         &CP1::reserved,
         &CP1::reserved,
@@ -380,24 +535,83 @@ CP1::Exception CP1::execute( std::uint32_t word ) noexcept
         &CP1::reserved,
         &CP1::reserved,
         &CP1::reserved,
+    };
+  };
+
+  // The soft-float mode swaps in the instructions rounding or raising exceptions,
+  // the others are exact and quiet on the host FPU too
+  constexpr auto soft_fmt_S_D_fn_table = []( auto format, std::array<Instruction, 64> table ) constexpr
+  {
+    using T = decltype( format );
+
+    table[0x00] = &CP1::soft_binary<SoftAdd, T>;
+    table[0x01] = &CP1::soft_binary<SoftSub, T>;
+    table[0x02] = &CP1::soft_binary<SoftMul, T>;
+    table[0x03] = &CP1::soft_binary<SoftDiv, T>;
+    table[0x04] = &CP1::soft_unary<SoftSqrt, T>;
+    table[0x08] = &CP1::soft_to_integer<std::int64_t, ieee754::NEAREST_AWAY, T>; // ROUND.L
+    table[0x09] = &CP1::soft_to_integer<std::int64_t, ieee754::ZERO, T>;         // TRUNC.L
+    table[0x0A] = &CP1::soft_to_integer<std::int64_t, ieee754::UP, T>;           // CEIL.L
+    table[0x0B] = &CP1::soft_to_integer<std::int64_t, ieee754::DOWN, T>;         // FLOOR.L
+    table[0x0C] = &CP1::soft_to_integer<std::int32_t, ieee754::NEAREST_AWAY, T>; // ROUND.W
+    table[0x0D] = &CP1::soft_to_integer<std::int32_t, ieee754::ZERO, T>;         // TRUNC.W
+    table[0x0E] = &CP1::soft_to_integer<std::int32_t, ieee754::UP, T>;           // CEIL.W
+    table[0x0F] = &CP1::soft_to_integer<std::int32_t, ieee754::DOWN, T>;         // FLOOR.W
+    table[0x15] = &CP1::soft_unary<SoftRecip, T>;
+    table[0x16] = &CP1::soft_unary<SoftRsqrt, T>;
+    table[0x18] = &CP1::soft_ternary<SoftMaddf, T>;
+    table[0x19] = &CP1::soft_ternary<SoftMsubf, T>;
+    table[0x1A] = &CP1::soft_rint<T>;
+    table[0x20] = &CP1::soft_cvt<float, T>;
+    table[0x21] = &CP1::soft_cvt<double, T>;
+    table[0x24] = &CP1::soft_to_integer<std::int32_t, ieee754::ZERO, T>; // CVT.W
+    table[0x25] = &CP1::soft_to_integer<std::int64_t, ieee754::ZERO, T>; // CVT.L
+
+    return table;
+  };
+
+  constexpr auto soft_fmt_W_L_fn_table = []( auto integer, std::array<Instruction, 64> table ) constexpr
+  {
+    using I = decltype( integer );
+
+    table[0x20] = &CP1::soft_cvt<float, I>;
+    table[0x21] = &CP1::soft_cvt<double, I>;
+
+    return table;
   };
 
-  int v;
+  static constexpr auto fmt_S_fn_table = fmt_S_D_fn_table( float{} );
+  static constexpr auto fmt_D_fn_table = fmt_S_D_fn_table( double{} );
+  static constexpr auto fmt_W_fn_table = fmt_W_L_fn_table( float{}, std::int32_t{} );
+  static constexpr auto fmt_L_fn_table = fmt_W_L_fn_table( double{}, std::int64_t{} );
+
+  static constexpr auto soft_fmt_S_fn_table = soft_fmt_S_D_fn_table( float{}, fmt_S_fn_table );
+  static constexpr auto soft_fmt_D_fn_table = soft_fmt_S_D_fn_table( double{}, fmt_D_fn_table );
+  static constexpr auto soft_fmt_W_fn_table = soft_fmt_W_L_fn_table( std::int32_t{}, fmt_W_fn_table );
+  static constexpr auto soft_fmt_L_fn_table = soft_fmt_W_L_fn_table( std::int64_t{}, fmt_L_fn_table );
+
+  Instruction instruction;
 
   switch ( fmt( word ) )
   {
   default:
     return RESERVED;
   case FMT_S:
+    instruction = ( soft ? soft_fmt_S_fn_table : fmt_S_fn_table )[word & FUNCTION];
+    break;
   case FMT_D:
-    v = ( this->*fmt_S_D_fn_table[word & FUNCTION] )( word );
+    instruction = ( soft ? soft_fmt_D_fn_table : fmt_D_fn_table )[word & FUNCTION];
     break;
   case FMT_W:
+    instruction = ( soft ? soft_fmt_W_fn_table : fmt_W_fn_table )[word & FUNCTION];
+    break;
   case FMT_L:
-    v = ( this->*fmt_W_L_fn_table[word & FUNCTION] )( word );
+    instruction = ( soft ? soft_fmt_L_fn_table : fmt_L_fn_table )[word & FUNCTION];
     break;
   }
 
+  int const v = ( this->*instruction )( word );
+
   if ( v == 1 )
   {
     return ( CP1::Exception )cause();
@@ -445,518 +659,355 @@ int CP1::unimplemented( std::uint32_t ) noexcept
   return 1;
 }
 
+template <typename T>
 int CP1::add( std::uint32_t word ) noexcept
 {
-  auto _add = [ this, word ] ( auto t )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
-    auto const _ft = ft( word );
-
-    auto const res = this->fpr[_fs].*t + this->fpr[_ft].*t;
-    if ( handle_fpu_ex() ) return 1;
-    this->fpr[_fd].*t = res;
-    return 0;
-  };
+  constexpr auto t = Format<T>::value;
 
-  auto const _fmt = fmt( word );
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
+  auto const _ft = ft( word );
 
-  if ( _fmt == FMT_S )
-    return _add( &FPR::f );
-  else
-    return _add( &FPR::d );
+  auto const res = this->fpr[_fs].*t + this->fpr[_ft].*t;
+  if ( handle_fpu_ex( res ) ) return 1;
+  this->fpr[_fd].*t = res;
+  return 0;
 }
+template <typename T>
 int CP1::sub( std::uint32_t word ) noexcept
 {
-  auto _sub = [ this, word ] ( auto t )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
-    auto const _ft = ft( word );
+  constexpr auto t = Format<T>::value;
 
-    auto const res = this->fpr[_fs].*t - this->fpr[_ft].*t;
-    if ( handle_fpu_ex() ) return 1;
-    this->fpr[_fd].*t = res;
-
-    return 0;
-  };
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
+  auto const _ft = ft( word );
 
-  auto const _fmt = fmt( word );
+  auto const res = this->fpr[_fs].*t - this->fpr[_ft].*t;
+  if ( handle_fpu_ex( res ) ) return 1;
+  this->fpr[_fd].*t = res;
 
-  if ( _fmt == FMT_S )
-    return _sub( &FPR::f );
-  else
-    return _sub( &FPR::d );
+  return 0;
 }
+template <typename T>
 int CP1::mul( std::uint32_t word ) noexcept
 {
-  auto _mul = [ this, word ] ( auto t )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
-    auto const _ft = ft( word );
-
-    auto const res = this->fpr[_fs].*t * this->fpr[_ft].*t;
-    if ( handle_fpu_ex() ) return 1;
-    this->fpr[_fd].*t = res;
+  constexpr auto t = Format<T>::value;
 
-    return 0;
-  };
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
+  auto const _ft = ft( word );
 
-  auto const _fmt = fmt( word );
+  auto const res = this->fpr[_fs].*t * this->fpr[_ft].*t;
+  if ( handle_fpu_ex( res ) ) return 1;
+  this->fpr[_fd].*t = res;
 
-  if ( _fmt == FMT_S )
-    return _mul( &FPR::f );
-  else
-    return _mul( &FPR::d );
+  return 0;
 }
+template <typename T>
 int CP1::div( std::uint32_t word ) noexcept
 {
-  auto _div = [ this, word ] ( auto t )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
-    auto const _ft = ft( word );
+  constexpr auto t = Format<T>::value;
 
-    auto const res = this->fpr[_fs].*t / this->fpr[_ft].*t;
-    if ( handle_fpu_ex() ) return 1;
-    this->fpr[_fd].*t = res;
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
+  auto const _ft = ft( word );
 
-    return 0;
-  };
-
-  auto const _fmt = fmt( word );
+  auto const res = this->fpr[_fs].*t / this->fpr[_ft].*t;
+  if ( handle_fpu_ex( res ) ) return 1;
+  this->fpr[_fd].*t = res;
 
-  if ( _fmt == FMT_S )
-    return _div( &FPR::f );
-  else
-    return _div( &FPR::d );
+  return 0;
 }
+template <typename T>
 int CP1::sqrt( std::uint32_t word ) noexcept
 {
-  auto const _fmt = fmt( word );
-
-  auto _sqrt = [ this, word ] ( auto t )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
+  constexpr auto t = Format<T>::value;
 
-    auto const res = std::sqrt( this->fpr[_fs].*t );
-    if ( handle_fpu_ex() ) return 1;
-    this->fpr[_fd].*t = res;
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
 
-    return 0;
-  };
+  auto const res = std::sqrt( this->fpr[_fs].*t );
+  if ( handle_fpu_ex( res ) ) return 1;
+  this->fpr[_fd].*t = res;
 
-  if ( _fmt == FMT_S )
-    return _sqrt( &FPR::f );
-  else
-    return _sqrt( &FPR::d );
+  return 0;
 }
+template <typename T>
 int CP1::abs( std::uint32_t word ) noexcept
 {
-  auto _abs = [ this, word ] ( auto t )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
+  constexpr auto t = Format<T>::value;
 
-    auto const res = std::fabs( this->fpr[_fs].*t );
-    if ( handle_fpu_ex() ) return 1;
-    this->fpr[_fd].*t = res;
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
 
-    return 0;
-  };
-
-  auto const _fmt = fmt( word );
+  auto const res = std::fabs( this->fpr[_fs].*t );
+  if ( handle_fpu_ex( res ) ) return 1;
+  this->fpr[_fd].*t = res;
 
-  if ( _fmt == FMT_S )
-    return _abs( &FPR::f );
-  else
-    return _abs( &FPR::d );
+  return 0;
 }
+template <typename T>
 int CP1::mov( std::uint32_t word ) noexcept
 {
-  auto _mov = [ this, word ] ( auto t )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
+  constexpr auto t = Format<T>::value;
 
-    auto const res = this->fpr[_fs].*t;
-    if ( handle_fpu_ex() ) return 1;
-    this->fpr[_fd].*t = res;
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
 
-    return 0;
-  };
-
-  auto const _fmt = fmt( word );
+  auto const res = this->fpr[_fs].*t;
+  if ( handle_fpu_ex( res ) ) return 1;
+  this->fpr[_fd].*t = res;
 
-  if ( _fmt == FMT_S )
-    return _mov( &FPR::f );
-  else
-    return _mov( &FPR::d );
+  return 0;
 }
+template <typename T>
 int CP1::neg( std::uint32_t word ) noexcept
 {
-  auto _neg = [ this, word ] ( auto t )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
+  constexpr auto t = Format<T>::value;
 
-    auto const res = -( this->fpr[_fs].*t );
-    if ( handle_fpu_ex() ) return 1;
-    this->fpr[_fd].*t = res;
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
 
-    return 0;
-  };
-
-  auto const _fmt = fmt( word );
+  auto const res = -( this->fpr[_fs].*t );
+  if ( handle_fpu_ex( res ) ) return 1;
+  this->fpr[_fd].*t = res;
 
-  if ( _fmt == FMT_S )
-    return _neg( &FPR::f );
-  else
-    return _neg( &FPR::d );
+  return 0;
 }
+template <typename T>
 int CP1::round_l( std::uint32_t word ) noexcept
 {
-  auto _round_l = [ this, word ] ( auto t )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
+  constexpr auto t = Format<T>::value;
 
-    auto const res = std::llround( this->fpr[_fs].*t );
-    if ( handle_fpu_ex() ) return 1;
-    this->fpr[_fd].i64 = std::uint64_t( res );
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
 
-    return 0;
-  };
-
-  auto const _fmt = fmt( word );
+  auto const res = std::llround( this->fpr[_fs].*t );
+  if ( handle_fpu_ex( res ) ) return 1;
+  this->fpr[_fd].i64 = std::uint64_t( res );
 
-  if ( _fmt == FMT_S )
-    return _round_l( &FPR::f );
-  else
-    return _round_l( &FPR::d );
+  return 0;
 }
+template <typename T>
 int CP1::trunc_l( std::uint32_t word ) noexcept
 {
-  auto _trunc_l = [ this, word ] ( auto t )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
+  constexpr auto t = Format<T>::value;
 
-    auto const res = ( std::uint64_t )std::trunc( this->fpr[_fs].*t );
-    if ( handle_fpu_ex() ) return 1;
-    this->fpr[_fd].i64 = res;
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
 
-    return 0;
-  };
-
-  auto const _fmt = fmt( word );
+  auto const res = ( std::uint64_t )std::trunc( this->fpr[_fs].*t );
+  if ( handle_fpu_ex( res ) ) return 1;
+  this->fpr[_fd].i64 = res;
 
-  if ( _fmt == FMT_S )
-    return _trunc_l( &FPR::f );
-  else
-    return _trunc_l( &FPR::d );
+  return 0;
 }
+template <typename T>
 int CP1::ceil_l( std::uint32_t word ) noexcept
 {
-  auto _ceil_l = [ this, word ] ( auto t )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
+  constexpr auto t = Format<T>::value;
 
-    auto const res = ( std::uint64_t )std::ceil( this->fpr[_fs].*t );
-    if ( handle_fpu_ex() ) return 1;
-    this->fpr[_fd].i64 = res;
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
 
-    return 0;
-  };
-
-  auto const _fmt = fmt( word );
+  auto const res = ( std::uint64_t )std::ceil( this->fpr[_fs].*t );
+  if ( handle_fpu_ex( res ) ) return 1;
+  this->fpr[_fd].i64 = res;
 
-  if ( _fmt == FMT_S )
-    return _ceil_l( &FPR::f );
-  else
-    return _ceil_l( &FPR::d );
+  return 0;
 }
+template <typename T>
 int CP1::floor_l( std::uint32_t word ) noexcept
 {
-  auto _floor_l = [ this, word ] ( auto t )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
+  constexpr auto t = Format<T>::value;
 
-    auto const res = ( std::uint64_t )std::floor( this->fpr[_fs].*t );
-    if ( handle_fpu_ex() ) return 1;
-    this->fpr[_fd].i64 = res;
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
 
-    return 0;
-  };
-
-  auto const _fmt = fmt( word );
+  auto const res = ( std::uint64_t )std::floor( this->fpr[_fs].*t );
+  if ( handle_fpu_ex( res ) ) return 1;
+  this->fpr[_fd].i64 = res;
 
-  if ( _fmt == FMT_S )
-    return _floor_l( &FPR::f );
-  else
-    return _floor_l( &FPR::d );
+  return 0;
 }
+template <typename T>
 int CP1::round_w( std::uint32_t word ) noexcept
 {
-  auto _round_w = [ this, word ] ( auto t )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
+  constexpr auto t = Format<T>::value;
 
-    auto const res = std::lround( this->fpr[_fs].*t );
-    if ( handle_fpu_ex() ) return 1;
-    this->fpr[_fd].i32 = std::uint32_t( res );
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
 
-    return 0;
-  };
-
-  auto const _fmt = fmt( word );
+  auto const res = std::lround( this->fpr[_fs].*t );
+  if ( handle_fpu_ex( res ) ) return 1;
+  this->fpr[_fd].i32 = std::uint32_t( res );
 
-  if ( _fmt == FMT_S )
-    return _round_w( &FPR::f );
-  else
-    return _round_w( &FPR::d );
+  return 0;
 }
+template <typename T>
 int CP1::trunc_w( std::uint32_t word ) noexcept
 {
-  auto _trunc_w = [ this, word ] ( auto t )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
+  constexpr auto t = Format<T>::value;
 
-    auto const res = ( std::uint32_t )std::trunc( this->fpr[_fs].*t );
-    if ( handle_fpu_ex() ) return 1;
-    this->fpr[_fd].i32 = res;
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
 
-    return 0;
-  };
-
-  auto const _fmt = fmt( word );
+  auto const res = ( std::uint32_t )std::trunc( this->fpr[_fs].*t );
+  if ( handle_fpu_ex( res ) ) return 1;
+  this->fpr[_fd].i32 = res;
 
-  if ( _fmt == FMT_S )
-    return _trunc_w( &FPR::f );
-  else
-    return _trunc_w( &FPR::d );
+  return 0;
 }
+template <typename T>
 int CP1::ceil_w( std::uint32_t word ) noexcept
 {
-  auto _ceil_w = [ this, word ] ( auto t )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
+  constexpr auto t = Format<T>::value;
 
-    auto const res = ( std::uint32_t )std::ceil( this->fpr[_fs].*t );
-    if ( handle_fpu_ex() ) return 1;
-    this->fpr[_fd].i32 = res;
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
 
-    return 0;
-  };
-
-  auto const _fmt = fmt( word );
+  auto const res = ( std::uint32_t )std::ceil( this->fpr[_fs].*t );
+  if ( handle_fpu_ex( res ) ) return 1;
+  this->fpr[_fd].i32 = res;
 
-  if ( _fmt == FMT_S )
-    return _ceil_w( &FPR::f );
-  else
-    return _ceil_w( &FPR::d );
+  return 0;
 }
+template <typename T>
 int CP1::floor_w( std::uint32_t word ) noexcept
 {
-  auto _floor_w = [ this, word ] ( auto t )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
+  constexpr auto t = Format<T>::value;
 
-    auto const res = ( std::uint32_t )std::floor( this->fpr[_fs].*t );
-    if ( handle_fpu_ex() ) return 1;
-    this->fpr[_fd].i32 = res;
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
 
-    return 0;
-  };
-
-  auto const _fmt = fmt( word );
+  auto const res = ( std::uint32_t )std::floor( this->fpr[_fs].*t );
+  if ( handle_fpu_ex( res ) ) return 1;
+  this->fpr[_fd].i32 = res;
 
-  if ( _fmt == FMT_S )
-    return _floor_w( &FPR::f );
-  else
-    return _floor_w( &FPR::d );
+  return 0;
 }
+template <typename T>
 int CP1::sel( std::uint32_t word ) noexcept
 {
-  auto _sel = [ this, word ] ( auto t, auto i )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
-    auto const _ft = ft( word );
-
-    auto const res = this->fpr[_fd].*i & 0x1 ? this->fpr[_ft].*t : this->fpr[_fs].*t;
-    if ( handle_fpu_ex() ) return 1;
-    this->fpr[_fd].*t = res;
+  constexpr auto t = Format<T>::value;
+  constexpr auto i = Format<T>::bits;
 
-    return 0;
-  };
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
+  auto const _ft = ft( word );
 
-  auto const _fmt = fmt( word );
+  auto const res = this->fpr[_fd].*i & 0x1 ? this->fpr[_ft].*t : this->fpr[_fs].*t;
+  if ( handle_fpu_ex( res ) ) return 1;
+  this->fpr[_fd].*t = res;
 
-  if ( _fmt == FMT_S )
-    return _sel( &FPR::f, &FPR::i32 );
-  else
-    return _sel( &FPR::d, &FPR::i64 );
+  return 0;
 }
+template <typename T>
 int CP1::seleqz( std::uint32_t word ) noexcept
 {
-  auto _seleqz = [ this, word ] ( auto t, auto i )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
-    auto const _ft = ft( word );
+  constexpr auto t = Format<T>::value;
+  constexpr auto i = Format<T>::bits;
 
-    auto const res = this->fpr[_ft].*i & 0x1 ? 0 : this->fpr[_fs].*t;
-    if ( handle_fpu_ex() ) return 1;
-    this->fpr[_fd].*t = res;
-
-    return 0;
-  };
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
+  auto const _ft = ft( word );
 
-  auto const _fmt = fmt( word );
+  auto const res = this->fpr[_ft].*i & 0x1 ? 0 : this->fpr[_fs].*t;
+  if ( handle_fpu_ex( res ) ) return 1;
+  this->fpr[_fd].*t = res;
 
-  if ( _fmt == FMT_S )
-    return _seleqz( &FPR::f, &FPR::i32 );
-  else
-    return _seleqz( &FPR::d, &FPR::i64 );
+  return 0;
 }
+template <typename T>
 int CP1::recip( std::uint32_t word ) noexcept
 {
-  auto _recip = [ this, word ] ( auto t )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
+  constexpr auto t = Format<T>::value;
 
-    auto const res = MIPS32_STATIC_CAST( t, 1.0 ) / this->fpr[_fs].*t;
-    if ( handle_fpu_ex() ) return 1;
-    this->fpr[_fd].*t = res;
-
-    return 0;
-  };
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
 
-  auto const _fmt = fmt( word );
+  auto const res = MIPS32_STATIC_CAST( t, 1.0 ) / this->fpr[_fs].*t;
+  if ( handle_fpu_ex( res ) ) return 1;
+  this->fpr[_fd].*t = res;
 
-  if ( _fmt == FMT_S )
-    return _recip( &FPR::f );
-  else
-    return _recip( &FPR::d );
+  return 0;
 }
+template <typename T>
 int CP1::rsqrt( std::uint32_t word ) noexcept
 {
-  auto _rsqrt = [ this, word ] ( auto t )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
+  constexpr auto t = Format<T>::value;
 
-    auto const res = 1.0f / std::sqrt( this->fpr[_fs].*t );
-    if ( handle_fpu_ex() ) return 1;
-    this->fpr[_fd].*t = res;
-
-    return 0;
-  };
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
 
-  auto const _fmt = fmt( word );
+  auto const res = 1.0f / std::sqrt( this->fpr[_fs].*t );
+  if ( handle_fpu_ex( res ) ) return 1;
+  this->fpr[_fd].*t = res;
 
-  if ( _fmt == FMT_S )
-    return _rsqrt( &FPR::f );
-  else
-    return _rsqrt( &FPR::d );
+  return 0;
 }
+template <typename T>
 int CP1::selnez( std::uint32_t word ) noexcept
 {
-  auto _selnez = [ this, word ] ( auto t, auto i )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
-    auto const _ft = ft( word );
+  constexpr auto t = Format<T>::value;
+  constexpr auto i = Format<T>::bits;
 
-    auto const res = this->fpr[_ft].*i & 0x1 ? this->fpr[_fs].*t : 0;
-    if ( handle_fpu_ex() ) return 1;
-    this->fpr[_fd].*t = res;
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
+  auto const _ft = ft( word );
 
-    return 0;
-  };
-
-  auto const _fmt = fmt( word );
+  auto const res = this->fpr[_ft].*i & 0x1 ? this->fpr[_fs].*t : 0;
+  if ( handle_fpu_ex( res ) ) return 1;
+  this->fpr[_fd].*t = res;
 
-  if ( _fmt == FMT_S )
-    return _selnez( &FPR::f, &FPR::i32 );
-  else
-    return _selnez( &FPR::d, &FPR::i64 );
+  return 0;
 }
+template <typename T>
 int CP1::maddf( std::uint32_t word ) noexcept
 {
-  auto _maddf = [ this, word ] ( auto t )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
-    auto const _ft = ft( word );
-
-    auto const res = std::fma( this->fpr[_fs].*t, this->fpr[_ft].*t, this->fpr[_fd].*t );
-    if ( handle_fpu_ex() ) return 1;
-    this->fpr[_fd].*t = res;
+  constexpr auto t = Format<T>::value;
 
-    return 0;
-  };
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
+  auto const _ft = ft( word );
 
-  auto const _fmt = fmt( word );
+  auto const res = std::fma( this->fpr[_fs].*t, this->fpr[_ft].*t, this->fpr[_fd].*t );
+  if ( handle_fpu_ex( res ) ) return 1;
+  this->fpr[_fd].*t = res;
 
-  if ( _fmt == FMT_S )
-    return _maddf( &FPR::f );
-  else
-    return _maddf( &FPR::d );
+  return 0;
 }
+template <typename T>
 int CP1::msubf( std::uint32_t word ) noexcept
 {
-  auto _msubf = [ this, word ] ( auto t )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
-    auto const _ft = ft( word );
-
-    auto const res = this->fpr[_fd].*t - ( this->fpr[_fs].*t / this->fpr[_ft].*t );
-    if ( handle_fpu_ex() ) return 1;
-    this->fpr[_fd].*t = res;
+  constexpr auto t = Format<T>::value;
 
-    return 0;
-  };
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
+  auto const _ft = ft( word );
 
-  auto const _fmt = fmt( word );
+  auto const res = std::fma( -( this->fpr[_fs].*t ), this->fpr[_ft].*t, this->fpr[_fd].*t );
+  if ( handle_fpu_ex( res ) ) return 1;
+  this->fpr[_fd].*t = res;
 
-  if ( _fmt == FMT_S )
-    return _msubf( &FPR::f );
-  else
-    return _msubf( &FPR::d );
+  return 0;
 }
+template <typename T>
 int CP1::rint( std::uint32_t word ) noexcept
 {
-  auto _rint = [ this, word ] ( auto t, auto i )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
+  constexpr auto t = Format<T>::value;
+  constexpr auto i = Format<T>::bits;
 
-    auto const res = MIPS32_STATIC_CAST( i, std::llrint( this->fpr[_fs].*t ) );
-    if ( handle_fpu_ex() ) return 1;
-    this->fpr[_fd].*i = res;
-
-    return 0;
-  };
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
 
-  auto const _fmt = fmt( word );
+  auto const res = MIPS32_STATIC_CAST( i, std::llrint( this->fpr[_fs].*t ) );
+  if ( handle_fpu_ex( res ) ) return 1;
+  this->fpr[_fd].*i = res;
 
-  if ( _fmt == FMT_S )
-    return _rint( &FPR::f, &FPR::i32 );
-  else
-    return _rint( &FPR::d, &FPR::i64 );
+  return 0;
 }
+template <typename T>
 int CP1::class_( std::uint32_t word ) noexcept
 {
   /*
@@ -978,472 +1029,316 @@ int CP1::class_( std::uint32_t word ) noexcept
   - and zero (bit 9).
   */
 
-  auto _classify = [ this, word ] ( auto t, auto i )
-  {
-//constexpr std::uint32_t SNAN{0x01};
-    constexpr std::uint32_t QNAN{ 0x02 };
-    constexpr std::uint32_t INFINITY_{ 0x04 };
-    constexpr std::uint32_t NORMAL{ 0x08 };
-    constexpr std::uint32_t SUBNORMAL{ 0x10 };
-    constexpr std::uint32_t ZERO{ 0x20 };
+  constexpr auto t = Format<T>::value;
+  constexpr auto i = Format<T>::bits;
 
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
-
-    auto value = this->fpr[_fs].*t; // copy in case fd == fs
+//constexpr std::uint32_t SNAN{0x01};
+  constexpr std::uint32_t QNAN{ 0x02 };
+  constexpr std::uint32_t INFINITY_{ 0x04 };
+  constexpr std::uint32_t NORMAL{ 0x08 };
+  constexpr std::uint32_t SUBNORMAL{ 0x10 };
+  constexpr std::uint32_t ZERO{ 0x20 };
 
-    auto class_type = std::fpclassify( value );
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
 
-    switch ( class_type )
-    {
-    case FP_INFINITE: this->fpr[_fd].*i = INFINITY_; break;
-    case FP_NAN: this->fpr[_fd].*i = QNAN; break;
-    case FP_NORMAL: this->fpr[_fd].*i = NORMAL; break;
-    case FP_SUBNORMAL: this->fpr[_fd].*i = SUBNORMAL; break;
-    case FP_ZERO: this->fpr[_fd].*i = ZERO; break;
-    }
+  auto value = this->fpr[_fs].*t; // copy in case fd == fs
 
-    if ( class_type != FP_NAN && !std::signbit( value ) )
-    {
-      this->fpr[_fd].*i <<= 4;
-    }
+  auto class_type = std::fpclassify( value );
 
-    return 0;
-  };
+  switch ( class_type )
+  {
+  case FP_INFINITE: this->fpr[_fd].*i = INFINITY_; break;
+  case FP_NAN: this->fpr[_fd].*i = QNAN; break;
+  case FP_NORMAL: this->fpr[_fd].*i = NORMAL; break;
+  case FP_SUBNORMAL: this->fpr[_fd].*i = SUBNORMAL; break;
+  case FP_ZERO: this->fpr[_fd].*i = ZERO; break;
+  }
 
-  auto const _fmt = fmt( word );
+  if ( class_type != FP_NAN && !std::signbit( value ) )
+  {
+    this->fpr[_fd].*i <<= 4;
+  }
 
-  if ( _fmt == FMT_S )
-    return _classify( &FPR::f, &FPR::i32 );
-  else
-    return _classify( &FPR::d, &FPR::i64 );
+  return 0;
 }
+template <typename T>
 int CP1::min( std::uint32_t word ) noexcept
 {
-  auto _min = [ this, word ] ( auto t )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
-    auto const _ft = ft( word );
+  constexpr auto t = Format<T>::value;
 
-    auto const res = std::fmin( this->fpr[_fs].*t, this->fpr[_ft].*t );
-    if ( handle_fpu_ex() ) return 1;
-    this->fpr[_fd].*t = res;
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
+  auto const _ft = ft( word );
 
-    return 0;
-  };
+  auto const res = std::fmin( this->fpr[_fs].*t, this->fpr[_ft].*t );
+  if ( handle_fpu_ex( res ) ) return 1;
+  this->fpr[_fd].*t = res;
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_S )
-    return _min( &FPR::f );
-  else
-    return _min( &FPR::d );
+  return 0;
 }
+template <typename T>
 int CP1::max( std::uint32_t word ) noexcept
 {
-  auto _max = [ this, word ] ( auto t )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
-    auto const _ft = ft( word );
+  constexpr auto t = Format<T>::value;
 
-    auto const res = std::fmax( this->fpr[_fs].*t, this->fpr[_ft].*t );
-    if ( handle_fpu_ex() ) return 1;
-    this->fpr[_fd].*t = res;
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
+  auto const _ft = ft( word );
 
-    return 0;
-  };
+  auto const res = std::fmax( this->fpr[_fs].*t, this->fpr[_ft].*t );
+  if ( handle_fpu_ex( res ) ) return 1;
+  this->fpr[_fd].*t = res;
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_S )
-    return _max( &FPR::f );
-  else
-    return _max( &FPR::d );
+  return 0;
 }
+template <typename T>
 int CP1::mina( std::uint32_t word ) noexcept
 {
-  auto _mina = [ this, word ] ( auto t )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
-    auto const _ft = ft( word );
+  constexpr auto t = Format<T>::value;
 
-    auto const res = std::fmin( std::fabs( this->fpr[_fs].*t ), std::fabs( this->fpr[_ft].*t ) );
-    if ( handle_fpu_ex() ) return 1;
-    this->fpr[_fd].*t = res;
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
+  auto const _ft = ft( word );
 
-    return 0;
-  };
+  auto const res = std::fmin( std::fabs( this->fpr[_fs].*t ), std::fabs( this->fpr[_ft].*t ) );
+  if ( handle_fpu_ex( res ) ) return 1;
+  this->fpr[_fd].*t = res;
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_S )
-    return _mina( &FPR::f );
-  else
-    return _mina( &FPR::d );
+  return 0;
 }
+template <typename T>
 int CP1::maxa( std::uint32_t word ) noexcept
 {
-  auto _maxa = [ this, word ] ( auto t )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
-    auto const _ft = ft( word );
+  constexpr auto t = Format<T>::value;
 
-    auto const res = std::fmax( std::fabs( this->fpr[_fs].*t ), std::fabs( this->fpr[_ft].*t ) );
-    if ( handle_fpu_ex() ) return 1;
-    this->fpr[_fd].*t = res;
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
+  auto const _ft = ft( word );
 
-    return 0;
-  };
+  auto const res = std::fmax( std::fabs( this->fpr[_fs].*t ), std::fabs( this->fpr[_ft].*t ) );
+  if ( handle_fpu_ex( res ) ) return 1;
+  this->fpr[_fd].*t = res;
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_S )
-    return _maxa( &FPR::f );
-  else
-    return _maxa( &FPR::d );
+  return 0;
 }
-int CP1::cvt_s( std::uint32_t word ) noexcept
+template <typename To, typename From>
+int CP1::cvt( std::uint32_t word ) noexcept
 {
-  auto _cvt_s = [ this, word ] ( auto t, int raw_data_type )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
-
-    float res;
-
-    if ( raw_data_type == 0 )
-      res = ( float )( this->fpr[_fs].*t );
-    else if ( raw_data_type == 1 )
-      res = ( float )( std::int32_t )( this->fpr[_fs].*t );
-    else
-      res = ( float )( std::int64_t )( this->fpr[_fs].*t );
-
-    if ( handle_fpu_ex() ) return 1;
-    this->fpr[_fd].f = res;
-
-    return 0;
-  };
-
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_D )
-    return _cvt_s( &FPR::d, 0 );
-  else if ( _fmt == FMT_W )
-    return _cvt_s( &FPR::i32, 1 );
+  // CVT.S.S and CVT.D.D
+  if constexpr ( std::is_same_v<To, From> )
+    return reserved( word );
   else
-    return _cvt_s( &FPR::i64, 2 );
-}
-int CP1::cvt_d( std::uint32_t word ) noexcept
-{
-  auto _cvt_d = [ this, word ] ( auto t, int raw_data_type )
   {
+    constexpr auto to = Format<To>::value;
+    constexpr auto from = Format<From>::value;
+
     auto const _fd = fd( word );
     auto const _fs = fs( word );
 
-    double res;
-    if ( raw_data_type == 0 )
-      res = ( double )( this->fpr[_fs].*t );
-    else if ( raw_data_type == 1 )
-      res = ( double )( std::int32_t )( this->fpr[_fs].*t );
-    else
-      res = ( double )( std::int64_t )( this->fpr[_fs].*t );
-
-    if ( handle_fpu_ex() ) return 1;
-    this->fpr[_fd].d = res;
+    auto const res = ( To )( From )( this->fpr[_fs].*from );
+    if ( handle_fpu_ex( res ) ) return 1;
+    this->fpr[_fd].*to = res;
 
     return 0;
-  };
-
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == FMT_S )
-    return _cvt_d( &FPR::f, 0 );
-  else if ( _fmt == FMT_W )
-    return _cvt_d( &FPR::i32, 1 );
-  else
-    return _cvt_d( &FPR::i64, 2 );
+  }
 }
+template <typename T>
 int CP1::cvt_l( std::uint32_t word ) noexcept
 {
-  auto _cvt_l = [ this, word ] ( auto t )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
+  constexpr auto t = Format<T>::value;
 
-    auto const res = ( std::uint64_t )( this->fpr[_fs].*t );
-    if ( handle_fpu_ex() ) return 1;
-    this->fpr[_fd].i64 = res;
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
 
-    return 0;
-  };
-
-  auto const _fmt = fmt( word );
+  auto const res = ( std::uint64_t )( this->fpr[_fs].*t );
+  if ( handle_fpu_ex( res ) ) return 1;
+  this->fpr[_fd].i64 = res;
 
-  if ( _fmt == FMT_D )
-    return _cvt_l( &FPR::d );
-  else
-    return _cvt_l( &FPR::f );
+  return 0;
 }
+template <typename T>
 int CP1::cvt_w( std::uint32_t word ) noexcept
 {
-  auto _cvt_w = [ this, word ] ( auto t )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
+  constexpr auto t = Format<T>::value;
 
-    auto const res = ( std::uint32_t )( this->fpr[_fs].*t );
-    if ( handle_fpu_ex() ) return 1;
-    this->fpr[_fd].i32 = res;
-
-    return 0;
-  };
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
 
-  auto const _fmt = fmt( word );
+  auto const res = ( std::uint32_t )( this->fpr[_fs].*t );
+  if ( handle_fpu_ex( res ) ) return 1;
+  this->fpr[_fd].i32 = res;
 
-  if ( _fmt == FMT_D )
-    return _cvt_w( &FPR::d );
-  else
-    return _cvt_w( &FPR::f );
+  return 0;
 }
+template <typename T>
 int CP1::cmp_af( std::uint32_t word ) noexcept
 {
-  auto _cmp_af = [ this, word ] ( auto i )
-  {
-    auto const _fd = fd( word );
+  constexpr auto i = Format<T>::bits;
 
-    this->fpr[_fd].*i = CMP_FALSE;
+  auto const _fd = fd( word );
 
-    return 0;
-  };
+  this->fpr[_fd].*i = CMP_FALSE;
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == CMP_FMT_S )
-    return _cmp_af( &FPR::i32 );
-  else
-    return _cmp_af( &FPR::i64 );
+  return 0;
 }
+template <typename T>
 int CP1::cmp_un( std::uint32_t word ) noexcept
 {
-  auto _cmp_un = [ this, word ] ( auto t, auto i )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
-    auto const _ft = ft( word );
+  constexpr auto t = Format<T>::value;
+  constexpr auto i = Format<T>::bits;
 
-    if ( std::isunordered( fpr[_fs].*t, fpr[_ft].*t ) )
-      this->fpr[_fd].*i = MIPS32_STATIC_CAST( i, CMP_TRUE );
-    else
-      this->fpr[_fd].*i = MIPS32_STATIC_CAST( i, CMP_FALSE );
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
+  auto const _ft = ft( word );
 
-    return 0;
-  };
-
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == CMP_FMT_S )
-    return _cmp_un( &FPR::f, &FPR::i32 );
+  if ( std::isunordered( fpr[_fs].*t, fpr[_ft].*t ) )
+    this->fpr[_fd].*i = MIPS32_STATIC_CAST( i, CMP_TRUE );
   else
-    return _cmp_un( &FPR::d, &FPR::i64 );
+    this->fpr[_fd].*i = MIPS32_STATIC_CAST( i, CMP_FALSE );
+
+  return 0;
 }
+template <typename T>
 int CP1::cmp_eq( std::uint32_t word ) noexcept
 {
-  auto _cmp_eq = [ this, word ] ( auto t, auto i )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
-    auto const _ft = ft( word );
+  constexpr auto t = Format<T>::value;
+  constexpr auto i = Format<T>::bits;
 
-    this->fpr[_fd].*i = this->fpr[_fs].*t == this->fpr[_ft].*t ? MIPS32_STATIC_CAST( i, CMP_TRUE ) : MIPS32_STATIC_CAST( i, CMP_FALSE );
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
+  auto const _ft = ft( word );
 
-    return 0;
-  };
+  this->fpr[_fd].*i = this->fpr[_fs].*t == this->fpr[_ft].*t ? MIPS32_STATIC_CAST( i, CMP_TRUE ) : MIPS32_STATIC_CAST( i, CMP_FALSE );
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == CMP_FMT_S )
-    return _cmp_eq( &FPR::f, &FPR::i32 );
-  else
-    return _cmp_eq( &FPR::d, &FPR::i64 );
+  return 0;
 }
+template <typename T>
 int CP1::cmp_ueq( std::uint32_t word ) noexcept
 {
-  auto _cmp_ueq = [ this, word ] ( auto t, auto i )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
-    auto const _ft = ft( word );
+  constexpr auto t = Format<T>::value;
+  constexpr auto i = Format<T>::bits;
 
-    this->fpr[_fd].*i = std::isunordered( this->fpr[_fs].*t, this->fpr[_ft].*t ) ? MIPS32_STATIC_CAST( i, CMP_TRUE ) : MIPS32_STATIC_CAST( i, CMP_FALSE );
-    this->fpr[_fd].*i |= this->fpr[_fs].*t == this->fpr[_ft].*t ? MIPS32_STATIC_CAST( i, CMP_TRUE ) : MIPS32_STATIC_CAST( i, CMP_FALSE );
-
-    return 0;
-  };
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
+  auto const _ft = ft( word );
 
-  auto const _fmt = fmt( word );
+  this->fpr[_fd].*i = std::isunordered( this->fpr[_fs].*t, this->fpr[_ft].*t ) ? MIPS32_STATIC_CAST( i, CMP_TRUE ) : MIPS32_STATIC_CAST( i, CMP_FALSE );
+  this->fpr[_fd].*i |= this->fpr[_fs].*t == this->fpr[_ft].*t ? MIPS32_STATIC_CAST( i, CMP_TRUE ) : MIPS32_STATIC_CAST( i, CMP_FALSE );
 
-  if ( _fmt == CMP_FMT_S )
-    return _cmp_ueq( &FPR::f, &FPR::i32 );
-  else
-    return _cmp_ueq( &FPR::d, &FPR::i64 );
+  return 0;
 }
+template <typename T>
 int CP1::cmp_lt( std::uint32_t word ) noexcept
 {
-  auto _cmp_lt = [ this, word ] ( auto t, auto i )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
-    auto const _ft = ft( word );
-
-    this->fpr[_fd].*i = std::isless( this->fpr[_fs].*t, this->fpr[_ft].*t ) ? MIPS32_STATIC_CAST( i, CMP_TRUE ) : MIPS32_STATIC_CAST( i, CMP_FALSE );
+  constexpr auto t = Format<T>::value;
+  constexpr auto i = Format<T>::bits;
 
-    return 0;
-  };
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
+  auto const _ft = ft( word );
 
-  auto const _fmt = fmt( word );
+  this->fpr[_fd].*i = std::isless( this->fpr[_fs].*t, this->fpr[_ft].*t ) ? MIPS32_STATIC_CAST( i, CMP_TRUE ) : MIPS32_STATIC_CAST( i, CMP_FALSE );
 
-  if ( _fmt == CMP_FMT_S )
-    return _cmp_lt( &FPR::f, &FPR::i32 );
-  else
-    return _cmp_lt( &FPR::d, &FPR::i64 );
+  return 0;
 }
+template <typename T>
 int CP1::cmp_ult( std::uint32_t word ) noexcept
 {
-  auto _cmp_ult = [ this, word ] ( auto t, auto i )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
-    auto const _ft = ft( word );
+  constexpr auto t = Format<T>::value;
+  constexpr auto i = Format<T>::bits;
 
-    this->fpr[_fd].*i = std::isunordered( this->fpr[_fs].*t, this->fpr[_ft].*t ) ? MIPS32_STATIC_CAST( i, CMP_TRUE ) : MIPS32_STATIC_CAST( i, CMP_FALSE );
-    this->fpr[_fd].*i |= std::isless( this->fpr[_fs].*t, this->fpr[_ft].*t ) ? MIPS32_STATIC_CAST( i, CMP_TRUE ) : MIPS32_STATIC_CAST( i, CMP_FALSE );
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
+  auto const _ft = ft( word );
 
-    return 0;
-  };
+  this->fpr[_fd].*i = std::isunordered( this->fpr[_fs].*t, this->fpr[_ft].*t ) ? MIPS32_STATIC_CAST( i, CMP_TRUE ) : MIPS32_STATIC_CAST( i, CMP_FALSE );
+  this->fpr[_fd].*i |= std::isless( this->fpr[_fs].*t, this->fpr[_ft].*t ) ? MIPS32_STATIC_CAST( i, CMP_TRUE ) : MIPS32_STATIC_CAST( i, CMP_FALSE );
 
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == CMP_FMT_S )
-    return _cmp_ult( &FPR::f, &FPR::i32 );
-  else
-    return _cmp_ult( &FPR::d, &FPR::i64 );
+  return 0;
 }
+template <typename T>
 int CP1::cmp_le( std::uint32_t word ) noexcept
 {
-  auto const _fmt = fmt( word );
+  constexpr auto t = Format<T>::value;
+  constexpr auto i = Format<T>::bits;
 
-  auto _cmp_le = [ this, word ] ( auto t, auto i )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
-    auto const _ft = ft( word );
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
+  auto const _ft = ft( word );
 
-    this->fpr[_fd].*i = std::islessequal( this->fpr[_fs].*t, this->fpr[_ft].*t ) ? MIPS32_STATIC_CAST( i, CMP_TRUE ) : MIPS32_STATIC_CAST( i, CMP_FALSE );
+  this->fpr[_fd].*i = std::islessequal( this->fpr[_fs].*t, this->fpr[_ft].*t ) ? MIPS32_STATIC_CAST( i, CMP_TRUE ) : MIPS32_STATIC_CAST( i, CMP_FALSE );
 
-    return 0;
-  };
-
-  if ( _fmt == CMP_FMT_S )
-    return _cmp_le( &FPR::f, &FPR::i32 );
-  else
-    return _cmp_le( &FPR::d, &FPR::i64 );
+  return 0;
 }
+template <typename T>
 int CP1::cmp_ule( std::uint32_t word ) noexcept
 {
-  auto _cmp_ule = [ this, word ] ( auto t, auto i )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
-    auto const _ft = ft( word );
+  constexpr auto t = Format<T>::value;
+  constexpr auto i = Format<T>::bits;
 
-    this->fpr[_fd].*i = std::isunordered( this->fpr[_fs].*t, this->fpr[_ft].*t ) ? MIPS32_STATIC_CAST( i, CMP_TRUE ) : MIPS32_STATIC_CAST( i, CMP_FALSE );
-    this->fpr[_fd].*i |= std::islessequal( this->fpr[_fs].*t, this->fpr[_ft].*t ) ? MIPS32_STATIC_CAST( i, CMP_TRUE ) : MIPS32_STATIC_CAST( i, CMP_FALSE );
-
-    return 0;
-  };
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
+  auto const _ft = ft( word );
 
-  auto const _fmt = fmt( word );
+  this->fpr[_fd].*i = std::isunordered( this->fpr[_fs].*t, this->fpr[_ft].*t ) ? MIPS32_STATIC_CAST( i, CMP_TRUE ) : MIPS32_STATIC_CAST( i, CMP_FALSE );
+  this->fpr[_fd].*i |= std::islessequal( this->fpr[_fs].*t, this->fpr[_ft].*t ) ? MIPS32_STATIC_CAST( i, CMP_TRUE ) : MIPS32_STATIC_CAST( i, CMP_FALSE );
 
-  if ( _fmt == CMP_FMT_S )
-    return _cmp_ule( &FPR::f, &FPR::i32 );
-  else
-    return _cmp_ule( &FPR::d, &FPR::i64 );
+  return 0;
 }
 
+template <typename T>
 int CP1::cmp_or( std::uint32_t word ) noexcept
 {
-  auto _cmp_or = [ this, word ] ( auto t, auto i )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
-    auto const _ft = ft( word );
+  constexpr auto t = Format<T>::value;
+  constexpr auto i = Format<T>::bits;
 
-    if ( !std::isunordered( fpr[_fs].*t, fpr[_ft].*t ) )
-      this->fpr[_fd].*i = MIPS32_STATIC_CAST( i, CMP_TRUE );
-    else
-      this->fpr[_fd].*i = MIPS32_STATIC_CAST( i, CMP_FALSE );
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
+  auto const _ft = ft( word );
 
-    return 0;
-  };
-
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == CMP_FMT_S )
-    return _cmp_or( &FPR::f, &FPR::i32 );
+  if ( !std::isunordered( fpr[_fs].*t, fpr[_ft].*t ) )
+    this->fpr[_fd].*i = MIPS32_STATIC_CAST( i, CMP_TRUE );
   else
-    return _cmp_or( &FPR::d, &FPR::i64 );
+    this->fpr[_fd].*i = MIPS32_STATIC_CAST( i, CMP_FALSE );
+
+  return 0;
 }
 
+template <typename T>
 int CP1::cmp_une( std::uint32_t word ) noexcept
 {
-  auto _cmp_une = [ this, word ] ( auto t, auto i )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
-    auto const _ft = ft( word );
+  constexpr auto t = Format<T>::value;
+  constexpr auto i = Format<T>::bits;
 
-    if ( std::isunordered( this->fpr[_fs].*t, this->fpr[_ft].*t ) || this->fpr[_fs].*t != this->fpr[_ft].*t )
-      this->fpr[_fd].*i = MIPS32_STATIC_CAST( i, CMP_TRUE );
-    else
-      this->fpr[_fd].*i = MIPS32_STATIC_CAST( i, CMP_FALSE );
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
+  auto const _ft = ft( word );
 
-    return 0;
-  };
-
-  auto const _fmt = fmt( word );
-
-  if ( _fmt == CMP_FMT_S )
-    return _cmp_une( &FPR::f, &FPR::i32 );
+  if ( std::isunordered( this->fpr[_fs].*t, this->fpr[_ft].*t ) || this->fpr[_fs].*t != this->fpr[_ft].*t )
+    this->fpr[_fd].*i = MIPS32_STATIC_CAST( i, CMP_TRUE );
   else
-    return _cmp_une( &FPR::d, &FPR::i64 );
+    this->fpr[_fd].*i = MIPS32_STATIC_CAST( i, CMP_FALSE );
+
+  return 0;
 }
 
+template <typename T>
 int CP1::cmp_ne( std::uint32_t word ) noexcept
 {
-  auto _cmp_ne = [ this, word ] ( auto t, auto i )
-  {
-    auto const _fd = fd( word );
-    auto const _fs = fs( word );
-    auto const _ft = ft( word );
-
-    if ( this->fpr[_fs].*t != this->fpr[_ft].*t )
-      this->fpr[_fd].*i = MIPS32_STATIC_CAST( i, CMP_TRUE );
-    else
-      this->fpr[_fd].*i = MIPS32_STATIC_CAST( i, CMP_FALSE );
-
-    return 0;
-  };
+  constexpr auto t = Format<T>::value;
+  constexpr auto i = Format<T>::bits;
 
-  auto const _fmt = fmt( word );
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
+  auto const _ft = ft( word );
 
-  if ( _fmt == CMP_FMT_S )
-    return _cmp_ne( &FPR::f, &FPR::i32 );
+  if ( this->fpr[_fs].*t != this->fpr[_ft].*t )
+    this->fpr[_fd].*i = MIPS32_STATIC_CAST( i, CMP_TRUE );
   else
-    return _cmp_ne( &FPR::d, &FPR::i64 );
+    this->fpr[_fd].*i = MIPS32_STATIC_CAST( i, CMP_FALSE );
+
+  return 0;
 }
 
 // Signaling NaN is not supported
@@ -1603,6 +1498,114 @@ int CP1::cmp_sule( std::uint32_t word ) noexcept
 }
 */
 
+template <typename Op, typename T>
+int CP1::soft_unary( std::uint32_t word ) noexcept
+{
+  constexpr auto t = Format<T>::value;
+
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
+
+  auto env = environment_of( fcsr );
+  auto const res = Op::apply( this->fpr[_fs].*t, env );
+  if ( raise_fpu_ex( env.raised ) ) return 1;
+  this->fpr[_fd].*t = res;
+
+  return 0;
+}
+template <typename Op, typename T>
+int CP1::soft_binary( std::uint32_t word ) noexcept
+{
+  constexpr auto t = Format<T>::value;
+
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
+  auto const _ft = ft( word );
+
+  auto env = environment_of( fcsr );
+  auto const res = Op::apply( this->fpr[_fs].*t, this->fpr[_ft].*t, env );
+  if ( raise_fpu_ex( env.raised ) ) return 1;
+  this->fpr[_fd].*t = res;
+
+  return 0;
+}
+template <typename Op, typename T>
+int CP1::soft_ternary( std::uint32_t word ) noexcept
+{
+  constexpr auto t = Format<T>::value;
+
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
+  auto const _ft = ft( word );
+
+  auto env = environment_of( fcsr );
+  auto const res = Op::apply( this->fpr[_fs].*t, this->fpr[_ft].*t, this->fpr[_fd].*t, env );
+  if ( raise_fpu_ex( env.raised ) ) return 1;
+  this->fpr[_fd].*t = res;
+
+  return 0;
+}
+template <typename I, std::uint32_t rounding, typename T>
+int CP1::soft_to_integer( std::uint32_t word ) noexcept
+{
+  constexpr auto t = Format<T>::value;
+  constexpr auto i = Format<I>::value;
+
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
+
+  auto env = environment_of( fcsr );
+  auto const res = ieee754::to_integer<I>( this->fpr[_fs].*t, rounding, env );
+  if ( raise_fpu_ex( env.raised ) ) return 1;
+  this->fpr[_fd].*i = MIPS32_STATIC_CAST( i, res );
+
+  return 0;
+}
+template <typename T>
+int CP1::soft_rint( std::uint32_t word ) noexcept
+{
+  constexpr auto t = Format<T>::value;
+  constexpr auto i = Format<T>::bits;
+
+  auto const _fd = fd( word );
+  auto const _fs = fs( word );
+
+  auto env = environment_of( fcsr );
+  auto const res = MIPS32_STATIC_CAST( i, ieee754::to_integer<std::int64_t>( this->fpr[_fs].*t, env.rounding, env ) );
+  if ( raise_fpu_ex( env.raised ) ) return 1;
+  this->fpr[_fd].*i = res;
+
+  return 0;
+}
+template <typename To, typename From>
+int CP1::soft_cvt( std::uint32_t word ) noexcept
+{
+  // CVT.S.S and CVT.D.D
+  if constexpr ( std::is_same_v<To, From> )
+    return reserved( word );
+  else
+  {
+    constexpr auto to = Format<To>::value;
+    constexpr auto from = Format<From>::value;
+
+    auto const _fd = fd( word );
+    auto const _fs = fs( word );
+
+    auto env = environment_of( fcsr );
+    To res;
+
+    if constexpr ( std::is_integral_v<From> )
+      res = ieee754::from_integer<To>( From( this->fpr[_fs].*from ), env );
+    else
+      res = ieee754::convert<To>( this->fpr[_fs].*from, env );
+
+    if ( raise_fpu_ex( env.raised ) ) return 1;
+    this->fpr[_fd].*to = res;
+
+    return 0;
+  }
+}
+
 } // namespace mips32
 
 #undef MIPS32_STATIC_CAST
@@ -30,6 +30,9 @@ public:
   // Resets the FPU to its default state.
   void reset() noexcept;
 
+  // The FPRs, read only.
+  std::array<FPR, 32> const &registers() const noexcept;
+
   // Reads a FPU's register.
   std::uint32_t read( std::uint32_t reg ) noexcept;
 
@@ -37,6 +40,25 @@ public:
   // Writes to read only fields are ignored.
   void write( std::uint32_t reg, std::uint32_t data ) noexcept;
 
+  // Moves the exceptions raised by the host FPU since the last call into the Cause and Flags fields of FCSR.
+  // `read` and `write` call it, the CPU calls it at the end of a run: the host's flags belong to its thread.
+  // Cause isn't cleared by an instruction, it's the union of every exception folded, like Flags.
+  void sync_flags() noexcept;
+
+  // Drops the exceptions raised by the host FPU, e.g. by the host code before a run or inside a syscall.
+  void clear_host_flags() noexcept;
+
+  // Sets the host FPU of the calling thread for this CP1: the rounding and flushing of FCSR,
+  // or the defaults of the soft-float fast paths, then drops its exceptions.
+  // The CPU calls it when a run begins, as the host FPU is shared with anything else running on the thread.
+  void bind_host_fpu() noexcept;
+
+  // Computes the instructions rounding, or raising exceptions, in software, see `ieee754.hpp`:
+  // the results and FCSR are the same on every host, whatever the state of its FPU.
+  // Off by default, it isn't changed by a reset.
+  bool soft_float() const noexcept { return soft; }
+  void set_soft_float( bool enabled ) noexcept;
+
   // Trapped exception that will be signaled to the CPU.
   enum Exception : std::uint32_t
   {
@@ -81,7 +103,18 @@ private:
   // Check if the FPU raised any exception and
   // sets the needed flags in the cause field.
   // Returns true to signal a trap.
-  bool handle_fpu_ex() noexcept;
+  //
+  // The host FPU is checked only if an exception is enabled: otherwise its sticky flags
+  // are left to accumulate until FCSR is read, see `sync_flags`, as reading them is slow:
+  // Cause then holds the exceptions of every instruction since, not only of the last one.
+  // `result` is read by the check, so the compilers ignoring FENV_ACCESS compute it before.
+  template <typename T>
+  bool handle_fpu_ex( T const &result ) noexcept { return enable() && !soft && trap_fpu_ex( &result ); }
+  bool trap_fpu_ex( void const *result ) noexcept;
+
+  // Sets the Cause of the exceptions `raised`, and their Flags unless enabled.
+  // Returns true to signal a trap.
+  bool raise_fpu_ex( std::uint32_t raised ) noexcept;
 
   /****************
    *              *
@@ -92,51 +125,113 @@ private:
   int reserved( std::uint32_t word ) noexcept;
   int unimplemented( std::uint32_t word ) noexcept;
 
+  // The instructions of S and D, or of W and L for CMP.condn.fmt, `T` is float or double.
+  // `execute` jumps to the one of the format, see `Format` in cp1.cpp.
+
+  template <typename T>
   int add( std::uint32_t word ) noexcept;
+  template <typename T>
   int sub( std::uint32_t word ) noexcept;
+  template <typename T>
   int mul( std::uint32_t word ) noexcept;
+  template <typename T>
   int div( std::uint32_t word ) noexcept;
+  template <typename T>
   int sqrt( std::uint32_t word ) noexcept;
+  template <typename T>
   int abs( std::uint32_t word ) noexcept;
+  template <typename T>
   int mov( std::uint32_t word ) noexcept;
+  template <typename T>
   int neg( std::uint32_t word ) noexcept;
+  template <typename T>
   int round_l( std::uint32_t word ) noexcept;
+  template <typename T>
   int trunc_l( std::uint32_t word ) noexcept;
+  template <typename T>
   int ceil_l( std::uint32_t word ) noexcept;
+  template <typename T>
   int floor_l( std::uint32_t word ) noexcept;
+  template <typename T>
   int round_w( std::uint32_t word ) noexcept;
+  template <typename T>
   int trunc_w( std::uint32_t word ) noexcept;
+  template <typename T>
   int ceil_w( std::uint32_t word ) noexcept;
+  template <typename T>
   int floor_w( std::uint32_t word ) noexcept;
+  template <typename T>
   int sel( std::uint32_t word ) noexcept;
+  template <typename T>
   int seleqz( std::uint32_t word ) noexcept;
+  template <typename T>
   int recip( std::uint32_t word ) noexcept;
+  template <typename T>
   int rsqrt( std::uint32_t word ) noexcept;
+  template <typename T>
   int selnez( std::uint32_t word ) noexcept;
+  template <typename T>
   int maddf( std::uint32_t word ) noexcept;
+  template <typename T>
   int msubf( std::uint32_t word ) noexcept;
+  template <typename T>
   int rint( std::uint32_t word ) noexcept;
+  template <typename T>
   int class_( std::uint32_t word ) noexcept;
+  template <typename T>
   int min( std::uint32_t word ) noexcept;
+  template <typename T>
   int max( std::uint32_t word ) noexcept;
+  template <typename T>
   int mina( std::uint32_t word ) noexcept;
+  template <typename T>
   int maxa( std::uint32_t word ) noexcept;
-  int cvt_s( std::uint32_t word ) noexcept;
-  int cvt_d( std::uint32_t word ) noexcept;
+  // CVT.fmt.fmt, of float, double, std::int32_t or std::int64_t
+  template <typename To, typename From>
+  int cvt( std::uint32_t word ) noexcept;
+  template <typename T>
   int cvt_l( std::uint32_t word ) noexcept;
+  template <typename T>
   int cvt_w( std::uint32_t word ) noexcept;
+  template <typename T>
   int cmp_af( std::uint32_t word ) noexcept;
+  template <typename T>
   int cmp_un( std::uint32_t word ) noexcept;
+  template <typename T>
   int cmp_eq( std::uint32_t word ) noexcept;
+  template <typename T>
   int cmp_ueq( std::uint32_t word ) noexcept;
+  template <typename T>
   int cmp_lt( std::uint32_t word ) noexcept;
+  template <typename T>
   int cmp_ult( std::uint32_t word ) noexcept;
+  template <typename T>
   int cmp_le( std::uint32_t word ) noexcept;
+  template <typename T>
   int cmp_ule( std::uint32_t word ) noexcept;
+  template <typename T>
   int cmp_or( std::uint32_t word ) noexcept;
+  template <typename T>
   int cmp_une( std::uint32_t word ) noexcept;
+  template <typename T>
   int cmp_ne( std::uint32_t word ) noexcept;
 
+  // The soft-float instructions, `execute` swaps them in for the ones above, see `set_soft_float`.
+  // `Op` computes fd from fs, from fs and ft, or from fs, ft and fd.
+
+  template <typename Op, typename T>
+  int soft_unary( std::uint32_t word ) noexcept;
+  template <typename Op, typename T>
+  int soft_binary( std::uint32_t word ) noexcept;
+  template <typename Op, typename T>
+  int soft_ternary( std::uint32_t word ) noexcept;
+  template <typename I, std::uint32_t rounding, typename T>
+  int soft_to_integer( std::uint32_t word ) noexcept;
+  template <typename T>
+  int soft_rint( std::uint32_t word ) noexcept;
+  template <typename To, typename From>
+  int soft_cvt( std::uint32_t word ) noexcept;
+
   /* Signaling NaN is not supported
   int cabs_saf( std::uint32_t word ) noexcept;
   int cabs_sun( std::uint32_t word ) noexcept;
@@ -152,6 +247,8 @@ private:
 
   std::uint32_t fir, fcsr;
 
+  bool soft{ false };
+
   // Floating Point Environment
   std::fenv_t env;
 };
@@ -1,6 +1,11 @@
 #include "cpu.hpp"
+#include "loader.hpp"
 
+#include <cassert>
 #include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
 
 namespace mips32
 {
@@ -32,7 +37,22 @@ constexpr int _sign_extend{ -_zero_extend };
 constexpr int _byte{ 0x9876 };
 constexpr int _halfword{ -_byte };
 
-CPU::CPU( RAM &ram ) noexcept : string_handler( ram ), mmu( ram, fixed_mapping_segments ) {}
+// The words are accessed atomically by LL/SC only, the other accesses are plain.
+std::atomic<std::uint32_t> *as_atomic( std::uint32_t *word ) noexcept
+{
+  static_assert( sizeof( std::atomic<std::uint32_t> ) == sizeof( std::uint32_t ), "A word can't be accessed atomically." );
+  static_assert( std::atomic<std::uint32_t>::is_always_lock_free, "A word can't be accessed atomically." );
+
+  return reinterpret_cast<std::atomic<std::uint32_t> *>( word );
+}
+
+CPU::CPU( RAM &ram, std::uint32_t core ) noexcept
+  : core( core ), ram( ram ), string_handler( ram ), mmu( ram, fixed_mapping_segments )
+{
+  reset_heap();
+
+  flight_instructions.resize( flight_default_instructions );
+}
 
 IODevice * CPU::attach_iodevice( IODevice * device ) noexcept
 {
@@ -48,26 +68,253 @@ FileHandler * CPU::attach_file_handler( FileHandler * handler ) noexcept
   return old;
 }
 
-std::uint32_t CPU::start() noexcept
+// Scatters the PCs of the same code over the whole map.
+constexpr std::uint32_t edge_hash( std::uint32_t pc ) noexcept
 {
-  exit_code.store( NONE, std::memory_order_release );
+  pc = ( pc >> 2 ) * 0x9E37'79B1;
+  return pc ^ pc >> 15;
+}
 
-  while ( exit_code.load( std::memory_order_acquire ) == NONE )
+template <std::uint32_t features>
+void CPU::step() noexcept
+{
+  auto const *const word = mmu.access( pc, running_mode() );
+
+  // fetch
+  if ( pc & 0b11 || !word )
+  {
+    signal_exception( ExCause::AdEL, word ? *word : 0, pc ); // word can be nullptr
+    return;
+  }
+
+  [[maybe_unused]] auto const from = pc;
+
+  // The block of the PC can be swapped by the memory accesses of the tracer, or of the instruction
+  auto const instr = *word;
+
+  if constexpr ( ( features & feature_flight ) != 0 )
+    record_flight( pc, instr );
+
+  if constexpr ( ( features & feature_trace ) != 0 )
+    trace_before( instr );
+
+  // execute
+  pc += 4;
+  ( this->*function_table[opcode( instr )] )( instr );
+
+  gpr[0] = 0;
+
+  if constexpr ( ( features & feature_trace ) != 0 )
+    trace( from, instr );
+
+  // There are no delay slots, the control flow is taken unless the PC is the next one
+  if constexpr ( ( features & feature_coverage ) != 0 )
   {
-    auto const *const word = mmu.access( pc, running_mode() );
+    if ( pc != from + 4 )
+      cover( from, pc );
+  }
+
+  if ( ++retired >= retire_limit )
+    retire();
+}
 
-    // fetch
-    if ( pc & 0b11 || !word )
+template <std::uint32_t features>
+void CPU::loop( [[maybe_unused]] std::uint32_t target ) noexcept
+{
+  while ( exit_code.load( std::memory_order_acquire ) == NONE )
+  {
+    if constexpr ( ( features & feature_target ) != 0 )
     {
-      signal_exception( ExCause::AdEL, word ? *word : 0, pc ); // word can be nullptr
-      continue;
+      if ( pc == target )
+        break;
     }
 
-    // execute
-    pc += 4;
-    ( this->*function_table[opcode( *word )] )( *word );
+    if ( auto const requests = attention.load( std::memory_order_acquire ) )
+      attend( requests );
 
-    gpr[0] = 0;
+    step<features>();
+  }
+}
+
+template <std::uint32_t... features>
+constexpr std::array<CPU::loop_ptr, sizeof...( features )> CPU::make_loops( std::integer_sequence<std::uint32_t, features...> ) noexcept
+{
+  return { &CPU::loop<features>... };
+}
+
+template <std::uint32_t... features>
+constexpr std::array<CPU::step_ptr, sizeof...( features )> CPU::make_steps( std::integer_sequence<std::uint32_t, features...> ) noexcept
+{
+  return { &CPU::step<features>... };
+}
+
+void CPU::run_loop( std::uint32_t features, std::uint32_t target ) noexcept
+{
+  static constexpr auto loops = make_loops( std::make_integer_sequence<std::uint32_t, feature_target * 2>{} );
+
+  trace_every_gpr = true;
+
+  ( this->*loops[features | attached_features()] )( target );
+}
+
+std::uint32_t CPU::attached_features() const noexcept
+{
+  return ( coverage ? feature_coverage : 0 ) | ( tracer ? feature_trace : 0 ) |
+         ( flight_instructions.enabled() || flight_accesses.enabled() ? feature_flight : 0 );
+}
+
+/**
+ * The edges are hashed like AFL does: the source is shifted, so A -> B and B -> A,
+ * or A -> A and B -> B, don't collide, and the counters wrap skipping 0, so a hit is never lost.
+ **/
+void CPU::cover( std::uint32_t from, std::uint32_t to ) noexcept
+{
+  auto &counter = coverage[( edge_hash( from ) >> 1 ^ edge_hash( to ) ) & coverage_mask];
+  counter += 1 + ( counter == 0xFF );
+}
+
+void CPU::attach_coverage( std::uint8_t *map, std::uint32_t size ) noexcept
+{
+  assert( !( size & ( size - 1 ) ) && "The size of the coverage map must be a power of 2." );
+
+  coverage = size ? map : nullptr;
+  coverage_mask = size - 1;
+}
+
+void CPU::attach_tracer( TraceWriter *tracer ) noexcept
+{
+  this->tracer = tracer;
+}
+
+std::uint32_t CPU::memory_operand( std::uint32_t word, std::uint32_t &address, bool &store ) const noexcept
+{
+  address = gpr[rs( word )] + sign_extend<_halfword>( immediate( word ) );
+  store = false;
+
+  switch ( opcode( word ) )
+  {
+  case 0x20:                         // LB
+  case 0x24: return 1;               // LBU
+  case 0x21:                         // LH
+  case 0x25: return 2;               // LHU
+  case 0x23:                         // LW
+  case 0x31: return 4;               // LWC1
+  case 0x35: return 8;               // LDC1
+  case 0x28: store = true; return 1; // SB
+  case 0x29: store = true; return 2; // SH
+  case 0x2B:                         // SW
+  case 0x39: store = true; return 4; // SWC1
+  case 0x3D: store = true; return 8; // SDC1
+  case 0x1F:                         // LL, SC
+  {
+    if ( function( word ) != 0x36 && function( word ) != 0x26 )
+      return 0;
+
+    auto offset = word >> 7 & 0x1FF;
+    if ( offset & 0x100 )
+      offset |= 0xFFFF'FE00;
+
+    address = gpr[rs( word )] + offset;
+    store = function( word ) == 0x26;
+    return 4;
+  }
+  default:
+    return 0;
+  }
+}
+
+// The PCs fetched are aligned, the low bit of the access tells a store
+void CPU::record_flight( std::uint32_t pc, std::uint32_t word ) noexcept
+{
+  if ( flight_instructions.enabled() )
+    flight_instructions.push( pc, word );
+
+  if ( flight_accesses.enabled() )
+  {
+    std::uint32_t address;
+    bool          store;
+
+    if ( memory_operand( word, address, store ) )
+      flight_accesses.push( pc | store, address );
+  }
+}
+
+/**
+ * The words are read through the MMU, which creates their block if missing,
+ * and are traced only if the instruction changes them.
+ * An unaligned store can cross 3 words.
+ **/
+void CPU::trace_before( std::uint32_t word ) noexcept
+{
+  traced_words_no = 0;
+
+  std::uint32_t address;
+  bool          store;
+
+  auto const size = memory_operand( word, address, store );
+  if ( !store )
+    return;
+
+  auto const mode = running_mode();
+
+  for ( std::uint64_t at = address & ~3u; at < std::uint64_t( address ) + size; at += 4 )
+  {
+    if ( auto const *target = mmu.access( ( std::uint32_t )at, mode ) )
+      traced_words[traced_words_no++] = { ( std::uint32_t )at, *target };
+  }
+}
+
+void CPU::trace( std::uint32_t pc, std::uint32_t word ) noexcept
+{
+  std::array<TraceWriter::Store, 3> stores;
+  std::uint32_t                     stores_no = 0;
+
+  for ( std::uint32_t i = 0; i < traced_words_no; ++i )
+  {
+    auto const *target = mmu.access( traced_words[i].address, running_mode() );
+    if ( target && *target != traced_words[i].value )
+      stores[stores_no++] = { traced_words[i].address, *target };
+  }
+
+  auto const op = opcode( word );
+
+  // Only the syscalls write a GPR that isn't in the instruction, or the link register
+  auto written = 1u << rs( word ) | 1u << rt( word ) | 1u << rd( word ) | 1u << 31;
+  if ( trace_every_gpr || ( op == 0 && function( word ) == 0x0C ) )
+  {
+    written = ~0u;
+    trace_every_gpr = false;
+  }
+
+  // The FPRs can be changed only by COP1, LWC1 and LDC1
+  auto const *fpr = op == 0x11 || op == 0x31 || op == 0x35 ? &cp1.registers() : nullptr;
+
+  tracer->record( pc, word, gpr, written, fpr, stores.data(), stores_no );
+}
+
+std::uint32_t CPU::start() noexcept
+{
+  exit_code.store( NONE, std::memory_order_release );
+
+  return run();
+}
+
+std::uint32_t CPU::run() noexcept
+{
+  // The RAM could have been restored, or loaded, since the last run
+  mmu.forget();
+
+  begin_run();
+
+  run_loop( 0, 0 );
+
+  end_run();
+
+  // The guest has exited or has been stopped, its buffered output must be visible
+  if ( io_device )
+  {
+    auto const lock = ram.lock(); // the device is shared by the cores
+    io_device->flush();
   }
 
   return exit_code.load( std::memory_order_acquire );
@@ -78,34 +325,141 @@ void CPU::stop() noexcept
   exit_code.store( MANUAL_STOP, std::memory_order_release );
 }
 
+void CPU::retire() noexcept
+{
+  // The exit syscall, or an exception, of the last instruction wins
+  auto expected = std::uint32_t( NONE );
+  exit_code.compare_exchange_strong( expected, LIMIT, std::memory_order_acq_rel );
+}
+
+void CPU::attach_cores( CPU *const *cores, std::uint32_t count ) noexcept
+{
+  this->cores = cores;
+  cores_no = count;
+}
+
+void CPU::interrupt() noexcept
+{
+  attention.fetch_or( attention_ipi, std::memory_order_release );
+}
+
 std::uint32_t CPU::single_step() noexcept
 {
   exit_code.store( NONE, std::memory_order_release );
+  mmu.forget();
+
+  begin_run();
+
+  if ( auto const requests = attention.load( std::memory_order_acquire ) )
+    attend( requests );
 
-  auto * word = mmu.access( pc, running_mode() );
+  static constexpr auto steps = make_steps( std::make_integer_sequence<std::uint32_t, feature_target>{} );
 
-  if ( pc & 0b11 || !word ) // fetch
+  trace_every_gpr = true;
+
+  ( this->*steps[attached_features()] )();
+
+  end_run();
+
+  return exit_code.load( std::memory_order_acquire );
+}
+
+std::uint32_t CPU::run_to( std::uint32_t target ) noexcept
+{
+  exit_code.store( NONE, std::memory_order_release );
+  mmu.forget();
+
+  begin_run();
+
+  run_loop( feature_target, target );
+
+  end_run();
+
+  if ( io_device )
+    io_device->flush();
+
+  return exit_code.load( std::memory_order_acquire );
+}
+
+void CPU::attend( std::uint32_t requests ) noexcept
+{
+  if ( requests & attention_ipi )
+    deliver_ipi();
+
+  if ( requests & attention_sample )
   {
-    signal_exception( ExCause::AdEL, 0, pc );
+    std::lock_guard<std::mutex> lock( sampler.mutex );
+    answer_sample();
   }
-  else // execute
-  {
-    pc += 4;
-    ( this->*function_table[opcode( *word )] )( *word );
+}
 
-    gpr[0] = 0;
-  }
+void CPU::begin_run() noexcept
+{
+  // The host FPU could have been changed by another machine on this thread,
+  // and the flags raised by the host so far aren't the guest's
+  cp1.bind_host_fpu();
 
-  return exit_code.load( std::memory_order_acquire );
+  // Status can have been changed by the inspector
+  take_interrupt();
+
+  std::lock_guard<std::mutex> lock( sampler.mutex );
+  sampler.running = true;
+}
+
+void CPU::end_run() noexcept
+{
+  // FCSR can be inspected from another thread
+  cp1.sync_flags();
+
+  std::lock_guard<std::mutex> lock( sampler.mutex );
+  sampler.running = false;
+  answer_sample(); // posted after the last instruction
+}
+
+void CPU::answer_sample() noexcept
+{
+  attention.fetch_and( ~attention_sample, std::memory_order_relaxed );
+
+  if ( sampler.served == sampler.requested )
+    return;
+
+  take_sample( *sampler.destination, sampler.address, sampler.count );
+
+  sampler.served = sampler.requested;
+  sampler.answered.notify_all();
+}
+
+void CPU::take_sample( MachineInspector::CPUSample &sample, std::uint32_t address, std::uint32_t count ) noexcept
+{
+  sample.pc = pc;
+  sample.gpr = gpr;
+
+  auto const lock = ram.lock(); // the other cores can create blocks meanwhile
+  sample.memory = string_handler.read( address, count );
 }
 
 void CPU::hard_reset() noexcept
 {
   gpr[0] = 0;
-  cp0.reset();
+  cp0.reset( core );
   cp1.reset();
+  ll_bit = false;
+  retired = 0;
+  attention.fetch_and( ~attention_ipi, std::memory_order_release );
+  ipi_taken = ipi_again = false;
   enter_kernel_mode();
   pc = 0xBFC0'0000;
+  reset_heap();
+}
+
+void CPU::reset_heap( std::uint32_t begin ) noexcept
+{
+  // Word aligned, as every pointer returned by sbrk
+  begin = ( begin + 3 ) & ~3u;
+
+  heap_begin = begin > heap_default_begin ? begin : heap_default_begin;
+  program_break = heap_begin;
+  heap_high_water = heap_begin;
 }
 
 constexpr std::uint32_t opcode( std::uint32_t word ) noexcept
@@ -176,7 +530,7 @@ void CPU::special( std::uint32_t word ) noexcept
       &CPU::syscall,
       &CPU::break_,
       &CPU::reserved, // SDBBP
-      &CPU::reserved, // SYNC
+      &CPU::sync,
       &CPU::clz,
       &CPU::clo,
       &CPU::reserved, // MFLO
@@ -249,6 +603,10 @@ void CPU::special3( std::uint32_t word ) noexcept
     ext( word );
   else if ( fn == 0b000'100 )
     ins( word );
+  else if ( fn == 0b110'110 && !( word & 1 << 6 ) )
+    ll( word );
+  else if ( fn == 0b100'110 && !( word & 1 << 6 ) )
+    sc( word );
   else
     reserved( word );
 }
@@ -324,8 +682,10 @@ void CPU::pcrel( std::uint32_t word ) noexcept
 void CPU::cop1( std::uint32_t word ) noexcept
 {
   constexpr std::uint32_t MFC1{ 0b00'000 };
+  constexpr std::uint32_t CFC1{ 0b00'010 };
   constexpr std::uint32_t MFHC1{ 0b00'011 };
   constexpr std::uint32_t MTC1{ 0b00'100 };
+  constexpr std::uint32_t CTC1{ 0b00'110 };
   constexpr std::uint32_t MTHC1{ 0b00'111 };
 
   auto _ft = rd( word );
@@ -348,6 +708,16 @@ void CPU::cop1( std::uint32_t word ) noexcept
   {
     cp1.mthc1( _ft, gpr[_rt] );
   }
+  else if ( _type == CFC1 || _type == CTC1 )
+  {
+    // FIR, FEXR, FENR and FCSR
+    if ( _ft != 0 && _ft != 26 && _ft != 28 && _ft != 31 )
+      reserved( word );
+    else if ( _type == CFC1 )
+      gpr[_rt] = cp1.read( _ft );
+    else
+      cp1.write( _ft, gpr[_rt] );
+  }
   else
   {
     auto ex = cp1.execute( word );
@@ -691,6 +1061,69 @@ void CPU::ins( std::uint32_t word ) noexcept
   gpr[_rt] = ( gpr[_rt] & ~( mask << _pos ) ) | ( gpr[_rs] & mask ) << _pos;
 }
 
+/**
+ * Load Linked/Store Conditional, the offset is 9 bits wide (15..7).
+ *
+ * LL reserves the word, remembering its address and value.
+ * SC stores the word only if it still holds that value,
+ * with an atomic compare-exchange, so the other cores can't interleave.
+ * A value written again between them (ABA) doesn't break the reservation.
+ *
+ * The reservation is cleared by SC and ERET.
+ **/
+void CPU::ll( std::uint32_t word ) noexcept
+{
+  auto _base = rs( word );
+  auto _rt = rt( word );
+  auto _offset = word >> 7 & 0x1FF;
+
+  if ( _offset & 0x100 ) // sign extend
+    _offset |= 0xFFFF'FE00;
+
+  auto address = gpr[_base] + _offset;
+
+  auto *target = address & 0b11 ? nullptr : mmu.access( address, running_mode() );
+
+  if ( !target )
+  {
+    signal_exception( ExCause::AdEL, word, pc - 4 );
+    return;
+  }
+
+  ll_bit = true;
+  ll_address = address;
+  ll_value = as_atomic( target )->load( std::memory_order_acquire );
+
+  gpr[_rt] = ll_value;
+}
+void CPU::sc( std::uint32_t word ) noexcept
+{
+  auto _base = rs( word );
+  auto _rt = rt( word );
+  auto _offset = word >> 7 & 0x1FF;
+
+  if ( _offset & 0x100 ) // sign extend
+    _offset |= 0xFFFF'FE00;
+
+  auto address = gpr[_base] + _offset;
+
+  auto *target = address & 0b11 ? nullptr : mmu.store( address, running_mode() );
+
+  if ( !target )
+  {
+    signal_exception( ExCause::AdES, word, pc - 4 );
+    return;
+  }
+
+  auto expected = ll_value;
+  bool const stored = ll_bit && ll_address == address
+    && as_atomic( target )->compare_exchange_strong( expected, gpr[_rt], std::memory_order_seq_cst );
+
+  ll_bit = false;
+
+  gpr[_rt] = stored;
+}
+
 /**
  * Load/Store Byte, always aligned.
  *
@@ -764,7 +1197,7 @@ void CPU::op_byte( std::uint32_t word ) noexcept
         0x00FF'FFFF,
     };
 
-    auto *store_byte = mmu.access( address, running_mode() );
+    auto *store_byte = mmu.store( address, running_mode() );
 
     if ( !store_byte )
     {
@@ -873,7 +1306,7 @@ void CPU::op_halfword( std::uint32_t word ) noexcept
 
     lowhalf_value = gpr[_rt] & 0xFFFF;
 
-    auto *lowhalf_ptr = mmu.access( address, running_mode() );
+    auto *lowhalf_ptr = mmu.store( address, running_mode() );
     if ( !lowhalf_ptr )
     {
       signal_exception( ExCause::AdES, word, pc - 4 );
@@ -887,7 +1320,7 @@ void CPU::op_halfword( std::uint32_t word ) noexcept
         signal_exception( ExCause::DBE, word, pc - 4 );
         return;
       }
-      auto *highhalf_ptr = mmu.access( address + 4, running_mode() );
+      auto *highhalf_ptr = mmu.store( address + 4, running_mode() );
       if ( !highhalf_ptr )
       {
         signal_exception( ExCause::AdES, word, pc - 4 );
@@ -945,7 +1378,7 @@ void CPU::op_word( std::uint32_t _rt, std::uint32_t address, std::uint32_t _word
 
   if ( align == 0 )
   {
-    auto *word = mmu.access( address, running_mode() );
+    auto *word = op == _load ? mmu.access( address, running_mode() ) : mmu.store( address, running_mode() );
 
     if constexpr ( op == _load )
     {
@@ -974,8 +1407,8 @@ void CPU::op_word( std::uint32_t _rt, std::uint32_t address, std::uint32_t _word
       return;
     }
 
-    auto *low = mmu.access( address, running_mode() );
-    auto *high = mmu.access( address + 4, running_mode() );
+    auto *low = op == _load ? mmu.access( address, running_mode() ) : mmu.store( address, running_mode() );
+    auto *high = op == _load ? mmu.access( address + 4, running_mode() ) : mmu.store( address + 4, running_mode() );
 
     if constexpr ( op == _load )
     {
@@ -1123,7 +1556,7 @@ void CPU::pop66( std::uint32_t word ) noexcept
 
     auto _imm = word & 0x1F'FFFF; // 21 bits
 
-    if ( _imm & 1 << 21 ) // sign extend
+    if ( _imm & 1 << 20 ) // sign extend
       _imm |= 0xFFE0'0000;
 
     pc += _imm << 2;
@@ -1188,10 +1621,9 @@ void CPU::pop76( std::uint32_t word ) noexcept
     {
       auto _imm = word & 0x1F'FFFF; // 21 bits
 
-      if ( _imm & 1 << 21 ) // sign extend
+      if ( _imm & 1 << 20 ) // sign extend
         _imm |= 0xFFE0'0000;
 
-      gpr[31] = pc;
       pc += _imm << 2;
     }
   }
@@ -1301,15 +1733,28 @@ void CPU::syscall( std::uint32_t word ) noexcept
   constexpr std::uint32_t a0{ 4 };
   constexpr std::uint32_t a1{ 5 };
   constexpr std::uint32_t a2{ 6 };
+  constexpr std::uint32_t a3{ 7 };
 
   auto const sysnum = gpr[v0];
 
-  if ( sysnum == 0 || sysnum > 17 )
+  if ( sysnum == 0 || sysnum > 19 )
   {
     signal_exception( ExCause::Sys, word, pc - 4 );
     return;
   }
 
+  // The syscalls of the cores are serialized, they access the RAM through RAMIO and share the devices
+  auto const lock = ram.lock();
+
+  // The host code of the syscall can raise the flags of the FPU, they aren't the guest's
+  struct HostFlags
+  {
+    CP1 &cp1;
+
+    explicit HostFlags( CP1 &cp1 ) noexcept : cp1( cp1 ) { cp1.sync_flags(); }
+    ~HostFlags() { cp1.clear_host_flags(); }
+  } const host_flags{ cp1 };
+
   if ( sysnum == 1 ) // print int
   {
     io_device->print_integer( gpr[a0] );
@@ -1342,8 +1787,8 @@ void CPU::syscall( std::uint32_t word ) noexcept
   else if ( sysnum == 4 ) // print string
   {
     auto address = gpr[a0];
-    auto str = string_handler.read( address, 0xFFFF'FFFF, true);
-    io_device->print_string( str.data() );
+    auto [str, length] = string_handler.string( address, string_buffer );
+    io_device->print_string( str, length );
   }
   else if ( sysnum == 5 ) // read int
   {
@@ -1390,7 +1835,30 @@ void CPU::syscall( std::uint32_t word ) noexcept
   }
   else if ( sysnum == 9 ) // sbrk
   {
-    signal_exception( ExCause::Int, word, pc - 4 );
+    constexpr std::uint32_t sp{ 29 };
+    constexpr std::int64_t  useg_end{ 0x8000'0000 };
+
+    // The cores share the heap of the first one
+    auto &heap = cores_no ? *cores[0] : *this;
+
+    // The heap can't grow past the stack, if there's one above it
+    std::int64_t const limit = gpr[sp] > heap.heap_begin && gpr[sp] < useg_end ? gpr[sp] : useg_end;
+
+    // Rounded up to a word, negative increments shrink the heap
+    auto const increment = ( std::int64_t( ( std::int32_t )gpr[a0] ) + 3 ) & ~std::int64_t( 3 );
+    auto const new_break = std::int64_t( heap.program_break ) + increment;
+
+    if ( new_break < heap.heap_begin || new_break > limit )
+    {
+      gpr[v0] = 0xFFFF'FFFF;
+    }
+    else
+    {
+      gpr[v0] = heap.program_break;
+      heap.program_break = ( std::uint32_t )new_break;
+      if ( heap.program_break > heap.heap_high_water )
+        heap.heap_high_water = heap.program_break;
+    }
   }
   else if ( sysnum == 10 || sysnum == 17 ) // exit
   {
@@ -1417,12 +1885,12 @@ void CPU::syscall( std::uint32_t word ) noexcept
   {
     auto filename_address = gpr[a0];
 
-    auto filename = string_handler.read( filename_address, 0xFFFF'FFFF, true );
+    auto filename = string_handler.string( filename_address, string_buffer ).first;
     char flags[5] = { 0 }; // flags must be null terminated, but $a1 can contain up to 4 chars without '\0'.
 
     std::memcpy( flags, &gpr[a1], 4 );
 
-    gpr[v0] = file_handler->open( filename.data(), flags );
+    gpr[v0] = file_handler->open( filename, flags );
   }
   else if ( sysnum == 14 ) // file read
   {
@@ -1430,14 +1898,8 @@ void CPU::syscall( std::uint32_t word ) noexcept
     auto buf = gpr[a1];
     auto count = gpr[a2];
 
-    // Allocate enough space
-    std::unique_ptr<char[]> data( new char[count] );
-
-    // Read the data from file and store the result
-    gpr[v0] = file_handler->read( fd, data.get(), count );
-
-    // Write the data into the RAM
-    string_handler.write( buf, data.get(), count );
+    // Read the data from file directly into the RAM
+    gpr[v0] = file_transfer( fd, buf, count, true );
   }
   else if ( sysnum == 15 ) // file write
   {
@@ -1445,9 +1907,8 @@ void CPU::syscall( std::uint32_t word ) noexcept
     auto buf = gpr[a1];
     auto count = gpr[a2];
 
-    auto data = string_handler.read( buf, count );
-
-    gpr[v0] = file_handler->write( fd, data.data(), count );
+    // Write the data into the file directly from the RAM
+    gpr[v0] = file_transfer( fd, buf, count, false );
   }
   else if ( sysnum == 16 ) // file close
   {
@@ -1457,11 +1918,98 @@ void CPU::syscall( std::uint32_t word ) noexcept
 
     gpr[v0] = 0;
   }
+  else if ( sysnum == 18 ) // file map
+  {
+    auto fd = gpr[a0];
+    auto address = gpr[a1];
+    auto size = gpr[a2];
+    auto offset = gpr[a3];
+
+    constexpr std::uint64_t useg_end{ 0x8000'0000 };
+
+    gpr[v0] = 0xFFFF'FFFF;
+
+    // Word aligned, so the blocks entirely covered can be backed by the host mapping
+    if ( !size || ( address | offset ) & 0b11 || std::uint64_t( address ) + size > useg_end )
+      return;
+
+    auto const handle = file_handler->native_handle( fd );
+    if ( handle == -1 )
+      return;
+
+    std::unique_ptr<MappedFile> file( new ( std::nothrow ) MappedFile( handle, offset, size ) );
+    if ( !file || !file->data() )
+      return;
+
+    // The blocks that exist are overwritten, the others adopt the mapping
+    if ( ram.journaling() )
+      ram.record( address, size );
+
+    Loader( ram ).map( address, std::move( file ), size );
+
+    gpr[v0] = address;
+  }
+  else if ( sysnum == 19 ) // inter-processor interrupt
+  {
+    auto target = gpr[a0];
+
+    if ( target < cores_no )
+    {
+      cores[target]->interrupt();
+      gpr[v0] = 0;
+    }
+    else
+    {
+      gpr[v0] = 0xFFFF'FFFF;
+    }
+  }
   else
   {
     signal_exception( ExCause::Sys, word, pc - 4 );
   }
 }
+/**
+ * The guest buffer is split in batches of spans pointing directly into the RAM,
+ * see `RAMIO::pin`, so there's no intermediate copy.
+ * A batch that isn't transferred completely ends the transfer.
+ **/
+std::uint32_t CPU::file_transfer( std::uint32_t fd, std::uint32_t address, std::uint32_t count, bool to_ram ) noexcept
+{
+  std::uint32_t total = 0;
+
+  while ( count )
+  {
+    auto const spans_no = string_handler.pin( address, count, file_spans.data(), ( std::uint32_t )file_spans.size() );
+
+    std::uint32_t batch_size = 0;
+    for ( std::uint32_t i = 0; i < spans_no; ++i )
+      batch_size += file_spans[i].size;
+
+    // The pinned blocks stay in memory
+    if ( to_ram && ram.journaling() )
+      ram.record( address, batch_size );
+
+    auto const result = to_ram
+      ? file_handler->readv( fd, file_spans.data(), spans_no )
+      : file_handler->writev( fd, file_spans.data(), spans_no );
+
+    string_handler.unpin();
+
+    if ( std::int32_t( result ) < 0 )
+      return total ? total : result;
+
+    total += result;
+
+    if ( result < batch_size || !batch_size )
+      break;
+
+    address += batch_size;
+    count -= batch_size;
+  }
+
+  return total;
+}
+
 void CPU::break_( std::uint32_t ) noexcept
 {
   set_ex_cause( ExCause::Bp );
@@ -1798,6 +2346,11 @@ void CPU::selnez( std::uint32_t word ) noexcept
 
   gpr[_rd] = gpr[_rt] ? gpr[_rs] : 0;
 }
+void CPU::sync( std::uint32_t ) noexcept
+{
+  // Every stype is a full barrier, the strongest one
+  std::atomic_thread_fence( std::memory_order_seq_cst );
+}
 
 /* * * * * *
  *         *
@@ -1864,6 +2417,9 @@ void CPU::mtc0( std::uint32_t word ) noexcept
   auto _sel = word & 0x7;
 
   cp0.write( _rd, _sel, gpr[_rt] );
+
+  // Status can enable the pending IPI
+  take_interrupt();
 }
 void CPU::mthc0( std::uint32_t ) noexcept
 {
@@ -1881,18 +2437,30 @@ void CPU::mfmc0( std::uint32_t word ) noexcept
     cp0.status |= 1;
   else
     cp0.status &= ~1;
+
+  take_interrupt();
 }
 
 void CPU::eret( std::uint32_t ) noexcept
 {
   enter_user_mode();
 
+  ll_bit = false;
+
+  // The IPI has been serviced, unless another one was raised meanwhile
+  if ( ipi_taken && !ipi_again )
+    cp0.cause &= ~ipi_line;
+
+  ipi_taken = ipi_again = false;
+
   if ( cp0.status & 0b100 ) // Status ERL
     pc = cp0.error_epc;
   else
     pc = cp0.epc;
 
   cp0.status &= ~0b110;
+
+  take_interrupt();
 }
 
 /* * * * *
@@ -1970,6 +2538,32 @@ void CPU::enter_user_mode() noexcept
   cp0.status |= 0x16;
 }
 
+void CPU::deliver_ipi() noexcept
+{
+  // Latched, the IPIs raised from now on are new ones
+  attention.fetch_and( ~attention_ipi, std::memory_order_release );
+
+  if ( ipi_taken )
+    ipi_again = true;
+  else
+    cp0.cause |= ipi_line;
+
+  take_interrupt();
+}
+
+void CPU::take_interrupt() noexcept
+{
+  auto const ie = cp0.status & 1;
+  auto const erl_exl = cp0.status & 0b110;
+  auto const pending = cp0.cause & cp0.status & ipi_line;
+
+  if ( !ie || erl_exl || !pending || ipi_taken )
+    return;
+
+  ipi_taken = true;
+  signal_exception( ExCause::Int, 0, pc );
+}
+
 void CPU::set_ex_cause( std::uint32_t ex ) noexcept
 {
   cp0.cause = cp0.cause & ~0x7C | ex << 2;
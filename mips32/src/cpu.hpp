@@ -3,14 +3,21 @@
 #include <mips32/file_handler.hpp>
 #include <mips32/io_device.hpp>
 #include <mips32/cp0.hpp>
+#include <mips32/machine_inspector.hpp>
 #include "cp1.hpp"
+#include "flight_recorder.hpp"
 #include "mmu.hpp"
 #include "ram.hpp"
 #include "ram_io.hpp"
+#include "trace.hpp"
 
 #include <array>
 #include <atomic>
+#include <condition_variable>
 #include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
 
 namespace mips32
 {
@@ -19,7 +26,8 @@ class CPU
   friend class MachineInspector;
 
 public:
-  explicit CPU( RAM &ram ) noexcept;
+  // `core` is the number of the CPU in a multi-core machine.
+  explicit CPU( RAM &ram, std::uint32_t core = 0 ) noexcept;
 
   IODevice* attach_iodevice( IODevice *device ) noexcept;
   FileHandler* attach_file_handler( FileHandler *handler ) noexcept;
@@ -31,6 +39,7 @@ public:
     INTERRUPT,
     EXCEPTION,
     EXIT,
+    LIMIT,
   };
 
   enum ExCause : std::uint32_t
@@ -52,11 +61,44 @@ public:
   std::uint32_t start() noexcept;
   void          stop() noexcept;
 
+  // Same as `start`, but the exit code isn't reset first, a CPU stopped before is not started.
+  std::uint32_t run() noexcept;
+
+  // The CPUs that can be interrupted by the guest, with the IPI syscall, `core` included.
+  void attach_cores( CPU *const *cores, std::uint32_t count ) noexcept;
+
+  // Raises the inter-processor interrupt, Cause IP2, taken when Status IE and IM2 are set.
+  // ERET clears Cause IP2. Thread-safe, the interrupts raised while pending are merged.
+  void interrupt() noexcept;
+
   std::uint32_t single_step() noexcept;
 
+  // Same as `start`, but returns NONE before executing the instruction at `target`, if reached.
+  std::uint32_t run_to( std::uint32_t target ) noexcept;
+
+  // Counts the edges taken into `map`, see `Machine::attach_coverage`, `nullptr` detaches it.
+  // `size` must be a power of 2.
+  void attach_coverage( std::uint8_t *map, std::uint32_t size ) noexcept;
+
+  // Records every instruction retired into `tracer`, see `Machine::trace`, `nullptr` detaches it.
+  void attach_tracer( TraceWriter *tracer ) noexcept;
+
   void hard_reset() noexcept;
 
+  // The heap used by sbrk starts at `heap_default_begin`, or at `begin`, if higher.
+  // The program break is moved back to the beginning.
+  void reset_heap( std::uint32_t begin = 0 ) noexcept;
+
+  // MARS' heap, above the static data.
+  static inline constexpr std::uint32_t heap_default_begin{ 0x1004'0000 };
+
+  // Cause IP2 and Status IM2
+  static inline constexpr std::uint32_t ipi_line{ 0x0400 };
+
 private:
+  std::uint32_t const core;
+
+  RAM  &ram;
   RAMIO string_handler;
 
   MMU mmu;
@@ -69,9 +111,83 @@ private:
 
   std::atomic<std::uint32_t> exit_code;
 
+  // Instructions executed since the reset, the ones raising an exception included.
+  // Once `retired` reaches `retire_limit`, the CPU stops with LIMIT.
+  std::uint64_t retired{ 0 };
+  std::uint64_t retire_limit{ ~std::uint64_t( 0 ) };
+
+  // Requests checked between two instructions, with a single load
+  static inline constexpr std::uint32_t attention_ipi{ 0x1 };
+  static inline constexpr std::uint32_t attention_sample{ 0x2 };
+
+  std::atomic<std::uint32_t> attention{ 0 };
+
+  bool ipi_taken{ false }; // the IPI of Cause is serviced, until `eret`
+  bool ipi_again{ false }; // another IPI was latched meanwhile, Cause keeps it after `eret`
+
+  // Edge coverage, a counter per hash of the edge, the mask is the size of the map - 1
+  std::uint8_t *coverage{ nullptr };
+  std::uint32_t coverage_mask{ 0 };
+
+  // The last instructions fetched, (pc, word), and the last memory accesses, (pc | 1 if a store, address),
+  // see `MachineInspector::CPU_flight_record`
+  FlightRecorder flight_instructions;
+  FlightRecorder flight_accesses;
+
+  static inline constexpr std::uint32_t flight_default_instructions{ 64 };
+
+  // Features of the interpreter loop, every combination is compiled on its own,
+  // so the loop without them doesn't pay for their checks
+  static inline constexpr std::uint32_t feature_coverage{ 0x1 };
+  static inline constexpr std::uint32_t feature_trace{ 0x2 };
+  static inline constexpr std::uint32_t feature_flight{ 0x4 };
+  static inline constexpr std::uint32_t feature_target{ 0x8 }; // stops before the instruction at the target
+
+  // The words that the instruction being traced can store, with their content before it
+  TraceWriter                         *tracer{ nullptr };
+  std::array<TraceWriter::Store, 3>    traced_words;
+  std::uint32_t                        traced_words_no{ 0 };
+  bool                                 trace_every_gpr{ true }; // they could have been changed outside of a run
+
+  /**
+   * Samples requested by other threads, see `MachineInspector::CPU_sample`.
+   *
+   * Every request is an epoch: it's pending while `requested` is ahead of `served`.
+   * A running CPU answers it between two instructions, copying directly into `destination`,
+   * otherwise the requester copies the sample itself, as the CPU can't start meanwhile.
+   **/
+  struct Sampler
+  {
+    std::mutex              mutex;
+    std::condition_variable answered;
+    bool                    running{ false };
+    std::uint64_t           requested{ 0 };
+    std::uint64_t           served{ 0 };
+
+    MachineInspector::CPUSample *destination{ nullptr };
+    std::uint32_t                address{ 0 };
+    std::uint32_t                count{ 0 };
+  } sampler;
+
+  CPU *const   *cores{ nullptr };
+  std::uint32_t cores_no{ 0 };
+
+  // Reservation of LL, checked and cleared by SC
+  bool          ll_bit{ false };
+  std::uint32_t ll_address;
+  std::uint32_t ll_value;
+
   IODevice* io_device;
   FileHandler* file_handler;
 
+  std::array<FileSpan, 16> file_spans;    // guest buffers of the file syscalls, 1 span per block
+  std::vector<char>        string_buffer; // guest strings that cross more blocks
+
+  // The heap is [heap_begin, program_break), its blocks are allocated by the RAM when touched
+  std::uint32_t heap_begin;
+  std::uint32_t program_break;
+  std::uint32_t heap_high_water; // highest program break ever reached
+
   void reserved( std::uint32_t word ) noexcept;
 
   void special( std::uint32_t word ) noexcept;
@@ -153,6 +269,7 @@ private:
   void seleqz( std::uint32_t word ) noexcept;
   void tne( std::uint32_t word ) noexcept;
   void selnez( std::uint32_t word ) noexcept;
+  void sync( std::uint32_t ) noexcept;
 
   /* * * * * *
    *         *
@@ -196,6 +313,8 @@ private:
    * * * * * * */
   void ext( std::uint32_t word ) noexcept;
   void ins( std::uint32_t word ) noexcept;
+  void ll( std::uint32_t word ) noexcept;
+  void sc( std::uint32_t word ) noexcept;
 
   std::uint32_t running_mode() noexcept;
 
@@ -214,9 +333,76 @@ private:
   void enter_kernel_mode() noexcept;
   void enter_user_mode() noexcept;
 
+  // Handles the requests flagged in `attention`.
+  void attend( std::uint32_t requests ) noexcept;
+
+  // Latches the IPI requested into Cause, and takes it if it's enabled.
+  void deliver_ipi() noexcept;
+
+  // Takes the IPI pending in Cause, if Status enables it and it isn't being serviced yet.
+  // Called whenever one of them changes: the requests aren't polled while the IPI is masked.
+  void take_interrupt() noexcept;
+
+  // Fetches and executes an instruction.
+  template <std::uint32_t features>
+  void step() noexcept;
+
+  // Steps until the CPU stops, answering the requests of the other threads.
+  template <std::uint32_t features>
+  void loop( std::uint32_t target ) noexcept;
+
+  using loop_ptr = void ( CPU::* )( std::uint32_t ) noexcept;
+  using step_ptr = void ( CPU::* )() noexcept;
+
+  // The loops, and the steps, compiled for every combination of `features`, indexed by it.
+  template <std::uint32_t... features>
+  static constexpr std::array<loop_ptr, sizeof...( features )> make_loops( std::integer_sequence<std::uint32_t, features...> ) noexcept;
+
+  template <std::uint32_t... features>
+  static constexpr std::array<step_ptr, sizeof...( features )> make_steps( std::integer_sequence<std::uint32_t, features...> ) noexcept;
+
+  // Runs the loop compiled with `features`, and the coverage, the trace and the flight recorder if attached.
+  void run_loop( std::uint32_t features, std::uint32_t target ) noexcept;
+
+  // Features needed by the coverage, the trace and the flight recorder, if attached.
+  std::uint32_t attached_features() const noexcept;
+
+  // Decodes the memory operand of the instruction `word`, at `address`, and if it's a `store`.
+  // Returns its size in bytes, 0 if the instruction doesn't access the memory.
+  std::uint32_t memory_operand( std::uint32_t word, std::uint32_t &address, bool &store ) const noexcept;
+
+  // Records the instruction `word` at `pc`, just fetched, and its memory access.
+  void record_flight( std::uint32_t pc, std::uint32_t word ) noexcept;
+
+  // Increments the counter of the edge `from` -> `to`.
+  void cover( std::uint32_t from, std::uint32_t to ) noexcept;
+
+  // Reads the words that the instruction `word` can store, before executing it.
+  void trace_before( std::uint32_t word ) noexcept;
+
+  // Records the instruction `word` at `pc`, just executed.
+  void trace( std::uint32_t pc, std::uint32_t word ) noexcept;
+
+  // Stops with LIMIT, unless the last instruction has stopped the CPU already.
+  void retire() noexcept;
+
+  // The sampler knows if the CPU is running, the pending sample is answered when it stops.
+  void begin_run() noexcept;
+  void end_run() noexcept;
+
+  // Answers the pending sample, if not withdrawn. The sampler must be locked.
+  void answer_sample() noexcept;
+
+  // Copies the registers, and [address, address + count) of the RAM, into `sample`.
+  void take_sample( MachineInspector::CPUSample &sample, std::uint32_t address, std::uint32_t count ) noexcept;
+
   void set_ex_cause( std::uint32_t ex ) noexcept;
   void signal_exception( std::uint32_t ex, std::uint32_t word, std::uint32_t pc ) noexcept;
 
+  // Reads (`to_ram`), or writes, `count` bytes at `address` from/to the file `fd`.
+  // Returns the number of bytes transferred, negative if error.
+  std::uint32_t file_transfer( std::uint32_t fd, std::uint32_t address, std::uint32_t count, bool to_ram ) noexcept;
+
   using method_ptr = void ( CPU::* )( std::uint32_t ) noexcept;
 
   static inline constexpr std::array<method_ptr, 64> function_table{
@@ -0,0 +1,677 @@
+#include <mips32/disassembler.hpp>
+
+#include <array>
+
+namespace mips32
+{
+namespace
+{
+// How the fields of an instruction are written after its mnemonic
+enum class Operands : std::uint8_t
+{
+  NONE,
+  RD_RS_RT,
+  RD_RT_RS,     // variable shifts
+  RD_RT_SA,     // shifts
+  RD_RS_RT_SA1, // LSA, the shift is sa + 1
+  RD_RS,
+  RS,
+  RS_RT,
+  RT,
+  RT_RS_SIMM,
+  RT_RS_UIMM,
+  RT_UIMM,
+  RT_MEM,       // rt, offset(base)
+  RT_MEM9,      // LL/SC, 9 bits offset
+  FT_MEM,       // ft, offset(base)
+  RT_RS_EXT,    // rt, rs, pos, size
+  RT_RS_INS,    // rt, rs, pos, size
+  RT_RD_SEL,    // COP0 register and select
+  RT_FS,
+  RT_FCR,       // CFC1/CTC1, the control register is numbered as a GPR
+  FD_FS,
+  FD_FS_FT,
+  RS_RT_B16,    // branches, the target is absolute
+  RS_B16,
+  RT_B16,
+  B16,
+  RS_B21,
+  B26,
+  J26,
+  RT_SIMM,      // JIC, JIALC
+  RS_PC19,      // ADDIUPC, LWPC, LWUPC, the address is absolute
+  RS_UIMM,      // AUIPC, ALUIPC
+  UIMM,
+};
+
+struct Instruction
+{
+  char const *name{ nullptr }; // nullptr if reserved
+  Operands    operands{ Operands::NONE };
+};
+
+// CP1 arithmetic, a name per format: S and D, or W and L
+struct FPUInstruction
+{
+  char const *names[2]{ nullptr, nullptr };
+  Operands    operands{ Operands::NONE };
+};
+
+constexpr std::uint32_t opcode( std::uint32_t word ) noexcept { return word >> 26; }
+constexpr std::uint32_t rs( std::uint32_t word ) noexcept { return word >> 21 & 0x1F; }
+constexpr std::uint32_t rt( std::uint32_t word ) noexcept { return word >> 16 & 0x1F; }
+constexpr std::uint32_t rd( std::uint32_t word ) noexcept { return word >> 11 & 0x1F; }
+constexpr std::uint32_t shamt( std::uint32_t word ) noexcept { return word >> 6 & 0x1F; }
+constexpr std::uint32_t function( std::uint32_t word ) noexcept { return word & 0x3F; }
+
+// Sign extends the low `bits` bits of `value`
+template <std::uint32_t bits>
+constexpr std::uint32_t sign_extend( std::uint32_t value ) noexcept
+{
+  return std::uint32_t( std::int32_t( value << ( 32 - bits ) ) >> ( 32 - bits ) );
+}
+
+constexpr auto primary_table = [] {
+  std::array<Instruction, 64> t{};
+
+  // 0x00 SPECIAL, 0x01 REGIMM, 0x06-0x08, 0x16-0x18, 0x36, 0x3E compact branches,
+  // 0x0F AUI/LUI, 0x10 COP0, 0x11 COP1, 0x1F SPECIAL3, 0x3B PCREL are decoded by `decode`
+  t[0x02] = { "J", Operands::J26 };
+  t[0x03] = { "JAL", Operands::J26 };
+  t[0x04] = { "BEQ", Operands::RS_RT_B16 };
+  t[0x05] = { "BNE", Operands::RS_RT_B16 };
+  t[0x09] = { "ADDIU", Operands::RT_RS_SIMM };
+  t[0x0A] = { "SLTI", Operands::RT_RS_SIMM };
+  t[0x0B] = { "SLTIU", Operands::RT_RS_SIMM };
+  t[0x0C] = { "ANDI", Operands::RT_RS_UIMM };
+  t[0x0D] = { "ORI", Operands::RT_RS_UIMM };
+  t[0x0E] = { "XORI", Operands::RT_RS_UIMM };
+  t[0x20] = { "LB", Operands::RT_MEM };
+  t[0x21] = { "LH", Operands::RT_MEM };
+  t[0x23] = { "LW", Operands::RT_MEM };
+  t[0x24] = { "LBU", Operands::RT_MEM };
+  t[0x25] = { "LHU", Operands::RT_MEM };
+  t[0x28] = { "SB", Operands::RT_MEM };
+  t[0x29] = { "SH", Operands::RT_MEM };
+  t[0x2B] = { "SW", Operands::RT_MEM };
+  t[0x31] = { "LWC1", Operands::FT_MEM };
+  t[0x32] = { "BC", Operands::B26 };
+  t[0x35] = { "LDC1", Operands::FT_MEM };
+  t[0x39] = { "SWC1", Operands::FT_MEM };
+  t[0x3A] = { "BALC", Operands::B26 };
+  t[0x3D] = { "SDC1", Operands::FT_MEM };
+
+  return t;
+}();
+
+constexpr auto special_table = [] {
+  std::array<Instruction, 64> t{};
+
+  // 0x02 SRL/ROTR, 0x06 SRLV/ROTRV, 0x09 JALR/JR, 0x18-0x1B MUL/DIV are decoded by `decode`
+  t[0x00] = { "SLL", Operands::RD_RT_SA };
+  t[0x03] = { "SRA", Operands::RD_RT_SA };
+  t[0x04] = { "SLLV", Operands::RD_RT_RS };
+  t[0x05] = { "LSA", Operands::RD_RS_RT_SA1 };
+  t[0x07] = { "SRAV", Operands::RD_RT_RS };
+  t[0x0C] = { "SYSCALL", Operands::NONE };
+  t[0x0D] = { "BREAK", Operands::NONE };
+  t[0x0F] = { "SYNC", Operands::NONE };
+  t[0x10] = { "CLZ", Operands::RD_RS };
+  t[0x11] = { "CLO", Operands::RD_RS };
+  t[0x20] = { "ADD", Operands::RD_RS_RT };
+  t[0x21] = { "ADDU", Operands::RD_RS_RT };
+  t[0x22] = { "SUB", Operands::RD_RS_RT };
+  t[0x23] = { "SUBU", Operands::RD_RS_RT };
+  t[0x24] = { "AND", Operands::RD_RS_RT };
+  t[0x25] = { "OR", Operands::RD_RS_RT };
+  t[0x26] = { "XOR", Operands::RD_RS_RT };
+  t[0x27] = { "NOR", Operands::RD_RS_RT };
+  t[0x2A] = { "SLT", Operands::RD_RS_RT };
+  t[0x2B] = { "SLTU", Operands::RD_RS_RT };
+  t[0x30] = { "TGE", Operands::RS_RT };
+  t[0x31] = { "TGEU", Operands::RS_RT };
+  t[0x32] = { "TLT", Operands::RS_RT };
+  t[0x33] = { "TLTU", Operands::RS_RT };
+  t[0x34] = { "TEQ", Operands::RS_RT };
+  t[0x35] = { "SELEQZ", Operands::RD_RS_RT };
+  t[0x36] = { "TNE", Operands::RS_RT };
+  t[0x37] = { "SELNEZ", Operands::RD_RS_RT };
+
+  return t;
+}();
+
+// SOP30-SOP33, by the function - 0x18 and by the low bit of sa
+constexpr std::array<std::array<char const *, 2>, 4> sop_table{ {
+  { "MUL", "MUH" },
+  { "MULU", "MUHU" },
+  { "DIV", "MOD" },
+  { "DIVU", "MODU" },
+} };
+
+constexpr auto regimm_table = [] {
+  std::array<Instruction, 32> t{};
+
+  t[0x00] = { "BLTZ", Operands::RS_B16 };
+  t[0x01] = { "BGEZ", Operands::RS_B16 };
+  t[0x10] = { "NAL", Operands::NONE };
+  t[0x11] = { "BAL", Operands::B16 };
+  t[0x17] = { "SIGRIE", Operands::UIMM };
+
+  return t;
+}();
+
+constexpr auto cop0_table = [] {
+  std::array<Instruction, 32> t{};
+
+  // 0x0B MFMC0 and the C0 functions, rs >= 0x10, are decoded by `decode`
+  t[0x00] = { "MFC0", Operands::RT_RD_SEL };
+  t[0x02] = { "MFHC0", Operands::RT_RD_SEL };
+  t[0x04] = { "MTC0", Operands::RT_RD_SEL };
+  t[0x06] = { "MTHC0", Operands::RT_RD_SEL };
+
+  return t;
+}();
+
+constexpr auto cop1_move_table = [] {
+  std::array<Instruction, 32> t{};
+
+  t[0x00] = { "MFC1", Operands::RT_FS };
+  t[0x02] = { "CFC1", Operands::RT_FCR };
+  t[0x03] = { "MFHC1", Operands::RT_FS };
+  t[0x04] = { "MTC1", Operands::RT_FS };
+  t[0x06] = { "CTC1", Operands::RT_FCR };
+  t[0x07] = { "MTHC1", Operands::RT_FS };
+
+  return t;
+}();
+
+// The functions of the formats S and D, see `CP1::execute`
+constexpr auto fpu_s_d_table = [] {
+  std::array<FPUInstruction, 64> t{};
+
+  t[0x00] = { { "ADD.S", "ADD.D" }, Operands::FD_FS_FT };
+  t[0x01] = { { "SUB.S", "SUB.D" }, Operands::FD_FS_FT };
+  t[0x02] = { { "MUL.S", "MUL.D" }, Operands::FD_FS_FT };
+  t[0x03] = { { "DIV.S", "DIV.D" }, Operands::FD_FS_FT };
+  t[0x04] = { { "SQRT.S", "SQRT.D" }, Operands::FD_FS };
+  t[0x05] = { { "ABS.S", "ABS.D" }, Operands::FD_FS };
+  t[0x06] = { { "MOV.S", "MOV.D" }, Operands::FD_FS };
+  t[0x07] = { { "NEG.S", "NEG.D" }, Operands::FD_FS };
+  t[0x08] = { { "ROUND.L.S", "ROUND.L.D" }, Operands::FD_FS };
+  t[0x09] = { { "TRUNC.L.S", "TRUNC.L.D" }, Operands::FD_FS };
+  t[0x0A] = { { "CEIL.L.S", "CEIL.L.D" }, Operands::FD_FS };
+  t[0x0B] = { { "FLOOR.L.S", "FLOOR.L.D" }, Operands::FD_FS };
+  t[0x0C] = { { "ROUND.W.S", "ROUND.W.D" }, Operands::FD_FS };
+  t[0x0D] = { { "TRUNC.W.S", "TRUNC.W.D" }, Operands::FD_FS };
+  t[0x0E] = { { "CEIL.W.S", "CEIL.W.D" }, Operands::FD_FS };
+  t[0x0F] = { { "FLOOR.W.S", "FLOOR.W.D" }, Operands::FD_FS };
+  t[0x10] = { { "SEL.S", "SEL.D" }, Operands::FD_FS_FT };
+  t[0x14] = { { "SELEQZ.S", "SELEQZ.D" }, Operands::FD_FS_FT };
+  t[0x15] = { { "RECIP.S", "RECIP.D" }, Operands::FD_FS };
+  t[0x16] = { { "RSQRT.S", "RSQRT.D" }, Operands::FD_FS };
+  t[0x17] = { { "SELNEZ.S", "SELNEZ.D" }, Operands::FD_FS_FT };
+  t[0x18] = { { "MADDF.S", "MADDF.D" }, Operands::FD_FS_FT };
+  t[0x19] = { { "MSUBF.S", "MSUBF.D" }, Operands::FD_FS_FT };
+  t[0x1A] = { { "RINT.S", "RINT.D" }, Operands::FD_FS };
+  t[0x1B] = { { "CLASS.S", "CLASS.D" }, Operands::FD_FS };
+  t[0x1C] = { { "MIN.S", "MIN.D" }, Operands::FD_FS_FT };
+  t[0x1D] = { { "MAX.S", "MAX.D" }, Operands::FD_FS_FT };
+  t[0x1E] = { { "MINA.S", "MINA.D" }, Operands::FD_FS_FT };
+  t[0x1F] = { { "MAXA.S", "MAXA.D" }, Operands::FD_FS_FT };
+  t[0x20] = { { "CVT.S.S", "CVT.S.D" }, Operands::FD_FS };
+  t[0x21] = { { "CVT.D.S", "CVT.D.D" }, Operands::FD_FS };
+  t[0x24] = { { "CVT.W.S", "CVT.W.D" }, Operands::FD_FS };
+  t[0x25] = { { "CVT.L.S", "CVT.L.D" }, Operands::FD_FS };
+
+  return t;
+}();
+
+// The functions of the formats W and L: the compares of S and D, and the conversions from W and L
+constexpr auto fpu_w_l_table = [] {
+  std::array<FPUInstruction, 64> t{};
+
+  t[0x00] = { { "CMP.AF.S", "CMP.AF.D" }, Operands::FD_FS_FT };
+  t[0x01] = { { "CMP.UN.S", "CMP.UN.D" }, Operands::FD_FS_FT };
+  t[0x02] = { { "CMP.EQ.S", "CMP.EQ.D" }, Operands::FD_FS_FT };
+  t[0x03] = { { "CMP.UEQ.S", "CMP.UEQ.D" }, Operands::FD_FS_FT };
+  t[0x04] = { { "CMP.LT.S", "CMP.LT.D" }, Operands::FD_FS_FT };
+  t[0x05] = { { "CMP.ULT.S", "CMP.ULT.D" }, Operands::FD_FS_FT };
+  t[0x06] = { { "CMP.LE.S", "CMP.LE.D" }, Operands::FD_FS_FT };
+  t[0x07] = { { "CMP.ULE.S", "CMP.ULE.D" }, Operands::FD_FS_FT };
+  t[0x08] = { { "CMP.SAF.S", "CMP.SAF.D" }, Operands::FD_FS_FT };
+  t[0x09] = { { "CMP.SUN.S", "CMP.SUN.D" }, Operands::FD_FS_FT };
+  t[0x0A] = { { "CMP.SEQ.S", "CMP.SEQ.D" }, Operands::FD_FS_FT };
+  t[0x0B] = { { "CMP.SUEQ.S", "CMP.SUEQ.D" }, Operands::FD_FS_FT };
+  t[0x0C] = { { "CMP.SLT.S", "CMP.SLT.D" }, Operands::FD_FS_FT };
+  t[0x0D] = { { "CMP.SULT.S", "CMP.SULT.D" }, Operands::FD_FS_FT };
+  t[0x0E] = { { "CMP.SLE.S", "CMP.SLE.D" }, Operands::FD_FS_FT };
+  t[0x0F] = { { "CMP.SULE.S", "CMP.SULE.D" }, Operands::FD_FS_FT };
+  t[0x11] = { { "CMP.OR.S", "CMP.OR.D" }, Operands::FD_FS_FT };
+  t[0x12] = { { "CMP.UNE.S", "CMP.UNE.D" }, Operands::FD_FS_FT };
+  t[0x13] = { { "CMP.NE.S", "CMP.NE.D" }, Operands::FD_FS_FT };
+  t[0x19] = { { "CMP.SOR.S", "CMP.SOR.D" }, Operands::FD_FS_FT };
+  t[0x1A] = { { "CMP.SUNE.S", "CMP.SUNE.D" }, Operands::FD_FS_FT };
+  t[0x1B] = { { "CMP.SNE.S", "CMP.SNE.D" }, Operands::FD_FS_FT };
+  t[0x20] = { { "CVT.S.W", "CVT.S.L" }, Operands::FD_FS };
+  t[0x21] = { { "CVT.D.W", "CVT.D.L" }, Operands::FD_FS };
+
+  return t;
+}();
+
+Instruction cop1( std::uint32_t word ) noexcept
+{
+  switch ( rs( word ) )
+  {
+  case 0x10: // S
+  case 0x11: // D
+  {
+    auto const &instruction = fpu_s_d_table[function( word )];
+    return { instruction.names[rs( word ) & 1], instruction.operands };
+  }
+  case 0x14: // W
+  case 0x15: // L
+  {
+    auto const &instruction = fpu_w_l_table[function( word )];
+    return { instruction.names[rs( word ) & 1], instruction.operands };
+  }
+  default:
+    return cop1_move_table[rs( word )];
+  }
+}
+
+// Mirrors the decoders of the CPU, the groups that aren't decoded by a single field are resolved here.
+Instruction decode( std::uint32_t word ) noexcept
+{
+  auto const _rs = rs( word );
+  auto const _rt = rt( word );
+
+  switch ( opcode( word ) )
+  {
+  case 0x00: // SPECIAL
+  {
+    auto const fn = function( word );
+
+    switch ( fn )
+    {
+    case 0x00:
+      if ( word == 0 )
+        return { "NOP", Operands::NONE };
+      break;
+    case 0x02:
+      return { word & 1 << 21 ? "ROTR" : "SRL", Operands::RD_RT_SA };
+    case 0x06:
+      return { word & 1 << 6 ? "ROTRV" : "SRLV", Operands::RD_RT_RS };
+    case 0x09:
+      if ( rd( word ) == 0 )
+        return { "JR", Operands::RS };
+      return { "JALR", Operands::RD_RS };
+    case 0x18:
+    case 0x19:
+    case 0x1A:
+    case 0x1B:
+    {
+      auto const sa = shamt( word );
+      if ( sa != 0b10 && sa != 0b11 )
+        return {};
+      return { sop_table[fn - 0x18][sa & 1], Operands::RD_RS_RT };
+    }
+    }
+
+    return special_table[fn];
+  }
+  case 0x01: // REGIMM
+    return regimm_table[_rt];
+  case 0x06: // POP06
+    if ( _rs == 0 && _rt != 0 )
+      return { "BLEZALC", Operands::RT_B16 };
+    if ( _rs == _rt && _rt != 0 )
+      return { "BGEZALC", Operands::RT_B16 };
+    if ( _rs != _rt && _rs != 0 && _rt != 0 )
+      return { "BGEUC", Operands::RS_RT_B16 };
+    return {};
+  case 0x07: // POP07
+    if ( _rs == 0 && _rt != 0 )
+      return { "BGTZALC", Operands::RT_B16 };
+    if ( _rs == _rt && _rt != 0 )
+      return { "BLTZALC", Operands::RT_B16 };
+    if ( _rs != _rt && _rs != 0 && _rt != 0 )
+      return { "BLTUC", Operands::RS_RT_B16 };
+    return {};
+  case 0x08: // POP10
+    if ( _rs == 0 && _rt != 0 )
+      return { "BEQZALC", Operands::RT_B16 };
+    if ( _rs < _rt && _rs != 0 )
+      return { "BEQC", Operands::RS_RT_B16 };
+    return { "BOVC", Operands::RS_RT_B16 };
+  case 0x0F:
+    if ( _rs == 0 )
+      return { "LUI", Operands::RT_UIMM };
+    return { "AUI", Operands::RT_RS_UIMM };
+  case 0x10: // COP0
+    if ( _rs & 0x10 )
+      return function( word ) == 0x18 ? Instruction{ "ERET", Operands::NONE } : Instruction{};
+    if ( _rs == 0x0B )
+      return { word & 1 << 5 ? "EI" : "DI", Operands::RT };
+    return cop0_table[_rs];
+  case 0x11: // COP1
+    return cop1( word );
+  case 0x16: // POP26
+    if ( _rs == 0 && _rt != 0 )
+      return { "BLEZC", Operands::RT_B16 };
+    if ( _rs == _rt && _rt != 0 )
+      return { "BGEZC", Operands::RT_B16 };
+    if ( _rs != _rt && _rs != 0 && _rt != 0 )
+      return { "BGEC", Operands::RS_RT_B16 };
+    return {};
+  case 0x17: // POP27
+    if ( _rs == 0 && _rt != 0 )
+      return { "BGTZC", Operands::RT_B16 };
+    if ( _rs == _rt && _rt != 0 )
+      return { "BLTZC", Operands::RT_B16 };
+    if ( _rs != _rt && _rs != 0 && _rt != 0 )
+      return { "BLTC", Operands::RS_RT_B16 };
+    return {};
+  case 0x18: // POP30
+    if ( _rs < _rt && _rs != 0 )
+      return { "BNEC", Operands::RS_RT_B16 };
+    if ( _rs < _rt )
+      return { "BNEZALC", Operands::RT_B16 };
+    return { "BNVC", Operands::RS_RT_B16 };
+  case 0x1F: // SPECIAL3
+  {
+    auto const fn = function( word );
+
+    if ( fn == 0x00 )
+      return { "EXT", Operands::RT_RS_EXT };
+    if ( fn == 0x04 )
+      return { "INS", Operands::RT_RS_INS };
+    if ( fn == 0x36 && !( word & 1 << 6 ) )
+      return { "LL", Operands::RT_MEM9 };
+    if ( fn == 0x26 && !( word & 1 << 6 ) )
+      return { "SC", Operands::RT_MEM9 };
+    return {};
+  }
+  case 0x36: // POP66
+    if ( _rs != 0 )
+      return { "BEQZC", Operands::RS_B21 };
+    return { "JIC", Operands::RT_SIMM };
+  case 0x3B: // PCREL
+    switch ( _rt )
+    {
+    case 0x1C:
+    case 0x1D: return {};
+    case 0x1E: return { "AUIPC", Operands::RS_UIMM };
+    case 0x1F: return { "ALUIPC", Operands::RS_UIMM };
+    }
+    switch ( _rt >> 3 )
+    {
+    case 0: return { "ADDIUPC", Operands::RS_PC19 };
+    case 1: return { "LWPC", Operands::RS_PC19 };
+    case 2: return { "LWUPC", Operands::RS_PC19 };
+    default: return {}; // LDPC
+    }
+  case 0x3E: // POP76
+    if ( _rs != 0 )
+      return { "BNEZC", Operands::RS_B21 };
+    return { "JIALC", Operands::RT_SIMM };
+  default:
+    return primary_table[opcode( word )];
+  }
+}
+
+// Appends to a buffer, dropping what doesn't fit
+class Writer
+{
+public:
+  Writer( char *buffer, std::uint32_t size ) noexcept
+    : at( size ? buffer : nullptr ), end( size ? buffer + size - 1 : nullptr )
+  {}
+
+  void put( char c ) noexcept
+  {
+    if ( at != end )
+      *at++ = c;
+    ++length;
+  }
+
+  void put( char const *s ) noexcept
+  {
+    while ( *s )
+      put( *s++ );
+  }
+
+  void separator() noexcept
+  {
+    put( ',' );
+    put( ' ' );
+  }
+
+  void gpr( std::uint32_t n ) noexcept
+  {
+    put( '$' );
+    unsigned_decimal( n );
+  }
+
+  void fpr( std::uint32_t n ) noexcept
+  {
+    put( "$f" );
+    unsigned_decimal( n );
+  }
+
+  void unsigned_decimal( std::uint32_t value ) noexcept
+  {
+    char digits[10];
+    int  count = 0;
+
+    do
+    {
+      digits[count++] = char( '0' + value % 10 );
+      value /= 10;
+    } while ( value );
+
+    while ( count )
+      put( digits[--count] );
+  }
+
+  void decimal( std::uint32_t value ) noexcept
+  {
+    if ( value & 0x8000'0000 )
+    {
+      put( '-' );
+      value = 0 - value;
+    }
+
+    unsigned_decimal( value );
+  }
+
+  // At least `width` digits
+  void hex( std::uint32_t value, int width = 1 ) noexcept
+  {
+    static constexpr char digits[] = "0123456789ABCDEF";
+
+    int count = 8;
+    while ( count > width && !( value >> ( count - 1 ) * 4 ) )
+      --count;
+
+    put( "0x" );
+    while ( count )
+      put( digits[value >> --count * 4 & 0xF] );
+  }
+
+  void address( std::uint32_t value ) noexcept { hex( value, 8 ); }
+
+  // offset(base)
+  void memory( std::uint32_t offset, std::uint32_t base ) noexcept
+  {
+    decimal( offset );
+    put( '(' );
+    gpr( base );
+    put( ')' );
+  }
+
+  std::uint32_t finish() noexcept
+  {
+    if ( at )
+      *at = '\0';
+    return length;
+  }
+
+private:
+  char *at;
+  char *end; // the room of the NUL
+
+  std::uint32_t length{ 0 };
+};
+
+void write_operands( Writer &out, Operands operands, std::uint32_t word, std::uint32_t pc ) noexcept
+{
+  auto const _rs = rs( word );
+  auto const _rt = rt( word );
+  auto const _rd = rd( word );
+  auto const sa = shamt( word );
+  auto const imm = word & 0xFFFF;
+  auto const simm = sign_extend<16>( imm );
+  auto const next = pc + 4; // there are no delay slots, the offsets are relative to the next instruction
+
+  // The FPR fields share the positions of the GPR ones
+  auto const _fd = sa;
+  auto const _fs = _rd;
+  auto const _ft = _rt;
+
+  switch ( operands )
+  {
+  case Operands::NONE:
+    break;
+  case Operands::RD_RS_RT:
+    out.gpr( _rd ), out.separator(), out.gpr( _rs ), out.separator(), out.gpr( _rt );
+    break;
+  case Operands::RD_RT_RS:
+    out.gpr( _rd ), out.separator(), out.gpr( _rt ), out.separator(), out.gpr( _rs );
+    break;
+  case Operands::RD_RT_SA:
+    out.gpr( _rd ), out.separator(), out.gpr( _rt ), out.separator(), out.unsigned_decimal( sa );
+    break;
+  case Operands::RD_RS_RT_SA1:
+    out.gpr( _rd ), out.separator(), out.gpr( _rs ), out.separator(), out.gpr( _rt ), out.separator();
+    out.unsigned_decimal( sa + 1 );
+    break;
+  case Operands::RD_RS:
+    out.gpr( _rd ), out.separator(), out.gpr( _rs );
+    break;
+  case Operands::RS:
+    out.gpr( _rs );
+    break;
+  case Operands::RS_RT:
+    out.gpr( _rs ), out.separator(), out.gpr( _rt );
+    break;
+  case Operands::RT:
+    out.gpr( _rt );
+    break;
+  case Operands::RT_RS_SIMM:
+    out.gpr( _rt ), out.separator(), out.gpr( _rs ), out.separator(), out.decimal( simm );
+    break;
+  case Operands::RT_RS_UIMM:
+    out.gpr( _rt ), out.separator(), out.gpr( _rs ), out.separator(), out.hex( imm );
+    break;
+  case Operands::RT_UIMM:
+    out.gpr( _rt ), out.separator(), out.hex( imm );
+    break;
+  case Operands::RT_MEM:
+    out.gpr( _rt ), out.separator(), out.memory( simm, _rs );
+    break;
+  case Operands::RT_MEM9:
+    out.gpr( _rt ), out.separator(), out.memory( sign_extend<9>( word >> 7 ), _rs );
+    break;
+  case Operands::FT_MEM:
+    out.fpr( _ft ), out.separator(), out.memory( simm, _rs );
+    break;
+  case Operands::RT_RS_EXT:
+    out.gpr( _rt ), out.separator(), out.gpr( _rs ), out.separator();
+    out.unsigned_decimal( sa ), out.separator(), out.unsigned_decimal( _rd + 1 );
+    break;
+  case Operands::RT_RS_INS:
+    out.gpr( _rt ), out.separator(), out.gpr( _rs ), out.separator();
+    out.unsigned_decimal( sa ), out.separator(), out.decimal( _rd + 1 - sa );
+    break;
+  case Operands::RT_RD_SEL:
+    out.gpr( _rt ), out.separator(), out.gpr( _rd ), out.separator(), out.unsigned_decimal( word & 0x7 );
+    break;
+  case Operands::RT_FS:
+    out.gpr( _rt ), out.separator(), out.fpr( _fs );
+    break;
+  case Operands::RT_FCR:
+    out.gpr( _rt ), out.separator(), out.gpr( _fs );
+    break;
+  case Operands::FD_FS:
+    out.fpr( _fd ), out.separator(), out.fpr( _fs );
+    break;
+  case Operands::FD_FS_FT:
+    out.fpr( _fd ), out.separator(), out.fpr( _fs ), out.separator(), out.fpr( _ft );
+    break;
+  case Operands::RS_RT_B16:
+    out.gpr( _rs ), out.separator(), out.gpr( _rt ), out.separator(), out.address( next + ( simm << 2 ) );
+    break;
+  case Operands::RS_B16:
+    out.gpr( _rs ), out.separator(), out.address( next + ( simm << 2 ) );
+    break;
+  case Operands::RT_B16:
+    out.gpr( _rt ), out.separator(), out.address( next + ( simm << 2 ) );
+    break;
+  case Operands::B16:
+    out.address( next + ( simm << 2 ) );
+    break;
+  case Operands::RS_B21:
+    out.gpr( _rs ), out.separator(), out.address( next + ( sign_extend<21>( word ) << 2 ) );
+    break;
+  case Operands::B26:
+    out.address( next + ( sign_extend<26>( word ) << 2 ) );
+    break;
+  case Operands::J26:
+    out.address( ( next & 0xF000'0000 ) | ( word & 0x03FF'FFFF ) << 2 );
+    break;
+  case Operands::RT_SIMM:
+    out.gpr( _rt ), out.separator(), out.decimal( simm );
+    break;
+  case Operands::RS_PC19:
+    out.gpr( _rs ), out.separator(), out.address( pc + ( sign_extend<19>( word ) << 2 ) );
+    break;
+  case Operands::RS_UIMM:
+    out.gpr( _rs ), out.separator(), out.hex( imm );
+    break;
+  case Operands::UIMM:
+    out.hex( imm );
+    break;
+  }
+}
+} // namespace
+
+std::uint32_t disassemble( std::uint32_t word, std::uint32_t pc, char *buffer, std::uint32_t size ) noexcept
+{
+  Writer out{ buffer, size };
+
+  auto const instruction = decode( word );
+
+  if ( !instruction.name )
+  {
+    out.put( "RESERVED " );
+    out.address( word );
+    return out.finish();
+  }
+
+  out.put( instruction.name );
+
+  if ( instruction.operands != Operands::NONE )
+  {
+    out.put( ' ' );
+    write_operands( out, instruction.operands, word, pc );
+  }
+
+  return out.finish();
+}
+
+char const *mnemonic( std::uint32_t word ) noexcept
+{
+  auto const *name = decode( word ).name;
+  return name ? name : "RESERVED";
+}
+} // namespace mips32
@@ -0,0 +1,308 @@
+#include <mips32/farm.hpp>
+#include <mips32/machine.hpp>
+#include <mips32/native_file_handler.hpp>
+
+#include "cpu.hpp"
+
+#include <fmt/compile.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace mips32
+{
+// Reads the input of a job, and collects its output.
+class JobDevice : public IODevice
+{
+public:
+  JobDevice( std::string const &input, std::string &output ) noexcept : input( input ), output( output ) {}
+
+  void print_integer( std::uint32_t value ) noexcept override
+  {
+    fmt::format_to( std::back_inserter( output ), FMT_COMPILE( "{}" ), ( std::int32_t )value );
+  }
+
+  void print_float( float value ) noexcept override
+  {
+    fmt::format_to( std::back_inserter( output ), FMT_COMPILE( "{}" ), value );
+  }
+
+  void print_double( double value ) noexcept override
+  {
+    fmt::format_to( std::back_inserter( output ), FMT_COMPILE( "{}" ), value );
+  }
+
+  void print_string( char const *string ) noexcept override
+  {
+    if ( string )
+      output += string;
+  }
+
+  void print_string( char const *string, std::uint32_t length ) noexcept override
+  {
+    output.append( string, length );
+  }
+
+  void read_integer( std::uint32_t *value ) noexcept override
+  {
+    *value = ( std::uint32_t )parse( std::strtol );
+  }
+
+  void read_float( float *value ) noexcept override
+  {
+    *value = parse( std::strtof );
+  }
+
+  void read_double( double *value ) noexcept override
+  {
+    *value = parse( std::strtod );
+  }
+
+  // A single character, or a line
+  void read_string( char *string, std::uint32_t max_count ) noexcept override
+  {
+    if ( !string || !max_count )
+      return;
+
+    std::memset( string, 0, max_count );
+
+    if ( max_count == 1 )
+    {
+      if ( next < input.size() )
+        string[0] = input[next++];
+      return;
+    }
+
+    auto const line_end = input.find( '\n', next );
+    auto const length = std::min<std::size_t>( { line_end == std::string::npos ? input.size() - next : line_end + 1 - next, max_count - 1 } );
+
+    std::memcpy( string, input.data() + next, length );
+    next += length;
+  }
+
+private:
+  template <typename Number>
+  Number parse( Number ( *convert )( char const *, char **, int ) ) noexcept
+  {
+    char const *begin = input.c_str() + next;
+    char *end;
+
+    auto const value = convert( begin, &end, 10 );
+    next += end - begin;
+
+    return value;
+  }
+
+  template <typename Number>
+  Number parse( Number ( *convert )( char const *, char ** ) ) noexcept
+  {
+    char const *begin = input.c_str() + next;
+    char *end;
+
+    auto const value = convert( begin, &end );
+    next += end - begin;
+
+    return value;
+  }
+
+  std::string const &input;
+  std::string       &output;
+  std::size_t        next{ 0 }; // first character not read yet
+};
+
+inline namespace v0
+{
+class FarmImpl
+{
+public:
+  explicit FarmImpl( std::uint32_t workers ) noexcept;
+
+  std::uint32_t workers() const noexcept { return workers_no; }
+
+  std::vector<Farm::Result> run( std::vector<Farm::Job> const &jobs ) noexcept;
+
+private:
+  // Jobs [next, end) of a worker, the owner takes them from the front, the thieves from the back.
+  struct Share
+  {
+    std::mutex    mutex;
+    std::uint32_t next{ 0 };
+    std::uint32_t end{ 0 };
+  };
+
+  // Runs the jobs of the share `worker`, then the stolen ones.
+  void work( std::uint32_t worker, std::vector<Farm::Job> const &jobs, std::vector<Farm::Result> &results ) noexcept;
+
+  // Takes the next job of the share `worker`.
+  // Returns false if it's empty.
+  bool take( std::uint32_t worker, std::uint32_t &job ) noexcept;
+
+  // Moves the second half of the first share that isn't empty into the share `worker`, and takes its first job.
+  // Returns false if every share is empty, the batch is over.
+  bool steal( std::uint32_t worker, std::uint32_t &job ) noexcept;
+
+  static Farm::Result run_job( Farm::Job const &job ) noexcept;
+
+  std::uint32_t            workers_no;
+  std::uint32_t            active{ 0 }; // workers of the batch
+  std::unique_ptr<Share[]> shares;
+};
+} // namespace v0
+
+Farm::Farm( std::uint32_t workers ) noexcept : _impl( new FarmImpl( workers ) ) {}
+
+Farm::~Farm() { delete _impl; }
+
+std::uint32_t Farm::workers() const noexcept { return _impl->workers(); }
+
+std::vector<Farm::Result> Farm::run( std::vector<Job> const &jobs ) noexcept { return _impl->run( jobs ); }
+
+v0::FarmImpl::FarmImpl( std::uint32_t workers ) noexcept
+    : workers_no( workers ? workers : std::max( std::thread::hardware_concurrency(), 1u ) )
+    , shares( new Share[workers_no] )
+{}
+
+/**
+ * The batch is split in contiguous shares, one per worker,
+ * the calling thread is the first worker.
+ **/
+std::vector<Farm::Result> v0::FarmImpl::run( std::vector<Farm::Job> const &jobs ) noexcept
+{
+  auto const jobs_no = ( std::uint32_t )jobs.size();
+
+  std::vector<Farm::Result> results( jobs_no );
+
+  active = std::min( workers_no, jobs_no );
+
+  for ( std::uint32_t worker = 0; worker < active; ++worker )
+  {
+    shares[worker].next = std::uint32_t( std::uint64_t( jobs_no ) * worker / active );
+    shares[worker].end = std::uint32_t( std::uint64_t( jobs_no ) * ( worker + 1 ) / active );
+  }
+
+  std::vector<std::thread> threads;
+  threads.reserve( active ? active - 1 : 0 );
+
+  for ( std::uint32_t worker = 1; worker < active; ++worker )
+    threads.emplace_back( &FarmImpl::work, this, worker, std::cref( jobs ), std::ref( results ) );
+
+  if ( active )
+    work( 0, jobs, results );
+
+  for ( auto &thread : threads )
+    thread.join();
+
+  return results;
+}
+
+void v0::FarmImpl::work( std::uint32_t worker, std::vector<Farm::Job> const &jobs, std::vector<Farm::Result> &results ) noexcept
+{
+  auto const jobs_no = std::uint64_t( jobs.size() );
+
+  // The initial share
+  auto const first = std::uint32_t( jobs_no * worker / active );
+  auto const last = std::uint32_t( jobs_no * ( worker + 1 ) / active );
+
+  std::uint32_t job;
+
+  while ( take( worker, job ) || steal( worker, job ) )
+  {
+    auto &result = results[job];
+
+    result = run_job( jobs[job] );
+    result.worker = worker;
+    result.stolen = job < first || job >= last;
+  }
+}
+
+bool v0::FarmImpl::take( std::uint32_t worker, std::uint32_t &job ) noexcept
+{
+  auto &share = shares[worker];
+
+  std::lock_guard<std::mutex> lock( share.mutex );
+
+  if ( share.next == share.end )
+    return false;
+
+  job = share.next++;
+  return true;
+}
+
+bool v0::FarmImpl::steal( std::uint32_t worker, std::uint32_t &job ) noexcept
+{
+  for ( std::uint32_t i = 1; i < active; ++i )
+  {
+    auto &victim = shares[( worker + i ) % active];
+
+    std::uint32_t begin, end;
+
+    {
+      std::lock_guard<std::mutex> lock( victim.mutex );
+
+      if ( victim.next == victim.end )
+        continue;
+
+      // A single job left is stolen too, its owner could be busy for long
+      begin = victim.next + ( victim.end - victim.next ) / 2;
+      end = victim.end;
+      victim.end = begin;
+    }
+
+    // Only the owner refills its share, and it's empty
+    auto &share = shares[worker];
+
+    std::lock_guard<std::mutex> lock( share.mutex );
+
+    job = begin;
+    share.next = begin + 1;
+    share.end = end;
+    return true;
+  }
+
+  return false;
+}
+
+Farm::Result v0::FarmImpl::run_job( Farm::Job const &job ) noexcept
+{
+  using namespace std::chrono;
+
+  Farm::Result result;
+
+  auto const start = steady_clock::now();
+
+  {
+    JobDevice         device( job.input, result.output );
+    NativeFileHandler files{ false }; // the ring isn't worth it for a single program
+
+    Machine machine{ job.ram_alloc_limit, &device, &files };
+    machine.reset();
+
+    if ( machine.load_file( job.executable.c_str() ) )
+      return result;
+
+    auto inspector = machine.get_inspector();
+
+    if ( job.instruction_limit )
+      inspector.CPU_retire_limit() = job.instruction_limit;
+
+    result.failed = false;
+    result.exit_code = machine.start();
+
+    auto const gpr = inspector.CPU_gpr_begin();
+
+    if ( result.exit_code == CPU::EXIT && gpr[2] == 17 ) // $v0, exit2
+      result.exit_value = gpr[4];                       // $a0
+
+    result.instructions = inspector.CPU_retired();
+  }
+
+  result.microseconds = ( std::uint64_t )duration_cast<microseconds>( steady_clock::now() - start ).count();
+  return result;
+}
+} // namespace mips32
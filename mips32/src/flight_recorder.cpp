@@ -0,0 +1,77 @@
+#include "flight_recorder.hpp"
+
+#include <new>
+
+namespace mips32
+{
+void FlightRecorder::resize( std::uint32_t entries ) noexcept
+{
+  slots.reset();
+  mask = 0;
+
+  started.store( 0, std::memory_order_relaxed );
+  completed.store( 0, std::memory_order_relaxed );
+
+  if ( !entries || entries > 0x100'0000 )
+    return;
+
+  std::uint32_t size = 1;
+  while ( size < entries )
+    size <<= 1;
+
+  slots.reset( new ( std::nothrow ) std::atomic<std::uint32_t>[size * 2] );
+  if ( !slots )
+    return;
+
+  for ( std::uint32_t i = 0; i < size * 2; i += 2 )
+  {
+    slots[i].store( unused, std::memory_order_relaxed );
+    slots[i + 1].store( 0, std::memory_order_relaxed );
+  }
+
+  mask = size - 1;
+}
+
+/**
+ * The entry `end + k`, started while copying, reuses the slot of `end + k - size`,
+ * which is the k-th copied: the first `started - end` copies are dropped.
+ **/
+std::vector<std::uint32_t> FlightRecorder::read() const noexcept
+{
+  std::vector<std::uint32_t> words;
+
+  if ( !slots )
+    return words;
+
+  auto const size = mask + 1;
+  auto const end = completed.load( std::memory_order_acquire );
+
+  words.resize( size * 2 );
+
+  for ( std::uint32_t i = 0; i < size; ++i )
+  {
+    auto const *const slot = slots.get() + ( ( end - size + i ) & mask ) * 2;
+    words[i * 2] = slot[0].load( std::memory_order_relaxed );
+    words[i * 2 + 1] = slot[1].load( std::memory_order_relaxed );
+  }
+
+  std::atomic_thread_fence( std::memory_order_acquire );
+
+  auto const overwritten = started.load( std::memory_order_relaxed ) - end;
+
+  std::uint32_t kept = 0;
+
+  for ( std::uint32_t i = overwritten < size ? overwritten : size; i < size; ++i )
+  {
+    if ( words[i * 2] == unused )
+      continue;
+
+    words[kept * 2] = words[i * 2];
+    words[kept * 2 + 1] = words[i * 2 + 1];
+    ++kept;
+  }
+
+  words.resize( kept * 2 );
+  return words;
+}
+} // namespace mips32
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace mips32
+{
+/**
+ * Ring of the last entries pushed, each one a pair of words.
+ * Written by a single thread, read wait-free by any other.
+ *
+ * Every push announces the entry in `started`, before writing it, then publishes it in `completed`.
+ * A reader copies the entries published, then drops the ones whose slot has been reused
+ * by an entry started meanwhile, instead of retrying.
+ **/
+class FlightRecorder
+{
+public:
+  // Written in the first word of the slots never used, an entry can't start with it.
+  static inline constexpr std::uint32_t unused{ 0xFFFF'FFFF };
+
+  // Holds the last `entries` entries, rounded up to a power of 2, 0 disables it.
+  // The entries pushed until now are lost. Not thread-safe.
+  void resize( std::uint32_t entries ) noexcept;
+
+  bool          enabled() const noexcept { return slots != nullptr; }
+  std::uint32_t size() const noexcept { return slots ? mask + 1 : 0; }
+
+  void push( std::uint32_t first, std::uint32_t second ) noexcept
+  {
+    auto const index = completed.load( std::memory_order_relaxed ); // written by this thread only
+
+    started.store( index + 1, std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_release );
+
+    auto *const slot = slots.get() + ( index & mask ) * 2;
+    slot[0].store( first, std::memory_order_relaxed );
+    slot[1].store( second, std::memory_order_relaxed );
+
+    completed.store( index + 1, std::memory_order_release );
+  }
+
+  // Returns the pairs of words of the entries, oldest first.
+  // Can be called by any thread, also while pushing.
+  std::vector<std::uint32_t> read() const noexcept;
+
+private:
+  std::unique_ptr<std::atomic<std::uint32_t>[]> slots; // 2 words per entry
+  std::uint32_t                                 mask{ 0 };
+
+  // Entries pushed, wrapping around
+  std::atomic<std::uint32_t> started{ 0 };
+  std::atomic<std::uint32_t> completed{ 0 };
+};
+} // namespace mips32
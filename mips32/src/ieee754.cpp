@@ -0,0 +1,789 @@
+#include "ieee754.hpp"
+
+#include "cp1.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+namespace mips32::ieee754
+{
+namespace
+{
+template <typename T>
+struct Format;
+
+template <>
+struct Format<float>
+{
+  using Bits = std::uint32_t;
+
+  static constexpr int fraction = 23;
+  static constexpr int exponent = 8;
+};
+
+template <>
+struct Format<double>
+{
+  using Bits = std::uint64_t;
+
+  static constexpr int fraction = 52;
+  static constexpr int exponent = 11;
+};
+
+/**
+ * The fields of the format, and the helpers working on its bits.
+ *
+ * A finite nonzero value is unpacked as `sig * 2^(exp - bias - fraction)`, with the leading 1 of `sig` at the bit `fraction`.
+ * The results are rounded from `sig * 2^(exp - bias - 61)`, with the leading 1 of `sig` at the bit 62,
+ * and at least 9 bits below the ones of the fraction: the last one is sticky, set if any bit shifted out was.
+ **/
+template <typename T>
+struct Traits
+{
+  using Bits = typename Format<T>::Bits;
+
+  static constexpr int  fraction = Format<T>::fraction;
+  static constexpr int  width = int( sizeof( Bits ) * 8 );
+  static constexpr int  max_exp = ( 1 << Format<T>::exponent ) - 1;
+  static constexpr int  bias = max_exp >> 1;
+  static constexpr Bits sign_bit = Bits( 1 ) << ( width - 1 );
+  static constexpr Bits fraction_mask = ( Bits( 1 ) << fraction ) - 1;
+  static constexpr Bits quiet_bit = Bits( 1 ) << ( fraction - 1 );
+  static constexpr Bits infinity = Bits( max_exp ) << fraction;
+  static constexpr Bits default_nan = infinity | quiet_bit;
+
+  static Bits bits( T value ) noexcept
+  {
+    Bits b;
+    std::memcpy( &b, &value, sizeof( b ) );
+    return b;
+  }
+
+  static T value( Bits b ) noexcept
+  {
+    T v;
+    std::memcpy( &v, &b, sizeof( v ) );
+    return v;
+  }
+
+  static int  exp( Bits b ) noexcept { return int( b >> fraction ) & max_exp; }
+  static bool sign( Bits b ) noexcept { return ( b & sign_bit ) != 0; }
+  static bool nan( Bits b ) noexcept { return ( b & ~sign_bit ) > infinity; }
+  static bool signaling( Bits b ) noexcept { return nan( b ) && !( b & quiet_bit ); }
+  static bool inf( Bits b ) noexcept { return ( b & ~sign_bit ) == infinity; }
+  static bool zero( Bits b ) noexcept { return !( b & ~sign_bit ); }
+  static bool normal( Bits b ) noexcept { return unsigned( exp( b ) - 1 ) < unsigned( max_exp - 1 ); }
+  static Bits signed_zero( bool sign ) noexcept { return sign ? sign_bit : 0; }
+  static Bits signed_infinity( bool sign ) noexcept { return infinity | signed_zero( sign ); }
+
+  // The subnormals are zeroes, if flushed
+  static Bits operand( T value, Environment const &env ) noexcept
+  {
+    auto const b = bits( value );
+    return env.flush && !exp( b ) ? b & sign_bit : b;
+  }
+};
+
+struct Unpacked
+{
+  bool          sign;
+  int           exp;
+  std::uint64_t sig;
+};
+
+int leading_zeros( std::uint64_t x ) noexcept
+{
+  int n = 0;
+
+  if ( !( x >> 32 ) ) n += 32, x <<= 32;
+  if ( !( x >> 48 ) ) n += 16, x <<= 16;
+  if ( !( x >> 56 ) ) n += 8, x <<= 8;
+  if ( !( x >> 60 ) ) n += 4, x <<= 4;
+  if ( !( x >> 62 ) ) n += 2, x <<= 2;
+  if ( !( x >> 63 ) ) n += 1;
+
+  return n;
+}
+
+std::uint64_t shift_right_jam( std::uint64_t x, int n ) noexcept
+{
+  if ( n <= 0 )
+    return x;
+  if ( n >= 64 )
+    return x != 0;
+
+  return x >> n | ( ( x << ( 64 - n ) ) != 0 );
+}
+
+// 128 bits, for the exact products of FMA
+struct Wide
+{
+  std::uint64_t hi, lo;
+};
+
+Wide multiply( std::uint64_t a, std::uint64_t b ) noexcept
+{
+  auto const a_lo = a & 0xFFFF'FFFF, a_hi = a >> 32;
+  auto const b_lo = b & 0xFFFF'FFFF, b_hi = b >> 32;
+
+  auto const lo_lo = a_lo * b_lo;
+  auto const hi_lo = a_hi * b_lo;
+  auto const lo_hi = a_lo * b_hi;
+  auto const hi_hi = a_hi * b_hi;
+
+  auto const middle = ( lo_lo >> 32 ) + ( hi_lo & 0xFFFF'FFFF ) + ( lo_hi & 0xFFFF'FFFF );
+
+  return { hi_hi + ( hi_lo >> 32 ) + ( lo_hi >> 32 ) + ( middle >> 32 ), middle << 32 | ( lo_lo & 0xFFFF'FFFF ) };
+}
+
+int leading_zeros( Wide x ) noexcept
+{
+  return x.hi ? leading_zeros( x.hi ) : x.lo ? 64 + leading_zeros( x.lo ) : 128;
+}
+
+Wide shift_left( Wide x, int n ) noexcept
+{
+  if ( n <= 0 )
+    return x;
+  if ( n >= 64 )
+    return { x.lo << ( n - 64 ), 0 };
+
+  return { x.hi << n | x.lo >> ( 64 - n ), x.lo << n };
+}
+
+Wide shift_right_jam( Wide x, int n ) noexcept
+{
+  if ( n <= 0 )
+    return x;
+  if ( n >= 128 )
+    return { 0, ( x.hi | x.lo ) != 0 };
+  if ( n >= 64 )
+    return { 0, shift_right_jam( x.hi, n - 64 ) | ( x.lo != 0 ) };
+
+  return { x.hi >> n, x.hi << ( 64 - n ) | x.lo >> n | ( ( x.lo << ( 64 - n ) ) != 0 ) };
+}
+
+bool less( Wide a, Wide b ) noexcept { return a.hi < b.hi || ( a.hi == b.hi && a.lo < b.lo ); }
+
+Wide add( Wide a, Wide b ) noexcept
+{
+  auto const lo = a.lo + b.lo;
+  return { a.hi + b.hi + ( lo < a.lo ), lo };
+}
+
+Wide subtract( Wide a, Wide b ) noexcept { return { a.hi - b.hi - ( a.lo < b.lo ), a.lo - b.lo }; }
+
+// The finite nonzero `b`, the subnormals normalized
+template <typename T>
+Unpacked unpack( typename Traits<T>::Bits b ) noexcept
+{
+  using F = Traits<T>;
+
+  auto const sign = F::sign( b );
+  auto const exp = F::exp( b );
+  std::uint64_t sig = b & F::fraction_mask;
+
+  if ( exp )
+    return { sign, exp, sig | std::uint64_t( 1 ) << F::fraction };
+
+  auto const shift = leading_zeros( sig ) - ( 63 - F::fraction );
+  return { sign, 1 - shift, sig << shift };
+}
+
+// Rounds `sig * 2^(exp - bias - 61)`, `sig` has its leading 1 at the bit 62
+template <typename T>
+T round_pack( bool sign, int exp, std::uint64_t sig, Environment &env ) noexcept
+{
+  using F = Traits<T>;
+  using Bits = typename F::Bits;
+
+  constexpr int           extra = 62 - F::fraction;
+  constexpr std::uint64_t mask = ( std::uint64_t( 1 ) << extra ) - 1;
+  constexpr std::uint64_t half = std::uint64_t( 1 ) << ( extra - 1 );
+
+  bool const    nearest = env.rounding == NEAREST || env.rounding == NEAREST_AWAY;
+  std::uint64_t increment = half;
+
+  if ( !nearest )
+    increment = env.rounding == ( sign ? DOWN : UP ) ? mask : 0;
+
+  auto round_bits = sig & mask;
+
+  if ( exp < 0 )
+  {
+    bool const tiny = exp < -1 || sig + increment < ( std::uint64_t( 1 ) << 63 );
+
+    if ( env.flush && tiny )
+    {
+      env.raised |= CP1::UNDERFLOW_ | CP1::INEXACT;
+      return F::value( F::signed_zero( sign ) );
+    }
+
+    sig = shift_right_jam( sig, -exp );
+    exp = 0;
+    round_bits = sig & mask;
+
+    if ( tiny && round_bits )
+      env.raised |= CP1::UNDERFLOW_;
+  }
+  else if ( exp > F::max_exp - 2 || ( exp == F::max_exp - 2 && sig + increment >= ( std::uint64_t( 1 ) << 63 ) ) )
+  {
+    env.raised |= CP1::OVERFLOW_ | CP1::INEXACT;
+
+    // The largest finite number, unless rounding away from zero
+    return F::value( F::signed_infinity( sign ) - !increment );
+  }
+
+  if ( round_bits )
+    env.raised |= CP1::INEXACT;
+
+  sig = ( sig + increment ) >> extra;
+
+  // Ties to even
+  if ( round_bits == half && env.rounding == NEAREST )
+    sig &= ~std::uint64_t( 1 );
+
+  if ( !sig )
+    exp = 0;
+
+  // The leading 1 of `sig` carries into the exponent
+  return F::value( F::signed_zero( sign ) + ( Bits( exp ) << F::fraction ) + Bits( sig ) );
+}
+
+// Same as `round_pack`, with the leading 1 of `sig` anywhere below the bit 63
+template <typename T>
+T normalize_round_pack( bool sign, int exp, std::uint64_t sig, Environment &env ) noexcept
+{
+  auto const shift = leading_zeros( sig ) - 1;
+  return round_pack<T>( sign, exp - shift, sig << shift, env );
+}
+
+template <typename T>
+T propagate( typename Traits<T>::Bits a, typename Traits<T>::Bits b, Environment &env ) noexcept
+{
+  using F = Traits<T>;
+
+  if ( F::signaling( a ) || F::signaling( b ) )
+    env.raised |= CP1::INVALID;
+
+  return F::value( ( F::nan( a ) ? a : b ) | F::quiet_bit );
+}
+
+template <typename T>
+T invalid( Environment &env ) noexcept
+{
+  env.raised |= CP1::INVALID;
+  return Traits<T>::value( Traits<T>::default_nan );
+}
+
+// The exact zero of x - x, or of two zeroes of opposite sign
+template <typename T>
+T cancelled( Environment const &env ) noexcept
+{
+  return Traits<T>::value( Traits<T>::signed_zero( env.rounding == DOWN ) );
+}
+
+// `a` and `b` finite and nonzero, `b` negated if subtracting
+template <typename T>
+T add_magnitudes( Unpacked a, Unpacked b, Environment &env ) noexcept
+{
+  using F = Traits<T>;
+
+  if ( a.exp < b.exp || ( a.exp == b.exp && a.sig < b.sig ) )
+    std::swap( a, b );
+
+  auto const sig_a = a.sig << ( 61 - F::fraction );
+  auto const sig_b = shift_right_jam( b.sig << ( 61 - F::fraction ), a.exp - b.exp );
+
+  if ( a.sign == b.sign )
+    return normalize_round_pack<T>( a.sign, a.exp, sig_a + sig_b, env );
+
+  if ( sig_a == sig_b )
+    return cancelled<T>( env );
+
+  return normalize_round_pack<T>( a.sign, a.exp, sig_a - sig_b, env );
+}
+
+template <typename T>
+T add_signed( T x, T y, bool negate, Environment &env ) noexcept
+{
+  using F = Traits<T>;
+
+  auto const a = F::operand( x, env );
+  auto b = F::operand( y, env );
+
+  if ( F::nan( a ) || F::nan( b ) )
+    return propagate<T>( a, b, env );
+
+  b ^= negate ? F::sign_bit : 0;
+
+  if ( F::inf( a ) )
+    return F::inf( b ) && F::sign( a ) != F::sign( b ) ? invalid<T>( env ) : F::value( a );
+  if ( F::inf( b ) )
+    return F::value( b );
+
+  if ( F::zero( a ) )
+    return !F::zero( b ) || F::sign( a ) == F::sign( b ) ? F::value( b ) : cancelled<T>( env );
+  if ( F::zero( b ) )
+    return F::value( a );
+
+  return add_magnitudes<T>( unpack<T>( a ), unpack<T>( b ), env );
+}
+
+template <typename T>
+bool fast( T a, T b, Environment const &env ) noexcept
+{
+  using F = Traits<T>;
+  return env.rounding == NEAREST && env.inexact_raised && F::normal( F::bits( a ) ) && F::normal( F::bits( b ) );
+}
+
+template <typename T>
+bool normal( T r ) noexcept
+{
+  return Traits<T>::normal( Traits<T>::bits( r ) );
+}
+} // namespace
+
+template <typename T>
+T add( T a, T b, Environment &env ) noexcept
+{
+  if ( fast( a, b, env ) )
+  {
+    T const r = a + b;
+    if ( normal( r ) )
+      return r;
+  }
+
+  return add_signed( a, b, false, env );
+}
+
+template <typename T>
+T sub( T a, T b, Environment &env ) noexcept
+{
+  if ( fast( a, b, env ) )
+  {
+    T const r = a - b;
+    if ( normal( r ) )
+      return r;
+  }
+
+  return add_signed( a, b, true, env );
+}
+
+template <typename T>
+T mul( T x, T y, Environment &env ) noexcept
+{
+  using F = Traits<T>;
+
+  if ( fast( x, y, env ) )
+  {
+    T const r = x * y;
+    if ( normal( r ) )
+      return r;
+  }
+
+  auto const a = F::operand( x, env );
+  auto const b = F::operand( y, env );
+
+  if ( F::nan( a ) || F::nan( b ) )
+    return propagate<T>( a, b, env );
+
+  bool const sign = F::sign( a ) != F::sign( b );
+
+  if ( F::inf( a ) || F::inf( b ) )
+    return F::zero( a ) || F::zero( b ) ? invalid<T>( env ) : F::value( F::signed_infinity( sign ) );
+  if ( F::zero( a ) || F::zero( b ) )
+    return F::value( F::signed_zero( sign ) );
+
+  auto const ua = unpack<T>( a );
+  auto const ub = unpack<T>( b );
+
+  // The leading 1 of the product is at the bit 125 or 126, of the high half at 61 or 62
+  auto const product = multiply( ua.sig << ( 62 - F::fraction ), ub.sig << ( 63 - F::fraction ) );
+
+  return normalize_round_pack<T>( sign, ua.exp + ub.exp - F::bias, product.hi | ( product.lo != 0 ), env );
+}
+
+template <typename T>
+T div( T x, T y, Environment &env ) noexcept
+{
+  using F = Traits<T>;
+
+  if ( fast( x, y, env ) )
+  {
+    T const r = x / y;
+    if ( normal( r ) )
+      return r;
+  }
+
+  auto const a = F::operand( x, env );
+  auto const b = F::operand( y, env );
+
+  if ( F::nan( a ) || F::nan( b ) )
+    return propagate<T>( a, b, env );
+
+  bool const sign = F::sign( a ) != F::sign( b );
+
+  if ( F::inf( a ) )
+    return F::inf( b ) ? invalid<T>( env ) : F::value( F::signed_infinity( sign ) );
+  if ( F::inf( b ) )
+    return F::value( F::signed_zero( sign ) );
+
+  if ( F::zero( b ) )
+  {
+    if ( F::zero( a ) )
+      return invalid<T>( env );
+
+    env.raised |= CP1::DIVBYZERO;
+    return F::value( F::signed_infinity( sign ) );
+  }
+
+  if ( F::zero( a ) )
+    return F::value( F::signed_zero( sign ) );
+
+  auto ua = unpack<T>( a );
+  auto const ub = unpack<T>( b );
+
+  if ( ua.sig < ub.sig )
+    ua.sig <<= 1, --ua.exp;
+
+  // A bit of the quotient per step, sig_a / sig_b is in [1, 2)
+  std::uint64_t remainder = ua.sig;
+  std::uint64_t quotient = 0;
+
+  for ( int i = 0; i < 63; ++i )
+  {
+    quotient <<= 1;
+
+    if ( remainder >= ub.sig )
+      remainder -= ub.sig, quotient |= 1;
+
+    remainder <<= 1;
+  }
+
+  return round_pack<T>( sign, ua.exp - ub.exp + F::bias - 1, quotient | ( remainder != 0 ), env );
+}
+
+template <typename T>
+T sqrt( T x, Environment &env ) noexcept
+{
+  using F = Traits<T>;
+
+  if ( env.rounding == NEAREST && env.inexact_raised && F::normal( F::bits( x ) ) && x > 0 )
+    return std::sqrt( x );
+
+  auto const a = F::operand( x, env );
+
+  if ( F::nan( a ) )
+    return propagate<T>( a, a, env );
+  if ( F::zero( a ) )
+    return F::value( a );
+  if ( F::sign( a ) )
+    return invalid<T>( env );
+  if ( F::inf( a ) )
+    return F::value( a );
+
+  auto const ua = unpack<T>( a );
+
+  // sig * 2^unbiased, with an even exponent and the leading 1 of sig at the bit 60 or 61
+  auto const unbiased = ua.exp - F::bias - F::fraction;
+  auto       shift = 60 - F::fraction;
+
+  if ( ( unbiased - shift ) & 1 )
+    ++shift;
+
+  auto const sig = ua.sig << shift;
+
+  // Digit by digit, of sig * 2^60: the root has its leading 1 at the bit 60
+  std::uint64_t remainder = 0;
+  std::uint64_t root = 0;
+
+  for ( int i = 60; i >= 0; --i )
+  {
+    remainder = remainder << 2 | ( i >= 30 ? sig >> ( 2 * i - 60 ) & 3 : 0 );
+
+    auto const trial = root << 2 | 1;
+    root <<= 1;
+
+    if ( remainder >= trial )
+      remainder -= trial, root |= 1;
+  }
+
+  return normalize_round_pack<T>( false, ( unbiased - shift ) / 2 + F::bias + 31, root | ( remainder != 0 ), env );
+}
+
+template <typename T>
+T fma( T x, T y, T z, Environment &env ) noexcept
+{
+  using F = Traits<T>;
+
+  if ( fast( x, y, env ) && F::normal( F::bits( z ) ) )
+  {
+    T const r = std::fma( x, y, z );
+    if ( normal( r ) )
+      return r;
+  }
+
+  auto const a = F::operand( x, env );
+  auto const b = F::operand( y, env );
+  auto const c = F::operand( z, env );
+
+  if ( F::nan( a ) || F::nan( b ) || F::nan( c ) )
+  {
+    if ( F::signaling( c ) )
+      env.raised |= CP1::INVALID;
+
+    return F::nan( a ) || F::nan( b ) ? propagate<T>( a, b, env ) : propagate<T>( c, c, env );
+  }
+
+  bool const sign = F::sign( a ) != F::sign( b );
+
+  if ( F::inf( a ) || F::inf( b ) )
+  {
+    if ( F::zero( a ) || F::zero( b ) || ( F::inf( c ) && F::sign( c ) != sign ) )
+      return invalid<T>( env );
+
+    return F::value( F::signed_infinity( sign ) );
+  }
+
+  if ( F::inf( c ) )
+    return F::value( c );
+
+  if ( F::zero( a ) || F::zero( b ) )
+  {
+    if ( !F::zero( c ) || F::sign( c ) == sign )
+      return F::zero( c ) ? F::value( F::signed_zero( sign ) ) : F::value( c );
+
+    return cancelled<T>( env );
+  }
+
+  if ( F::zero( c ) )
+    return mul( x, y, env );
+
+  auto const ua = unpack<T>( a );
+  auto const ub = unpack<T>( b );
+  auto const uc = unpack<T>( c );
+
+  // Both with the leading 1 at the bit 126, as value * 2^exp
+  auto product = multiply( ua.sig << ( 62 - F::fraction ), ub.sig << ( 63 - F::fraction ) );
+  auto product_exp = ua.exp + ub.exp - 2 * F::bias - 125;
+
+  if ( !( product.hi >> 62 ) )
+    product = shift_left( product, 1 ), --product_exp;
+
+  auto addend = shift_left( { 0, uc.sig }, 126 - F::fraction );
+  auto addend_exp = uc.exp - F::bias - 126;
+
+  bool result_sign = sign;
+  Wide sum;
+  int  exp;
+
+  if ( product_exp < addend_exp || ( product_exp == addend_exp && less( product, addend ) ) )
+  {
+    std::swap( product, addend );
+    std::swap( product_exp, addend_exp );
+    result_sign = F::sign( c );
+  }
+
+  addend = shift_right_jam( addend, product_exp - addend_exp );
+  exp = product_exp;
+
+  if ( sign == F::sign( c ) )
+  {
+    sum = add( product, addend );
+  }
+  else
+  {
+    if ( product.hi == addend.hi && product.lo == addend.lo )
+      return cancelled<T>( env );
+
+    sum = subtract( product, addend );
+  }
+
+  // Into 64 bits, the leading 1 at the bit 126 then the low half jammed
+  auto const shift = leading_zeros( sum ) - 1;
+  sum = shift < 0 ? shift_right_jam( sum, -shift ) : shift_left( sum, shift );
+  exp -= shift;
+
+  return round_pack<T>( result_sign, exp + 64 + F::bias + 61, sum.hi | ( sum.lo != 0 ), env );
+}
+
+template <typename T>
+T fms( T x, T y, T z, Environment &env ) noexcept
+{
+  using F = Traits<T>;
+
+  // Negating a product is exact, a NaN is propagated as it is
+  auto const a = F::bits( x );
+
+  return fma( F::nan( a ) ? x : F::value( a ^ F::sign_bit ), y, z, env );
+}
+
+template <typename T, typename U>
+T convert( U x, Environment &env ) noexcept
+{
+  using F = Traits<T>;
+  using G = Traits<U>;
+
+  // Every normal float is a normal double
+  if constexpr ( F::fraction > G::fraction )
+  {
+    if ( G::normal( G::bits( x ) ) )
+      return T( x );
+  }
+
+  auto const a = G::operand( x, env );
+  bool const sign = G::sign( a );
+
+  if ( G::nan( a ) )
+  {
+    if ( G::signaling( a ) )
+      env.raised |= CP1::INVALID;
+
+    // The payload keeps its most significant bits
+    auto const payload = std::uint64_t( a & G::fraction_mask );
+    auto const fraction = F::fraction > G::fraction ? payload << ( F::fraction - G::fraction ) : payload >> ( G::fraction - F::fraction );
+
+    return F::value( F::signed_infinity( sign ) | F::quiet_bit | typename F::Bits( fraction ) );
+  }
+
+  if ( G::inf( a ) )
+    return F::value( F::signed_infinity( sign ) );
+  if ( G::zero( a ) )
+    return F::value( F::signed_zero( sign ) );
+
+  auto const ua = unpack<U>( a );
+  return normalize_round_pack<T>( sign, ua.exp - G::bias + F::bias, ua.sig << ( 61 - G::fraction ), env );
+}
+
+template <typename T, typename I>
+T from_integer( I n, Environment &env ) noexcept
+{
+  using F = Traits<T>;
+
+  // Every std::int32_t is a double
+  if constexpr ( sizeof( I ) * 8 <= F::fraction )
+  {
+    return T( n );
+  }
+  else
+  {
+    if ( !n )
+      return F::value( 0 );
+
+    bool const    sign = n < 0;
+    std::uint64_t magnitude = sign ? 0 - std::uint64_t( n ) : std::uint64_t( n );
+
+    // The minimum std::int64_t, 2^63
+    if ( magnitude >> 63 )
+      return round_pack<T>( sign, F::bias + 62, magnitude >> 1, env );
+
+    return normalize_round_pack<T>( sign, F::bias + 61, magnitude, env );
+  }
+}
+
+template <typename I, typename T>
+I to_integer( T x, std::uint32_t rounding, Environment &env ) noexcept
+{
+  using F = Traits<T>;
+
+  constexpr int           bits = int( sizeof( I ) * 8 );
+  constexpr std::uint64_t limit = std::uint64_t( 1 ) << ( bits - 1 ); // the magnitude of the minimum
+
+  auto const a = F::operand( x, env );
+
+  if ( F::nan( a ) )
+  {
+    env.raised |= CP1::INVALID;
+    return 0;
+  }
+
+  bool const sign = F::sign( a );
+  auto const out_of_range = [ &env, sign ] {
+    env.raised |= CP1::INVALID;
+    return sign ? std::numeric_limits<I>::min() : std::numeric_limits<I>::max();
+  };
+
+  if ( F::inf( a ) )
+    return out_of_range();
+  if ( F::zero( a ) )
+    return 0;
+
+  auto const ua = unpack<T>( a );
+  auto const shift = ua.exp - F::bias - F::fraction;
+
+  std::uint64_t magnitude;
+  bool          inexact = false;
+
+  if ( shift >= 0 )
+  {
+    // At least 2^63, the minimum std::int64_t is the only one in range
+    if ( ua.exp - F::bias >= 63 )
+      return sign && bits == 64 && ua.exp - F::bias == 63 && ua.sig == std::uint64_t( 1 ) << F::fraction ? std::numeric_limits<I>::min()
+                                                                                                       : out_of_range();
+
+    magnitude = ua.sig << shift;
+  }
+  else
+  {
+    auto const discarded = -shift;
+
+    magnitude = discarded >= 64 ? 0 : ua.sig >> discarded;
+
+    bool const round_bit = discarded <= 64 && ( ua.sig >> ( discarded - 1 ) & 1 );
+    bool const sticky = discarded - 1 >= 64 ? true : ( ua.sig & ( ( std::uint64_t( 1 ) << ( discarded - 1 ) ) - 1 ) ) != 0;
+
+    inexact = round_bit || sticky;
+
+    bool increment = false;
+
+    switch ( rounding )
+    {
+    case NEAREST: increment = round_bit && ( sticky || ( magnitude & 1 ) ); break;
+    case NEAREST_AWAY: increment = round_bit; break;
+    case UP: increment = !sign && inexact; break;
+    case DOWN: increment = sign && inexact; break;
+    }
+
+    magnitude += increment;
+  }
+
+  if ( magnitude > limit - !sign )
+    return out_of_range();
+
+  if ( inexact )
+    env.raised |= CP1::INEXACT;
+
+  return I( sign ? 0 - magnitude : magnitude );
+}
+
+template float  add( float, float, Environment & ) noexcept;
+template double add( double, double, Environment & ) noexcept;
+template float  sub( float, float, Environment & ) noexcept;
+template double sub( double, double, Environment & ) noexcept;
+template float  mul( float, float, Environment & ) noexcept;
+template double mul( double, double, Environment & ) noexcept;
+template float  div( float, float, Environment & ) noexcept;
+template double div( double, double, Environment & ) noexcept;
+template float  sqrt( float, Environment & ) noexcept;
+template double sqrt( double, Environment & ) noexcept;
+template float  fma( float, float, float, Environment & ) noexcept;
+template double fma( double, double, double, Environment & ) noexcept;
+template float  fms( float, float, float, Environment & ) noexcept;
+template double fms( double, double, double, Environment & ) noexcept;
+
+template float  convert<float, double>( double, Environment & ) noexcept;
+template double convert<double, float>( float, Environment & ) noexcept;
+
+template float  from_integer<float, std::int32_t>( std::int32_t, Environment & ) noexcept;
+template float  from_integer<float, std::int64_t>( std::int64_t, Environment & ) noexcept;
+template double from_integer<double, std::int32_t>( std::int32_t, Environment & ) noexcept;
+template double from_integer<double, std::int64_t>( std::int64_t, Environment & ) noexcept;
+
+template std::int32_t to_integer<std::int32_t, float>( float, std::uint32_t, Environment & ) noexcept;
+template std::int32_t to_integer<std::int32_t, double>( double, std::uint32_t, Environment & ) noexcept;
+template std::int64_t to_integer<std::int64_t, float>( float, std::uint32_t, Environment & ) noexcept;
+template std::int64_t to_integer<std::int64_t, double>( double, std::uint32_t, Environment & ) noexcept;
+} // namespace mips32::ieee754
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+
+namespace mips32::ieee754
+{
+/**
+ * IEEE 754 binary32 and binary64 arithmetic in software, for the soft-float mode of CP1.
+ *
+ * The results and the exceptions are the same on every host, whatever the state of its FPU:
+ * every operation is rounded once, by integer arithmetic on the significands.
+ * The NaNs are propagated like SSE does, the first operand that is a NaN is quieted and returned,
+ * the invalid operations return the default NaN, positive.
+ *
+ * The fast paths compute with the host FPU when its result can't differ: to nearest, with normal
+ * operands and result, and Inexact already raised, the only exception such an operation can raise.
+ * They expect the host FPU to round to nearest without flushing the subnormals, see `CP1::bind_host_fpu`.
+ **/
+
+// The roundings of FCSR.RM, and to nearest with the ties away from zero
+enum Rounding : std::uint32_t
+{
+  NEAREST,
+  ZERO,
+  UP,
+  DOWN,
+  NEAREST_AWAY,
+};
+
+struct Environment
+{
+  std::uint32_t rounding;       // FCSR.RM
+  bool          flush;          // FCSR.FS, the subnormal operands and results are flushed to zero
+  bool          inexact_raised; // Inexact is raised and can't trap, the fast paths can't change FCSR
+  std::uint32_t raised{ 0 };    // The exceptions raised, the bits of `CP1::Exception`
+};
+
+template <typename T>
+T add( T a, T b, Environment &env ) noexcept;
+
+template <typename T>
+T sub( T a, T b, Environment &env ) noexcept;
+
+template <typename T>
+T mul( T a, T b, Environment &env ) noexcept;
+
+template <typename T>
+T div( T a, T b, Environment &env ) noexcept;
+
+template <typename T>
+T sqrt( T a, Environment &env ) noexcept;
+
+// a * b + c, rounded once
+template <typename T>
+T fma( T a, T b, T c, Environment &env ) noexcept;
+
+// c - a * b, rounded once
+template <typename T>
+T fms( T a, T b, T c, Environment &env ) noexcept;
+
+// Between float and double
+template <typename T, typename U>
+T convert( U a, Environment &env ) noexcept;
+
+// Of std::int32_t or std::int64_t
+template <typename T, typename I>
+T from_integer( I a, Environment &env ) noexcept;
+
+// To std::int32_t or std::int64_t, `rounding` instead of the one of `env`.
+// The NaNs are converted to 0, the values out of range to the nearest integer, raising Invalid.
+template <typename I, typename T>
+I to_integer( T a, std::uint32_t rounding, Environment &env ) noexcept;
+} // namespace mips32::ieee754
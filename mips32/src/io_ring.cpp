@@ -0,0 +1,241 @@
+#include "io_ring.hpp"
+
+#include <algorithm>
+
+#if defined( __linux__ ) && __has_include( <linux/io_uring.h> )
+#  define MIPS32_IO_URING
+#  include <linux/io_uring.h>
+#  include <sys/mman.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+
+#  include <cerrno>
+#  include <cstring>
+#endif
+
+namespace mips32
+{
+#ifdef MIPS32_IO_URING
+
+int io_uring_setup( std::uint32_t entries, io_uring_params *params ) noexcept
+{
+  return ( int )::syscall( __NR_io_uring_setup, entries, params );
+}
+
+int io_uring_enter( int fd, std::uint32_t to_submit, std::uint32_t min_complete, std::uint32_t flags ) noexcept
+{
+  return ( int )::syscall( __NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0 );
+}
+
+template <typename T>
+T *at( void *base, std::uint32_t offset ) noexcept
+{
+  return ( T * )( ( char * )base + offset );
+}
+
+// Returns the view, or nullptr in case of failure.
+void *map_ring( int fd, std::uint64_t size, std::uint64_t offset ) noexcept
+{
+  void *view = ::mmap( nullptr, ( std::size_t )size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, ( off_t )offset );
+  return view == MAP_FAILED ? nullptr : view;
+}
+
+IORing::IORing( std::uint32_t entries ) noexcept
+{
+  if ( !entries )
+    return;
+
+  io_uring_params params;
+  std::memset( &params, 0, sizeof( params ) );
+
+  // ENOSYS on old kernels, EPERM where it's disabled, as in many containers
+  int const fd = io_uring_setup( entries, &params );
+  if ( fd < 0 )
+    return;
+
+  sq_ring_size = params.sq_off.array + params.sq_entries * sizeof( std::uint32_t );
+  cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof( io_uring_cqe );
+  sqes_size = params.sq_entries * sizeof( io_uring_sqe );
+
+  // Both rings can share a single view
+  if ( params.features & IORING_FEAT_SINGLE_MMAP )
+    sq_ring_size = cq_ring_size = std::max( sq_ring_size, cq_ring_size );
+
+  sq_ring = map_ring( fd, sq_ring_size, IORING_OFF_SQ_RING );
+  cq_ring = params.features & IORING_FEAT_SINGLE_MMAP ? sq_ring : map_ring( fd, cq_ring_size, IORING_OFF_CQ_RING );
+  sqes = map_ring( fd, sqes_size, IORING_OFF_SQES );
+
+  if ( !sq_ring || !cq_ring || !sqes )
+  {
+    if ( sqes )
+      ::munmap( sqes, sqes_size );
+    if ( cq_ring && cq_ring != sq_ring )
+      ::munmap( cq_ring, cq_ring_size );
+    if ( sq_ring )
+      ::munmap( sq_ring, sq_ring_size );
+    ::close( fd );
+    return;
+  }
+
+  sq_head = at<std::uint32_t>( sq_ring, params.sq_off.head );
+  sq_tail = at<std::uint32_t>( sq_ring, params.sq_off.tail );
+  sq_mask = at<std::uint32_t>( sq_ring, params.sq_off.ring_mask );
+  sq_array = at<std::uint32_t>( sq_ring, params.sq_off.array );
+  cq_head = at<std::uint32_t>( cq_ring, params.cq_off.head );
+  cq_tail = at<std::uint32_t>( cq_ring, params.cq_off.tail );
+  cq_mask = at<std::uint32_t>( cq_ring, params.cq_off.ring_mask );
+  cqes = at<io_uring_cqe>( cq_ring, params.cq_off.cqes );
+
+  capacity = params.sq_entries;
+  ring_fd = fd;
+}
+
+IORing::~IORing()
+{
+  if ( !available() )
+    return;
+
+  // The buffers of the requests in flight may be freed right after
+  while ( in_flight && !reap( in_flight ) )
+    ;
+
+  ::munmap( sqes, sqes_size );
+  if ( cq_ring != sq_ring )
+    ::munmap( cq_ring, cq_ring_size );
+  ::munmap( sq_ring, sq_ring_size );
+  ::close( ring_fd );
+}
+
+bool IORing::read( int fd, void *dst, std::uint32_t size, std::uint64_t offset, std::uint64_t tag ) noexcept
+{
+  return queue( IORING_OP_READ, fd, dst, size, offset, tag );
+}
+
+bool IORing::write( int fd, void const *src, std::uint32_t size, std::uint64_t offset, std::uint64_t tag ) noexcept
+{
+  return queue( IORING_OP_WRITE, fd, src, size, offset, tag );
+}
+
+bool IORing::queue( std::uint8_t opcode, int fd, void const *data, std::uint32_t size, std::uint64_t offset, std::uint64_t tag ) noexcept
+{
+  if ( !available() )
+    return true;
+
+  // Makes room for the completion
+  if ( in_flight == capacity && reap( 1 ) )
+    return true;
+
+  // Only this thread writes the tail, the kernel releases the head
+  auto const tail = *sq_tail;
+  auto const index = tail & *sq_mask;
+
+  auto *sqe = at<io_uring_sqe>( sqes, index * sizeof( io_uring_sqe ) );
+  std::memset( sqe, 0, sizeof( *sqe ) );
+  sqe->opcode = opcode;
+  sqe->fd = fd;
+  sqe->off = offset;
+  sqe->addr = ( std::uint64_t )( std::uintptr_t )data;
+  sqe->len = size;
+  sqe->user_data = tag;
+
+  sq_array[index] = index;
+  __atomic_store_n( sq_tail, tail + 1, __ATOMIC_RELEASE );
+
+  int submitted;
+  do
+    submitted = io_uring_enter( ring_fd, 1, 0, 0 );
+  while ( submitted < 0 && errno == EINTR );
+
+  if ( submitted != 1 )
+  {
+    // Takes the entry back, the kernel hasn't consumed it
+    __atomic_store_n( sq_tail, tail, __ATOMIC_RELEASE );
+    return true;
+  }
+
+  ++in_flight;
+  return false;
+}
+
+std::int64_t IORing::wait( std::uint64_t tag ) noexcept
+{
+  while ( true )
+  {
+    auto const same_tag = [tag]( Completion const &completion ) { return completion.tag == tag; };
+    auto const completion = std::find_if( completed.begin(), completed.end(), same_tag );
+
+    if ( completion != completed.end() )
+    {
+      auto const result = completion->result;
+      completed.erase( completion );
+      return result;
+    }
+
+    if ( !in_flight || reap( 1 ) )
+      return -EIO;
+  }
+}
+
+bool IORing::reap( std::uint32_t min_complete ) noexcept
+{
+  auto head = *cq_head;
+
+  if ( __atomic_load_n( cq_tail, __ATOMIC_ACQUIRE ) - head < min_complete )
+  {
+    int waited;
+    do
+      waited = io_uring_enter( ring_fd, 0, min_complete, IORING_ENTER_GETEVENTS );
+    while ( waited < 0 && errno == EINTR );
+
+    if ( waited < 0 )
+      return true;
+  }
+
+  auto const tail = __atomic_load_n( cq_tail, __ATOMIC_ACQUIRE );
+
+  for ( ; head != tail; ++head )
+  {
+    auto const &cqe = at<io_uring_cqe>( cqes, 0 )[head & *cq_mask];
+    completed.push_back( { cqe.user_data, cqe.res } );
+    --in_flight;
+  }
+
+  __atomic_store_n( cq_head, head, __ATOMIC_RELEASE );
+  return false;
+}
+
+#else
+
+IORing::IORing( std::uint32_t ) noexcept
+{}
+
+IORing::~IORing()
+{}
+
+bool IORing::read( int, void *, std::uint32_t, std::uint64_t, std::uint64_t ) noexcept
+{
+  return true;
+}
+
+bool IORing::write( int, void const *, std::uint32_t, std::uint64_t, std::uint64_t ) noexcept
+{
+  return true;
+}
+
+bool IORing::queue( std::uint8_t, int, void const *, std::uint32_t, std::uint64_t, std::uint64_t ) noexcept
+{
+  return true;
+}
+
+std::int64_t IORing::wait( std::uint64_t ) noexcept
+{
+  return -1;
+}
+
+bool IORing::reap( std::uint32_t ) noexcept
+{
+  return true;
+}
+
+#endif
+} // namespace mips32
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace mips32
+{
+/**
+ * Minimal io_uring, driven by its raw syscalls.
+ *
+ * Every request is submitted as soon as it's queued, so the kernel
+ * works on it while the caller goes on, and is identified by a `tag`.
+ * Its result is collected by `wait`, in any order.
+ *
+ * Only available on Linux 5.6+, where it's not forbidden by the system,
+ * `available()` returns false anywhere else.
+ * Older kernels that can create a ring, but don't know IORING_OP_READ/WRITE,
+ * complete every request with `-EINVAL`.
+ * Not thread-safe.
+ **/
+class IORing
+{
+public:
+  // No ring is created if `entries` is 0.
+  explicit IORing( std::uint32_t entries = 64 ) noexcept;
+
+  IORing( IORing const & ) = delete;
+  IORing &operator=( IORing const & ) = delete;
+
+  // Waits for every request in flight.
+  ~IORing();
+
+  bool available() const noexcept { return ring_fd != -1; }
+
+  // Queues the read of `size` bytes at `offset` of the file `fd` into `dst`,
+  // which must stay valid until the request is waited.
+  // Returns:
+  // `true`  - in case of *failure*, nothing has been queued
+  // `false` - in case of success
+  bool read( int fd, void *dst, std::uint32_t size, std::uint64_t offset, std::uint64_t tag ) noexcept;
+
+  // Same as `read`, but writes `src` into the file.
+  bool write( int fd, void const *src, std::uint32_t size, std::uint64_t offset, std::uint64_t tag ) noexcept;
+
+  // Waits for the request `tag`.
+  // Returns the number of bytes transferred, or a negative `errno`.
+  std::int64_t wait( std::uint64_t tag ) noexcept;
+
+private:
+  bool queue( std::uint8_t opcode, int fd, void const *data, std::uint32_t size, std::uint64_t offset, std::uint64_t tag ) noexcept;
+
+  // Moves the completions from the ring to `completed`, waiting for at least `min_complete`.
+  // Returns true if the wait has failed.
+  bool reap( std::uint32_t min_complete ) noexcept;
+
+  struct Completion
+  {
+    std::uint64_t tag;
+    std::int64_t  result;
+  };
+
+  int           ring_fd{ -1 };
+  std::uint32_t capacity{ 0 };  // of the submission queue, the completion queue is at least as big
+  std::uint32_t in_flight{ 0 }; // never more than `capacity`, the completions can't overflow
+
+  std::vector<Completion> completed; // reaped, but not yet waited
+
+  // Views of the shared rings
+  void         *sq_ring{ nullptr };
+  void         *cq_ring{ nullptr };
+  void         *sqes{ nullptr };
+  std::uint64_t sq_ring_size{ 0 };
+  std::uint64_t cq_ring_size{ 0 };
+  std::uint64_t sqes_size{ 0 };
+
+  std::uint32_t *sq_head{ nullptr };
+  std::uint32_t *sq_tail{ nullptr };
+  std::uint32_t *sq_mask{ nullptr };
+  std::uint32_t *sq_array{ nullptr };
+  std::uint32_t *cq_head{ nullptr };
+  std::uint32_t *cq_tail{ nullptr };
+  std::uint32_t *cq_mask{ nullptr };
+  void          *cqes{ nullptr };
+};
+} // namespace mips32
@@ -0,0 +1,346 @@
+#include "loader.hpp"
+#include "ram_io.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <new>
+
+namespace mips32
+{
+// Returns true if [address, address + size) exceeds the address space.
+constexpr bool overflows( std::uint32_t address, std::uint64_t size ) noexcept
+{
+  return size > 0x1'0000'0000 - std::uint64_t( address );
+}
+
+////
+//// FAMA
+////
+struct FamaHeader
+{
+  char          magic[4];
+  std::uint32_t version;
+  std::uint32_t data_sz;
+  std::uint32_t text_sz;
+  std::uint32_t kdata_sz;
+  std::uint32_t ktext_sz;
+  std::uint32_t data_addr;
+  std::uint32_t text_addr;
+  std::uint32_t kdata_addr;
+  std::uint32_t ktext_addr;
+};
+
+static_assert( sizeof( FamaHeader ) == 40, "The header must match `executable_format.md`." );
+
+constexpr std::uint32_t fama_version{ 0x1 };
+
+// A section of a "fama" executable, `offset` is relative to the header.
+struct FamaSection
+{
+  std::uint32_t address;
+  std::uint32_t size;
+  std::uint64_t offset;
+};
+
+// Returns the sections in the order they're stored.
+std::array<FamaSection, 4> fama_sections( FamaHeader const &header ) noexcept
+{
+  std::array<FamaSection, 4> sections{ {
+    { header.data_addr, header.data_sz, 0 },
+    { header.text_addr, header.text_sz, 0 },
+    { header.kdata_addr, header.kdata_sz, 0 },
+    { header.ktext_addr, header.ktext_sz, 0 },
+  } };
+
+  std::uint64_t offset = sizeof( FamaHeader );
+  for ( auto &section : sections )
+  {
+    section.offset = offset;
+    offset += section.size;
+  }
+
+  return sections;
+}
+
+////
+//// ELF32
+////
+struct ElfHeader
+{
+  std::uint8_t  e_ident[16];
+  std::uint16_t e_type;
+  std::uint16_t e_machine;
+  std::uint32_t e_version;
+  std::uint32_t e_entry;
+  std::uint32_t e_phoff;
+  std::uint32_t e_shoff;
+  std::uint32_t e_flags;
+  std::uint16_t e_ehsize;
+  std::uint16_t e_phentsize;
+  std::uint16_t e_phnum;
+  std::uint16_t e_shentsize;
+  std::uint16_t e_shnum;
+  std::uint16_t e_shstrndx;
+};
+
+struct ElfProgramHeader
+{
+  std::uint32_t p_type;
+  std::uint32_t p_offset;
+  std::uint32_t p_vaddr;
+  std::uint32_t p_paddr;
+  std::uint32_t p_filesz;
+  std::uint32_t p_memsz;
+  std::uint32_t p_flags;
+  std::uint32_t p_align;
+};
+
+static_assert( sizeof( ElfHeader ) == 52 && sizeof( ElfProgramHeader ) == 32, "ELF32 layout mismatch." );
+
+constexpr std::uint8_t  elf_class32{ 1 };
+constexpr std::uint8_t  elf_data_lsb{ 1 };
+constexpr std::uint16_t elf_exec{ 2 };
+constexpr std::uint16_t elf_mips{ 8 };
+constexpr std::uint32_t elf_load{ 1 };
+
+////
+//// LOADER
+////
+bool Loader::load( void const *data, std::uint32_t &entry ) noexcept
+{
+  if ( !data )
+    return true;
+
+  mapped = false;
+
+  // The size of the executable is unknown, its headers are trusted
+  auto const *executable = ( std::uint8_t const * )data;
+  auto const size = std::numeric_limits<std::uint64_t>::max();
+
+  if ( !std::memcmp( executable, "fama", 4 ) )
+    return load_fama( executable, size, entry );
+  else if ( !std::memcmp( executable, "\x7F" "ELF", 4 ) )
+    return load_elf( executable, size, entry );
+  else
+    return true;
+}
+
+bool Loader::load( std::unique_ptr<MappedFile> file, std::uint32_t &entry ) noexcept
+{
+  if ( !file || file->size() < 4 )
+    return true;
+
+  mapped = true;
+
+  auto const *executable = file->data();
+  auto const size = file->size();
+
+  bool error = true;
+
+  if ( !std::memcmp( executable, "fama", 4 ) )
+    error = load_fama( executable, size, entry );
+  else if ( !std::memcmp( executable, "\x7F" "ELF", 4 ) )
+    error = load_elf( executable, size, entry );
+
+  if ( !error )
+    ram.images.emplace_back( std::move( file ) );
+
+  return error;
+}
+
+bool Loader::load_fama( std::uint8_t const *data, std::uint64_t size, std::uint32_t &entry ) noexcept
+{
+  if ( size < sizeof( FamaHeader ) )
+    return true;
+
+  FamaHeader header;
+  std::memcpy( &header, data, sizeof( header ) );
+
+  if ( header.version != fama_version )
+    return true;
+
+  auto const sections = fama_sections( header );
+
+  for ( auto const &section : sections )
+  {
+    // The section must fit inside the file and the address space
+    if ( section.offset + section.size > size || overflows( section.address, section.size ) )
+      return true;
+  }
+
+  for ( auto const &section : sections )
+  {
+    place( section.address, data + section.offset, section.size );
+    occupy( section.address, section.size );
+  }
+
+  entry = header.text_sz ? header.text_addr : header.ktext_addr;
+  return false;
+}
+
+/**
+ * Only the program headers are read, the sections are ignored.
+ * Every `PT_LOAD` segment is placed at `p_vaddr`:
+ * - `p_filesz` bytes from the file
+ * - `p_memsz - p_filesz` zeros, the `.bss`
+ **/
+bool Loader::load_elf( std::uint8_t const *data, std::uint64_t size, std::uint32_t &entry ) noexcept
+{
+  if ( size < sizeof( ElfHeader ) )
+    return true;
+
+  ElfHeader header;
+  std::memcpy( &header, data, sizeof( header ) );
+
+  if ( header.e_ident[4] != elf_class32 || header.e_ident[5] != elf_data_lsb
+       || header.e_type != elf_exec || header.e_machine != elf_mips
+       || header.e_phentsize < sizeof( ElfProgramHeader )
+       || header.e_phoff + std::uint64_t( header.e_phnum ) * header.e_phentsize > size )
+    return true;
+
+  auto const segment = [&]( std::uint32_t i ) {
+    ElfProgramHeader program_header;
+    std::memcpy( &program_header, data + header.e_phoff + i * header.e_phentsize, sizeof( program_header ) );
+    return program_header;
+  };
+
+  for ( std::uint32_t i = 0; i < header.e_phnum; ++i )
+  {
+    auto const ph = segment( i );
+
+    if ( ph.p_type != elf_load )
+      continue;
+
+    if ( ph.p_filesz > ph.p_memsz
+         || std::uint64_t( ph.p_offset ) + ph.p_filesz > size
+         || overflows( ph.p_vaddr, ph.p_memsz ) )
+      return true;
+  }
+
+  for ( std::uint32_t i = 0; i < header.e_phnum; ++i )
+  {
+    auto const ph = segment( i );
+
+    if ( ph.p_type != elf_load )
+      continue;
+
+    place( ph.p_vaddr, data + ph.p_offset, ph.p_filesz );
+    zero( ph.p_vaddr + ph.p_filesz, ph.p_memsz - ph.p_filesz );
+    occupy( ph.p_vaddr, ph.p_memsz );
+  }
+
+  entry = header.e_entry;
+  return false;
+}
+
+void Loader::map( std::uint32_t address, std::unique_ptr<MappedFile> file, std::uint32_t size ) noexcept
+{
+  mapped = true;
+
+  auto const file_size = file->size() < size ? ( std::uint32_t )file->size() : size;
+
+  place( address, file->data(), file_size );
+  zero( address + file_size, size - file_size );
+
+  ram.images.emplace_back( std::move( file ) );
+}
+
+void Loader::place( std::uint32_t address, std::uint8_t const *src, std::uint32_t size ) noexcept
+{
+  if ( !mapped )
+  {
+    copy( address, src, size );
+    return;
+  }
+
+  // Large files are mostly placed into fresh ranges, no block needs to be checked
+  bool const fresh = !exists( address, size );
+
+  while ( size )
+  {
+    auto const base_address = RAM::calculate_base_address( address );
+    auto const chunk = std::min( size, RAM::block_size - ( address - base_address ) );
+
+    // The mapping is private, its memory can be written
+    if ( chunk == RAM::block_size && !( ( std::uintptr_t )src & 0b11 ) && ( fresh || !exists( base_address ) ) )
+      ram.swapped.push_back( { base_address, ( std::uint32_t * )src } );
+    else
+      copy( address, src, chunk );
+
+    address += chunk;
+    src += chunk;
+    size -= chunk;
+  }
+}
+
+/**
+ * The blocks partially covered are copied from a block of zeros,
+ * the ones entirely covered share an anonymous mapping.
+ **/
+void Loader::zero( std::uint32_t address, std::uint32_t size ) noexcept
+{
+  static std::uint8_t const zeros[RAM::block_size]{};
+
+  std::uint64_t const end = std::uint64_t( address ) + size;
+  std::uint64_t const first = ( std::uint64_t( address ) + RAM::block_size - 1 ) / RAM::block_size * RAM::block_size;
+  std::uint64_t const last = end / RAM::block_size * RAM::block_size;
+
+  std::unique_ptr<MappedFile> anonymous;
+
+  if ( last > first )
+    anonymous.reset( new ( std::nothrow ) MappedFile( last - first ) );
+
+  std::uint64_t const full_begin = anonymous && anonymous->data() ? first : end;
+  bool const          fresh = !exists( address, size );
+
+  while ( size )
+  {
+    auto const base_address = RAM::calculate_base_address( address );
+    auto const chunk = std::min( size, RAM::block_size - ( address - base_address ) );
+
+    if ( chunk == RAM::block_size && address >= full_begin && ( fresh || !exists( base_address ) ) )
+      ram.swapped.push_back( { base_address, ( std::uint32_t * )( anonymous->data() + ( address - first ) ) } );
+    else
+      copy( address, zeros, chunk );
+
+    address += chunk;
+    size -= chunk;
+  }
+
+  if ( full_begin != end )
+    ram.images.emplace_back( std::move( anonymous ) );
+}
+
+void Loader::copy( std::uint32_t address, std::uint8_t const *src, std::uint32_t size ) noexcept
+{
+  if ( size )
+    RAMIO( ram ).write( address, src, size );
+}
+
+bool Loader::exists( std::uint32_t base_address ) const noexcept
+{
+  return ram.exists( base_address );
+}
+
+bool Loader::exists( std::uint32_t address, std::uint32_t size ) const noexcept
+{
+  auto const first = RAM::calculate_base_address( address );
+  auto const last = std::uint64_t( address ) + size;
+  auto const inside = [first, last]( auto const &block ) { return block.base_address >= first && block.base_address < last; };
+
+  return std::any_of( ram.blocks.cbegin(), ram.blocks.cend(), inside )
+    || std::any_of( ram.swapped.cbegin(), ram.swapped.cend(), inside );
+}
+
+void Loader::occupy( std::uint32_t address, std::uint32_t size ) noexcept
+{
+  constexpr std::uint64_t useg_limit{ 0x8000'0000 };
+
+  auto const section_end = std::uint64_t( address ) + size;
+
+  if ( size && section_end <= useg_limit && section_end > end )
+    end = ( std::uint32_t )section_end;
+}
+} // namespace mips32
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "mapped_file.hpp"
+#include "ram.hpp"
+
+#include <cstdint>
+#include <memory>
+
+namespace mips32
+{
+/**
+ * Loads executables, and maps files, into the RAM.
+ *
+ * Supported formats:
+ * - "fama", see `executable_format.md`
+ * - ELF32, MIPS little-endian, only its `PT_LOAD` segments
+ *
+ * The sections are copied block by block, never word by word.
+ * If the executable lives inside a mapped file, every block
+ * entirely covered by a section is backed by the file itself,
+ * and paged in copy-on-write the first time it's accessed.
+ * The blocks entirely covered by zeros, like `.bss`, are backed
+ * by anonymous memory, zeroed by the OS when touched.
+ **/
+class Loader
+{
+public:
+  constexpr Loader( RAM &ram ) noexcept : ram( ram ) {}
+
+  // Loads an executable, its entry point is stored in `entry`.
+  // Returns:
+  // `true`  - in case of *failure*, nothing has been loaded
+  // `false` - in case of success
+  bool load( void const *data, std::uint32_t &entry ) noexcept;
+
+  // Same as above, but the sections are taken from the mapped `file`,
+  // which is kept alive by the RAM.
+  bool load( std::unique_ptr<MappedFile> file, std::uint32_t &entry ) noexcept;
+
+  // Places the mapped `file` at `address`, followed by zeros up to `size` bytes
+  // if the file is smaller. The file is kept alive by the RAM.
+  void map( std::uint32_t address, std::unique_ptr<MappedFile> file, std::uint32_t size ) noexcept;
+
+  // Returns the first address past the sections loaded in useg, 0 if there are none.
+  // The heap can begin there.
+  constexpr std::uint32_t useg_end() const noexcept { return end; }
+
+private:
+  // `size` is the size of the executable, if known.
+  // Both return `true` in case of failure.
+  bool load_fama( std::uint8_t const *data, std::uint64_t size, std::uint32_t &entry ) noexcept;
+  bool load_elf( std::uint8_t const *data, std::uint64_t size, std::uint32_t &entry ) noexcept;
+
+  // Places `size` bytes from `src` to the RAM at `address`.
+  // If the executable is mapped, the blocks entirely covered are backed by `src`,
+  // otherwise they're copied.
+  void place( std::uint32_t address, std::uint8_t const *src, std::uint32_t size ) noexcept;
+
+  // Fills `size` bytes of the RAM at `address` with zeros.
+  void zero( std::uint32_t address, std::uint32_t size ) noexcept;
+
+  // Copies `size` bytes from `src` to the RAM at `address`.
+  void copy( std::uint32_t address, std::uint8_t const *src, std::uint32_t size ) noexcept;
+
+  // Returns true if the block at `base_address` has already been allocated or swapped.
+  bool exists( std::uint32_t base_address ) const noexcept;
+
+  // Returns true if any block in [address, address + size) has already been allocated or swapped.
+  bool exists( std::uint32_t address, std::uint32_t size ) const noexcept;
+
+  // Extends `end` to include [address, address + size), if inside useg.
+  void occupy( std::uint32_t address, std::uint32_t size ) noexcept;
+
+  RAM &ram;
+  bool mapped{ false }; // the executable lives inside a private mapping owned by the RAM
+  std::uint32_t end{ 0 };
+};
+} // namespace mips32
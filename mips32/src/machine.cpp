@@ -1,8 +1,16 @@
 #include <mips32/machine.hpp>
 #include <mips32/literals.hpp>
 
-#include "ram.hpp"
 #include "cpu.hpp"
+#include "loader.hpp"
+#include "ram.hpp"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <new>
+#include <thread>
+#include <vector>
 
 namespace mips32
 {
@@ -15,7 +23,7 @@ class MachineImpl
   friend class MachineInspector;
 
 public:
-  MachineImpl( std::uint32_t ram_alloc_limit, IODevice* io_device, FileHandler* file_handler ) noexcept;
+  MachineImpl( std::uint32_t ram_alloc_limit, IODevice* io_device, FileHandler* file_handler, std::uint32_t cores ) noexcept;
 
   MachineImpl( MachineImpl const& ) = delete;
 
@@ -23,10 +31,14 @@ public:
 
   ~MachineImpl();
 
-  MachineInspector get_inspector() noexcept;
+  MachineInspector get_inspector( std::uint32_t core ) noexcept;
+
+  std::uint32_t cores() const noexcept;
 
   bool load( void const * data ) noexcept;
 
+  bool load_file( char const * path ) noexcept;
+
   std::uint32_t start() noexcept;
 
   void stop() noexcept;
@@ -35,24 +47,46 @@ public:
 
   void reset() noexcept;
 
+  void interrupt( std::uint32_t core ) noexcept;
+
+  bool capture( std::uint32_t pc ) noexcept;
+  bool rewind() noexcept;
+
+  bool attach_coverage( std::uint8_t *map, std::uint32_t size ) noexcept;
+
+  bool trace( char const *path ) noexcept;
+
   IODevice* swap_io_device( IODevice *device ) noexcept;
   FileHandler* swap_file_handler( FileHandler *handler ) noexcept;
 
 private:
+  // Every core starts from `entry`, with the heap after the executable.
+  void boot( std::uint32_t entry, std::uint32_t heap_begin ) noexcept;
+
   RAM ram;
-  CPU cpu;
+  std::vector<std::unique_ptr<CPU>> cpus;
+  std::vector<CPU *>                cores_list; // attached to every CPU, for the IPIs
+
+  std::unique_ptr<MachineInspector::CPUState> golden; // registers captured, the RAM is journaling
+  std::unique_ptr<TraceWriter>                tracer; // attached to the CPU
 };
 }
 
-Machine::Machine( std::uint32_t ram_alloc_limit, IODevice* io_device, FileHandler* file_handler ) noexcept
-  : _impl( new MachineImpl( ram_alloc_limit, io_device, file_handler ) )
+Machine::Machine( std::uint32_t ram_alloc_limit, IODevice* io_device, FileHandler* file_handler, std::uint32_t cores ) noexcept
+  : _impl( new MachineImpl( ram_alloc_limit, io_device, file_handler, cores ) )
 {}
 
 Machine::~Machine() { delete _impl; }
 
 bool Machine::load( void const * data ) noexcept { return _impl->load( data ); }
 
-MachineInspector Machine::get_inspector() noexcept { return _impl->get_inspector(); }
+bool Machine::load_file( char const * path ) noexcept { return _impl->load_file( path ); }
+
+MachineInspector Machine::get_inspector() noexcept { return _impl->get_inspector( 0 ); }
+
+MachineInspector Machine::get_inspector( std::uint32_t core ) noexcept { return _impl->get_inspector( core ); }
+
+std::uint32_t Machine::cores() const noexcept { return _impl->cores(); }
 
 std::uint32_t Machine::start() noexcept { return _impl->start(); }
 
@@ -62,15 +96,38 @@ std::uint32_t Machine::single_step() noexcept { return _impl->single_step(); }
 
 void Machine::reset() noexcept { _impl->reset(); }
 
+void Machine::interrupt( std::uint32_t core ) noexcept { _impl->interrupt( core ); }
+
+bool Machine::capture( std::uint32_t pc ) noexcept { return _impl->capture( pc ); }
+
+bool Machine::rewind() noexcept { return _impl->rewind(); }
+
+bool Machine::attach_coverage( std::uint8_t *map, std::uint32_t size ) noexcept { return _impl->attach_coverage( map, size ); }
+
+bool Machine::trace( char const *path ) noexcept { return _impl->trace( path ); }
+
 IODevice* Machine::swap_iodevice( IODevice *device ) noexcept { return _impl->swap_io_device( device ); }
 
 FileHandler* Machine::swap_file_handler( FileHandler *handler ) noexcept { return _impl->swap_file_handler( handler ); }
 
-v0::MachineImpl::MachineImpl( std::uint32_t ram_alloc_limit, IODevice* io_device, FileHandler* file_handler ) noexcept
-  : ram( ram_alloc_limit ), cpu( ram )
+v0::MachineImpl::MachineImpl( std::uint32_t ram_alloc_limit, IODevice* io_device, FileHandler* file_handler, std::uint32_t cores ) noexcept
+  : ram( ram_alloc_limit )
 {
-  cpu.attach_iodevice( io_device );
-  cpu.attach_file_handler( file_handler );
+  if ( cores > 1 )
+    ram.share();
+
+  for ( std::uint32_t core = 0; core < ( cores ? cores : 1 ); ++core )
+  {
+    cpus.emplace_back( new CPU( ram, core ) );
+    cores_list.push_back( cpus.back().get() );
+  }
+
+  for ( auto &cpu : cpus )
+  {
+    cpu->attach_iodevice( io_device );
+    cpu->attach_file_handler( file_handler );
+    cpu->attach_cores( cores_list.data(), ( std::uint32_t )cores_list.size() );
+  }
 }
 
 v0::MachineImpl::~MachineImpl()
@@ -78,20 +135,204 @@ v0::MachineImpl::~MachineImpl()
   stop();
 }
 
-MachineInspector v0::MachineImpl::get_inspector() noexcept { return MachineInspector().inspect( ram ).inspect( cpu ); }
+MachineInspector v0::MachineImpl::get_inspector( std::uint32_t core ) noexcept { return MachineInspector().inspect( ram ).inspect( *cpus[core] ); }
+
+std::uint32_t v0::MachineImpl::cores() const noexcept { return ( std::uint32_t )cpus.size(); }
+
+/**
+ * A single core runs on the calling thread.
+ *
+ * Otherwise the exit codes are reset before any thread is started,
+ * so the first core to return can stop also the ones not running yet.
+ * The first core runs on the calling thread, the others on their own.
+ **/
+std::uint32_t v0::MachineImpl::start() noexcept
+{
+  if ( cpus.size() == 1 )
+    return cpus[0]->start();
+
+  for ( auto &cpu : cpus )
+    MachineInspector().inspect( *cpu, false ).CPU_write_exit_code( CPU::NONE );
+
+  std::atomic<std::uint32_t> result{ CPU::NONE };
+
+  auto const run = [this, &result]( CPU &cpu ) {
+    auto expected = std::uint32_t( CPU::NONE );
+
+    if ( result.compare_exchange_strong( expected, cpu.run() ) )
+      stop();
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve( cpus.size() - 1 );
+
+  for ( std::size_t core = 1; core < cpus.size(); ++core )
+    threads.emplace_back( run, std::ref( *cpus[core] ) );
+
+  run( *cpus[0] );
+
+  for ( auto &thread : threads )
+    thread.join();
+
+  return result.load();
+}
+
+void v0::MachineImpl::stop() noexcept
+{
+  for ( auto &cpu : cpus )
+    cpu->stop();
+}
+
+std::uint32_t v0::MachineImpl::single_step() noexcept
+{
+  std::uint32_t result = CPU::NONE;
+
+  for ( auto &cpu : cpus )
+  {
+    auto const exit_code = cpu->single_step();
+
+    if ( result == CPU::NONE )
+      result = exit_code;
+  }
+
+  return result;
+}
+
+void v0::MachineImpl::reset() noexcept
+{
+  for ( auto &cpu : cpus )
+    cpu->hard_reset();
+}
+
+void v0::MachineImpl::interrupt( std::uint32_t core ) noexcept { cpus[core]->interrupt(); }
+
+bool v0::MachineImpl::capture( std::uint32_t pc ) noexcept
+{
+  golden.reset();
+  ram.end_journal();
+
+  if ( cpus.size() != 1 || cpus[0]->run_to( pc ) != CPU::NONE )
+    return true;
+
+  golden.reset( new ( std::nothrow ) MachineInspector::CPUState( get_inspector( 0 ).CPU_state() ) );
+  if ( !golden )
+    return true;
+
+  ram.begin_journal();
+  return false;
+}
+
+/**
+ * The journal is gone if the RAM has been restored since the capture.
+ **/
+bool v0::MachineImpl::rewind() noexcept
+{
+  if ( !golden || !ram.journaling() )
+    return true;
+
+  ram.rewind();
+  get_inspector( 0 ).CPU_restore( *golden );
+  return false;
+}
+
+bool v0::MachineImpl::attach_coverage( std::uint8_t *map, std::uint32_t size ) noexcept
+{
+  if ( cpus.size() != 1 || ( map && ( !size || size & ( size - 1 ) ) ) )
+    return true;
+
+  cpus[0]->attach_coverage( map, map ? size : 0 );
+  return false;
+}
 
-std::uint32_t v0::MachineImpl::start() noexcept { return cpu.start(); }
+bool v0::MachineImpl::trace( char const *path ) noexcept
+{
+  bool failed = false;
 
-void v0::MachineImpl::stop() noexcept { cpu.stop(); }
+  if ( tracer )
+  {
+    cpus[0]->attach_tracer( nullptr );
+    failed = tracer->close();
+    tracer.reset();
+  }
 
-std::uint32_t v0::MachineImpl::single_step() noexcept { return cpu.single_step(); }
+  if ( !path )
+    return failed;
 
-void v0::MachineImpl::reset() noexcept { cpu.hard_reset(); }
+  if ( cpus.size() != 1 )
+    return true;
 
-IODevice* v0::MachineImpl::swap_io_device( IODevice *device ) noexcept { return cpu.attach_iodevice( device ); }
+  auto const state = get_inspector( 0 ).CPU_state();
+
+  tracer.reset( new ( std::nothrow ) TraceWriter );
+  if ( !tracer || tracer->open( path, state.pc, state.gpr, state.fpr ) )
+  {
+    tracer.reset();
+    return true;
+  }
+
+  cpus[0]->attach_tracer( tracer.get() );
+  return failed;
+}
+
+IODevice* v0::MachineImpl::swap_io_device( IODevice *device ) noexcept
+{
+  IODevice *old = nullptr;
 
-FileHandler* v0::MachineImpl::swap_file_handler( FileHandler *handler ) noexcept { return cpu.attach_file_handler( handler ); }
+  for ( auto &cpu : cpus )
+    old = cpu->attach_iodevice( device );
 
-bool v0::MachineImpl::load( void const * data ) noexcept { return false; }
+  return old;
+}
+
+FileHandler* v0::MachineImpl::swap_file_handler( FileHandler *handler ) noexcept
+{
+  FileHandler *old = nullptr;
+
+  for ( auto &cpu : cpus )
+    old = cpu->attach_file_handler( handler );
+
+  return old;
+}
+
+bool v0::MachineImpl::load( void const * data ) noexcept
+{
+  // A new program, the golden state belongs to the old one
+  golden.reset();
+  ram.end_journal();
+
+  std::uint32_t entry;
+
+  Loader loader( ram );
+  if ( loader.load( data, entry ) )
+    return true;
+
+  boot( entry, loader.useg_end() );
+  return false;
+}
+
+bool v0::MachineImpl::load_file( char const * path ) noexcept
+{
+  // A new program, the golden state belongs to the old one
+  golden.reset();
+  ram.end_journal();
+
+  std::uint32_t entry;
+
+  Loader loader( ram );
+  if ( loader.load( std::unique_ptr<MappedFile>( new ( std::nothrow ) MappedFile( path ) ), entry ) )
+    return true;
+
+  boot( entry, loader.useg_end() );
+  return false;
+}
+
+void v0::MachineImpl::boot( std::uint32_t entry, std::uint32_t heap_begin ) noexcept
+{
+  for ( std::uint32_t core = 0; core < cpus.size(); ++core )
+  {
+    get_inspector( core ).CPU_pc() = entry;
+    cpus[core]->reset_heap( heap_begin );
+  }
+}
 
 }
\ No newline at end of file
@@ -1,14 +1,19 @@
 #include <mips32/cp0.hpp>
 #include "cp1.hpp"
 #include "cpu.hpp"
+#include "mapped_file.hpp"
 #include "ram.hpp"
 #include "ram_io.hpp"
+#include "snapshot_writer.hpp"
 
 #include <mips32/machine_inspector.hpp>
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstring>
 #include <cstdio>
+#include <new>
 #include <string>
 
 namespace mips32
@@ -171,6 +176,28 @@ noexcept
   return addresses;
 }
 
+std::vector<std::uint32_t> MachineInspector::RAM_corrupted_addresses() const noexcept
+{
+  return ram->corrupted;
+}
+
+bool MachineInspector::RAM_verify() noexcept
+{
+  for ( auto &block : ram->swapped )
+  {
+    if ( block.image )
+      ram->verify( block );
+  }
+
+  return !ram->corrupted.empty();
+}
+
+MachineInspector::RAMFaults MachineInspector::RAM_faults() const noexcept
+{
+  auto const &faults = ram->faults();
+  return { faults.allocations, faults.swap_ins, faults.swap_outs };
+}
+
 std::vector<char> MachineInspector::RAM_read( std::uint32_t address, std::uint32_t count, bool read_string ) noexcept
 {
   return RAMIO( *ram ).read( address, count, read_string );
@@ -205,6 +232,16 @@ std::uint32_t MachineInspector::CP1_fcsr() const noexcept
 {
   return cp1->fcsr;
 }
+
+bool MachineInspector::CP1_soft_float() const noexcept
+{
+  return cp1->soft_float();
+}
+
+void MachineInspector::CP1_soft_float( bool enabled ) noexcept
+{
+  cp1->set_soft_float( enabled );
+}
 /* * * *
  *     *
  * CPU *
@@ -236,6 +273,108 @@ void MachineInspector::CPU_write_exit_code( std::uint32_t value ) noexcept
   cpu->exit_code.store( value, std::memory_order_release );
 }
 
+std::uint64_t MachineInspector::CPU_retired() const noexcept
+{
+  return cpu->retired;
+}
+
+std::uint64_t &MachineInspector::CPU_retire_limit() noexcept
+{
+  return cpu->retire_limit;
+}
+
+MachineInspector::HeapInfo MachineInspector::CPU_heap_info() const noexcept
+{
+  return { cpu->heap_begin, cpu->program_break, cpu->heap_high_water };
+}
+
+void MachineInspector::CPU_flight_recorder( std::uint32_t instructions, std::uint32_t accesses ) noexcept
+{
+  cpu->flight_instructions.resize( instructions );
+  cpu->flight_accesses.resize( accesses );
+}
+
+MachineInspector::FlightRecord MachineInspector::CPU_flight_record() const noexcept
+{
+  FlightRecord record;
+
+  auto const instructions = cpu->flight_instructions.read();
+  record.instructions.reserve( instructions.size() / 2 );
+  for ( std::size_t i = 0; i < instructions.size(); i += 2 )
+    record.instructions.push_back( { instructions[i], instructions[i + 1] } );
+
+  auto const accesses = cpu->flight_accesses.read();
+  record.accesses.reserve( accesses.size() / 2 );
+  for ( std::size_t i = 0; i < accesses.size(); i += 2 )
+    record.accesses.push_back( { accesses[i] & ~1u, accesses[i + 1], ( accesses[i] & 1 ) != 0 } );
+
+  return record;
+}
+
+MachineInspector::CPUState MachineInspector::CPU_state() const noexcept
+{
+  return { cpu->pc, cpu->gpr, cpu->cp0, cpu->cp1.fpr, cpu->cp1.fcsr, CPU_heap_info() };
+}
+
+void MachineInspector::CPU_restore( CPUState const &state ) noexcept
+{
+  cpu->pc = state.pc;
+  cpu->gpr = state.gpr;
+  cpu->cp0 = state.cp0;
+  cpu->cp1.fpr = state.fpr;
+  cpu->cp1.fcsr = state.fcsr;
+  cpu->cp1.set_round_mode();
+  cpu->cp1.set_denormal_flush();
+  cpu->heap_begin = state.heap.begin;
+  cpu->program_break = state.heap.program_break;
+  cpu->heap_high_water = state.heap.high_water;
+  cpu->ll_bit = false;
+}
+
+/**
+ * The request is pending until the CPU, or the caller, has copied the sample.
+ * A request not answered in time is withdrawn, the CPU then ignores it,
+ * since `destination` is written only while holding the lock.
+ **/
+bool MachineInspector::CPU_sample( CPUSample &sample, std::uint32_t address, std::uint32_t count, std::uint32_t timeout_ms ) noexcept
+{
+  auto &sampler = cpu->sampler;
+
+  auto const deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds( timeout_ms );
+  auto const idle = [&sampler] { return sampler.served == sampler.requested; };
+
+  std::unique_lock<std::mutex> lock( sampler.mutex );
+
+  // Another sample is pending
+  if ( !sampler.answered.wait_until( lock, deadline, idle ) )
+    return true;
+
+  if ( !sampler.running )
+  {
+    cpu->take_sample( sample, address, count );
+    return false;
+  }
+
+  sampler.destination = &sample;
+  sampler.address = address;
+  sampler.count = count;
+
+  auto const epoch = ++sampler.requested;
+  auto const answered = [&sampler, epoch] { return sampler.served >= epoch; };
+
+  cpu->attention.fetch_or( CPU::attention_sample, std::memory_order_release );
+
+  if ( sampler.answered.wait_until( lock, deadline, answered ) )
+    return false;
+
+  // Withdrawn
+  sampler.requested = sampler.served;
+  cpu->attention.fetch_and( ~CPU::attention_sample, std::memory_order_release );
+  sampler.answered.notify_all();
+
+  return true;
+}
+
 CP0 & MachineInspector::access_CP0() noexcept
 {
   return *cp0;
@@ -249,6 +388,8 @@ CP0 & MachineInspector::access_CP0() noexcept
 
 constexpr std::uint32_t magic_tag{ 0x66'61'6D'61 };
 constexpr std::uint32_t version_tag{ 0x1 };
+constexpr std::uint32_t ram_version_tag{ 0x3 };
+constexpr std::uint32_t cpu_version_tag{ 0x2 };
 
 struct StateHeader
 {
@@ -256,27 +397,27 @@ struct StateHeader
   std::uint32_t version{};
 };
 
-bool is_valid( StateHeader header ) noexcept
+bool is_valid( StateHeader header, std::uint32_t version = version_tag ) noexcept
 {
   return header.magic == magic_tag // "fama"
-    && header.version == version_tag;
+    && header.version == version;
 }
 
-bool read_tag( std::FILE* file ) noexcept
+bool read_tag( std::FILE* file, std::uint32_t version = version_tag ) noexcept
 {
   StateHeader header;
 
   [[maybe_unused]] auto _read = std::fread( &header, sizeof( StateHeader ), 1, file );
   assert( _read == 1 && "Couldn't read state header" );
 
-  return !is_valid( header );
+  return !is_valid( header, version );
 }
 
-bool write_tag( std::FILE* file ) noexcept
+bool write_tag( std::FILE* file, std::uint32_t version = version_tag ) noexcept
 {
   StateHeader header;
   header.magic = magic_tag;
-  header.version = version_tag;
+  header.version = version;
 
   [[maybe_unused]] auto _write = std::fwrite( &header, sizeof( StateHeader ), 1, file );
   assert( _write == 1 && "Couldn't write state header" );
@@ -289,76 +430,142 @@ bool write_tag( std::FILE* file ) noexcept
 ////
 /**
  * uint32_t -> alloc_limit -|
- * uint32_t -> blocks_no    |- data
+ * uint32_t -> blocks_no    |- RAMStateHeader
  * uint32_t -> swap_no     -|
- * (uint32_t, uint32_t, uint32_t * RAM::block_size) * blocks_no * swap_no -> base_address, access_count, data
+ * RAMStateEntry * (blocks_no + swap_no) -> base_address, access_count, offset, size, crc, encoding
+ * data of every block
+ *
+ * The allocated blocks come first, then the swapped ones.
+ * Every block is stored as described by `SnapshotWriter`:
+ * - RAW blocks start at an offset multiple of `RAM::block_size`,
+ *   which is also a multiple of the page size, so the file can be mapped
+ *   and each block used in place, see `restore_state_ram`
+ * - RLE blocks are packed, and decoded when restored
+ *
+ * The blocks are encoded in parallel and written after the index,
+ * which is written last, when their offsets are known.
+ *
+ * The state is written to a temporary file that replaces the old one
+ * only when completed, because the old one could be mapped by a RAM.
  **/
+struct RAMStateHeader
+{
+  std::uint32_t alloc_limit;
+  std::uint32_t blocks_no;
+  std::uint32_t swap_no;
+};
+
+struct RAMStateEntry
+{
+  std::uint32_t base_address;
+  std::uint32_t access_count;
+  std::uint64_t offset;
+  std::uint32_t size;
+  std::uint32_t crc;
+  BlockEncoding encoding;
+  std::uint32_t reserved;
+};
+
+constexpr std::uint64_t ram_index_offset{ sizeof( StateHeader ) + sizeof( RAMStateHeader ) };
+
 bool MachineInspector::save_state_ram( char const * name ) const noexcept
 {
   std::string ram_file_name{ name };
   ram_file_name += ".ram";
 
-  auto * file = std::fopen( ram_file_name.c_str(), "wb" );
+  std::string tmp_file_name{ ram_file_name };
+  tmp_file_name += ".tmp";
+
+  auto * file = std::fopen( tmp_file_name.c_str(), "wb" );
   if ( !file )
     return true;
 
-  if ( write_tag( file ) )
+  if ( write_tag( file, ram_version_tag ) )
   {
     std::fclose( file );
     return true;
   }
 
-  // Data
-  std::uint32_t _alloc_limit = ram->alloc_limit;
-  std::uint32_t _blocks_no = ram->blocks.size();
-  std::uint32_t _swap_no = ram->swapped.size();
+  // Header
+  RAMStateHeader header;
+  header.blocks_no = ( std::uint32_t )ram->blocks.size();
+  header.alloc_limit = std::max( ram->alloc_limit, header.blocks_no ); // a shared RAM can exceed it
+  header.swap_no = ( std::uint32_t )ram->swapped.size();
 
-  [[maybe_unused]] auto _alloc_limit_write = std::fwrite( &_alloc_limit, sizeof( _alloc_limit ), 1, file );
-  [[maybe_unused]] auto _blocks_no_write = std::fwrite( &_blocks_no, sizeof( _blocks_no ), 1, file );
-  [[maybe_unused]] auto _swap_no_write = std::fwrite( &_swap_no, sizeof( _swap_no ), 1, file );
+  [[maybe_unused]] auto _header_write = std::fwrite( &header, sizeof( header ), 1, file );
+  assert( _header_write == 1 && "Couldn't write the RAM header to file" );
 
-  assert( _alloc_limit_write == 1 && "Couldn't write alloc limit to file" );
-  assert( _blocks_no_write == 1 && "Couldn't write the number of blocks to file" );
-  assert( _swap_no_write == 1 && "Couldn't write the number of swapped blocks to file" );
+  // Index, reserved until the blocks are written. An empty RAM has no index, its data is nullptr
+  std::vector<RAMStateEntry> index( std::size_t( header.blocks_no ) + header.swap_no, RAMStateEntry{} );
 
-  // Allocated blocks
-  for ( auto const & block : ram->blocks )
+  if ( !index.empty() )
   {
-    std::uint32_t _base_address = block.base_address;
-    std::uint32_t _access_count = block.access_count;
+    [[maybe_unused]] auto _index_reserve = std::fwrite( index.data(), sizeof( RAMStateEntry ), index.size(), file );
+    assert( _index_reserve == index.size() && "Couldn't reserve the index inside the file" );
+  }
 
-    [[maybe_unused]] auto _base_address_write = std::fwrite( &_base_address, sizeof( _base_address ), 1, file );
-    [[maybe_unused]] auto _access_count_write = std::fwrite( &_access_count, sizeof( _access_count ), 1, file );
-    [[maybe_unused]] auto _data_write = std::fwrite( block.data.get(), 1, RAM::block_size, file );
+  // Blocks
+  auto const source = [this, blocks_no = header.blocks_no]( std::uint32_t i, std::uint32_t * scratch ) -> std::uint32_t const * {
+    if ( i < blocks_no )
+      return ram->blocks[i].data.get();
 
-    assert( _base_address_write == 1 && "[Allocated Block] Couldn't write base address to file" );
-    assert( _access_count_write == 1 && "[Allocated Block] Couldn't write access count to file" );
-    assert( _data_write == RAM::block_size && "[Allocated Block] Couldn't write data to file" );
-  }
+    auto & swapped_block = ram->swapped[i - blocks_no];
+
+    if ( swapped_block.image )
+    {
+      ram->verify( swapped_block );
+      return swapped_block.image;
+    }
+
+    RAM::Block block;
+    block.base_address = swapped_block.base_address;
+    block.adopt( scratch ).deserialize( ram->swap_prefix );
 
-  RAM::Block swapped_block;
-  swapped_block.allocate();
+    return scratch;
+  };
 
-  // Swapped blocks
-  for ( auto const & block : ram->swapped )
+  auto const blocks = SnapshotWriter{}.write( file, ram_index_offset + index.size() * sizeof( RAMStateEntry ), ( std::uint32_t )index.size(), source );
+
+  bool error = blocks.size() != index.size();
+
+  if ( !error && !index.empty() )
   {
-    swapped_block.base_address = block.base_address;
-    swapped_block.deserialize();
-    
-    [[maybe_unused]] auto _base_address_write = std::fwrite( &swapped_block.base_address, sizeof( swapped_block.base_address ), 1, file );
-    [[maybe_unused]] auto _access_count_write = std::fwrite( &swapped_block.access_count, sizeof( swapped_block.access_count ), 1, file );
-    [[maybe_unused]] auto _data_write = std::fwrite( swapped_block.data.get(), 1, RAM::block_size, file );
-
-    assert( _base_address_write == 1 && "[Swapped Block] Couldn't write base address to file" );
-    assert( _access_count_write == 1 && "[Swapped Block] Couldn't write access count to file" );
-    assert( _data_write == RAM::block_size && "[Swapped Block] Couldn't write data to file" );
+    for ( std::size_t i = 0; i < index.size(); ++i )
+    {
+      auto & entry = index[i];
+
+      if ( i < header.blocks_no )
+      {
+        entry.base_address = ram->blocks[i].base_address;
+        entry.access_count = ram->blocks[i].access_count;
+      }
+      else
+      {
+        entry.base_address = ram->swapped[i - header.blocks_no].base_address;
+        entry.access_count = 0;
+      }
+
+      entry.offset = blocks[i].offset;
+      entry.size = blocks[i].size;
+      entry.crc = blocks[i].crc;
+      entry.encoding = blocks[i].encoding;
+    }
+
+    error = std::fseek( file, ( long )ram_index_offset, SEEK_SET ) != 0
+      || std::fwrite( index.data(), sizeof( RAMStateEntry ), index.size(), file ) != index.size();
   }
 
-  //std::fflush( file );
-  bool error = std::ferror( file );
+  error |= std::ferror( file ) != 0;
+  error |= std::fclose( file ) != 0;
 
-  std::fclose( file );
-  return error;
+  if ( error )
+  {
+    std::remove( tmp_file_name.c_str() );
+    return true;
+  }
+
+  std::remove( ram_file_name.c_str() );
+  return std::rename( tmp_file_name.c_str(), ram_file_name.c_str() ) != 0;
 }
 
 ////
@@ -452,6 +659,7 @@ bool MachineInspector::save_state_cp1( char const * name ) const noexcept
  *
  * uint32_t, pc
  * uint32_t * 32, gprs
+ * uint32_t * 3, heap begin, program break and high-water mark
  * exit_code is always restored as `NONE`
  **/
 bool MachineInspector::save_state_cpu( char const * name ) const noexcept
@@ -469,7 +677,7 @@ bool MachineInspector::save_state_cpu( char const * name ) const noexcept
   if ( !file )
     return true;
 
-  if ( write_tag( file ) )
+  if ( write_tag( file, cpu_version_tag ) )
   {
     std::fclose( file );
     return true;
@@ -490,6 +698,11 @@ bool MachineInspector::save_state_cpu( char const * name ) const noexcept
   assert( pc_write_count == 1 && "Couldn't write PC to file!" );
   assert( gpr_write_count == cpu->gpr.size() && "Couldn't write GPRs to file!" );
 
+  std::uint32_t const heap[3] = { cpu->heap_begin, cpu->program_break, cpu->heap_high_water };
+  [[maybe_unused]] auto heap_write_count = std::fwrite( heap, sizeof( heap[0] ), 3, file );
+
+  assert( heap_write_count == 3 && "Couldn't write the heap to file!" );
+
   //std::fflush( file );
   bool error = std::ferror( file );
 
@@ -501,96 +714,148 @@ bool MachineInspector::save_state_cpu( char const * name ) const noexcept
 //// RAM
 ////
 /**
- * uint32_t -> alloc_limit -|
- * uint32_t -> blocks_no    |- data
- * uint32_t -> swap_no     -|
- * (uint32_t, uint32_t, uint32_t * RAM::block_size) * blocks_no -> base_address, access_count, data
- * uint32_t * swap_no -> base_address
+ * See `save_state_ram` for the file format.
  *
- * 1. Load the data from disk
- * 2. Load allocated blocks from disk
- * 3. Resize and overwrite swapped blocks data
+ * The file is mapped in memory and no RAW block is copied:
+ * 1. Validate the header, the index and the checksum of every block but the RAW swapped ones
+ * 2. The allocated blocks use their RAW data in place, or decode it
+ * 3. The swapped blocks use their RAW data as image, or decode it to disk
+ * 4. The RAM keeps the file mapped as long as it needs it
+ *
+ * The RAW swapped blocks are checked when first used, see `RAM::verify`:
+ * only the blocks allocated, at most the allocation limit, are read on restore.
+ * The corrupted ones are reported by `RAM_corrupted_addresses`, or at once by `RAM_verify`.
+ *
+ * The mapping is private, so the guest can write to its blocks
+ * without modifying the file.
+ * Nothing is modified if the file is corrupted, otherwise the journal of the RAM ends.
  **/
 bool MachineInspector::restore_state_ram( char const * name ) noexcept
 {
   std::string ram_file_name{ name };
   ram_file_name += ".ram";
 
-  auto * file = std::fopen( ram_file_name.c_str(), "rb" );
-  if ( !file )
+  std::unique_ptr<MappedFile> snapshot( new ( std::nothrow ) MappedFile( ram_file_name.c_str() ) );
+  if ( !snapshot || !snapshot->data() )
     return true;
 
-  if ( read_tag( file ) )
-  {
-    std::fclose( file );
-    return true;
-  }
+  auto * const data = snapshot->data();
+  auto const size = snapshot->size();
 
   // 1
-  std::uint32_t _alloc_limit = 0;
-  std::uint32_t _blocks_no = 0;
-  std::uint32_t _swap_no = 0;
+  if ( size < ram_index_offset )
+    return true;
 
-  [[maybe_unused]] auto alloc_read_count = std::fread( &_alloc_limit, sizeof( _alloc_limit ), 1, file );
-  [[maybe_unused]] auto blocks_read_count = std::fread( &_blocks_no, sizeof( _blocks_no ), 1, file );
-  [[maybe_unused]] auto swap_read_count = std::fread( &_swap_no, sizeof( _swap_no ), 1, file );
+  StateHeader tag;
+  RAMStateHeader header;
 
-  assert( alloc_read_count == 1 && "Couldn't read alloc_limit from file!" );
-  assert( blocks_read_count == 1 && "Couldn't read the number of allocated blocks from file!" );
-  assert( swap_read_count == 1 && "Couldn't read the number of swapped blocks from file!" );
+  std::memcpy( &tag, data, sizeof( tag ) );
+  std::memcpy( &header, data + sizeof( tag ), sizeof( header ) );
 
-  ram->alloc_limit = _alloc_limit;
+  if ( !is_valid( tag, ram_version_tag ) || header.blocks_no > header.alloc_limit )
+    return true;
 
-  // 2
-  ram->blocks.resize( _blocks_no );
+  std::vector<RAMStateEntry> index( std::size_t( header.blocks_no ) + header.swap_no );
+
+  auto const data_offset = ram_index_offset + index.size() * sizeof( RAMStateEntry );
+
+  if ( size < data_offset )
+    return true;
+
+  if ( !index.empty() )
+    std::memcpy( index.data(), data + ram_index_offset, index.size() * sizeof( RAMStateEntry ) );
 
-  for ( auto & block : ram->blocks )
+  for ( std::size_t i = 0; i < index.size(); ++i )
   {
-    [[maybe_unused]] auto addr_read_count = std::fread( &block.base_address, sizeof( block.base_address ), 1, file );
-    [[maybe_unused]] auto access_read_count = std::fread( &block.access_count, sizeof( block.access_count ), 1, file );
+    auto const & entry = index[i];
 
-    assert( addr_read_count == 1 && "[Allocated block] Couldn't read the base_address from file!" );
-    assert( access_read_count == 1 && "[Allocated block] Couldn't read the access_count from file!" );
+    if ( entry.offset < data_offset || entry.offset > size || size - entry.offset < entry.size )
+      return true;
 
-    if ( !block.data )
-      block.allocate();
+    auto const * const words = ( std::uint32_t const * )( data + entry.offset );
 
-    if ( !block.data )
+    if ( entry.encoding == BlockEncoding::RAW )
+    {
+      if ( entry.offset % RAM::block_size || entry.size != RAM::block_size )
+        return true;
+    }
+    else if ( entry.encoding == BlockEncoding::RLE )
+    {
+      if ( entry.offset % 4 || entry.size % 4 || rle_decode( words, entry.size / 4, nullptr ) )
+        return true;
+    }
+    else
     {
-      std::fclose( file );
       return true;
     }
 
-    [[maybe_unused]] auto data_read_count = std::fread( block.data.get(), 1, RAM::block_size, file );
+    auto const lazy = entry.encoding == BlockEncoding::RAW && i >= header.blocks_no;
 
-    assert( data_read_count == RAM::block_size && "[Allocated block] Couldn't read the block's data from file!" );
+    if ( !lazy && crc32( words, entry.size ) != entry.crc )
+      return true;
   }
 
-  // 3
-  RAM::Block swapped_block;
-  swapped_block.allocate();
+  ram->alloc_limit = header.alloc_limit;
+  ram->end_journal(); // its records don't belong to the snapshot
+  ram->corrupted.clear();
+
+  // 2
+  ram->blocks.resize( header.blocks_no );
+
+  for ( std::uint32_t i = 0; i < header.blocks_no; ++i )
+  {
+    auto const & entry = index[i];
+    auto * const words = ( std::uint32_t * )( data + entry.offset );
+
+    auto & block = ram->blocks[i];
+
+    block.base_address = entry.base_address;
+    block.access_count = entry.access_count;
+
+    if ( entry.encoding == BlockEncoding::RAW )
+    {
+      block.adopt( words );
+    }
+    else
+    {
+      block.deallocate().allocate();
+      rle_decode( words, entry.size / 4, block.data.get() );
+    }
+  }
 
-  assert( swapped_block.data && "Coulnd't allocate swapped block" );
+  // 3
+  ram->swapped.resize( header.swap_no );
 
-  ram->swapped.resize( _swap_no );
+  RAM::Block decoded_block;
 
-  for ( std::uint32_t i = 0; i < _swap_no; ++i )
+  for ( std::uint32_t i = 0; i < header.swap_no; ++i )
   {
-    [[maybe_unused]] auto addr_read_count = std::fread( &swapped_block.base_address, sizeof( swapped_block.base_address ), 1, file );
-    [[maybe_unused]] auto access_read_count = std::fread( &swapped_block.access_count, sizeof( swapped_block.access_count ), 1, file );
-    [[maybe_unused]] auto data_read_count = std::fread( swapped_block.data.get(), 1, RAM::block_size, file );
+    auto const & entry = index[header.blocks_no + i];
+    auto * const words = ( std::uint32_t * )( data + entry.offset );
+
+    if ( entry.encoding == BlockEncoding::RAW )
+    {
+      ram->swapped[i] = { entry.base_address, words, entry.crc, true };
+    }
+    else
+    {
+      if ( !decoded_block.data )
+        decoded_block.allocate();
+
+      rle_decode( words, entry.size / 4, decoded_block.data.get() );
 
-    assert( addr_read_count == 1 && "[Swapped block] Couldn't read base address" );
-    assert( access_read_count == 1 && "[Swapped block] Couldn't read access count" );
-    assert( data_read_count == RAM::block_size && "[Swapped block] Couldn't read data" );
+      decoded_block.base_address = entry.base_address;
+      decoded_block.serialize( ram->swap_prefix );
 
-    swapped_block.deserialize();
-    ram->swapped[i].base_address = swapped_block.base_address;
+      ram->swapped[i] = { entry.base_address, nullptr };
+    }
   }
 
-  bool error = std::ferror( file );
-  std::fclose( file );
-  return error;
+  // 4, the previous files aren't referenced anymore
+  ram->images.clear();
+  ram->images.emplace_back( std::move( snapshot ) );
+
+  return false;
 }
 
 //// 
@@ -683,6 +948,7 @@ bool MachineInspector::restore_state_cp1( char const * name ) noexcept
  *
  * uint32_t, pc
  * uint32_t * 32, gprs
+ * uint32_t * 3, heap begin, program break and high-water mark
  * exit_code is always NONE
  **/
 bool MachineInspector::restore_state_cpu( char const * name ) noexcept
@@ -700,7 +966,7 @@ bool MachineInspector::restore_state_cpu( char const * name ) noexcept
   if ( !file )
     return true;
 
-  if ( read_tag( file ) )
+  if ( read_tag( file, cpu_version_tag ) )
   {
     std::fclose( file );
     return true;
@@ -725,6 +991,15 @@ bool MachineInspector::restore_state_cpu( char const * name ) noexcept
   assert( pc_read_count == 1 && "Couldn't read PC from file!" );
   assert( gpr_read_count == cpu->gpr.size() && "Couldn't read GPRs from file!" );
 
+  std::uint32_t heap[3];
+  [[maybe_unused]] auto heap_read_count = std::fread( heap, sizeof( heap[0] ), 3, file );
+
+  assert( heap_read_count == 3 && "Couldn't read the heap from file!" );
+
+  cpu->heap_begin = heap[0];
+  cpu->program_break = heap[1];
+  cpu->heap_high_water = heap[2];
+
   bool error = std::ferror( file );
 
   std::fclose( file );
@@ -0,0 +1,186 @@
+#include "mapped_file.hpp"
+
+#ifdef _WIN32
+#  define WIN32_LEAN_AND_MEAN
+#  define NOMINMAX
+#  include <Windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace mips32
+{
+#ifdef _WIN32
+
+MappedFile::MappedFile( char const *name ) noexcept
+{
+  HANDLE file = CreateFileA( name, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+  if ( file == INVALID_HANDLE_VALUE )
+    return;
+
+  LARGE_INTEGER file_size;
+  if ( !GetFileSizeEx( file, &file_size ) || file_size.QuadPart == 0 )
+  {
+    CloseHandle( file );
+    return;
+  }
+
+  HANDLE mapping = CreateFileMappingA( file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr );
+  CloseHandle( file );
+
+  if ( !mapping )
+    return;
+
+  // The view keeps the mapping alive
+  view = MapViewOfFile( mapping, FILE_MAP_COPY, 0, 0, 0 );
+  CloseHandle( mapping );
+
+  if ( !view )
+    return;
+
+  address = ( std::uint8_t * )view;
+  length = view_length = ( std::uint64_t )file_size.QuadPart;
+}
+
+MappedFile::MappedFile( std::uint64_t size ) noexcept
+{
+  if ( !size )
+    return;
+
+  // Backed by the paging file, the pages are zeroed on demand
+  HANDLE mapping = CreateFileMappingA( INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, ( DWORD )( size >> 32 ), ( DWORD )size, nullptr );
+  if ( !mapping )
+    return;
+
+  view = MapViewOfFile( mapping, FILE_MAP_WRITE, 0, 0, 0 );
+  CloseHandle( mapping );
+
+  if ( !view )
+    return;
+
+  address = ( std::uint8_t * )view;
+  length = view_length = size;
+}
+
+MappedFile::MappedFile( std::intptr_t handle, std::uint64_t offset, std::uint64_t size ) noexcept
+{
+  LARGE_INTEGER file_size;
+  if ( !GetFileSizeEx( ( HANDLE )handle, &file_size ) || offset >= ( std::uint64_t )file_size.QuadPart || !size )
+    return;
+
+  if ( size > ( std::uint64_t )file_size.QuadPart - offset )
+    size = ( std::uint64_t )file_size.QuadPart - offset;
+
+  HANDLE mapping = CreateFileMappingA( ( HANDLE )handle, nullptr, PAGE_WRITECOPY, 0, 0, nullptr );
+  if ( !mapping )
+    return;
+
+  // Views must begin at a multiple of the allocation granularity
+  auto const aligned_offset = offset / page_size() * page_size();
+  auto const delta = offset - aligned_offset;
+
+  view = MapViewOfFile( mapping, FILE_MAP_COPY, ( DWORD )( aligned_offset >> 32 ), ( DWORD )aligned_offset, ( SIZE_T )( delta + size ) );
+  CloseHandle( mapping );
+
+  if ( !view )
+    return;
+
+  address = ( std::uint8_t * )view + delta;
+  length = size;
+  view_length = delta + size;
+}
+
+MappedFile::~MappedFile()
+{
+  if ( view )
+    UnmapViewOfFile( view );
+}
+
+std::uint32_t MappedFile::page_size() noexcept
+{
+  SYSTEM_INFO info;
+  GetSystemInfo( &info );
+  return info.dwAllocationGranularity;
+}
+
+#else
+
+MappedFile::MappedFile( char const *name ) noexcept
+{
+  int fd = ::open( name, O_RDONLY );
+  if ( fd == -1 )
+    return;
+
+  struct stat file_info;
+  if ( ::fstat( fd, &file_info ) || file_info.st_size == 0 )
+  {
+    ::close( fd );
+    return;
+  }
+
+  void *mapping = ::mmap( nullptr, ( std::size_t )file_info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+  ::close( fd ); // the mapping keeps the file alive
+
+  if ( mapping == MAP_FAILED )
+    return;
+
+  view = mapping;
+  address = ( std::uint8_t * )view;
+  length = view_length = ( std::uint64_t )file_info.st_size;
+}
+
+MappedFile::MappedFile( std::uint64_t size ) noexcept
+{
+  if ( !size )
+    return;
+
+  void *mapping = ::mmap( nullptr, ( std::size_t )size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+  if ( mapping == MAP_FAILED )
+    return;
+
+  view = mapping;
+  address = ( std::uint8_t * )view;
+  length = view_length = size;
+}
+
+MappedFile::MappedFile( std::intptr_t handle, std::uint64_t offset, std::uint64_t size ) noexcept
+{
+  int const fd = ( int )handle;
+
+  struct stat file_info;
+  if ( ::fstat( fd, &file_info ) || offset >= ( std::uint64_t )file_info.st_size || !size )
+    return;
+
+  if ( size > ( std::uint64_t )file_info.st_size - offset )
+    size = ( std::uint64_t )file_info.st_size - offset;
+
+  // Mappings must begin at a multiple of the page size
+  auto const aligned_offset = offset / page_size() * page_size();
+  auto const delta = offset - aligned_offset;
+
+  void *mapping = ::mmap( nullptr, ( std::size_t )( delta + size ), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, ( off_t )aligned_offset );
+  if ( mapping == MAP_FAILED )
+    return;
+
+  view = mapping;
+  address = ( std::uint8_t * )view + delta;
+  length = size;
+  view_length = delta + size;
+}
+
+MappedFile::~MappedFile()
+{
+  if ( view )
+    ::munmap( view, ( std::size_t )view_length );
+}
+
+std::uint32_t MappedFile::page_size() noexcept
+{
+  return ( std::uint32_t )::sysconf( _SC_PAGESIZE );
+}
+
+#endif
+} // namespace mips32
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+
+namespace mips32
+{
+/**
+ * A file mapped in memory, entirely or a window of it, or an anonymous region of zeros.
+ *
+ * The mapping is private: the memory can be written, but the
+ * modifications are copy-on-write and never reach the file.
+ * The pages are loaded, or zeroed, by the OS only when they are touched.
+ *
+ * Non copyable, non movable, allocate it on the heap if it needs to be shared.
+ **/
+class MappedFile
+{
+public:
+  // Maps the file `name`.
+  // If it fails, `data()` returns nullptr.
+  explicit MappedFile( char const *name ) noexcept;
+
+  // Maps `size` bytes of zeros, not backed by any file.
+  // If it fails, `data()` returns nullptr.
+  explicit MappedFile( std::uint64_t size ) noexcept;
+
+  // Maps up to `size` bytes of an already opened file, starting at `offset`,
+  // less if the file ends before. `handle` is a file descriptor, or a `HANDLE` on Windows,
+  // and can be closed once the constructor returns.
+  // If it fails, or `offset` is past the end of the file, `data()` returns nullptr.
+  MappedFile( std::intptr_t handle, std::uint64_t offset, std::uint64_t size ) noexcept;
+
+  MappedFile( MappedFile const & ) = delete;
+  MappedFile &operator=( MappedFile const & ) = delete;
+
+  ~MappedFile();
+
+  std::uint8_t *data() const noexcept { return address; }
+  std::uint64_t size() const noexcept { return length; }
+
+  // Returns the granularity of the host's pages.
+  static std::uint32_t page_size() noexcept;
+
+private:
+  std::uint8_t *address{ nullptr };
+  std::uint64_t length{ 0 };
+
+  // The whole mapping, starts before `address` if the window isn't aligned to a page
+  void         *view{ nullptr };
+  std::uint64_t view_length{ 0 };
+};
+} // namespace mips32
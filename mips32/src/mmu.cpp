@@ -14,7 +14,22 @@ std::uint32_t *MMU::access( std::uint32_t address, std::uint32_t access_flags )
   // 1
     if ( segment.contains( address ) && segment.has_access( access_flags ) )
     {
-      return &ram[address];
+      auto const base_address = RAM::calculate_base_address( address );
+      auto const offset = ( address - base_address ) >> 2;
+
+      if ( base_address == cached_base )
+        return cached_words + offset;
+
+      auto *word = &ram[address];
+
+      // Skips the lookup, and the lock, while the accesses stay inside the block
+      if ( ram.shared() )
+      {
+        cached_base = base_address;
+        cached_words = word - offset;
+      }
+
+      return word;
     }
   }
 
@@ -22,4 +37,14 @@ std::uint32_t *MMU::access( std::uint32_t address, std::uint32_t access_flags )
   return nullptr;
 }
 
+std::uint32_t *MMU::store( std::uint32_t address, std::uint32_t access_flags ) noexcept
+{
+  auto *word = access( address, access_flags );
+
+  if ( word && ram.journaling() )
+    ram.record( address, word );
+
+  return word;
+}
+
 } // namespace mips32
\ No newline at end of file
@@ -35,8 +35,18 @@ public:
 
   std::uint32_t *access( std::uint32_t address, std::uint32_t access_flags ) noexcept;
 
+  // Same as `access`, for a word about to be written: its page is recorded, if the RAM is journaling.
+  std::uint32_t *store( std::uint32_t address, std::uint32_t access_flags ) noexcept;
+
+  // Forgets the last block accessed, the RAM could have been modified in the meantime.
+  void forget() noexcept { cached_base = 1; }
+
 private:
   RAM &ram;
   std::vector<Segment> segments;
+
+  // Last block accessed, only if the RAM is shared, as its words never move
+  std::uint32_t  cached_base{ 1 }; // never a base address
+  std::uint32_t *cached_words{ nullptr };
 };
 } // namespace mips32
\ No newline at end of file
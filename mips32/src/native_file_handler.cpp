@@ -0,0 +1,623 @@
+#include <mips32/native_file_handler.hpp>
+
+#include "io_ring.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <vector>
+
+#ifdef _WIN32
+#  include <fcntl.h>
+#  include <io.h>
+#  include <sys/stat.h>
+#else
+#  include <fcntl.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+
+#  include <cerrno>
+#endif
+
+namespace mips32
+{
+constexpr std::uint32_t read_chunk_size{ 128 * 1024 };
+constexpr std::uint32_t write_chunk_size{ 64 * 1024 };
+constexpr std::uint32_t failure{ 0xFFFF'FFFF };
+constexpr std::uint32_t ring_entries{ 64 };
+
+////
+//// HOST FILES
+////
+#ifdef _WIN32
+
+int os_open( char const *name, int flags ) noexcept
+{
+  return ::_open( name, flags | _O_BINARY, _S_IREAD | _S_IWRITE );
+}
+
+void os_close( int fd ) noexcept
+{
+  ::_close( fd );
+}
+
+std::uint64_t os_size( int fd ) noexcept
+{
+  auto const size = ::_filelengthi64( fd );
+  return size < 0 ? 0 : ( std::uint64_t )size;
+}
+
+// Windows has no positional I/O on CRT descriptors, the calls are serialized by the handler
+std::int64_t os_pread( int fd, void *dst, std::uint32_t size, std::uint64_t offset ) noexcept
+{
+  if ( ::_lseeki64( fd, ( long long )offset, SEEK_SET ) < 0 )
+    return -1;
+  return ::_read( fd, dst, size );
+}
+
+std::int64_t os_pwrite( int fd, void const *src, std::uint32_t size, std::uint64_t offset ) noexcept
+{
+  if ( ::_lseeki64( fd, ( long long )offset, SEEK_SET ) < 0 )
+    return -1;
+  return ::_write( fd, src, size );
+}
+
+std::intptr_t os_handle( int fd ) noexcept
+{
+  return ::_get_osfhandle( fd );
+}
+
+constexpr int os_read_only{ _O_RDONLY };
+constexpr int os_write_only{ _O_WRONLY };
+constexpr int os_read_write{ _O_RDWR };
+constexpr int os_create{ _O_CREAT };
+constexpr int os_truncate{ _O_TRUNC };
+
+#else
+
+int os_open( char const *name, int flags ) noexcept
+{
+  int fd;
+  do
+    fd = ::open( name, flags | O_CLOEXEC, 0666 );
+  while ( fd < 0 && errno == EINTR );
+  return fd;
+}
+
+void os_close( int fd ) noexcept
+{
+  ::close( fd );
+}
+
+std::uint64_t os_size( int fd ) noexcept
+{
+  struct stat info;
+  return ::fstat( fd, &info ) ? 0 : ( std::uint64_t )info.st_size;
+}
+
+std::int64_t os_pread( int fd, void *dst, std::uint32_t size, std::uint64_t offset ) noexcept
+{
+  ssize_t result;
+  do
+    result = ::pread( fd, dst, size, ( off_t )offset );
+  while ( result < 0 && errno == EINTR );
+  return result;
+}
+
+std::int64_t os_pwrite( int fd, void const *src, std::uint32_t size, std::uint64_t offset ) noexcept
+{
+  ssize_t result;
+  do
+    result = ::pwrite( fd, src, size, ( off_t )offset );
+  while ( result < 0 && errno == EINTR );
+  return result;
+}
+
+std::intptr_t os_handle( int fd ) noexcept
+{
+  return fd;
+}
+
+constexpr int os_read_only{ O_RDONLY };
+constexpr int os_write_only{ O_WRONLY };
+constexpr int os_read_write{ O_RDWR };
+constexpr int os_create{ O_CREAT };
+constexpr int os_truncate{ O_TRUNC };
+
+#endif
+
+// Reads until `size` bytes or the end of the file.
+// Returns the bytes read, negative in case of failure.
+std::int64_t read_fully( int fd, char *dst, std::uint32_t size, std::uint64_t offset ) noexcept
+{
+  std::int64_t total = 0;
+
+  while ( size )
+  {
+    auto const result = os_pread( fd, dst, size, offset );
+    if ( result < 0 )
+      return total ? total : result;
+    if ( result == 0 )
+      break;
+
+    total += result;
+    dst += result;
+    offset += ( std::uint64_t )result;
+    size -= ( std::uint32_t )result;
+  }
+
+  return total;
+}
+
+// Returns true in case of failure.
+bool write_fully( int fd, char const *src, std::uint32_t size, std::uint64_t offset ) noexcept
+{
+  while ( size )
+  {
+    auto const result = os_pwrite( fd, src, size, offset );
+    if ( result <= 0 )
+      return true;
+
+    src += result;
+    offset += ( std::uint64_t )result;
+    size -= ( std::uint32_t )result;
+  }
+
+  return false;
+}
+
+////
+//// HANDLER
+////
+inline namespace v0
+{
+// A region of a file held in memory.
+struct Chunk
+{
+  char         *data{ nullptr };
+  std::uint64_t offset{ 0 };
+  std::uint32_t size{ 0 };
+  bool          in_flight{ false }; // submitted to the ring, `size` is the requested one
+
+  bool contains( std::uint64_t position ) const noexcept
+  {
+    return !in_flight && position >= offset && position < offset + size;
+  }
+};
+
+struct File
+{
+  int  os_fd{ -1 }; // -1 if the descriptor is free
+  bool append{ false };
+
+  std::uint64_t position{ 0 }; // where the guest reads or writes next
+  std::uint64_t end{ 0 };      // size of the file, including the pending writes
+
+  // 2 read chunks and 2 write chunks, allocated on the first transfer and kept by the descriptor
+  std::unique_ptr<char[]> memory;
+
+  Chunk current;  // being consumed by the reads
+  Chunk ahead;    // read ahead, follows `current`
+  Chunk pending;  // small writes being coalesced
+  Chunk flushing; // being written in background
+
+  bool failed{ false }; // a background write has failed, reported by the next write
+};
+
+class NativeFileHandlerImpl
+{
+public:
+  explicit NativeFileHandlerImpl( bool use_io_uring ) noexcept
+      : ring( use_io_uring ? ring_entries : 0 )
+  {}
+
+  ~NativeFileHandlerImpl();
+
+  std::uint32_t open( char const *name, char const *flags ) noexcept;
+  std::uint32_t read( std::uint32_t fd, char *dst, std::uint32_t count ) noexcept;
+  std::uint32_t write( std::uint32_t fd, char const *src, std::uint32_t count ) noexcept;
+  void          close( std::uint32_t fd ) noexcept;
+  std::intptr_t native_handle( std::uint32_t fd ) noexcept;
+
+  bool uses_io_uring() const noexcept { return ring.available() && ring_works; }
+
+private:
+  // Returns nullptr if `fd` isn't open.
+  File *file( std::uint32_t fd ) noexcept;
+
+  // Returns true if the chunks couldn't be allocated.
+  bool allocate( File &file ) noexcept;
+
+  // Fills `chunk` with `read_chunk_size` bytes at `offset`, in background if possible.
+  void read_chunk( std::uint32_t fd, File &file, Chunk &chunk, std::uint64_t offset, bool background ) noexcept;
+
+  // Waits for the read ahead, if any.
+  void complete_read( std::uint32_t fd, File &file, Chunk &chunk ) noexcept;
+
+  // Starts writing the pending chunk in background, if possible.
+  void flush( std::uint32_t fd, File &file ) noexcept;
+
+  // Waits for the chunk being flushed, if any.
+  void complete_write( std::uint32_t fd, File &file ) noexcept;
+
+  // Drops the read chunks, the file is about to change.
+  void invalidate_reads( std::uint32_t fd, File &file ) noexcept;
+
+  // Every file has 2 requests at most in flight, a read and a write
+  static constexpr std::uint64_t read_tag( std::uint32_t fd ) noexcept { return std::uint64_t( fd ) << 1; }
+  static constexpr std::uint64_t write_tag( std::uint32_t fd ) noexcept { return std::uint64_t( fd ) << 1 | 1; }
+
+  // The kernel can create a ring, but doesn't support its requests: any other error fails the request only
+  static bool unsupported( std::int64_t result ) noexcept { return result == -EINVAL || result == -EOPNOTSUPP; }
+
+  IORing ring;
+  bool   ring_works{ true }; // false if the kernel doesn't support the requests
+
+  std::vector<File>          files;
+  std::vector<std::uint32_t> free_descriptors;
+};
+
+NativeFileHandlerImpl::~NativeFileHandlerImpl()
+{
+  for ( std::uint32_t fd = 0; fd < files.size(); ++fd )
+    close( fd );
+}
+
+std::uint32_t NativeFileHandlerImpl::open( char const *name, char const *flags ) noexcept
+{
+  if ( !name || !flags )
+    return failure;
+
+  bool const update = std::strchr( flags, '+' );
+
+  int os_flags;
+  bool append = false;
+
+  switch ( flags[0] )
+  {
+  case 'r':
+    os_flags = update ? os_read_write : os_read_only;
+    break;
+  case 'w':
+    os_flags = ( update ? os_read_write : os_write_only ) | os_create | os_truncate;
+    break;
+  case 'a':
+    os_flags = ( update ? os_read_write : os_write_only ) | os_create;
+    append = true;
+    break;
+  default:
+    return failure;
+  }
+
+  int const os_fd = os_open( name, os_flags );
+  if ( os_fd < 0 )
+    return failure;
+
+  std::uint32_t fd;
+
+  if ( free_descriptors.empty() )
+  {
+    fd = ( std::uint32_t )files.size();
+    files.emplace_back();
+  }
+  else
+  {
+    fd = free_descriptors.back();
+    free_descriptors.pop_back();
+  }
+
+  auto &file = files[fd];
+  file.os_fd = os_fd;
+  file.append = append;
+  file.position = 0;
+  file.end = os_size( os_fd );
+  file.failed = false;
+  file.current.size = file.ahead.size = file.pending.size = file.flushing.size = 0;
+
+  return fd;
+}
+
+std::uint32_t NativeFileHandlerImpl::read( std::uint32_t fd, char *dst, std::uint32_t count ) noexcept
+{
+  auto *file = this->file( fd );
+  if ( !file || allocate( *file ) )
+    return failure;
+
+  // The reads must see the writes
+  flush( fd, *file );
+  complete_write( fd, *file );
+
+  std::uint32_t total = 0;
+
+  while ( count )
+  {
+    auto &current = file->current;
+
+    if ( current.contains( file->position ) )
+    {
+      auto const available = current.offset + current.size - file->position;
+      auto const chunk = count < available ? count : ( std::uint32_t )available;
+
+      std::memcpy( dst, current.data + ( file->position - current.offset ), chunk );
+
+      dst += chunk;
+      count -= chunk;
+      total += chunk;
+      file->position += chunk;
+      continue;
+    }
+
+    auto &ahead = file->ahead;
+    complete_read( fd, *file, ahead );
+
+    if ( ahead.contains( file->position ) )
+    {
+      std::swap( current, ahead );
+    }
+    else if ( count >= read_chunk_size )
+    {
+      // Big enough to skip the chunks
+      auto const result = read_fully( file->os_fd, dst, count, file->position );
+      if ( result < 0 )
+        return total ? total : failure;
+
+      total += ( std::uint32_t )result;
+      file->position += ( std::uint64_t )result;
+      break;
+    }
+    else
+    {
+      read_chunk( fd, *file, current, file->position, false );
+      if ( !current.size )
+        break; // end of file, or failure
+    }
+
+    // A full chunk, the file probably continues
+    auto const next = current.offset + current.size;
+    if ( current.size == read_chunk_size && !ahead.contains( next ) )
+      read_chunk( fd, *file, ahead, next, true );
+  }
+
+  return total;
+}
+
+std::uint32_t NativeFileHandlerImpl::write( std::uint32_t fd, char const *src, std::uint32_t count ) noexcept
+{
+  auto *file = this->file( fd );
+  if ( !file || allocate( *file ) )
+    return failure;
+
+  if ( file->failed )
+  {
+    file->failed = false;
+    return failure;
+  }
+
+  invalidate_reads( fd, *file );
+
+  auto const offset = file->append ? file->end : file->position;
+  auto &pending = file->pending;
+
+  // Only the contiguous writes are coalesced
+  if ( pending.size && offset != pending.offset + pending.size )
+    flush( fd, *file );
+
+  if ( count > write_chunk_size - pending.size )
+  {
+    flush( fd, *file );
+
+    // Too big to be coalesced, written before returning as `src` is the guest's memory
+    if ( count >= write_chunk_size )
+    {
+      complete_write( fd, *file );
+
+      if ( write_fully( file->os_fd, src, count, offset ) )
+        return failure;
+
+      file->position = offset + count;
+      file->end = file->end > file->position ? file->end : file->position;
+      return count;
+    }
+  }
+
+  if ( !pending.size )
+    pending.offset = offset;
+
+  std::memcpy( pending.data + pending.size, src, count );
+  pending.size += count;
+
+  file->position = offset + count;
+  file->end = file->end > file->position ? file->end : file->position;
+
+  if ( pending.size == write_chunk_size )
+    flush( fd, *file );
+
+  return count;
+}
+
+void NativeFileHandlerImpl::close( std::uint32_t fd ) noexcept
+{
+  auto *file = this->file( fd );
+  if ( !file )
+    return;
+
+  flush( fd, *file );
+  complete_write( fd, *file );
+  complete_read( fd, *file, file->ahead );
+
+  os_close( file->os_fd );
+  file->os_fd = -1;
+
+  free_descriptors.push_back( fd );
+}
+
+std::intptr_t NativeFileHandlerImpl::native_handle( std::uint32_t fd ) noexcept
+{
+  auto *file = this->file( fd );
+  if ( !file )
+    return -1;
+
+  flush( fd, *file );
+  complete_write( fd, *file );
+
+  return os_handle( file->os_fd );
+}
+
+File *NativeFileHandlerImpl::file( std::uint32_t fd ) noexcept
+{
+  if ( fd >= files.size() || files[fd].os_fd == -1 )
+    return nullptr;
+
+  return &files[fd];
+}
+
+bool NativeFileHandlerImpl::allocate( File &file ) noexcept
+{
+  if ( file.memory )
+    return false;
+
+  file.memory.reset( new ( std::nothrow ) char[2 * read_chunk_size + 2 * write_chunk_size] );
+  if ( !file.memory )
+    return true;
+
+  file.current.data = file.memory.get();
+  file.ahead.data = file.current.data + read_chunk_size;
+  file.pending.data = file.ahead.data + read_chunk_size;
+  file.flushing.data = file.pending.data + write_chunk_size;
+
+  return false;
+}
+
+void NativeFileHandlerImpl::read_chunk( std::uint32_t fd, File &file, Chunk &chunk, std::uint64_t offset, bool background ) noexcept
+{
+  chunk.offset = offset;
+  chunk.size = 0;
+
+  if ( background )
+  {
+    if ( !uses_io_uring() )
+      return; // blocking, as if it were read when needed
+
+    if ( !ring.read( file.os_fd, chunk.data, read_chunk_size, offset, read_tag( fd ) ) )
+    {
+      chunk.size = read_chunk_size;
+      chunk.in_flight = true;
+    }
+    return;
+  }
+
+  auto const result = read_fully( file.os_fd, chunk.data, read_chunk_size, offset );
+  chunk.size = result < 0 ? 0 : ( std::uint32_t )result;
+}
+
+void NativeFileHandlerImpl::complete_read( std::uint32_t fd, File &file, Chunk &chunk ) noexcept
+{
+  if ( !chunk.in_flight )
+    return;
+
+  auto const result = ring.wait( read_tag( fd ) );
+  chunk.in_flight = false;
+
+  if ( result < 0 )
+  {
+    if ( unsupported( result ) )
+    {
+      ring_works = false;
+      chunk.size = 0;
+      return;
+    }
+
+    // The request has failed, the chunk is read again blocking, as if it were never read ahead
+    auto const retried = read_fully( file.os_fd, chunk.data, read_chunk_size, chunk.offset );
+    chunk.size = retried < 0 ? 0 : ( std::uint32_t )retried;
+    return;
+  }
+
+  // Short reads happen only at the end of the file, but they're completed anyway
+  auto size = ( std::uint32_t )result;
+  if ( result > 0 && size < read_chunk_size )
+  {
+    auto const rest = read_fully( file.os_fd, chunk.data + size, read_chunk_size - size, chunk.offset + size );
+    size += rest > 0 ? ( std::uint32_t )rest : 0;
+  }
+
+  chunk.size = size;
+}
+
+void NativeFileHandlerImpl::flush( std::uint32_t fd, File &file ) noexcept
+{
+  if ( !file.pending.size )
+    return;
+
+  // Only 1 chunk is written at a time
+  complete_write( fd, file );
+  std::swap( file.pending, file.flushing );
+  file.pending.size = 0;
+
+  auto &flushing = file.flushing;
+
+  if ( uses_io_uring() && !ring.write( file.os_fd, flushing.data, flushing.size, flushing.offset, write_tag( fd ) ) )
+  {
+    flushing.in_flight = true;
+    return;
+  }
+
+  file.failed |= write_fully( file.os_fd, flushing.data, flushing.size, flushing.offset );
+  flushing.size = 0;
+}
+
+void NativeFileHandlerImpl::complete_write( std::uint32_t fd, File &file ) noexcept
+{
+  auto &flushing = file.flushing;
+
+  if ( !flushing.in_flight )
+    return;
+
+  auto const result = ring.wait( write_tag( fd ) );
+  flushing.in_flight = false;
+
+  if ( result < 0 && !unsupported( result ) )
+  {
+    file.failed = true;
+    flushing.size = 0;
+    return;
+  }
+
+  if ( result < 0 )
+    ring_works = false;
+
+  // Completes short writes, and the ones the kernel didn't support
+  auto const written = result < 0 ? 0u : ( std::uint32_t )result;
+  if ( written < flushing.size )
+    file.failed |= write_fully( file.os_fd, flushing.data + written, flushing.size - written, flushing.offset + written );
+
+  flushing.size = 0;
+}
+
+void NativeFileHandlerImpl::invalidate_reads( std::uint32_t fd, File &file ) noexcept
+{
+  complete_read( fd, file, file.ahead );
+  file.current.size = 0;
+  file.ahead.size = 0;
+}
+} // namespace v0
+
+NativeFileHandler::NativeFileHandler( bool use_io_uring ) noexcept
+    : _impl( new NativeFileHandlerImpl( use_io_uring ) )
+{}
+
+NativeFileHandler::~NativeFileHandler() { delete _impl; }
+
+std::uint32_t NativeFileHandler::open( char const *name, char const *flags ) noexcept { return _impl->open( name, flags ); }
+
+std::uint32_t NativeFileHandler::read( std::uint32_t fd, char *dst, std::uint32_t count ) noexcept { return _impl->read( fd, dst, count ); }
+
+std::uint32_t NativeFileHandler::write( std::uint32_t fd, char const *src, std::uint32_t count ) noexcept { return _impl->write( fd, src, count ); }
+
+void NativeFileHandler::close( std::uint32_t fd ) noexcept { _impl->close( fd ); }
+
+std::intptr_t NativeFileHandler::native_handle( std::uint32_t fd ) noexcept { return _impl->native_handle( fd ); }
+
+bool NativeFileHandler::uses_io_uring() const noexcept { return _impl->uses_io_uring(); }
+} // namespace mips32
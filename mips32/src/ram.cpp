@@ -1,19 +1,46 @@
 #include "ram.hpp"
+#include "snapshot_writer.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstdio>
 #include <cstring>
 #include <new>
 
+#ifdef _WIN32
+#  include <process.h>
+#else
+#  include <unistd.h>
+#endif
+
 namespace mips32
 {
-void addr_to_string( char *buf, std::uint32_t addr )
+// The words of a new block
+constexpr std::uint32_t sigrie{ 0x0417'CCCC };
+
+std::string swap_file_name( std::string const &prefix, std::uint32_t addr )
+{
+  char name[18]{ '\0' };
+  std::sprintf( name, "0x%08X.block", addr );
+  return prefix + name;
+}
+
+// Numbers the RAMs of this process.
+std::string next_swap_prefix()
 {
-  std::sprintf( buf, "0x%08X.block", addr );
+  static std::atomic<std::uint32_t> rams{ 0 };
+
+#ifdef _WIN32
+  auto const process = ( unsigned long )::_getpid();
+#else
+  auto const process = ( unsigned long )::getpid();
+#endif
+
+  return std::to_string( process ) + '-' + std::to_string( rams.fetch_add( 1, std::memory_order_relaxed ) ) + '-';
 }
 
-RAM::RAM( std::uint32_t alloc_limit ) : alloc_limit( alloc_limit / block_size )
+RAM::RAM( std::uint32_t alloc_limit ) : alloc_limit( alloc_limit / block_size ), swap_prefix( next_swap_prefix() )
 {
   assert( alloc_limit && "The allocation limit can't be 0 (zero)." );
   assert( alloc_limit % block_size == 0 && "The allocation limit must be a multiple of RAM::block_size." );
@@ -21,12 +48,32 @@ RAM::RAM( std::uint32_t alloc_limit ) : alloc_limit( alloc_limit / block_size )
   blocks.reserve( this->alloc_limit );
 }
 
+RAM::~RAM()
+{
+  for ( auto const &block : swapped )
+  {
+    if ( !block.image )
+      std::remove( swap_file( block.base_address ).c_str() );
+  }
+
+  // The blocks swapped in keep their file until they're swapped out again
+  if ( counted_faults.swap_outs )
+  {
+    for ( auto const &block : blocks )
+      std::remove( swap_file( block.base_address ).c_str() );
+  }
+}
+
 RAM::Block &RAM::least_accessed() noexcept
 {
-  std::sort( blocks.begin(), blocks.end(), [] ( Block &lhs, Block &rhs ) -> bool { return lhs.access_count > rhs.access_count; } );
+  std::sort( blocks.begin(), blocks.end(), [] ( Block &lhs, Block &rhs ) -> bool {
+    return lhs.pinned != rhs.pinned ? lhs.pinned : lhs.access_count > rhs.access_count;
+  } );
 
   for ( auto &block : blocks ) block.access_count = 0;
 
+  assert( !blocks.back().pinned && "Every block is pinned, none can be swapped." );
+
   return blocks.back();
 }
 
@@ -41,10 +88,11 @@ RAM::Block &RAM::least_accessed() noexcept
  *
  * Case 2:
  * - Block exists
- * - Block resides on disk
+ * - Block resides on disk, or inside a mapped file
+ * + If we can allocate another block, load it there and return the word
  * + Find a block to swap
  * + Swap that block on disk
- * + Load the block from disk
+ * + Load the block from disk, or adopt its image
  * + Return the word
  *
  * Case 3:
@@ -62,6 +110,11 @@ RAM::Block &RAM::least_accessed() noexcept
  *   + Return the word
  **/
 std::uint32_t &RAM::operator[]( std::uint32_t address ) noexcept
+{
+  return mutex ? shared_access( address ) : access( address );
+}
+
+std::uint32_t &RAM::access( std::uint32_t address ) noexcept
 {
   // Case 1
   for ( auto &block : blocks )
@@ -78,19 +131,39 @@ std::uint32_t &RAM::operator[]( std::uint32_t address ) noexcept
   {
     if ( contains( block_on_disk.base_address, address, block_size ) )
     {
+      // Images can be swapped before reaching the limit, there's no need to swap another block
+      if ( !full() )
+      {
+        Block new_block;
+        new_block.base_address = block_on_disk.base_address;
+
+        swap_in( new_block, block_on_disk );
+        ++counted_faults.swap_ins;
+
+        swapped.erase( swapped.begin() + ( &block_on_disk - swapped.data() ) );
+        blocks.push_back( std::move( new_block ) );
+
+        // Return the word
+        auto &block = blocks.back();
+        return block[( address - block.base_address ) >> 2];
+      }
+
       // Find a block to swap
       auto &allocated_block = least_accessed();
 
       auto old_addr = allocated_block.base_address;
 
       // Swap that block on disk
-      allocated_block.serialize();
+      allocated_block.serialize( swap_prefix );
       allocated_block.base_address = block_on_disk.base_address;
 
       // Load the block from disk
-      allocated_block.deserialize();
+      swap_in( allocated_block, block_on_disk );
+
+      ++counted_faults.swap_outs;
+      ++counted_faults.swap_ins;
 
-      block_on_disk.base_address = old_addr;
+      block_on_disk = { old_addr, nullptr };
 
       // Return the word
       return allocated_block[( address  - allocated_block.base_address) >> 2];
@@ -98,7 +171,7 @@ std::uint32_t &RAM::operator[]( std::uint32_t address ) noexcept
   }
 
   // Case 3.1
-  if ( blocks.size() < alloc_limit )
+  if ( !full() )
   {
     Block new_block;
 
@@ -107,6 +180,7 @@ std::uint32_t &RAM::operator[]( std::uint32_t address ) noexcept
     new_block.base_address = calculate_base_address( address );
 
     blocks.push_back( std::move( new_block ) );
+    ++counted_faults.allocations;
 
     // Return the word
     auto &block = blocks.back();
@@ -118,48 +192,247 @@ std::uint32_t &RAM::operator[]( std::uint32_t address ) noexcept
     // Find a block to swap
     auto &allocated_block = least_accessed();
 
-    swapped.push_back( { allocated_block.base_address } );
+    swapped.push_back( { allocated_block.base_address, nullptr } );
 
     // Swap that block on disk
-    allocated_block.serialize();
+    allocated_block.serialize( swap_prefix );
 
-    // Calculate the base address
+    // Calculate the base address, the words of the swapped block are reused
     allocated_block.base_address = calculate_base_address( address );
+    allocated_block.clear();
+
+    ++counted_faults.swap_outs;
+    ++counted_faults.allocations;
 
     // Return the word
     return allocated_block[( address - allocated_block.base_address ) >> 2];
   }
 }
 
-RAM::Block &RAM::Block::allocate() noexcept
+void RAM::share() noexcept
+{
+  if ( !mutex )
+    mutex.reset( new std::shared_mutex );
+}
+
+std::unique_lock<std::shared_mutex> RAM::lock() noexcept
+{
+  return mutex ? std::unique_lock<std::shared_mutex>( *mutex ) : std::unique_lock<std::shared_mutex>();
+}
+
+void RAM::begin_journal() noexcept
+{
+  assert( !mutex && "A shared RAM can't be journaled." );
+
+  if ( !journal )
+  {
+    journal.reset( new Journal );
+    journal->recorded.resize( ( 0x1'0000'0000ull / page_size ) / 64 );
+  }
+  else
+  {
+    for ( auto const page : journal->pages )
+      journal->recorded[page / page_size / 64] = 0;
+  }
+
+  journal->pages.clear();
+  journal->contents.clear();
+  journal->images = images.size();
+}
+
+void RAM::end_journal() noexcept
+{
+  journal.reset();
+}
+
+void RAM::record( std::uint32_t address, std::uint32_t const *word ) noexcept
+{
+  auto const page = address & ~( page_size - 1 );
+  auto &bits = journal->recorded[page / page_size / 64];
+  auto const bit = std::uint64_t( 1 ) << ( page / page_size % 64 );
+
+  if ( bits & bit )
+    return;
+
+  bits |= bit;
+
+  // The page is inside a single block, its words are contiguous
+  auto const *words = word - ( ( address - page ) >> 2 );
+
+  journal->pages.push_back( page );
+  journal->contents.insert( journal->contents.end(), words, words + page_size / 4 );
+}
+
+void RAM::record( std::uint32_t address, std::uint32_t count ) noexcept
+{
+  if ( !count )
+    return;
+
+  std::uint64_t const end = std::uint64_t( address ) + count;
+
+  for ( std::uint64_t page = address & ~( page_size - 1 ); page < end; page += page_size )
+  {
+    // Creating the block would allocate it, even if it's about to be mapped
+    if ( exists( calculate_base_address( ( std::uint32_t )page ) ) )
+      record( ( std::uint32_t )page, &access( ( std::uint32_t )page ) );
+  }
+}
+
+/**
+ * Every page is written back through `access`, as its block could have been swapped meanwhile.
+ * The blocks created since the beginning are kept, with their original content,
+ * except the ones mapped from a file and never used.
+ **/
+void RAM::rewind() noexcept
 {
-  constexpr std::uint32_t sigrie{ 0x0417'CCCC };
+  auto const *content = journal->contents.data();
 
+  for ( auto const page : journal->pages )
+  {
+    std::copy_n( content, page_size / 4, &access( page ) );
+    content += page_size / 4;
+  }
+
+  release_images( journal->images );
+  begin_journal();
+}
+
+bool RAM::exists( std::uint32_t base_address ) const noexcept
+{
+  auto const same_base = [base_address]( auto const &block ) { return block.base_address == base_address; };
+
+  return std::any_of( blocks.cbegin(), blocks.cend(), same_base )
+    || std::any_of( swapped.cbegin(), swapped.cend(), same_base );
+}
+
+/**
+ * The words of an image can hold any block: the evicted blocks leave theirs to the next one.
+ * Only the swapped blocks of a file point inside it, the evicted ones are on disk.
+ **/
+void RAM::release_images( std::size_t kept ) noexcept
+{
+  for ( auto i = kept; i < images.size(); ++i )
+  {
+    auto const begin = ( std::uintptr_t )images[i]->data();
+    auto const end = begin + images[i]->size();
+    auto const inside = [begin, end]( std::uint32_t const *words ) {
+      return ( std::uintptr_t )words >= begin && ( std::uintptr_t )words < end;
+    };
+
+    for ( auto &block : blocks )
+    {
+      if ( inside( block.data.get() ) )
+      {
+        Block copy;
+        if ( copy.allocate().data )
+          std::copy_n( block.data.get(), block_size / 4, copy.data.get() );
+
+        block.data = std::move( copy.data );
+      }
+    }
+
+    swapped.erase( std::remove_if( swapped.begin(), swapped.end(),
+                                   [&inside]( SwappedBlock const &block ) { return inside( block.image ); } ),
+                   swapped.end() );
+  }
+
+  if ( images.size() > kept )
+    images.erase( images.begin() + kept, images.end() );
+}
+
+/**
+ * The blocks are searched while holding the lock shared, as they can't be swapped.
+ * Their `access_count` isn't increased, it's useless without swapping.
+ *
+ * If the block is missing, the lock is acquired exclusively and the search is repeated,
+ * since another thread could have created the block in the meantime.
+ **/
+std::uint32_t &RAM::shared_access( std::uint32_t address ) noexcept
+{
+  {
+    std::shared_lock<std::shared_mutex> shared_lock( *mutex );
+
+    for ( auto &block : blocks )
+    {
+      if ( contains( block.base_address, address, block_size ) )
+        return block.data[( address - block.base_address ) >> 2];
+    }
+  }
+
+  std::unique_lock<std::shared_mutex> exclusive_lock( *mutex );
+  return access( address );
+}
+
+std::string RAM::swap_file( std::uint32_t base_address ) const
+{
+  return swap_file_name( swap_prefix, base_address );
+}
+
+void RAM::swap_in( Block &dst, SwappedBlock &src ) noexcept
+{
+  if ( src.image )
+  {
+    verify( src );
+    dst.adopt( src.image );
+  }
+  else if ( dst.data || dst.allocate().data )
+    dst.deserialize( swap_prefix );
+}
+
+void RAM::verify( SwappedBlock &block ) noexcept
+{
+  if ( !block.verify )
+    return;
+
+  block.verify = false;
+
+  if ( crc32( block.image, block_size ) == block.crc )
+    return;
+
+  // The image is private memory
+  std::fill_n( block.image, block_size / 4, sigrie );
+  corrupted.push_back( block.base_address );
+}
+
+RAM::Block &RAM::Block::allocate() noexcept
+{
   assert( !data && "Block already allocated." );
 
-  data.reset( new ( std::nothrow ) std::uint32_t[RAM::block_size / 4] );
+  // Assigning a new pointer also resets the deleter, the words are owned
+  data = decltype( data )( new ( std::nothrow ) std::uint32_t[RAM::block_size / 4] );
   assert( data && "Couldn't allocate the block." );
 
   if ( data )
-    std::fill_n( data.get(), RAM::block_size / 4, sigrie ); // fill the new block with the 'sigrie' instruction
+    clear();
 
   return *this;
 }
 
+RAM::Block &RAM::Block::clear() noexcept
+{
+  std::fill_n( data.get(), RAM::block_size / 4, sigrie );
+  return *this;
+}
+
 RAM::Block &RAM::Block::deallocate() noexcept
 {
   data.reset( nullptr );
   return *this;
 }
 
-RAM::Block &RAM::Block::serialize() noexcept
+RAM::Block &RAM::Block::adopt( std::uint32_t *image ) noexcept
 {
-  assert( data && "Block::serialize() called without allocated data." );
+  assert( image && !( ( std::uintptr_t )image & 0b11 ) && "Unaligned image." );
 
-  char file_name[18]{ '\0' };
-  addr_to_string( file_name, base_address );
+  data = decltype( data )( image, WordsDeleter{ true } );
+  return *this;
+}
 
-  std::FILE *out = std::fopen( file_name, "wb" );
+RAM::Block &RAM::Block::serialize( std::string const &prefix ) noexcept
+{
+  assert( data && "Block::serialize() called without allocated data." );
+
+  std::FILE *out = std::fopen( swap_file_name( prefix, base_address ).c_str(), "wb" );
   assert( out && "Couldn't open the file." );
 
   [[maybe_unused]] auto write_count = std::fwrite( data.get(), sizeof( std::uint32_t ), RAM::block_size / 4, out );
@@ -171,14 +444,11 @@ RAM::Block &RAM::Block::serialize() noexcept
   return *this;
 }
 
-RAM::Block &RAM::Block::deserialize() noexcept
+RAM::Block &RAM::Block::deserialize( std::string const &prefix ) noexcept
 {
   assert( data && "Block::deserialize() called without allocated data." );
 
-  char file_name[18]{ '\0' };
-  addr_to_string( file_name, base_address );
-
-  std::FILE *in = std::fopen( file_name, "rb" );
+  std::FILE *in = std::fopen( swap_file_name( prefix, base_address ).c_str(), "rb" );
   assert( in && "Couldn't open the file." );
 
   [[maybe_unused]] auto read_count = std::fread( data.get(), sizeof( std::uint32_t ), RAM::block_size / 4, in );
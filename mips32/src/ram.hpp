@@ -2,9 +2,14 @@
 
 #include <mips32/literals.hpp>
 
+#include "mapped_file.hpp"
+
 #include <algorithm>
 #include <cstdint>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
 #include <vector>
 
 namespace mips32
@@ -27,11 +32,18 @@ using namespace literals;
  * Every block is guaranteed to hold a contiguous sequence
  * of words, while the blocks, to each other, are not guaranteed to be.
  *
+ * The swap files of every RAM have their own prefix, unique in the process
+ * and among the processes, so more RAMs can share the working directory.
+ * They're removed by the destructor.
+ *
  * It satisfies MoveConstructible and MoveAssignable.
  *
+ * It's not thread-safe, unless it's shared, see `share`.
+ *
  **/
 class RAM
 {
+  friend class Loader;
   friend class MachineInspector;
   friend class RAMIO;
 
@@ -45,6 +57,9 @@ public:
   // A minimum of ``RAM::block_size`` is required.
   explicit RAM( std::uint32_t alloc_limit );
 
+  // Removes the swap files.
+  ~RAM();
+
   // Movable
   RAM( RAM && ) = default;
   RAM &operator=( RAM && ) = default;
@@ -56,24 +71,83 @@ public:
   // Returns the word at the given address
   std::uint32_t &operator[]( std::uint32_t address ) noexcept;
 
-  inline static constexpr std::uint32_t calculate_base_address( std::uint32_t address ) noexcept
+  // Makes the RAM safe to be accessed by more threads at once, it can't be undone.
+  //
+  // A shared RAM never swaps its blocks on disk, the allocation limit is ignored,
+  // so the words returned by operator[] keep their address and can be used without locking.
+  // Only the lookup of the blocks is locked, the creation of a block is exclusive.
+  void share() noexcept;
+
+  bool shared() const noexcept { return mutex != nullptr; }
+
+  // Locks a shared RAM exclusively, the lock owns nothing if it isn't shared.
+  // operator[] can't be used by the owner, the friends access the blocks directly.
+  std::unique_lock<std::shared_mutex> lock() noexcept;
+
+  // A page is the unit of the journal.
+  static inline constexpr std::uint32_t page_size{ 4_KB };
+
+  // Starts recording every page before its first write, dropping the previous records, see `record`.
+  // The RAM can be rewound to this point, as many times as needed. Not available if shared.
+  void begin_journal() noexcept;
+
+  // Stops recording, the records are dropped.
+  void end_journal() noexcept;
+
+  bool journaling() const noexcept { return journal != nullptr; }
+
+  // Records the page holding `address`, if it isn't yet, before it's written through `word`,
+  // the host address of the word at `address`. The RAM must be journaling.
+  void record( std::uint32_t address, std::uint32_t const *word ) noexcept;
+
+  // Same as above, for every page in [address, address + count) of the blocks that exist,
+  // they're accessed through operator[]. No block is created, the new ones are kept by `rewind`.
+  void record( std::uint32_t address, std::uint32_t count ) noexcept;
+
+  // Writes back every recorded page, the RAM is as it was at `begin_journal`, then the journal restarts.
+  // The files mapped since are released, see `release_images`.
+  // The cost is proportional to the pages written, not to the size of the RAM.
+  void rewind() noexcept;
+
+  // Blocks faulted in since the construction: allocated when first touched,
+  // loaded back from the disk, and written to the disk to make room for another one.
+  struct Faults
   {
-    std::uint32_t base_address = 0;
+    std::uint64_t allocations{ 0 };
+    std::uint64_t swap_ins{ 0 };
+    std::uint64_t swap_outs{ 0 };
+  };
+
+  Faults const &faults() const noexcept { return counted_faults; }
 
-    while ( base_address + RAM::block_size <= address )
-      base_address += RAM::block_size;
+  inline static constexpr std::uint32_t calculate_base_address( std::uint32_t address ) noexcept
+  {
+    static_assert( ( RAM::block_size & ( RAM::block_size - 1 ) ) == 0, "RAM::block_size must be a power of 2." );
 
-    return base_address;
+    return address & ~( RAM::block_size - 1 );
   }
 
 private:
+  // Deletes the words of a Block, unless they are borrowed from a mapped file.
+  struct WordsDeleter
+  {
+    bool borrowed; // value-initialized to false by std::unique_ptr
+
+    void operator()( std::uint32_t *words ) const noexcept
+    {
+      if ( !borrowed )
+        delete[] words;
+    }
+  };
+
   // Represent a portion of data of our RAM.
   // It's a very simple class that owns `RAM::block_size` words.
   struct Block
   {
-    std::uint32_t                    base_address;    // base address of our block
-    std::uint32_t                    access_count{ 0 }; // number of accesses through operator[]
-    std::unique_ptr<std::uint32_t[]> data;            // Words array
+    std::uint32_t                                  base_address;      // base address of our block
+    std::uint32_t                                  access_count{ 0 }; // number of accesses through operator[]
+    std::unique_ptr<std::uint32_t[], WordsDeleter> data;              // Words array
+    bool                                           pinned{ false };   // if true, it can't be swapped
 
     // Allocate a `RAM::block_size` array of words.
     // If it fails, `data` holds nullptr,
@@ -83,15 +157,23 @@ private:
     // Deallocate the data.
     Block &deallocate() noexcept;
 
+    // Fills the data with the 'sigrie' instruction, as a new block.
+    Block &clear() noexcept;
+
+    // Uses `RAM::block_size` bytes of a mapped file as words array, without copying them.
+    // The previous words array, if any, is deallocated.
+    // `image` must be 4 bytes aligned and live inside a *private* mapping owned by the RAM.
+    Block &adopt( std::uint32_t *image ) noexcept;
+
     // Copies the data to disk inside a file
-    // called 0xXXXXXXXX.block, where XXX
+    // called <prefix>0xXXXXXXXX.block, where XXX
     // stands for the `base_address` in hexadecimal.
-    Block &serialize() noexcept;
+    Block &serialize( std::string const &prefix ) noexcept;
 
     // Copies the data from disk, from a file
-    // called 0xXXXXXXXX.block, where XXX
+    // called <prefix>0xXXXXXXXX.block, where XXX
     // stands for the `base_address` in hexadecimal.
-    Block &deserialize() noexcept;
+    Block &deserialize( std::string const &prefix ) noexcept;
 
     // Returns the word specified by `pos`.
     // Also increase the counter of `access_count` by 1.
@@ -102,11 +184,42 @@ private:
     }
   };
 
+  // Body of operator[], without locking.
+  std::uint32_t &access( std::uint32_t address ) noexcept;
+
+  // operator[] of a shared RAM.
+  std::uint32_t &shared_access( std::uint32_t address ) noexcept;
+
+  // Returns true if a block must be swapped to make room for another one.
+  bool full() const noexcept { return blocks.size() >= alloc_limit && !mutex; }
+
   struct SwappedBlock
   {
-    std::uint32_t base_address;
+    std::uint32_t  base_address;
+    std::uint32_t *image{ nullptr }; // if not null, the block lives inside a mapped file instead of its swap file
+    std::uint32_t  crc{ 0 };         // CRC-32 of the image, if `verify`
+    bool           verify{ false };  // the image is checked when adopted, as a snapshot isn't read on restore
   };
 
+  // Name of the swap file of the block at `base_address`.
+  std::string swap_file( std::uint32_t base_address ) const;
+
+  // Returns true if the block at `base_address` is allocated, swapped or inside a mapped file.
+  bool exists( std::uint32_t base_address ) const noexcept;
+
+  // Unmaps every image after the first `kept`. The blocks allocated inside them are copied
+  // into their own words, the ones never swapped in are dropped, as they're only in the file.
+  void release_images( std::size_t kept ) noexcept;
+
+  // Loads the swapped block `src` into `dst`.
+  // An image is adopted as it is, once verified, otherwise `dst` is allocated, if needed, and deserialized from disk.
+  void swap_in( Block &dst, SwappedBlock &src ) noexcept;
+
+  // Checks the image of `block` the first time it's used, if needed.
+  // A corrupted image is overwritten as a new block, as its words can't be trusted,
+  // and its address is added to `corrupted`.
+  void verify( SwappedBlock &block ) noexcept;
+
   // Helper function that checks if the given addres belongs to a block.
   bool contains( std::uint32_t base, std::uint32_t address, std::uint32_t limit ) const noexcept
   {
@@ -116,7 +229,7 @@ private:
   /**
    * This is our algorithm that selects a block to overwrite.
    * It does 3 things:
-   *   1. Sort the block list by their `access_count` in descending order.
+   *   1. Sort the block list by their `access_count` in descending order, the pinned blocks first.
    *      This means that the most accessed block is also the first.
    *   2. Resets the `access_count`.
    *      This means that every block can be selected for the next substitution.
@@ -124,8 +237,24 @@ private:
    **/
   Block &least_accessed() noexcept;
 
-  std::uint32_t             alloc_limit; // Maximum number of allocable blocks.
-  std::vector<Block>        blocks;      // Block list.
-  std::vector<SwappedBlock> swapped;     // Swapped block list.
+  // Content of the pages before their first write since the beginning of the journal.
+  struct Journal
+  {
+    std::vector<std::uint64_t> recorded; // 1 bit per page of the address space
+    std::vector<std::uint32_t> pages;    // addresses of the recorded pages, in order
+    std::vector<std::uint32_t> contents; // `page_size` / 4 words per page, in the same order
+    std::size_t                images{ 0 }; // number of images at the beginning
+  };
+
+  std::uint32_t                            alloc_limit; // Maximum number of allocable blocks.
+  std::vector<Block>                       blocks;      // Block list.
+  std::vector<SwappedBlock>                swapped;     // Swapped block list.
+  std::vector<std::unique_ptr<MappedFile>> images;      // Files backing the blocks' images.
+  std::unique_ptr<std::shared_mutex>       mutex;       // Only if shared, keeps the RAM movable.
+  std::string                              swap_prefix; // Of the swap files, "<process id>-<RAM number>-".
+  std::unique_ptr<Journal>                 journal;     // Only if journaling.
+  std::vector<std::uint32_t>               corrupted;   // Blocks of the restored snapshot found corrupted.
+
+  Faults counted_faults;
 };
 } // namespace mips32
\ No newline at end of file
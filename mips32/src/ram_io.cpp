@@ -29,7 +29,8 @@ namespace mips32
  *
  * [1] and [2] are handled by accessing the Block with a pointer:
  * [1] -> pointer points to an allocated Block *inside the RAM object*
- * [2] -> pointer points to an allocated Block *local to this function*
+ * [2] -> pointer points to an allocated Block *local to this function*,
+ *        or directly to the block's image if it has one
  *
  * [3] if the Block doesn't exists we return an empty seq
  *
@@ -49,7 +50,8 @@ std::vector<char> RAMIO::read( std::uint32_t address, std::uint32_t count, bool
   if ( index == -1 ) // [3]
     return seq_buf;
 
-  RAM::Block *block = nullptr;
+  std::uint32_t base_address = 0;
+  std::uint32_t *words = nullptr;
   RAM::Block tmp;
 
   bool eof = false;
@@ -58,28 +60,41 @@ std::vector<char> RAMIO::read( std::uint32_t address, std::uint32_t count, bool
   {
     if ( in_memory ) // [1]
     {
-      block = ram.blocks.data() + index;
+      base_address = ram.blocks[index].base_address;
+      words = ram.blocks[index].data.get();
     }
     else             // [2]
     {
-      tmp.base_address = ram.swapped[index].base_address;
+      auto &swapped_block = ram.swapped[index];
 
-      if ( !tmp.data )
-        if ( !tmp.allocate().data )
-          break;
+      base_address = swapped_block.base_address;
+
+      if ( swapped_block.image )
+      {
+        ram.verify( swapped_block );
+        words = swapped_block.image;
+      }
+      else
+      {
+        tmp.base_address = base_address;
+
+        if ( !tmp.data )
+          if ( !tmp.allocate().data )
+            break;
 
-      tmp.deserialize();
+        tmp.deserialize( ram.swap_prefix );
 
-      block = &tmp;
+        words = tmp.data.get();
+      }
     }
 
-    std::uint32_t begin = address - block->base_address;
+    std::uint32_t begin = address - base_address;
     std::uint32_t limit = RAM::block_size - begin;
     std::uint32_t size  = std::min( count, limit );
 
     auto _old_length = seq_buf.size();
 
-    char * start = (char*)block->data.get() + begin;
+    char * start = (char*)words + begin;
     char * end = start + size;
 
     if ( read_string )
@@ -138,7 +153,7 @@ std::vector<char> RAMIO::read( std::uint32_t address, std::uint32_t count, bool
  *
  * [1] and [2] are handled by copying the content to:
  *   [1] the Block, or
- *   [2] the file.
+ *   [2] the file, or the block's image if it has one.
  *
  * [3] if the Block doesn't exists we need to create it and push it into our RAM.
  *
@@ -151,6 +166,9 @@ void RAMIO::write( std::uint32_t address, void const *src, std::uint32_t count )
   if ( address + count < address )
     return;
 
+  if ( ram.journaling() )
+    ram.record( address, count );
+
   std::uint32_t byte_written = 0;
 
   while ( count )
@@ -174,26 +192,32 @@ void RAMIO::write( std::uint32_t address, void const *src, std::uint32_t count )
       count -= size;
       address += size;
     }
-    else if ( !in_memory && index != -1 ) // [2]
+    else if ( !in_memory && index != -1 && ram.swapped[index].image ) // [2], the image is private memory
     {
       auto &block = ram.swapped[index];
+      ram.verify( block );
+
+      std::uint32_t begin = address - block.base_address;
+      std::uint32_t limit = RAM::block_size - begin;
+      std::uint32_t size  = std::min( count, limit );
 
-      char file_name[18]{ '\0' };
-      std::sprintf( file_name, "0x%08X.block", block.base_address );
+      std::memcpy( ( char* )block.image + begin, ( char* )src + byte_written, size );
 
-      std::FILE *block_file = std::fopen( file_name, "r+b" );
+      byte_written += size;
+      count -= size;
+      address += size;
+    }
+    else if ( !in_memory && index != -1 ) // [2]
+    {
+      auto &block = ram.swapped[index];
+
+      std::FILE *block_file = std::fopen( ram.swap_file( block.base_address ).c_str(), "r+b" );
 
       assert( block_file && "Couldn't open file!" );
 
       std::uint32_t begin = address - block.base_address;
       std::uint32_t limit = RAM::block_size - begin;
-      std::uint32_t size  = std::min( count, limit-1 );
-
-      if ( size == 0 )
-      {
-        ++byte_written;
-        continue;
-      }
+      std::uint32_t size  = std::min( count, limit );
 
       [[maybe_unused]] auto _seek = std::fseek( block_file, begin, SEEK_SET );
       assert( !_seek && "Couldn't seek string position." );
@@ -218,14 +242,14 @@ void RAMIO::write( std::uint32_t address, void const *src, std::uint32_t count )
       assert( block.data && "Couldn't allocate block!" );
 
       // If we can push the new block directly into memory, we add it to the allocated blocks
-      if ( ram.swapped.empty() && ( ram.blocks.size() < ram.alloc_limit ) )
+      if ( !ram.full() )
       {
         ram.blocks.emplace_back( std::move( block ) );
       }
       else // Otherwise we treat it like a swapped one
       {
-        block.deserialize();
-        ram.swapped.push_back( { block.base_address } );
+        block.serialize( ram.swap_prefix );
+        ram.swapped.push_back( { block.base_address, nullptr } );
       }
 
       continue;
@@ -237,6 +261,137 @@ void RAMIO::write( std::uint32_t address, void const *src, std::uint32_t count )
   }
 }
 
+/**
+ * Every span points to:
+ * - the block's image, if it's swapped and has one, it's private memory
+ * - otherwise the allocated block, after being created or swapped in by `RAM::operator[]`
+ *
+ * At most `alloc_limit` blocks can be pinned, otherwise no block
+ * could be swapped out to make room for the next one.
+ **/
+std::uint32_t RAMIO::pin( std::uint32_t address, std::uint32_t count, FileSpan *spans, std::uint32_t max_spans ) noexcept
+{
+  // only valid memory region can be used
+  count = ( std::uint32_t )std::min<std::uint64_t>( count, 0x1'0000'0000 - std::uint64_t( address ) );
+
+  std::uint32_t spans_no = 0;
+  std::uint32_t pinned_no = 0;
+
+  while ( count && spans_no < max_spans )
+  {
+    auto const base_address = RAM::calculate_base_address( address );
+    auto const begin = address - base_address;
+    auto const size = std::min( count, RAM::block_size - begin );
+
+    auto [index, in_memory] = get_block( address );
+
+    char *data = nullptr;
+
+    if ( !in_memory && index != -1 && ram.swapped[index].image )
+    {
+      ram.verify( ram.swapped[index] );
+      data = ( char * )ram.swapped[index].image + begin;
+    }
+    else
+    {
+      if ( pinned_no == ram.alloc_limit )
+        break;
+
+      if ( !in_memory )
+        ram.access( base_address );
+
+      for ( auto &block : ram.blocks )
+      {
+        if ( block.base_address == base_address )
+        {
+          block.pinned = true;
+          data = ( char * )block.data.get() + begin;
+          break;
+        }
+      }
+
+      ++pinned_no;
+    }
+
+    spans[spans_no++] = { data, size };
+
+    address += size;
+    count -= size;
+  }
+
+  return spans_no;
+}
+
+void RAMIO::unpin() noexcept
+{
+  for ( auto &block : ram.blocks )
+    block.pinned = false;
+}
+
+/**
+ * The terminator is searched block by block with `std::memchr`, in place:
+ * - if it's found inside the first block, we return a view of it
+ * - otherwise the string crosses more blocks and it's copied to `buffer`
+ *
+ * A missing block terminates the string.
+ **/
+std::pair<char const *, std::uint32_t> RAMIO::string( std::uint32_t address, std::vector<char> &buffer ) noexcept
+{
+  buffer.clear();
+
+  for ( ;; )
+  {
+    auto const base_address = RAM::calculate_base_address( address );
+    auto const begin = address - base_address;
+
+    auto const *const words = words_of( base_address );
+    if ( !words )
+      break;
+
+    auto const *const start = words + begin;
+    auto const *const end = words + RAM::block_size;
+
+    auto const *const terminator = ( char const * )std::memchr( start, '\0', end - start );
+
+    if ( terminator && buffer.empty() ) // the string lies inside this block
+      return { start, std::uint32_t( terminator - start ) };
+
+    buffer.insert( buffer.end(), start, terminator ? terminator : end );
+
+    address = base_address + RAM::block_size;
+
+    if ( terminator || address == 0 )
+      break;
+  }
+
+  auto const length = ( std::uint32_t )buffer.size();
+  buffer.push_back( '\0' );
+
+  return { buffer.data(), length };
+}
+
+char *RAMIO::words_of( std::uint32_t base_address ) noexcept
+{
+  auto[index, in_memory] = get_block( base_address );
+
+  if ( index == -1 )
+    return nullptr;
+
+  if ( in_memory )
+    return ( char * )ram.blocks[index].data.get();
+
+  if ( ram.swapped[index].image )
+  {
+    ram.verify( ram.swapped[index] );
+    return ( char * )ram.swapped[index].image;
+  }
+
+  ram.access( base_address );
+
+  auto[swapped_in, _] = get_block( base_address );
+  return ( char * )ram.blocks[swapped_in].data.get();
+}
+
 std::pair<std::uint32_t, bool> RAMIO::get_block( std::uint32_t address ) const noexcept
 {
   for ( auto i = 0u; i < ram.blocks.size(); ++i )
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <mips32/file_handler.hpp>
 #include "ram.hpp"
 
 #include <vector>
@@ -7,6 +8,7 @@
 
 namespace mips32
 {
+// Accesses the blocks of the RAM directly, a shared RAM must be locked by the caller, see `RAM::lock`.
 class RAMIO
 {
 public:
@@ -16,9 +18,28 @@ public:
 
   void write( std::uint32_t address, void const *src, std::uint32_t count ) noexcept;
 
+  // Stores into `spans` the host memory holding [address, address + count),
+  // one span per block, up to `max_spans` spans.
+  // The blocks are created or swapped in as needed, and can't be swapped out until `unpin`.
+  // Returns the number of spans, that could cover less than `count` bytes.
+  std::uint32_t pin( std::uint32_t address, std::uint32_t count, FileSpan *spans, std::uint32_t max_spans ) noexcept;
+
+  // Allows the pinned blocks to be swapped again.
+  void unpin() noexcept;
+
+  // Returns the null terminated string at `address`, and its length.
+  // If the string lies inside a single block, the pointer points directly into it,
+  // otherwise the string is copied into `buffer`, whose memory is reused.
+  // The pointer is valid until the RAM is accessed again.
+  std::pair<char const *, std::uint32_t> string( std::uint32_t address, std::vector<char> &buffer ) noexcept;
+
 private:
   std::pair<std::uint32_t, bool> get_block( std::uint32_t address ) const noexcept;
 
+  // Returns the words of the block at `base_address`, without copying them.
+  // A block swapped on disk is swapped in, nullptr if it doesn't exist.
+  char *words_of( std::uint32_t base_address ) noexcept;
+
   RAM &ram;
 };
 } // namespace mips32
\ No newline at end of file
@@ -0,0 +1,262 @@
+#include "snapshot_writer.hpp"
+#include "ram.hpp"
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <mutex>
+#include <system_error>
+#include <thread>
+
+namespace mips32
+{
+constexpr std::uint32_t block_words{ RAM::block_size / 4 };
+
+constexpr auto crc_table = []() {
+  std::array<std::uint32_t, 256> table{};
+
+  for ( std::uint32_t i = 0; i < 256; ++i )
+  {
+    std::uint32_t crc = i;
+    for ( int bit = 0; bit < 8; ++bit )
+      crc = crc & 1 ? ( crc >> 1 ) ^ 0xEDB8'8320 : crc >> 1;
+    table[i] = crc;
+  }
+
+  return table;
+}();
+
+std::uint32_t crc32( void const *data, std::uint64_t size ) noexcept
+{
+  auto const *bytes = ( std::uint8_t const * )data;
+
+  std::uint32_t crc = 0xFFFF'FFFF;
+  while ( size-- )
+    crc = crc_table[( crc ^ *bytes++ ) & 0xFF] ^ ( crc >> 8 );
+
+  return ~crc;
+}
+
+std::uint32_t rle_encode( std::uint32_t const *words, std::uint32_t *dst ) noexcept
+{
+  std::uint32_t size = 0;
+
+  for ( std::uint32_t i = 0; i < block_words; )
+  {
+    if ( size + 2 >= block_words ) // not smaller than the block
+      return 0;
+
+    std::uint32_t run = 1;
+    while ( i + run < block_words && words[i + run] == words[i] )
+      ++run;
+
+    dst[size++] = run;
+    dst[size++] = words[i];
+
+    i += run;
+  }
+
+  return size;
+}
+
+bool rle_decode( std::uint32_t const *src, std::uint32_t size, std::uint32_t *words ) noexcept
+{
+  if ( size % 2 )
+    return true;
+
+  std::uint32_t decoded = 0;
+
+  for ( std::uint32_t i = 0; i < size; i += 2 )
+  {
+    auto const run = src[i];
+
+    if ( run == 0 || run > block_words - decoded )
+      return true;
+
+    if ( words )
+      std::fill_n( words + decoded, run, src[i + 1] );
+
+    decoded += run;
+  }
+
+  return decoded != block_words;
+}
+
+SnapshotWriter::SnapshotWriter( unsigned workers ) noexcept : workers( workers )
+{
+  if ( !this->workers )
+    this->workers = std::max( 1u, std::thread::hardware_concurrency() );
+}
+
+/**
+ * The blocks go through a ring of `window` slots, the block `i` uses the slot `i % window`:
+ * 1. A worker claims the next block, if its slot has been written
+ * 2. The worker loads, encodes and checksums the block inside the slot
+ * 3. The writer waits for the slot, writes it and releases it
+ *
+ * In case of failure the remaining blocks are not claimed anymore,
+ * and the workers terminate.
+ **/
+std::vector<EncodedBlock> SnapshotWriter::write( std::FILE *file, std::uint64_t offset, std::uint32_t count, Source const &source ) noexcept
+{
+  struct Slot
+  {
+    std::vector<std::uint32_t> scratch = std::vector<std::uint32_t>( block_words );
+    std::vector<std::uint32_t> encoded = std::vector<std::uint32_t>( block_words );
+
+    std::uint32_t const *data{ nullptr }; // nullptr if the block couldn't be loaded
+    std::uint32_t        size{ 0 };
+    std::uint32_t        crc{ 0 };
+    BlockEncoding        encoding{ BlockEncoding::RAW };
+    bool                 ready{ false };
+  };
+
+  std::vector<EncodedBlock> blocks;
+
+  if ( !count )
+    return blocks;
+
+  auto const threads_no = std::min( workers, count );
+  auto const window = threads_no * 2;
+
+  std::vector<Slot> slots( window );
+
+  std::mutex              mutex;
+  std::condition_variable cv;
+  std::uint32_t           next = 0;    // next block to claim
+  std::uint32_t           written = 0; // blocks written so far
+
+  // 2
+  auto const encode = [&]( std::uint32_t index ) {
+    auto &slot = slots[index % window];
+    auto const *words = source( index, slot.scratch.data() );
+
+    if ( !words )
+    {
+      slot.data = nullptr;
+    }
+    else if ( auto const encoded_size = rle_encode( words, slot.encoded.data() ) )
+    {
+      slot.data = slot.encoded.data();
+      slot.size = encoded_size * 4;
+      slot.encoding = BlockEncoding::RLE;
+    }
+    else
+    {
+      slot.data = words;
+      slot.size = RAM::block_size;
+      slot.encoding = BlockEncoding::RAW;
+    }
+
+    if ( slot.data )
+      slot.crc = crc32( slot.data, slot.size );
+
+    {
+      std::lock_guard<std::mutex> lock( mutex );
+      slot.ready = true;
+    }
+    cv.notify_all();
+  };
+
+  auto const worker = [&]() {
+    for ( ;; )
+    {
+      // 1
+      std::uint32_t index;
+      {
+        std::unique_lock<std::mutex> lock( mutex );
+        cv.wait( lock, [&] { return next == count || next < written + window; } );
+
+        if ( next == count )
+          return;
+
+        index = next++;
+      }
+
+      encode( index );
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve( threads_no );
+
+  try
+  {
+    for ( unsigned i = 0; i < threads_no; ++i )
+      threads.emplace_back( worker );
+  }
+  catch ( std::system_error const & )
+  {
+    // Fewer workers run, without any the writer encodes every block itself
+  }
+
+  blocks.reserve( count );
+
+  bool error = false;
+
+  for ( std::uint32_t i = 0; i < count && !error; ++i )
+  {
+    // Serially, the block is encoded right before being written
+    if ( threads.empty() )
+      encode( i );
+
+    // 3
+    auto &slot = slots[i % window];
+    {
+      std::unique_lock<std::mutex> lock( mutex );
+      cv.wait( lock, [&] { return slot.ready; } );
+    }
+
+    if ( !slot.data )
+    {
+      error = true;
+      break;
+    }
+
+    if ( slot.encoding == BlockEncoding::RAW )
+    {
+      static constexpr char zeros[4096]{};
+
+      auto padding = ( RAM::block_size - offset % RAM::block_size ) % RAM::block_size;
+
+      while ( padding && !error )
+      {
+        auto const size = std::min<std::uint64_t>( padding, sizeof( zeros ) );
+
+        error = std::fwrite( zeros, 1, ( std::size_t )size, file ) != size;
+
+        padding -= size;
+        offset += size;
+      }
+    }
+
+    error = error || std::fwrite( slot.data, 1, slot.size, file ) != slot.size;
+
+    blocks.push_back( { offset, slot.size, slot.crc, slot.encoding } );
+    offset += slot.size;
+
+    {
+      std::lock_guard<std::mutex> lock( mutex );
+      slot.ready = false;
+      ++written;
+    }
+    cv.notify_all();
+  }
+
+  if ( error )
+  {
+    {
+      std::lock_guard<std::mutex> lock( mutex );
+      next = count;
+    }
+    cv.notify_all();
+
+    blocks.clear();
+  }
+
+  for ( auto &thread : threads )
+    thread.join();
+
+  return blocks;
+}
+} // namespace mips32
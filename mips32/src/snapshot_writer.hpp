@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+namespace mips32
+{
+// How a RAM block is stored inside a snapshot.
+enum class BlockEncoding : std::uint32_t
+{
+  RAW = 0, // `RAM::block_size` bytes, as they are
+  RLE = 1, // (count, word) pairs
+};
+
+// Where and how a block has been written.
+struct EncodedBlock
+{
+  std::uint64_t offset;   // from the beginning of the file
+  std::uint32_t size;     // in bytes
+  std::uint32_t crc;      // CRC-32 of the `size` bytes stored at `offset`
+  BlockEncoding encoding;
+};
+
+// CRC-32 (IEEE 802.3) of `size` bytes.
+std::uint32_t crc32( void const *data, std::uint64_t size ) noexcept;
+
+// Encodes a block of `RAM::block_size` bytes as (count, word) pairs into `dst`,
+// that must hold `RAM::block_size` bytes.
+// Returns the number of words written, or 0 if the encoding isn't smaller than the block.
+std::uint32_t rle_encode( std::uint32_t const *words, std::uint32_t *dst ) noexcept;
+
+// Decodes `size` words of (count, word) pairs into a block of `RAM::block_size` bytes.
+// If `words` is nullptr, the pairs are only validated.
+// Returns:
+// `true`  - in case of *failure*, the pairs don't describe exactly one block
+// `false` - in case of success
+bool rle_decode( std::uint32_t const *src, std::uint32_t size, std::uint32_t *words ) noexcept;
+
+/**
+ * Writes a sequence of RAM blocks to a file.
+ *
+ * A pool of workers encodes and checksums the blocks in parallel,
+ * while the thread calling `write` streams them to the file in order.
+ * At most a few blocks per worker are in flight at any given time.
+ * If no worker can be started, the thread calling `write` encodes the blocks itself.
+ *
+ * A block is written RAW, at an offset multiple of `RAM::block_size`,
+ * unless its RLE encoding is smaller, in which case it's packed after
+ * the previous one.
+ **/
+class SnapshotWriter
+{
+public:
+  // Returns the words of the block `index`, or nullptr in case of failure.
+  // The pointed memory must live until `write` returns.
+  // `scratch` holds `RAM::block_size` bytes that can be used to load the block,
+  // reserved to it until it's written.
+  // Called concurrently by the workers.
+  using Source = std::function<std::uint32_t const *( std::uint32_t index, std::uint32_t *scratch )>;
+
+  // Uses `workers` threads, or one per hardware thread if 0.
+  explicit SnapshotWriter( unsigned workers = 0 ) noexcept;
+
+  // Writes `count` blocks provided by `source` to `file`, starting at `offset`,
+  // that must be the current position of the file.
+  // Returns where every block has been written, or an empty vector in case of failure.
+  std::vector<EncodedBlock> write( std::FILE *file, std::uint64_t offset, std::uint32_t count, Source const &source ) noexcept;
+
+private:
+  unsigned workers;
+};
+} // namespace mips32
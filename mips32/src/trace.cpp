@@ -0,0 +1,677 @@
+#include "trace.hpp"
+#include "snapshot_writer.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <new>
+
+#ifdef _MSC_VER
+#  include <intrin.h>
+#endif
+
+namespace mips32
+{
+constexpr std::uint32_t trace_magic_tag{ 0x66'61'6D'61 }; // "fama"
+constexpr std::uint32_t trace_version_tag{ 0x1 };
+
+struct TraceHeader
+{
+  std::uint32_t magic;
+  std::uint32_t version;
+  std::uint32_t pc;
+  std::uint32_t gpr[32];
+  std::uint64_t fpr[32];
+};
+
+// A block of records, `stored_size` bytes follow, compressed if smaller than `size`.
+// The end of the trace is a block of size 0, followed by the number of records.
+struct TraceBlockHeader
+{
+  std::uint32_t size;
+  std::uint32_t stored_size;
+  std::uint32_t crc; // of the stored bytes
+};
+
+// Every record starts with its flags, followed by the fields flagged, in this order
+constexpr std::uint8_t record_jump{ 0x01 };   // zig-zag varint, PC - the PC following the previous one
+constexpr std::uint8_t record_word{ 0x02 };   // 4 bytes, the word isn't the recent one at the same PC
+constexpr std::uint8_t record_gpr{ 0x04 };    // varint mask, a zig-zag varint per GPR, new - old
+constexpr std::uint8_t record_fpr{ 0x08 };    // varint mask, a varint per FPR, new ^ old
+constexpr std::uint8_t record_stores{ 0x10 }; // varint count, per store a zig-zag varint, address - last address, and a varint value
+
+// Longest record, with every field
+constexpr std::uint32_t max_record_size{ 1 + 5 + 4 + 5 + 32 * 5 + 5 + 32 * 10 + 5 + 3 * ( 5 + 5 ) };
+
+constexpr std::uint32_t recent_slot( std::uint32_t pc ) noexcept
+{
+  return ( pc >> 2 & 1023 ) * 2;
+}
+
+constexpr std::uint32_t zigzag( std::uint32_t value ) noexcept
+{
+  return value << 1 ^ ( std::uint32_t )( ( std::int32_t )value >> 31 );
+}
+
+constexpr std::uint32_t unzigzag( std::uint32_t value ) noexcept
+{
+  return value >> 1 ^ ( 0 - ( value & 1 ) );
+}
+
+// Index of the lowest bit set, `mask` can't be 0.
+inline std::uint32_t lowest_bit( std::uint32_t mask ) noexcept
+{
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward( &index, mask );
+  return index;
+#else
+  return ( std::uint32_t )__builtin_ctz( mask );
+#endif
+}
+
+inline std::uint8_t *put_varint( std::uint8_t *out, std::uint64_t value ) noexcept
+{
+  while ( value >= 0x80 )
+  {
+    *out++ = std::uint8_t( value | 0x80 );
+    value >>= 7;
+  }
+
+  *out++ = std::uint8_t( value );
+  return out;
+}
+
+// Returns nullptr if the varint doesn't end before `end`, or doesn't fit 64 bits.
+inline std::uint8_t const *get_varint( std::uint8_t const *in, std::uint8_t const *end, std::uint64_t &value ) noexcept
+{
+  value = 0;
+
+  for ( int shift = 0; in != end && shift < 64; shift += 7 )
+  {
+    auto const byte = *in++;
+    value |= std::uint64_t( byte & 0x7F ) << shift;
+
+    if ( !( byte & 0x80 ) )
+      return in;
+  }
+
+  return nullptr;
+}
+
+/* * * * * * *
+ *           *
+ * LZ77      *
+ *           *
+ * * * * * * */
+
+/**
+ * A sequence of (literals, match) pairs:
+ * varint literals count, the literals, varint offset, varint match length - `min_match`.
+ * The last pair has the literals only, and it's always present.
+ **/
+constexpr std::uint32_t min_match{ 4 };
+constexpr std::uint32_t lz_hash_bits{ 13 };
+
+inline std::uint32_t load32( std::uint8_t const *bytes ) noexcept
+{
+  std::uint32_t value;
+  std::memcpy( &value, bytes, 4 );
+  return value;
+}
+
+std::uint32_t lz_compress( std::uint8_t const *src, std::uint32_t size, std::uint8_t *dst ) noexcept
+{
+  std::unique_ptr<std::uint32_t[]> table( new ( std::nothrow ) std::uint32_t[1 << lz_hash_bits]() ); // position + 1, 0 is empty
+  if ( !table )
+    return 0;
+
+  std::uint8_t *out = dst;
+  std::uint8_t *const out_end = dst + size;
+
+  std::uint32_t anchor = 0;
+  std::uint32_t i = 0;
+
+  while ( i + min_match <= size )
+  {
+    auto const sequence = load32( src + i );
+    auto &slot = table[( sequence * 2654435761u ) >> ( 32 - lz_hash_bits )];
+
+    auto const candidate = slot;
+    slot = i + 1;
+
+    if ( !candidate || load32( src + candidate - 1 ) != sequence )
+    {
+      ++i;
+      continue;
+    }
+
+    auto const match = candidate - 1;
+
+    std::uint32_t length = min_match;
+    while ( i + length < size && src[match + length] == src[i + length] )
+      ++length;
+
+    auto const literals = i - anchor;
+    if ( out_end - out <= std::ptrdiff_t( 5 + literals + 5 + 5 ) )
+      return 0;
+
+    out = put_varint( out, literals );
+    out = std::copy_n( src + anchor, literals, out );
+    out = put_varint( out, i - match );
+    out = put_varint( out, length - min_match );
+
+    i += length;
+    anchor = i;
+  }
+
+  auto const literals = size - anchor;
+  if ( out_end - out <= std::ptrdiff_t( 5 + literals ) )
+    return 0;
+
+  out = put_varint( out, literals );
+  out = std::copy_n( src + anchor, literals, out );
+
+  return ( std::uint32_t )( out - dst );
+}
+
+bool lz_decompress( std::uint8_t const *src, std::uint32_t size, std::uint8_t *dst, std::uint32_t dst_size ) noexcept
+{
+  auto const *in = src;
+  auto const *const end = src + size;
+
+  std::uint32_t out = 0;
+
+  while ( true )
+  {
+    std::uint64_t literals;
+    if ( !( in = get_varint( in, end, literals ) ) || literals > std::uint64_t( end - in ) || literals > dst_size - out )
+      return true;
+
+    std::copy_n( in, literals, dst + out );
+    in += literals;
+    out += ( std::uint32_t )literals;
+
+    if ( in == end )
+      return out != dst_size;
+
+    std::uint64_t offset, length;
+    if ( !( in = get_varint( in, end, offset ) ) || !( in = get_varint( in, end, length ) ) )
+      return true;
+
+    length += min_match;
+
+    if ( !offset || offset > out || length > dst_size - out )
+      return true;
+
+    // The match can overlap the bytes being copied
+    for ( std::uint32_t from = out - ( std::uint32_t )offset; length--; )
+      dst[out++] = dst[from++];
+  }
+}
+
+/* * * * * * * *
+ *             *
+ * TRACEWRITER *
+ *             *
+ * * * * * * * */
+
+TraceWriter::~TraceWriter()
+{
+  close();
+}
+
+bool TraceWriter::open( char const *path, std::uint32_t pc, std::array<std::uint32_t, 32> const &gpr, std::array<FPR, 32> const &fpr ) noexcept
+{
+  TraceHeader header{};
+  header.magic = trace_magic_tag;
+  header.version = trace_version_tag;
+  header.pc = pc;
+
+  for ( std::uint32_t i = 0; i < 32; ++i )
+  {
+    header.gpr[i] = this->gpr[i] = gpr[i];
+    header.fpr[i] = this->fpr[i] = fpr[i].i64;
+  }
+
+  next_pc = pc;
+
+  file = std::fopen( path, "wb" );
+  if ( !file )
+    return true;
+
+  if ( std::fwrite( &header, sizeof( header ), 1, file ) != 1 )
+  {
+    std::fclose( file );
+    file = nullptr;
+    return true;
+  }
+
+  block.resize( block_size );
+  thread = std::thread( &TraceWriter::write_blocks, this );
+
+  return false;
+}
+
+void TraceWriter::record( std::uint32_t pc, std::uint32_t word, std::array<std::uint32_t, 32> const &gpr, std::uint32_t written,
+                          std::array<FPR, 32> const *fpr, Store const *stores, std::uint32_t stores_no ) noexcept
+{
+  if ( used > block_size - max_record_size )
+    flush();
+
+  auto *const begin = block.data() + used;
+  auto *out = begin + 1;
+
+  std::uint8_t flags = 0;
+
+  if ( pc != next_pc )
+  {
+    flags |= record_jump;
+    out = put_varint( out, zigzag( pc - next_pc ) );
+  }
+
+  next_pc = pc + 4;
+
+  auto *const recent = recent_words.data() + recent_slot( pc );
+  if ( recent[0] != pc || recent[1] != word )
+  {
+    flags |= record_word;
+    recent[0] = pc;
+    recent[1] = word;
+
+    std::memcpy( out, &word, 4 );
+    out += 4;
+  }
+
+  std::uint32_t changed = 0;
+  for ( auto candidates = written & ~1u; candidates; candidates &= candidates - 1 )
+  {
+    auto const i = lowest_bit( candidates );
+    changed |= std::uint32_t( gpr[i] != this->gpr[i] ) << i;
+  }
+
+  if ( auto mask = changed )
+  {
+    flags |= record_gpr;
+    out = put_varint( out, mask );
+
+    for ( ; mask; mask &= mask - 1 )
+    {
+      auto const i = lowest_bit( mask );
+      out = put_varint( out, zigzag( gpr[i] - this->gpr[i] ) );
+      this->gpr[i] = gpr[i];
+    }
+  }
+
+  if ( fpr )
+  {
+    std::uint32_t mask = 0;
+    for ( std::uint32_t i = 0; i < 32; ++i )
+      mask |= std::uint32_t( ( *fpr )[i].i64 != this->fpr[i] ) << i;
+
+    if ( mask )
+    {
+      flags |= record_fpr;
+      out = put_varint( out, mask );
+
+      for ( ; mask; mask &= mask - 1 )
+      {
+        auto const i = lowest_bit( mask );
+        out = put_varint( out, ( *fpr )[i].i64 ^ this->fpr[i] );
+        this->fpr[i] = ( *fpr )[i].i64;
+      }
+    }
+  }
+
+  if ( stores_no )
+  {
+    flags |= record_stores;
+    out = put_varint( out, stores_no );
+
+    for ( std::uint32_t i = 0; i < stores_no; ++i )
+    {
+      out = put_varint( out, zigzag( stores[i].address - last_store ) );
+      out = put_varint( out, stores[i].value );
+      last_store = stores[i].address;
+    }
+  }
+
+  *begin = flags;
+  used += ( std::uint32_t )( out - begin );
+  ++records;
+}
+
+void TraceWriter::flush() noexcept
+{
+  block.resize( used );
+
+  std::unique_lock<std::mutex> lock( mutex );
+  changed.wait( lock, [this] { return pending.size() < max_pending; } );
+
+  pending.push_back( std::move( block ) );
+
+  if ( spare.empty() )
+    block = std::vector<std::uint8_t>();
+  else
+  {
+    block = std::move( spare.back() );
+    spare.pop_back();
+  }
+
+  lock.unlock();
+  changed.notify_all();
+
+  block.resize( block_size );
+  used = 0;
+}
+
+bool TraceWriter::close() noexcept
+{
+  if ( !file )
+    return true;
+
+  if ( used )
+    flush();
+
+  {
+    std::lock_guard<std::mutex> lock( mutex );
+    closing = true;
+  }
+
+  changed.notify_all();
+  thread.join();
+
+  TraceBlockHeader const end{ 0, 0, 0 };
+
+  bool failed = write_failed
+    || std::fwrite( &end, sizeof( end ), 1, file ) != 1
+    || std::fwrite( &records, sizeof( records ), 1, file ) != 1;
+
+  failed = std::fclose( file ) || failed;
+  file = nullptr;
+
+  return failed;
+}
+
+void TraceWriter::write_blocks() noexcept
+{
+  std::vector<std::uint8_t> compressed( block_size );
+
+  std::unique_lock<std::mutex> lock( mutex );
+
+  while ( true )
+  {
+    changed.wait( lock, [this] { return closing || !pending.empty(); } );
+
+    if ( pending.empty() )
+      return;
+
+    auto raw = std::move( pending.front() );
+    pending.pop_front();
+
+    lock.unlock();
+    changed.notify_all();
+
+    TraceBlockHeader header{};
+    header.size = ( std::uint32_t )raw.size();
+
+    header.stored_size = lz_compress( raw.data(), header.size, compressed.data() );
+
+    auto const *stored = header.stored_size ? compressed.data() : raw.data();
+    if ( !header.stored_size )
+      header.stored_size = header.size;
+
+    header.crc = crc32( stored, header.stored_size );
+
+    bool const failed = std::fwrite( &header, sizeof( header ), 1, file ) != 1
+      || std::fwrite( stored, 1, header.stored_size, file ) != header.stored_size;
+
+    lock.lock();
+
+    write_failed = write_failed || failed;
+    spare.push_back( std::move( raw ) );
+  }
+}
+
+/* * * * * * * *
+ *             *
+ * TRACEREADER *
+ *             *
+ * * * * * * * */
+
+inline namespace v0
+{
+class TraceReaderImpl
+{
+public:
+  explicit TraceReaderImpl( char const *path ) noexcept;
+
+  ~TraceReaderImpl();
+
+  TraceReader::Record const &initial_state() const noexcept { return initial; }
+
+  bool read( TraceReader::Record &record ) noexcept;
+
+  bool failed() const noexcept { return corrupted; }
+
+private:
+  // Loads the next block, returns false at the end of the trace, or if corrupted.
+  bool next_block() noexcept;
+
+  // Decodes a record from the current block into `state`, returns false if corrupted.
+  bool decode( TraceReader::Record &state ) noexcept;
+
+  std::FILE *file{ nullptr };
+  bool       corrupted{ true };
+  bool       ended{ false };
+
+  std::vector<std::uint8_t> block;
+  std::vector<std::uint8_t> stored;
+  std::uint32_t             position{ 0 };
+
+  TraceReader::Record initial{};
+  TraceReader::Record state{};
+
+  std::uint32_t                       next_pc{ 0 };
+  std::uint32_t                       last_store{ 0 };
+  std::array<std::uint32_t, 2 * 1024> recent_words{};
+};
+} // namespace v0
+
+TraceReader::TraceReader( char const *path ) noexcept : _impl( new TraceReaderImpl( path ) ) {}
+
+TraceReader::~TraceReader() { delete _impl; }
+
+TraceReader::Record const &TraceReader::initial_state() const noexcept { return _impl->initial_state(); }
+
+bool TraceReader::read( Record &record ) noexcept { return _impl->read( record ); }
+
+bool TraceReader::failed() const noexcept { return _impl->failed(); }
+
+v0::TraceReaderImpl::TraceReaderImpl( char const *path ) noexcept
+{
+  file = std::fopen( path, "rb" );
+  if ( !file )
+    return;
+
+  TraceHeader header;
+  if ( std::fread( &header, sizeof( header ), 1, file ) != 1 || header.magic != trace_magic_tag || header.version != trace_version_tag )
+    return;
+
+  initial.pc = header.pc;
+
+  for ( std::uint32_t i = 0; i < 32; ++i )
+  {
+    initial.gpr[i] = header.gpr[i];
+    initial.fpr[i].i64 = header.fpr[i];
+  }
+
+  state = initial;
+  next_pc = header.pc;
+  corrupted = false;
+}
+
+v0::TraceReaderImpl::~TraceReaderImpl()
+{
+  if ( file )
+    std::fclose( file );
+}
+
+bool v0::TraceReaderImpl::read( TraceReader::Record &record ) noexcept
+{
+  if ( corrupted || ended )
+    return true;
+
+  if ( position == block.size() && !next_block() )
+    return true;
+
+  if ( !decode( state ) )
+  {
+    corrupted = true;
+    return true;
+  }
+
+  record.index = state.index++;
+  record.pc = state.pc;
+  record.word = state.word;
+  record.gpr_changed = state.gpr_changed;
+  record.fpr_changed = state.fpr_changed;
+  record.gpr = state.gpr;
+  record.fpr = state.fpr;
+  record.stores.assign( state.stores.begin(), state.stores.end() );
+
+  return false;
+}
+
+bool v0::TraceReaderImpl::next_block() noexcept
+{
+  TraceBlockHeader header;
+
+  if ( std::fread( &header, sizeof( header ), 1, file ) != 1 )
+  {
+    corrupted = true; // the trace hasn't been closed
+    return false;
+  }
+
+  if ( !header.size )
+  {
+    std::uint64_t records;
+    corrupted = std::fread( &records, sizeof( records ), 1, file ) != 1 || records != state.index;
+    ended = true;
+    return false;
+  }
+
+  if ( header.size > TraceWriter::block_size || header.stored_size > header.size )
+  {
+    corrupted = true;
+    return false;
+  }
+
+  stored.resize( header.stored_size );
+  block.resize( header.size );
+  position = 0;
+
+  corrupted = std::fread( stored.data(), 1, stored.size(), file ) != stored.size()
+    || crc32( stored.data(), stored.size() ) != header.crc;
+
+  if ( !corrupted && header.stored_size < header.size )
+    corrupted = lz_decompress( stored.data(), header.stored_size, block.data(), header.size );
+  else if ( !corrupted )
+    block.swap( stored );
+
+  return !corrupted;
+}
+
+bool v0::TraceReaderImpl::decode( TraceReader::Record &record ) noexcept
+{
+  auto const *in = block.data() + position;
+  auto const *const end = block.data() + block.size();
+
+  std::uint64_t value;
+
+  auto const flags = *in++;
+
+  record.pc = next_pc;
+  if ( flags & record_jump )
+  {
+    if ( !( in = get_varint( in, end, value ) ) )
+      return false;
+
+    record.pc += unzigzag( ( std::uint32_t )value );
+  }
+
+  next_pc = record.pc + 4;
+
+  auto *const recent = recent_words.data() + recent_slot( record.pc );
+  if ( flags & record_word )
+  {
+    if ( end - in < 4 )
+      return false;
+
+    std::memcpy( &record.word, in, 4 );
+    in += 4;
+
+    recent[0] = record.pc;
+    recent[1] = record.word;
+  }
+  else if ( recent[0] == record.pc )
+    record.word = recent[1];
+  else
+    return false;
+
+  record.gpr_changed = 0;
+  if ( flags & record_gpr )
+  {
+    if ( !( in = get_varint( in, end, value ) ) )
+      return false;
+
+    record.gpr_changed = ( std::uint32_t )value;
+
+    for ( auto mask = record.gpr_changed; mask; mask &= mask - 1 )
+    {
+      if ( !( in = get_varint( in, end, value ) ) )
+        return false;
+
+      record.gpr[lowest_bit( mask )] += unzigzag( ( std::uint32_t )value );
+    }
+  }
+
+  record.fpr_changed = 0;
+  if ( flags & record_fpr )
+  {
+    if ( !( in = get_varint( in, end, value ) ) )
+      return false;
+
+    record.fpr_changed = ( std::uint32_t )value;
+
+    for ( auto mask = record.fpr_changed; mask; mask &= mask - 1 )
+    {
+      if ( !( in = get_varint( in, end, value ) ) )
+        return false;
+
+      record.fpr[lowest_bit( mask )].i64 ^= value;
+    }
+  }
+
+  record.stores.clear();
+  if ( flags & record_stores )
+  {
+    std::uint64_t count;
+    if ( !( in = get_varint( in, end, count ) ) || count > 3 )
+      return false;
+
+    while ( count-- )
+    {
+      std::uint64_t address;
+      if ( !( in = get_varint( in, end, address ) ) || !( in = get_varint( in, end, value ) ) )
+        return false;
+
+      last_store += unzigzag( ( std::uint32_t )address );
+      record.stores.push_back( { last_store, ( std::uint32_t )value } );
+    }
+  }
+
+  position = ( std::uint32_t )( in - block.data() );
+  return true;
+}
+} // namespace mips32
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <mips32/fpr.hpp>
+#include <mips32/trace.hpp>
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mips32
+{
+// Compresses `size` bytes with a byte-oriented LZ77 into `dst`, that must hold `size` bytes.
+// Returns the size of the compressed bytes, or 0 if they aren't smaller than `size`.
+std::uint32_t lz_compress( std::uint8_t const *src, std::uint32_t size, std::uint8_t *dst ) noexcept;
+
+// Decompresses `size` bytes into `dst`, that must hold exactly `dst_size` bytes.
+// Returns:
+// `true`  - in case of *failure*, the bytes don't decompress exactly into `dst_size` bytes
+// `false` - in case of success
+bool lz_decompress( std::uint8_t const *src, std::uint32_t size, std::uint8_t *dst, std::uint32_t dst_size ) noexcept;
+
+/**
+ * Writes an execution trace, see `TraceReader` for its content.
+ *
+ * The CPU encodes the records into a block, when it's full the block is queued
+ * to a background thread, that compresses and writes it.
+ * The CPU waits only if the thread is behind by more blocks than `max_pending`.
+ **/
+class TraceWriter
+{
+public:
+  using Store = TraceReader::Store;
+
+  static inline constexpr std::uint32_t block_size{ 64 * 1024 };
+  static inline constexpr std::uint32_t max_pending{ 8 };
+
+  TraceWriter() noexcept = default;
+
+  TraceWriter( TraceWriter const & ) = delete;
+  TraceWriter &operator=( TraceWriter const & ) = delete;
+
+  // Closes the trace, if still open.
+  ~TraceWriter();
+
+  // Creates the file `path`, starting with the given registers.
+  // Returns:
+  // `true`  - in case of *failure*
+  // `false` - in case of success
+  bool open( char const *path, std::uint32_t pc, std::array<std::uint32_t, 32> const &gpr, std::array<FPR, 32> const &fpr ) noexcept;
+
+  // Appends the instruction `word` at `pc`, `gpr` and `fpr` are the registers after it.
+  // Only the GPRs set in `written` are compared, `fpr` is nullptr if the instruction can't change them.
+  void record( std::uint32_t pc, std::uint32_t word, std::array<std::uint32_t, 32> const &gpr, std::uint32_t written,
+               std::array<FPR, 32> const *fpr, Store const *stores, std::uint32_t stores_no ) noexcept;
+
+  // Writes the pending blocks, then the end of the trace.
+  // Returns:
+  // `true`  - in case of *failure*, the trace is incomplete
+  // `false` - in case of success
+  bool close() noexcept;
+
+private:
+  // Queues the current block to the thread.
+  void flush() noexcept;
+
+  // Body of the thread, writes the queued blocks until closed.
+  void write_blocks() noexcept;
+
+  std::FILE *file{ nullptr };
+
+  std::vector<std::uint8_t> block; // being encoded, `block_size` bytes
+  std::uint32_t             used{ 0 };
+  std::uint64_t             records{ 0 };
+
+  // The state replayed by the reader too, see `TraceReader`
+  std::uint32_t                        next_pc;
+  std::array<std::uint32_t, 32>        gpr;
+  std::array<std::uint64_t, 32>        fpr;
+  std::uint32_t                        last_store{ 0 };
+  std::array<std::uint32_t, 2 * 1024>  recent_words{}; // (pc, word) pairs, direct mapped by PC
+
+  std::thread                           thread;
+  std::mutex                            mutex;
+  std::condition_variable               changed;
+  std::deque<std::vector<std::uint8_t>> pending;
+  std::vector<std::vector<std::uint8_t>> spare;   // blocks written, reused
+  bool                                  closing{ false };
+  bool                                  write_failed{ false };
+};
+} // namespace mips32
@@ -8,7 +8,7 @@ std::uint32_t FileManager::open( char const * name, char const * flags ) noexcep
   return fd_value;
 }
 
-std::uint32_t FileManager::read( std::uint32_t fd, char const * dst, std::uint32_t count ) noexcept
+std::uint32_t FileManager::read( std::uint32_t fd, char * dst, std::uint32_t count ) noexcept
 {
   param.fd = fd;
   param.dst = dst;
@@ -33,3 +33,10 @@ void FileManager::close( std::uint32_t fd ) noexcept
 
 FileManager::~FileManager()
 {}
+
+std::intptr_t FileManager::native_handle( std::uint32_t fd ) noexcept
+{
+  param.fd = fd;
+
+  return handle;
+}
@@ -9,12 +9,14 @@ class FileManager : public mips32::FileHandler
 public:
   virtual std::uint32_t open( char const *name, char const *flags ) noexcept;
 
-  virtual std::uint32_t read( std::uint32_t fd, char const *dst, std::uint32_t count ) noexcept;
+  virtual std::uint32_t read( std::uint32_t fd, char *dst, std::uint32_t count ) noexcept;
 
   virtual std::uint32_t write( std::uint32_t fd, char const *src, std::uint32_t count ) noexcept;
 
   virtual void close( std::uint32_t fd ) noexcept;
 
+  virtual std::intptr_t native_handle( std::uint32_t fd ) noexcept;
+
   virtual ~FileManager();
 
   inline void reset()
@@ -23,6 +25,7 @@ public:
     param.flags.clear();
     param.dst = param.src = nullptr;
     param.fd = param.count = 0;
+    handle = -1;
   }
 
   struct Param
@@ -37,4 +40,6 @@ public:
   static constexpr std::uint32_t write_count{ 142 };
 
   Param param{};
+
+  std::intptr_t handle{ -1 }; // returned by `native_handle`
 };
\ No newline at end of file
@@ -60,8 +60,10 @@ constexpr std::uint32_t operator""_cpu( char const *s, std::size_t n ) noexcept
       {"BOVC"sv, 0b001'000 << 26},
       {"BNVC"sv, 0b011'000 << 26},
       {"BREAK"sv, 0b001'101},
+      {"CFC1"sv, 0b010'001 << 26 | 0b010 << 21},
       {"CLO"sv, std::uint32_t( 0b1'010'001 )},
       {"CLZ"sv, std::uint32_t( 0b1'010'000 )},
+      {"CTC1"sv, 0b010'001 << 26 | 0b110 << 21},
       {"DI"sv, 0b010'000 << 26 | 0b01'011 << 21 | 0b01'100 << 11},
       {"DIV"sv, 0b00'010 << 6 | 0b011'010},
       {"MOD"sv, 0b00'011 << 6 | 0b011'010},
@@ -82,6 +84,7 @@ constexpr std::uint32_t operator""_cpu( char const *s, std::size_t n ) noexcept
       {"LDC1"sv, std::uint32_t( 0b110'101 ) << 26},
       {"LH"sv, std::uint32_t( 0b100'001 ) << 26},
       {"LHU"sv, std::uint32_t( 0b100'101 ) << 26},
+      {"LL"sv, 0b011'111 << 26 | 0b110'110},
       {"LSA"sv, 0b000'101},
       {"LUI"sv, 0b001'111 << 26},
       {"LW"sv, std::uint32_t( 0b100'011 ) << 26 },
@@ -108,6 +111,7 @@ constexpr std::uint32_t operator""_cpu( char const *s, std::size_t n ) noexcept
       {"ROTR"sv, 1 << 21 | 0b10},
       {"ROTRV"sv, 1 << 6 | 0b110},
       {"SB"sv, std::uint32_t( 0b101'000 ) << 26},
+      {"SC"sv, 0b011'111 << 26 | 0b100'110},
       {"SDC1"sv, std::uint32_t( 0b111'101 ) << 26},
       {"SELEQZ"sv, 0b110'101},
       {"SELNEZ"sv, 0b110'111},
@@ -127,6 +131,7 @@ constexpr std::uint32_t operator""_cpu( char const *s, std::size_t n ) noexcept
       {"SUBU"sv, 0b100'011},
       {"SW"sv, std::uint32_t( 0b101'011 ) << 26},
       {"SWC1"sv, std::uint32_t( 0b111'001 ) << 26},
+      {"SYNC"sv, 0b001'111},
       {"SYSCALL"sv, 0b001'100},
       {"TEQ"sv, 0b110'100},
       {"TGE"sv, 0b110'000},
@@ -161,6 +166,10 @@ constexpr std::uint32_t operator""_shamt( unsigned long long int v ) noexcept
 {
   return std::uint32_t( v & 0x1F ) << 6;
 }
+constexpr std::uint32_t operator""_off9( unsigned long long int v ) noexcept
+{
+  return ( std::uint32_t( v ) & 0x1FF ) << 7;
+}
 constexpr std::uint32_t operator""_imm16( unsigned long long int v ) noexcept
 {
   return std::uint32_t( v ) & 0xFFFF;
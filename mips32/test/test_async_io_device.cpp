@@ -0,0 +1,76 @@
+#include <catch.hpp>
+
+#include <mips32/async_io_device.hpp>
+#include "helpers/Terminal.hpp"
+
+#include <string>
+
+using namespace mips32;
+
+// Keeps the entire output, in order
+class Transcript : public Terminal
+{
+public:
+  void print_integer( std::uint32_t value ) noexcept override
+  {
+    output += std::to_string( ( std::int32_t )value );
+  }
+
+  void print_string( char const *string ) noexcept override
+  {
+    output += string;
+  }
+
+  void flush() noexcept override
+  {
+    ++flushes;
+  }
+
+  std::string output;
+  int         flushes = 0;
+};
+
+TEST_CASE( "An AsyncIODevice forwards the output from another thread" )
+{
+  Transcript transcript;
+
+  SECTION( "in order, even when the ring is full" )
+  {
+    std::string expected;
+
+    {
+      AsyncIODevice device{ &transcript, 4 };
+
+      for ( int i = 0; i < 1000; ++i )
+      {
+        device.print_integer( ( std::uint32_t )i );
+        device.print_string( "," );
+        expected += std::to_string( i ) + ",";
+      }
+
+      // Split in multiple records
+      std::string const long_string( 1000, 'z' );
+      device.print_string( long_string.c_str() );
+      expected += long_string;
+    }
+
+    REQUIRE( transcript.output == expected );
+    REQUIRE( transcript.flushes == 1 );
+  }
+
+  SECTION( "and synchronizes before an input" )
+  {
+    AsyncIODevice device{ &transcript };
+
+    device.print_string( "Insert a number: " );
+    device.print_float( 2.5f );
+
+    std::uint32_t value = 0;
+    device.read_integer( &value );
+
+    REQUIRE( transcript.output == "Insert a number: " );
+    REQUIRE( transcript.out_float == 2.5f );
+    REQUIRE( transcript.flushes == 1 );
+    REQUIRE( value == transcript.in_int );
+  }
+}
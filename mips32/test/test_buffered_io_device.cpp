@@ -0,0 +1,52 @@
+#include <catch.hpp>
+
+#include <mips32/buffered_io_device.hpp>
+#include "helpers/Terminal.hpp"
+
+#include <string>
+
+using namespace mips32;
+
+TEST_CASE( "A BufferedIODevice batches the output" )
+{
+  Terminal terminal;
+  BufferedIODevice device{ &terminal, -1, 64 };
+
+  device.print_integer( ( std::uint32_t )-42 );
+  device.print_string( " " );
+  device.print_float( 1.5f );
+  device.print_string( " ", 1 );
+  device.print_double( 0.1 );
+
+  SECTION( "until it's flushed" )
+  {
+    REQUIRE( terminal.out_string.empty() );
+
+    device.flush();
+    REQUIRE( terminal.out_string == "-42 1.5 0.1" );
+  }
+
+  SECTION( "until an input is requested" )
+  {
+    std::uint32_t value = 0;
+    device.read_integer( &value );
+
+    REQUIRE( terminal.out_string == "-42 1.5 0.1" );
+    REQUIRE( value == terminal.in_int );
+  }
+
+  SECTION( "until the buffer is full" )
+  {
+    std::string const string( 60, 'x' );
+    device.print_string( string.c_str() );
+    REQUIRE( terminal.out_string == "-42 1.5 0.1" );
+
+    device.flush();
+    REQUIRE( terminal.out_string == string );
+
+    // Bigger than the buffer, it's written in chunks
+    std::string const big( 100, 'y' );
+    device.print_string( big.c_str() );
+    REQUIRE( terminal.out_string == std::string( 100 - 64, 'y' ) );
+  }
+}
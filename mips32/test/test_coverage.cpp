@@ -0,0 +1,119 @@
+#include <catch.hpp>
+
+#include <mips32/machine.hpp>
+#include "../src/cpu.hpp"
+
+#include "helpers/test_cpu_instructions.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <numeric>
+
+using namespace mips32;
+using namespace mips32::literals;
+
+using ui32 = std::uint32_t;
+
+using CoverageMap = std::array<std::uint8_t, 64 * 1024>;
+
+// Loops `iterations` times, so the backward branch is taken `iterations - 1` times
+void write_loop( MachineInspector &inspector, std::uint16_t iterations )
+{
+  ui32 const program[] = {
+    "ADDIU"_cpu | 8_rt | ui32( iterations ),
+    "ADDIU"_cpu | 8_rt | 8_rs | 0xFFFF_imm16,   // loop:
+    "BNE"_cpu | 8_rs | 0_rt | 0xFFFE_imm16,     // loop
+    "ADDIU"_cpu | 2_rt | 10_imm16,              // exit
+    "SYSCALL"_cpu,
+  };
+  inspector.RAM_write( 0xBFC0'0000, program, sizeof( program ) );
+}
+
+std::uint32_t edges_hit( CoverageMap const &map )
+{
+  return ( std::uint32_t )std::count_if( map.begin(), map.end(), []( std::uint8_t counter ) { return counter != 0; } );
+}
+
+std::uint32_t hits( CoverageMap const &map )
+{
+  return std::accumulate( map.begin(), map.end(), 0u );
+}
+
+TEST_CASE( "The edges taken are counted into the coverage map" )
+{
+  Machine machine{ 1024 * 1024, nullptr, nullptr };
+  machine.reset();
+
+  auto inspector = machine.get_inspector();
+
+  CoverageMap map{};
+  REQUIRE_FALSE( machine.attach_coverage( map.data(), ( ui32 )map.size() ) );
+
+  SECTION( "A branch taken more times hits the same edge" )
+  {
+    write_loop( inspector, 11 );
+
+    REQUIRE( machine.start() == CPU::EXIT );
+    REQUIRE( edges_hit( map ) == 1 );
+    REQUIRE( hits( map ) == 10 );
+
+    // The same path hits the same edge
+    machine.reset();
+    REQUIRE( machine.start() == CPU::EXIT );
+    REQUIRE( edges_hit( map ) == 1 );
+    REQUIRE( hits( map ) == 20 );
+  }
+
+  SECTION( "The counters wrap skipping 0" )
+  {
+    write_loop( inspector, 257 );
+
+    REQUIRE( machine.start() == CPU::EXIT );
+    REQUIRE( edges_hit( map ) == 1 );
+    REQUIRE( hits( map ) == 1 );
+  }
+
+  SECTION( "The fork server runs with the coverage" )
+  {
+    write_loop( inspector, 5 );
+
+    REQUIRE_FALSE( machine.capture( 0xBFC0'0008 ) );
+    REQUIRE( edges_hit( map ) == 0 );
+
+    REQUIRE( machine.start() == CPU::EXIT );
+    REQUIRE( hits( map ) == 4 );
+
+    map.fill( 0 );
+    REQUIRE_FALSE( machine.rewind() );
+    REQUIRE( machine.start() == CPU::EXIT );
+    REQUIRE( hits( map ) == 4 );
+  }
+
+  SECTION( "A detached map isn't touched" )
+  {
+    write_loop( inspector, 11 );
+
+    REQUIRE_FALSE( machine.attach_coverage( nullptr, 0 ) );
+    REQUIRE( machine.start() == CPU::EXIT );
+    REQUIRE( edges_hit( map ) == 0 );
+
+    // Single stepping is covered too
+    REQUIRE_FALSE( machine.attach_coverage( map.data(), ( ui32 )map.size() ) );
+    machine.reset();
+
+    while ( machine.single_step() == CPU::NONE )
+      ;
+
+    REQUIRE( hits( map ) == 10 );
+  }
+
+  SECTION( "The map must fit the machine" )
+  {
+    REQUIRE( machine.attach_coverage( map.data(), 1000 ) );
+    REQUIRE( machine.attach_coverage( map.data(), 0 ) );
+
+    Machine smp{ 1024 * 1024, nullptr, nullptr, 2 };
+    REQUIRE( smp.attach_coverage( map.data(), ( ui32 )map.size() ) );
+  }
+}
@@ -84,8 +84,6 @@ struct INF<double>
   constexpr operator double() noexcept { return std::numeric_limits<double>::infinity(); }
 };
 
-// TODO: provoke FPU exception
-
 TEST_CASE( "A Coprocessor 1 object exists and is resetted" )
 {
   CP1 cp1;
@@ -1315,8 +1313,9 @@ TEST_CASE( "A Coprocessor 1 object exists and is resetted" )
 
     f1->d = 7202.0;
 
-    auto res_s = 9.0f - ( 40'000.0f / 2.0f );
-    auto res_d = 7202.0 - ( 7202.0 / 7202.0 );
+    // fd - fs * ft
+    auto res_s = 9.0f - 80'000.0f;
+    auto res_d = 7202.0 - 51'868'804.0;
 
     auto rs = cp1.execute( msubf_s );
     auto rd = cp1.execute( msubf_d );
@@ -1326,6 +1325,22 @@ TEST_CASE( "A Coprocessor 1 object exists and is resetted" )
 
     REQUIRE( f9->f == res_s );
     REQUIRE( f1->d == res_d );
+
+    SECTION( "The product isn't rounded before the subtraction" )
+    {
+      for ( auto const soft : { false, true } )
+      {
+        inspector.CP1_soft_float( soft );
+
+        // (1 + 2^-30)^2 = 1 + 2^-29 + 2^-60, rounded to 1 + 2^-29 on its own
+        f1->d = 1.0 + std::ldexp( 1.0, -29 );
+        f21->d = 1.0 + std::ldexp( 1.0, -30 );
+        f13->d = f21->d;
+
+        REQUIRE( cp1.execute( "MSUBF"_cp1 | FMT_D | 1_r1 | 21_r2 | 13_r3 ) == CP1::Exception::NONE );
+        REQUIRE( f1->d == -std::ldexp( 1.0, -60 ) );
+      }
+    }
   }
 
   SECTION( "MAX.S $f5, $f8, $f0 and MAX.D $f0, $f11, $f11 are executed" )
@@ -1890,6 +1905,73 @@ TEST_CASE( "A Coprocessor 1 object exists and is resetted" )
     REQUIRE( f4->i32 == res_d );
   }
 
+  SECTION( "DIV.S $f1, $f2, $f3 divides by zero without the exception enabled, it's only flagged" )
+  {
+    auto div_s = "DIV"_cp1 | FMT_S | 1_r1 | 2_r2 | 3_r3;
+
+    auto f1 = FP( 1 );
+    auto f2 = FP( 2 );
+    auto f3 = FP( 3 );
+
+    f2->f = 1.0f;
+    f3->f = 0.0f;
+
+    cp1.write( 31, 0 );
+
+    REQUIRE( cp1.execute( div_s ) == CP1::Exception::NONE );
+    REQUIRE( std::isinf( f1->f ) );
+
+    auto const fcsr = cp1.read( 31 );
+    REQUIRE( ( fcsr >> 2 & 0x1F ) == CP1::Exception::DIVBYZERO );
+    REQUIRE( ( fcsr >> 12 & 0x3F ) == CP1::Exception::DIVBYZERO );
+
+    // The flags are sticky
+    f3->f = 2.0f;
+    REQUIRE( cp1.execute( div_s ) == CP1::Exception::NONE );
+    REQUIRE( ( cp1.read( 31 ) >> 2 & 0x1F ) == CP1::Exception::DIVBYZERO );
+  }
+
+  SECTION( "DIV.D $f4, $f5, $f6 divides by zero with the exception enabled, it's trapped" )
+  {
+    auto div_d = "DIV"_cp1 | FMT_D | 4_r1 | 5_r2 | 6_r3;
+
+    auto f4 = FP( 4 );
+    auto f5 = FP( 5 );
+    auto f6 = FP( 6 );
+
+    f4->d = 3.0;
+    f5->d = 1.0;
+    f6->d = 0.0;
+
+    cp1.write( 31, CP1::Exception::DIVBYZERO << 7 );
+
+    REQUIRE( ( cp1.execute( div_d ) & CP1::Exception::DIVBYZERO ) != 0 );
+    REQUIRE( f4->d == 3.0 );
+
+    // A trapped exception isn't flagged
+    REQUIRE( ( cp1.read( 31 ) >> 2 & 0x1F ) == 0 );
+  }
+
+  SECTION( "SQRT.S $f0, $f1 of a negative number is invalid, more exceptions are flagged at once" )
+  {
+    auto sqrt_s = "SQRT"_cp1 | FMT_S | 0_r1 | 1_r2;
+    auto mul_s = "MUL"_cp1 | FMT_S | 2_r1 | 3_r2 | 3_r3;
+
+    auto f1 = FP( 1 );
+    auto f3 = FP( 3 );
+
+    f1->f = -1.0f;
+    f3->f = std::numeric_limits<float>::max();
+
+    cp1.write( 31, 0 );
+
+    REQUIRE( cp1.execute( sqrt_s ) == CP1::Exception::NONE );
+    REQUIRE( cp1.execute( mul_s ) == CP1::Exception::NONE );
+
+    auto const flags = cp1.read( 31 ) >> 2 & 0x1F;
+    REQUIRE( flags == ( CP1::Exception::INVALID | CP1::Exception::OVERFLOW_ | CP1::Exception::INEXACT ) );
+  }
+
   SECTION( "I execute reserved instructions" )
   {
     constexpr std::uint32_t opcode{ 0b010001 << 26 };
@@ -1997,4 +2079,183 @@ TEST_CASE( "A Coprocessor 1 object exists and is resetted" )
   }
 }
 
+TEST_CASE( "A Coprocessor 1 object computes in software" )
+{
+  CP1 cp1;
+  cp1.reset();
+
+  MachineInspector inspector;
+
+  inspector.inspect( cp1 );
+
+  SECTION( "It's off by default, and isn't changed by a reset" )
+  {
+    REQUIRE( !inspector.CP1_soft_float() );
+
+    inspector.CP1_soft_float( true );
+    cp1.reset();
+
+    REQUIRE( inspector.CP1_soft_float() );
+  }
+
+  SECTION( "ADD, MUL, DIV, SQRT, MADDF and MSUBF compute the results and the flags of the host FPU" )
+  {
+    CP1 hard;
+    hard.reset();
+
+    MachineInspector hard_inspector;
+    hard_inspector.inspect( hard );
+
+    inspector.CP1_soft_float( true );
+
+    std::uint32_t const instructions[] = {
+        "ADD"_cp1 | FMT_S | 0_r1 | 1_r2 | 2_r3,   "ADD"_cp1 | FMT_D | 0_r1 | 1_r2 | 2_r3,
+        "MUL"_cp1 | FMT_S | 0_r1 | 1_r2 | 2_r3,   "MUL"_cp1 | FMT_D | 0_r1 | 1_r2 | 2_r3,
+        "DIV"_cp1 | FMT_S | 0_r1 | 1_r2 | 2_r3,   "DIV"_cp1 | FMT_D | 0_r1 | 1_r2 | 2_r3,
+        "SQRT"_cp1 | FMT_S | 0_r1 | 1_r2,         "SQRT"_cp1 | FMT_D | 0_r1 | 1_r2,
+        "MADDF"_cp1 | FMT_S | 0_r1 | 1_r2 | 2_r3, "MADDF"_cp1 | FMT_D | 0_r1 | 1_r2 | 2_r3,
+        "MSUBF"_cp1 | FMT_S | 0_r1 | 1_r2 | 2_r3, "MSUBF"_cp1 | FMT_D | 0_r1 | 1_r2 | 2_r3,
+    };
+
+    double const operands[][3] = {
+        { 1.0, 3.0, 0.5 }, { 1e30, 1e30, -7.25 }, { -2.0, 0.0, 1.0 }, { 0.1, 0.2, 0.3 }, { 2.0, 1e-40, 1e-320 },
+    };
+
+    for ( auto const word : instructions )
+    {
+      for ( auto const &operand : operands )
+      {
+        CP1 *const cp1s[] = { &hard, &cp1 };
+        MachineInspector *const inspectors[] = { &hard_inspector, &inspector };
+        std::uint64_t results[2];
+        std::uint32_t fcsrs[2];
+
+        for ( int i = 0; i < 2; ++i )
+        {
+          auto regs = inspectors[i]->CP1_fpr_begin();
+
+          if ( ( word & FMT_D ) == FMT_D )
+          {
+            regs[0].d = operand[0];
+            regs[1].d = operand[1];
+            regs[2].d = operand[2];
+          }
+          else
+          {
+            regs[0].i64 = 0;
+            regs[0].f = float( operand[0] );
+            regs[1].f = float( operand[1] );
+            regs[2].f = float( operand[2] );
+          }
+
+          cp1s[i]->write( 31, 0 );
+          cp1s[i]->bind_host_fpu();
+
+          REQUIRE( cp1s[i]->execute( word ) == CP1::Exception::NONE );
+
+          results[i] = regs[0].i64;
+          fcsrs[i] = cp1s[i]->read( 31 );
+        }
+
+        REQUIRE( results[0] == results[1] );
+        REQUIRE( fcsrs[0] == fcsrs[1] );
+      }
+    }
+  }
+
+  SECTION( "DIV.S $f0, $f1, $f2 rounds as FCSR.RM, even if the host FPU doesn't" )
+  {
+    auto div_s = "DIV"_cp1 | FMT_S | 0_r1 | 1_r2 | 2_r3;
+
+    auto f0 = FP( 0 );
+    auto f1 = FP( 1 );
+    auto f2 = FP( 2 );
+
+    inspector.CP1_soft_float( true );
+
+    f1->f = 1.0f;
+    f2->f = 3.0f;
+
+    cp1.write( 31, 0x2 ); // Up
+    std::fesetround( FE_DOWNWARD );
+    REQUIRE( cp1.execute( div_s ) == CP1::Exception::NONE );
+    auto const up = f0->f;
+
+    cp1.write( 31, 0x3 ); // Down
+    std::fesetround( FE_UPWARD );
+    REQUIRE( cp1.execute( div_s ) == CP1::Exception::NONE );
+    auto const down = f0->f;
+
+    std::fesetround( FE_TONEAREST );
+
+    REQUIRE( up == std::nextafter( down, 1.0f ) );
+    REQUIRE( ( cp1.read( 31 ) >> 2 & 0x1F ) == CP1::Exception::INEXACT );
+  }
+
+  SECTION( "MUL.D $f0, $f1, $f1 flushes a subnormal result, as FCSR.FS is set" )
+  {
+    auto mul_d = "MUL"_cp1 | FMT_D | 0_r1 | 1_r2 | 1_r3;
+
+    auto f0 = FP( 0 );
+    auto f1 = FP( 1 );
+
+    inspector.CP1_soft_float( true );
+
+    f0->d = 1.0;
+    f1->d = -1e-160;
+
+    REQUIRE( cp1.execute( mul_d ) == CP1::Exception::NONE );
+
+    REQUIRE( f0->d == 0.0 );
+    REQUIRE( !std::signbit( f0->d ) );
+    REQUIRE( ( cp1.read( 31 ) >> 2 & 0x1F ) == ( CP1::Exception::UNDERFLOW_ | CP1::Exception::INEXACT ) );
+  }
+
+  SECTION( "DIV.D $f4, $f5, $f6 divides by zero with the exception enabled, it's trapped" )
+  {
+    auto div_d = "DIV"_cp1 | FMT_D | 4_r1 | 5_r2 | 6_r3;
+
+    auto f4 = FP( 4 );
+    auto f5 = FP( 5 );
+    auto f6 = FP( 6 );
+
+    inspector.CP1_soft_float( true );
+
+    f4->d = 3.0;
+    f5->d = 1.0;
+    f6->d = 0.0;
+
+    cp1.write( 31, CP1::Exception::DIVBYZERO << 7 );
+
+    REQUIRE( ( cp1.execute( div_d ) & CP1::Exception::DIVBYZERO ) != 0 );
+    REQUIRE( f4->d == 3.0 );
+    REQUIRE( ( cp1.read( 31 ) >> 2 & 0x1F ) == 0 );
+  }
+
+  SECTION( "CVT.W.D $f0, $f1 and CVT.L.S $f2, $f3 of NaN are invalid, converted to 0" )
+  {
+    auto cvt_w_d = "CVT_W"_cp1 | FMT_D | 0_r1 | 1_r2;
+    auto cvt_l_s = "CVT_L"_cp1 | FMT_S | 2_r1 | 3_r2;
+
+    auto f0 = FP( 0 );
+    auto f1 = FP( 1 );
+    auto f2 = FP( 2 );
+    auto f3 = FP( 3 );
+
+    inspector.CP1_soft_float( true );
+
+    f0->i64 = 1;
+    f1->d = QNAN<double>();
+    f2->i64 = 1;
+    f3->f = QNAN<float>();
+
+    REQUIRE( cp1.execute( cvt_w_d ) == CP1::Exception::NONE );
+    REQUIRE( cp1.execute( cvt_l_s ) == CP1::Exception::NONE );
+
+    REQUIRE( f0->i32 == 0 );
+    REQUIRE( f2->i64 == 0 );
+    REQUIRE( ( cp1.read( 31 ) >> 2 & 0x1F ) == CP1::Exception::INVALID );
+  }
+}
+
 #undef FP
\ No newline at end of file
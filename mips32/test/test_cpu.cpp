@@ -8,8 +8,14 @@
 #include "helpers/FileManager.hpp"
 
 #include <algorithm>
+#include <cstdio>
 #include <cstring>
 #include <memory>
+#include <vector>
+
+#ifdef _WIN32
+#  include <io.h>
+#endif
 
 // TODO: test for reserved(word) path
 // TODO: test BNEZALC
@@ -58,6 +64,8 @@ enum SYSCALL
   WRITE,
   CLOSE,
   EXIT2,
+  MAP,
+  IPI,
 };
 
 TEST_CASE( "A CPU object exists" )
@@ -1088,6 +1096,33 @@ TEST_CASE( "A CPU object exists" )
     }
   }
 
+  SECTION( "BEQZC $20, -2 and BNEZC $6, -2 branch backwards, without linking" )
+  {
+    auto $20 = R( 20 );
+    auto $6 = R( 6 );
+    auto $31 = R( 31 );
+
+    *$20 = 0;
+    *$6 = 1;
+    *$31 = 0;
+
+    PC() = pc;
+
+    SECTION( "BEQZC" )
+    {
+      $start = "BEQZC"_cpu | 20_rs | 0x1F'FFFE;
+      cpu.single_step();
+      REQUIRE( PC() == pc - 4 );
+    }
+    SECTION( "BNEZC" )
+    {
+      $start = "BNEZC"_cpu | 6_rs | 0x1F'FFFE;
+      cpu.single_step();
+      REQUIRE( PC() == pc - 4 );
+      REQUIRE( *$31 == 0 );
+    }
+  }
+
   SECTION( "BOVC $2, $1, 256 and BOVC $4, $3, 1024 are executed" )
   {
     auto const _bovc_jump = "BOVC"_cpu | 2_rs | 1_rt | 256;
@@ -1391,6 +1426,187 @@ TEST_CASE( "A CPU object exists" )
     REQUIRE( *$1 == res );
   }
 
+  SECTION( "LL $1, -4($2) and SC $3, -4($2) are executed" )
+  {
+    auto $1 = R( 1 );
+    auto $2 = R( 2 );
+    auto $3 = R( 3 );
+
+    *$2 = 0xBFC0'0104;
+    *$3 = 42;
+
+    ram[0xBFC0'0100] = 21;
+
+    $start = "LL"_cpu | 1_rt | 2_rs | 0x1FC_off9;
+    ram[0xBFC0'0004] = "SC"_cpu | 3_rt | 2_rs | 0x1FC_off9;
+
+    cpu.single_step();
+    REQUIRE( *$1 == 21 );
+
+    SECTION( "The reservation holds" )
+    {
+      cpu.single_step();
+
+      REQUIRE( *$3 == 1 );
+      REQUIRE( ram[0xBFC0'0100] == 42 );
+    }
+
+    SECTION( "The word is changed in the meantime" )
+    {
+      ram[0xBFC0'0100] = 84;
+
+      cpu.single_step();
+
+      REQUIRE( *$3 == 0 );
+      REQUIRE( ram[0xBFC0'0100] == 84 );
+    }
+  }
+
+  SECTION( "LL $1, 0($2) is executed, then ERET clears the reservation" )
+  {
+    auto $2 = R( 2 );
+    auto $3 = R( 3 );
+
+    *$2 = 0x0000'0100; // user mode after ERET
+    *$3 = 42;
+
+    ram[0x0000'0100] = 21;
+
+    $start = "LL"_cpu | 1_rt | 2_rs;
+    ram[0xBFC0'0004] = "ERET"_cpu;
+    ram[0x0000'0000] = "SC"_cpu | 3_rt | 2_rs;
+
+    cp0.status &= ~0b110; // EXL, ERL, ERET returns to EPC
+    cp0.epc = 0x0000'0000;
+
+    cpu.single_step();
+    cpu.single_step();
+    cpu.single_step();
+
+    REQUIRE( PC() == 0x0000'0004 );
+    REQUIRE( *$3 == 0 );
+    REQUIRE( ram[0x0000'0100] == 21 );
+  }
+
+  SECTION( "SC $3, 0($2) is executed without a reservation" )
+  {
+    auto $2 = R( 2 );
+    auto $3 = R( 3 );
+
+    *$2 = 0xBFC0'0100;
+    *$3 = 42;
+
+    ram[0xBFC0'0100] = 21;
+
+    $start = "SC"_cpu | 3_rt | 2_rs;
+    cpu.single_step();
+
+    REQUIRE( *$3 == 0 );
+    REQUIRE( ram[0xBFC0'0100] == 21 );
+  }
+
+  SECTION( "LL $1, 1($2) is executed with a misaligned address" )
+  {
+    auto $2 = R( 2 );
+
+    *$2 = 0xBFC0'0100;
+
+    $start = "LL"_cpu | 1_rt | 2_rs | 1_off9;
+    cpu.single_step();
+
+    REQUIRE( ExCause() == 4 );
+  }
+
+  SECTION( "SYNC is executed" )
+  {
+    $start = "SYNC"_cpu;
+    cpu.single_step();
+
+    REQUIRE( ExCause() == 0 );
+    REQUIRE( PC() == pc + 4 );
+  }
+
+  SECTION( "EBase holds the number of the CPU" )
+  {
+    REQUIRE( ( cp0.e_base & 0x3FF ) == 0 );
+
+    CPU other{ ram, 3 };
+    other.hard_reset();
+
+    REQUIRE( ( MachineInspector().inspect( other ).access_CP0().e_base & 0x3FF ) == 3 );
+  }
+
+  SECTION( "An inter-processor interrupt is raised" )
+  {
+    ram[0x8000'0180] = "NOP"_cpu;
+    ram[0x8000'0184] = "NOP"_cpu;
+    $start = "NOP"_cpu;
+
+    cp0.status &= ~0x0407; // IE, EXL, ERL, IM2
+
+    cpu.interrupt();
+
+    cpu.single_step(); // disabled, it stays pending
+    REQUIRE( PC() == pc + 4 );
+    REQUIRE( ( CAUSE() & CPU::ipi_line ) );
+
+    cp0.status |= 0x0401;
+
+    cpu.single_step();
+    REQUIRE( PC() == 0x8000'0184 );
+    REQUIRE( ExCause() == 0 );
+    REQUIRE( cp0.epc == pc + 4 );
+
+    // Taken only once
+    cp0.status |= 0x0401;
+
+    cpu.single_step();
+    REQUIRE( PC() == 0x8000'0188 );
+  }
+
+  SECTION( "A masked inter-processor interrupt is taken once MTC0 enables it" )
+  {
+    auto $1 = R( 1 );
+
+    ram[0x8000'0180] = "NOP"_cpu;
+    $start = "MTC0"_cpu | 1_rt | 12_rd;
+
+    cp0.status &= ~0x0407; // IE, EXL, ERL, IM2
+    *$1 = cp0.status | 0x0401;
+
+    cpu.interrupt();
+
+    // Latched, then enabled by the instruction
+    cpu.single_step();
+    REQUIRE( PC() == 0x8000'0180 );
+    REQUIRE( ExCause() == 0 );
+    REQUIRE( cp0.epc == pc + 4 );
+  }
+
+  SECTION( "An inter-processor interrupt raised while another one is serviced is taken after ERET" )
+  {
+    auto $1 = R( 1 );
+
+    // The handler enables the IPI again, it's taken once serviced
+    ram[0x8000'0180] = "MTC0"_cpu | 1_rt | 12_rd;
+    ram[0x8000'0184] = "ERET"_cpu;
+    $start = "NOP"_cpu;
+
+    cp0.status = cp0.status & ~0x0407 | 0x0401;
+    *$1 = 0x0401;
+
+    cpu.interrupt();
+    cpu.single_step();
+    REQUIRE( PC() == 0x8000'0184 );
+    REQUIRE( cp0.epc == pc );
+
+    cpu.interrupt();
+    cpu.single_step(); // ERET
+    REQUIRE( PC() == 0x8000'0180 );
+    REQUIRE( ExCause() == 0 );
+    REQUIRE( ( CAUSE() & CPU::ipi_line ) );
+  }
+
   SECTION( "J 0x0279'DB24 is executed" )
   {
     auto const _j = "J"_cpu | 0x0279'DB24;
@@ -3353,6 +3569,27 @@ TEST_CASE( "A CPU object exists" )
     REQUIRE( $f0->i64 == 0xDDDD'EEEE'CCCC'CCCCull );
   }
 
+  SECTION( "CTC1 $1, $31 and CFC1 $2, $31 are executed" )
+  {
+    auto const _ctc1 = "CTC1"_cpu | 1_rt | 31_rd;
+    auto const _cfc1 = "CFC1"_cpu | 2_rt | 31_rd;
+
+    auto $1 = R( 1 );
+    auto $2 = R( 2 );
+
+    // Round towards zero, the division by zero enabled
+    *$1 = 0x0000'0401;
+
+    ram[0xBFC0'0000] = _ctc1;
+    ram[0xBFC0'0004] = _cfc1;
+
+    cpu.single_step();
+    cpu.single_step();
+
+    REQUIRE( ( *$2 & 0x0003'FFFF ) == 0x0000'0401 );
+    REQUIRE( ( inspector.CP1_fcsr() & 0x0003'FFFF ) == 0x0000'0401 );
+  }
+
   SECTION( "Swapping 2 FPRs registers using GPRS" )
   {
     // $f0 into $1, $2
@@ -3893,16 +4130,45 @@ TEST_CASE( "A CPU object exists" )
   {
     auto $v0 = R( _v0 );
     auto $a0 = R( _a0 );
+    auto $sp = R( 29 );
 
-    *$v0 = SBRK;
-    *$a0 = 0;
+    auto const heap = inspector.CPU_heap_info();
+    REQUIRE( heap.begin == CPU::heap_default_begin );
+    REQUIRE( heap.program_break == heap.begin );
 
-    ram[0xBFC0'0000] = "EI"_cpu;
-    ram[0xBFC0'0004] = "SYSCALL"_cpu;
-    cpu.single_step();
-    cpu.single_step();
+    auto const sbrk = [&]( std::int32_t increment ) {
+      *$v0 = SBRK;
+      *$a0 = ( std::uint32_t )increment;
+      PC() = 0xBFC0'0000;
+      cpu.single_step();
+      return *$v0;
+    };
 
-    REQUIRE( PC() == 0x8000'0180 );
+    $start = "SYSCALL"_cpu;
+
+    auto const allocated_blocks = inspector.RAM_info().allocated_blocks_no;
+
+    // Rounded up to a word, without allocating memory
+    REQUIRE( sbrk( 1'000'001 ) == heap.begin );
+    REQUIRE( sbrk( 0 ) == heap.begin + 1'000'004 );
+    REQUIRE( inspector.RAM_info().allocated_blocks_no == allocated_blocks );
+
+    // The memory is allocated when touched
+    ram[heap.begin + 1'000'000] = 0xAABB'CCDD;
+    REQUIRE( ram[heap.begin + 1'000'000] == 0xAABB'CCDD );
+
+    REQUIRE( sbrk( -1'000'004 ) == heap.begin + 1'000'004 );
+    REQUIRE( inspector.CPU_heap_info().program_break == heap.begin );
+    REQUIRE( inspector.CPU_heap_info().high_water == heap.begin + 1'000'004 );
+
+    // Below the heap
+    REQUIRE( sbrk( -4 ) == 0xFFFF'FFFF );
+
+    // Into the stack
+    *$sp = heap.begin + 64;
+    REQUIRE( sbrk( 128 ) == 0xFFFF'FFFF );
+    REQUIRE( sbrk( 64 ) == heap.begin );
+    REQUIRE( inspector.CPU_heap_info().program_break == heap.begin + 64 );
   }
 
   SECTION( "[SYSCALL] exit is executed" )
@@ -3990,7 +4256,7 @@ TEST_CASE( "A CPU object exists" )
     cpu.single_step();
 
     REQUIRE( filehandler->param.fd == 0xDDDD'EEEE );
-    REQUIRE( filehandler->param.dst != nullptr );
+    REQUIRE( filehandler->param.dst == ( char* )std::addressof( ram[0x8877'6654] ) + 1 );
     REQUIRE( filehandler->param.count == 235 );
     REQUIRE( *$v0 == filehandler->read_count );
   }
@@ -4013,7 +4279,7 @@ TEST_CASE( "A CPU object exists" )
     cpu.single_step();
 
     REQUIRE( filehandler->param.fd == 0xAABB'EEDD );
-    REQUIRE( filehandler->param.src == nullptr );
+    REQUIRE( filehandler->param.src == ( char* )std::addressof( ram[0x3322'1100] ) );
     REQUIRE( filehandler->param.count == 897 );
     REQUIRE( *$v0 == filehandler->write_count );
   }
@@ -4048,6 +4314,171 @@ TEST_CASE( "A CPU object exists" )
     REQUIRE( *$a0 == 2537 );
   }
 
+  SECTION( "[SYSCALL] file map is executed" )
+  {
+    auto $v0 = R( _v0 );
+    auto $a0 = R( _a0 );
+    auto $a1 = R( _a1 );
+    auto $a2 = R( _a2 );
+    auto $a3 = R( 7 );
+
+    // 2 blocks and a bit
+    std::vector<char> content( 2 * RAM::block_size + 100 );
+    for ( std::uint32_t i = 0; i < content.size(); ++i )
+      content[i] = ( char )( i * 7 );
+
+    auto *file = std::fopen( "test_cpu.map", "w+b" );
+    REQUIRE( file );
+    REQUIRE( std::fwrite( content.data(), 1, content.size(), file ) == content.size() );
+    std::fflush( file );
+
+#ifdef _WIN32
+    filehandler->handle = ::_get_osfhandle( ::_fileno( file ) );
+#else
+    filehandler->handle = ::fileno( file );
+#endif
+
+    std::uint32_t const address = 0x2000'0000 - 0x100;
+    std::uint32_t const offset = 0x104;
+    std::uint32_t const size = 3 * RAM::block_size;
+    std::uint32_t const file_size = ( std::uint32_t )content.size() - offset;
+
+    auto const map = [&]( std::uint32_t address, std::uint32_t offset ) {
+      *$v0 = MAP;
+      *$a0 = FileManager::fd_value;
+      *$a1 = address;
+      *$a2 = size;
+      *$a3 = offset;
+      PC() = 0xBFC0'0000;
+      cpu.single_step();
+      return *$v0;
+    };
+
+    $start = "SYSCALL"_cpu;
+
+    REQUIRE( map( address + 2, offset ) == 0xFFFF'FFFF );
+
+    REQUIRE( map( address, offset ) == address );
+
+    // The block entirely covered by the file isn't copied, it waits to be touched
+    auto const swapped = inspector.RAM_info().swapped_addresses;
+    REQUIRE( std::find( swapped.cbegin(), swapped.cend(), 0x2000'0000 ) != swapped.cend() );
+    REQUIRE( filehandler->param.fd == FileManager::fd_value );
+
+    std::fclose( file );
+
+    auto const mapped = inspector.RAM_read( address, file_size );
+    REQUIRE( mapped.size() == file_size );
+    REQUIRE_FALSE( std::memcmp( mapped.data(), content.data() + offset, file_size ) );
+
+    // Past the end of the file
+    REQUIRE( inspector.RAM_read( address + file_size, size - file_size ) == std::vector<char>( size - file_size, 0 ) );
+
+    // Copy-on-write
+    ram[0x2000'0000] = 0xFFFF'FFFF;
+    REQUIRE( ram[0x2000'0000] == 0xFFFF'FFFF );
+
+    file = std::fopen( "test_cpu.map", "rb" );
+    REQUIRE( file );
+    std::vector<char> after( content.size() );
+    REQUIRE( std::fread( after.data(), 1, after.size(), file ) == content.size() );
+    std::fclose( file );
+    REQUIRE( after == content );
+
+    // Not supported by the handler
+    filehandler->handle = -1;
+    REQUIRE( map( address, offset ) == 0xFFFF'FFFF );
+  }
+
+  SECTION( "[SYSCALL] file map is rewound" )
+  {
+    auto $v0 = R( _v0 );
+    auto $a0 = R( _a0 );
+    auto $a1 = R( _a1 );
+    auto $a2 = R( _a2 );
+    auto $a3 = R( 7 );
+
+    std::vector<char> content( 2 * RAM::block_size, 0x5A );
+
+    auto *file = std::fopen( "test_cpu.map", "w+b" );
+    REQUIRE( file );
+    REQUIRE( std::fwrite( content.data(), 1, content.size(), file ) == content.size() );
+    std::fflush( file );
+
+#ifdef _WIN32
+    filehandler->handle = ::_get_osfhandle( ::_fileno( file ) );
+#else
+    filehandler->handle = ::fileno( file );
+#endif
+
+    // The first block exists, the second one is new
+    std::uint32_t const address = 0x2000'0000 - RAM::block_size;
+    ram[address] = 0x1234'5678;
+
+    $start = "SYSCALL"_cpu;
+    ram.begin_journal();
+
+    for ( int i = 0; i < 3; ++i )
+    {
+      *$v0 = MAP;
+      *$a0 = FileManager::fd_value;
+      *$a1 = address;
+      *$a2 = ( std::uint32_t )content.size();
+      *$a3 = 0;
+      PC() = 0xBFC0'0000;
+      cpu.single_step();
+      REQUIRE( *$v0 == address );
+
+      // Only the existing block is recorded, the new one is mapped
+      REQUIRE( ram[address] == 0x5A5A'5A5A );
+      auto const swapped = inspector.RAM_info().swapped_addresses;
+      REQUIRE( std::find( swapped.cbegin(), swapped.cend(), 0x2000'0000 ) != swapped.cend() );
+
+      // Used after the mapping is released
+      if ( i == 2 )
+        ram[0x2000'0000 + 4] = 0xFFFF'FFFF;
+
+      ram.rewind();
+
+      REQUIRE( ram[address] == 0x1234'5678 );
+    }
+
+    std::fclose( file );
+
+    // The block used is kept, the mapped words are copied
+    REQUIRE( ram[0x2000'0000] == 0x5A5A'5A5A );
+    REQUIRE( ram[0x2000'0000 + 4] == 0xFFFF'FFFF );
+    ram.end_journal();
+  }
+
+  SECTION( "[SYSCALL] inter-processor interrupt is executed" )
+  {
+    auto $v0 = R( _v0 );
+    auto $a0 = R( _a0 );
+
+    CPU *const cores[] = { &cpu };
+    cpu.attach_cores( cores, 1 );
+
+    cp0.status &= ~0x0407;
+
+    $start = "SYSCALL"_cpu;
+    ram[0xBFC0'0004] = "SYSCALL"_cpu;
+    ram[0xBFC0'0008] = "NOP"_cpu;
+
+    *$v0 = IPI;
+    *$a0 = 1;
+    cpu.single_step();
+    REQUIRE( *$v0 == 0xFFFF'FFFF );
+
+    *$v0 = IPI;
+    *$a0 = 0;
+    cpu.single_step();
+    REQUIRE( *$v0 == 0 );
+
+    cpu.single_step();
+    REQUIRE( ( CAUSE() & CPU::ipi_line ) );
+  }
+
   SECTION( "SYSCALL is executed with an incorrect value in $v0" )
   {
     auto $v0 = R( _v0 );
@@ -0,0 +1,133 @@
+#include <catch.hpp>
+
+#include <mips32/disassembler.hpp>
+
+#include "helpers/test_cp1_instructions.hpp"
+#include "helpers/test_cpu_instructions.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+using namespace mips32;
+
+using ui32 = std::uint32_t;
+
+constexpr ui32 pc{ 0xBFC0'0010 };
+
+// The formats of COP1
+constexpr ui32 fmt_s{ 0x10 << 21 };
+constexpr ui32 fmt_d{ 0x11 << 21 };
+constexpr ui32 fmt_w{ 0x14 << 21 };
+constexpr ui32 fmt_l{ 0x15 << 21 };
+
+std::string disassembled( ui32 word, ui32 at = pc )
+{
+  char buffer[disassembly_max_size];
+
+  auto const length = disassemble( word, at, buffer, sizeof( buffer ) );
+  REQUIRE( length < disassembly_max_size );
+  REQUIRE( length == std::strlen( buffer ) );
+
+  return buffer;
+}
+
+TEST_CASE( "The disassembler decodes what the CPU executes" )
+{
+  SECTION( "Arithmetic, logic and shifts" )
+  {
+    REQUIRE( disassembled( 0 ) == "NOP" );
+    REQUIRE( disassembled( "ADDU"_cpu | 8_rd | 9_rs | 10_rt ) == "ADDU $8, $9, $10" );
+    REQUIRE( disassembled( "ADDIU"_cpu | 8_rt | 8_rs | 0xFFFF_imm16 ) == "ADDIU $8, $8, -1" );
+    REQUIRE( disassembled( "ORI"_cpu | 8_rt | 0xFFFF_imm16 ) == "ORI $8, $0, 0xFFFF" );
+    REQUIRE( disassembled( "LUI"_cpu | 9_rt | 0x1001_imm16 ) == "LUI $9, 0x1001" );
+    REQUIRE( disassembled( "AUI"_cpu | 9_rt | 3_rs | 0x10_imm16 ) == "AUI $9, $3, 0x10" );
+    REQUIRE( disassembled( "SLL"_cpu | 2_rd | 3_rt | 4_shamt ) == "SLL $2, $3, 4" );
+    REQUIRE( disassembled( "ROTR"_cpu | 2_rd | 3_rt | 31_shamt ) == "ROTR $2, $3, 31" );
+    REQUIRE( disassembled( "SRLV"_cpu | 2_rd | 3_rt | 4_rs ) == "SRLV $2, $3, $4" );
+    REQUIRE( disassembled( "ROTRV"_cpu | 2_rd | 3_rt | 4_rs ) == "ROTRV $2, $3, $4" );
+    REQUIRE( disassembled( "LSA"_cpu | 2_rd | 3_rs | 4_rt | 1_shamt ) == "LSA $2, $3, $4, 2" );
+    REQUIRE( disassembled( "MUH"_cpu | 2_rd | 3_rs | 4_rt ) == "MUH $2, $3, $4" );
+    REQUIRE( disassembled( "MODU"_cpu | 2_rd | 3_rs | 4_rt ) == "MODU $2, $3, $4" );
+    REQUIRE( disassembled( "EXT"_cpu | 2_rt | 3_rs | 4_shamt | 7_rd ) == "EXT $2, $3, 4, 8" );
+    REQUIRE( disassembled( "INS"_cpu | 2_rt | 3_rs | 4_shamt | 11_rd ) == "INS $2, $3, 4, 8" );
+  }
+
+  SECTION( "Memory" )
+  {
+    REQUIRE( disassembled( "LW"_cpu | 10_rt | 9_rs | 0xFFFC_imm16 ) == "LW $10, -4($9)" );
+    REQUIRE( disassembled( "SB"_cpu | 8_rt | 29_rs | 5_imm16 ) == "SB $8, 5($29)" );
+    REQUIRE( disassembled( "SDC1"_cpu | 2_rt | 29_rs | 8_imm16 ) == "SDC1 $f2, 8($29)" );
+    REQUIRE( disassembled( "LL"_cpu | 8_rt | 9_rs | 0x1FC_off9 ) == "LL $8, -4($9)" );
+    REQUIRE( disassembled( "SC"_cpu | 8_rt | 9_rs | 4_off9 ) == "SC $8, 4($9)" );
+  }
+
+  SECTION( "Branches and jumps, with absolute targets" )
+  {
+    REQUIRE( disassembled( "BNE"_cpu | 8_rs | 0xFFFC_imm16 ) == "BNE $8, $0, 0xBFC00004" );
+    REQUIRE( disassembled( "BEQ"_cpu | 2_imm16 ) == "BEQ $0, $0, 0xBFC0001C" );
+    REQUIRE( disassembled( "J"_cpu | 0x40_imm26 ) == "J 0xB0000100" );
+    REQUIRE( disassembled( "JR"_cpu | 31_rs ) == "JR $31" );
+    REQUIRE( disassembled( "JALR"_cpu | 31_rd | 8_rs ) == "JALR $31, $8" );
+    REQUIRE( disassembled( "BC"_cpu | 0x3FF'FFFF_imm26 ) == "BC 0xBFC00010" );
+    REQUIRE( disassembled( "BAL"_cpu | 1_imm16 ) == "BAL 0xBFC00018" );
+    REQUIRE( disassembled( "BNEZC"_cpu | 3_rs | 0x1F'FFFE ) == "BNEZC $3, 0xBFC0000C" );
+    REQUIRE( disassembled( "JIC"_cpu | 3_rt | 8_imm16 ) == "JIC $3, 8" );
+    REQUIRE( disassembled( "LWPC"_cpu | 4_rs | 2 ) == "LWPC $4, 0xBFC00018" );
+
+    // The compact branches are told apart by their registers
+    REQUIRE( disassembled( "BLEZALC"_cpu | 5_rt | 1_imm16 ) == "BLEZALC $5, 0xBFC00018" );
+    REQUIRE( disassembled( "BGEZALC"_cpu | 5_rt | 5_rs | 1_imm16 ) == "BGEZALC $5, 0xBFC00018" );
+    REQUIRE( disassembled( "BGEUC"_cpu | 4_rs | 5_rt | 1_imm16 ) == "BGEUC $4, $5, 0xBFC00018" );
+    REQUIRE( disassembled( "BEQC"_cpu | 4_rs | 5_rt ) == "BEQC $4, $5, 0xBFC00014" );
+    REQUIRE( disassembled( "BOVC"_cpu | 5_rs | 4_rt ) == "BOVC $5, $4, 0xBFC00014" );
+    REQUIRE( disassembled( "BNEC"_cpu | 5_rt ) == "BNEZALC $5, 0xBFC00014" ); // POP30, rs = 0
+  }
+
+  SECTION( "Coprocessors and system" )
+  {
+    REQUIRE( disassembled( "SYSCALL"_cpu ) == "SYSCALL" );
+    REQUIRE( disassembled( "TEQ"_cpu | 2_rs | 3_rt ) == "TEQ $2, $3" );
+    REQUIRE( disassembled( "SIGRIE"_cpu | 0xCCCC_imm16 ) == "SIGRIE 0xCCCC" );
+    REQUIRE( disassembled( "ERET"_cpu ) == "ERET" );
+    REQUIRE( disassembled( "EI"_cpu | 4_rt ) == "EI $4" );
+    REQUIRE( disassembled( "MTC0"_cpu | 4_rt | 12_rd | 1 ) == "MTC0 $4, $12, 1" );
+    REQUIRE( disassembled( "MTC1"_cpu | 9_rt | 2_rd ) == "MTC1 $9, $f2" );
+    REQUIRE( disassembled( "CFC1"_cpu | 9_rt | 31_rd ) == "CFC1 $9, $31" );
+    REQUIRE( disassembled( "CTC1"_cpu | 9_rt | 26_rd ) == "CTC1 $9, $26" );
+
+    REQUIRE( disassembled( "ADD"_cp1 | fmt_s | 3_r1 | 4_r2 | 5_r3 ) == "ADD.S $f3, $f4, $f5" );
+    REQUIRE( disassembled( "SQRT"_cp1 | fmt_d | 3_r1 | 4_r2 ) == "SQRT.D $f3, $f4" );
+    REQUIRE( disassembled( "CVT_W"_cp1 | fmt_d | 3_r1 | 4_r2 ) == "CVT.W.D $f3, $f4" );
+    REQUIRE( disassembled( "CMP_ULT"_cp1 | fmt_w | 1_r1 | 2_r2 | 3_r3 ) == "CMP.ULT.S $f1, $f2, $f3" );
+    REQUIRE( disassembled( "CMP_NE"_cp1 | fmt_l | 1_r1 | 2_r2 | 3_r3 ) == "CMP.NE.D $f1, $f2, $f3" );
+    REQUIRE( disassembled( ( 0x11u << 26 ) | fmt_l | 3_r1 | 4_r2 | 0x21 ) == "CVT.D.L $f3, $f4" );
+  }
+
+  SECTION( "The words that the CPU doesn't execute" )
+  {
+    REQUIRE( disassembled( 0x0000'000A ) == "RESERVED 0x0000000A" );       // MOVZ
+    REQUIRE( disassembled( 0x1800'0000 ) == "RESERVED 0x18000000" );       // POP06 without registers
+    REQUIRE( disassembled( "MUL"_cpu & ~( 0b10u << 6 ) ) == "RESERVED 0x00000018" );
+    REQUIRE( disassembled( "MOVZ"_cp1 | fmt_s ) == "RESERVED 0x46000012" );
+    REQUIRE( disassembled( "ADD"_cp1 | 0x16 << 21 ) == "RESERVED 0x46C00000" ); // no format
+  }
+}
+
+TEST_CASE( "The disassembler writes into the buffer given" )
+{
+  auto const word = "ADDIU"_cpu | 8_rt | 8_rs | 0xFFFF_imm16;
+
+  REQUIRE( std::string( mnemonic( word ) ) == "ADDIU" );
+  REQUIRE( std::string( mnemonic( 0x0000'000A ) ) == "RESERVED" );
+
+  char buffer[8];
+  std::memset( buffer, 'x', sizeof( buffer ) );
+
+  // Truncated, the length is the whole one
+  REQUIRE( disassemble( word, pc, buffer, 6 ) == std::strlen( "ADDIU $8, $8, -1" ) );
+  REQUIRE( std::string( buffer ) == "ADDIU" );
+  REQUIRE( buffer[6] == 'x' );
+
+  REQUIRE( disassemble( word, pc, nullptr, 0 ) == std::strlen( "ADDIU $8, $8, -1" ) );
+}
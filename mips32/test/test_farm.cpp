@@ -0,0 +1,119 @@
+#include <catch.hpp>
+
+#include <mips32/farm.hpp>
+#include "../src/cpu.hpp"
+
+#include "helpers/test_cpu_instructions.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace mips32;
+using namespace mips32::literals;
+
+constexpr char const farm_executable[] = { "test_farm.fama" };
+
+// A fama executable, with the text only
+void write_farm_executable( std::uint32_t text_addr, std::vector<std::uint32_t> const &text )
+{
+  std::uint32_t const header[10] = {
+    0, 1,
+    0, ( std::uint32_t )( text.size() * 4 ), 0, 0,
+    0, text_addr, 0, 0,
+  };
+
+  auto *file = std::fopen( farm_executable, "wb" );
+  REQUIRE( file );
+
+  std::fwrite( "fama", 1, 4, file );
+  std::fwrite( header + 1, 4, 9, file );
+  std::fwrite( text.data(), 4, text.size(), file );
+
+  std::fclose( file );
+}
+
+TEST_CASE( "A Farm runs a batch of guest programs" )
+{
+  // Reads n, prints the sum of [1, n], then exits with it
+  write_farm_executable( 0x0040'0000, {
+    "ADDIU"_cpu | 2_rt | 5_imm16,               // read int
+    "SYSCALL"_cpu,
+    "ADDIU"_cpu | 9_rt,
+    "BEQ"_cpu | 2_rs | 0_rt | 3_imm16,          // loop: done
+    "ADDU"_cpu | 9_rd | 9_rs | 2_rt,
+    "ADDIU"_cpu | 2_rt | 2_rs | 0xFFFF_imm16,
+    "BEQ"_cpu | 0xFFFC_imm16,                   // loop
+    "ADDIU"_cpu | 4_rt | 9_rs,                  // done:
+    "ADDIU"_cpu | 2_rt | 1_imm16,               // print int
+    "SYSCALL"_cpu,
+    "ADDIU"_cpu | 2_rt | 17_imm16,              // exit2
+    "SYSCALL"_cpu,
+  } );
+
+  Farm farm{ 4 };
+  REQUIRE( farm.workers() == 4 );
+
+  SECTION( "The results follow the order of the jobs" )
+  {
+    std::vector<Farm::Job> jobs( 64 );
+    for ( std::uint32_t i = 0; i < jobs.size(); ++i )
+    {
+      jobs[i].executable = farm_executable;
+      jobs[i].input = "  " + std::to_string( i ) + "\n";
+    }
+
+    jobs[5].executable = "test_farm.missing";
+    jobs[7].instruction_limit = 20;
+
+    auto const results = farm.run( jobs );
+    REQUIRE( results.size() == jobs.size() );
+
+    for ( std::uint32_t i = 0; i < jobs.size(); ++i )
+    {
+      auto const &result = results[i];
+      REQUIRE( result.worker < 4 );
+
+      if ( i == 5 )
+      {
+        REQUIRE( result.failed );
+        continue;
+      }
+
+      REQUIRE_FALSE( result.failed );
+
+      if ( i == 7 )
+      {
+        REQUIRE( result.exit_code == CPU::LIMIT );
+        REQUIRE( result.instructions == 20 );
+        REQUIRE( result.output.empty() );
+        continue;
+      }
+
+      auto const sum = i * ( i + 1 ) / 2;
+
+      REQUIRE( result.exit_code == CPU::EXIT );
+      REQUIRE( result.exit_value == sum );
+      REQUIRE( result.output == std::to_string( sum ) );
+      REQUIRE( result.instructions == 3 + 4 * i + 6 );
+    }
+
+    REQUIRE( farm.run( {} ).empty() );
+  }
+
+  SECTION( "The idle workers steal the jobs of the busy ones" )
+  {
+    // The share of the first worker is much longer
+    std::vector<Farm::Job> jobs( 16, Farm::Job{ farm_executable, "10" } );
+    for ( std::uint32_t i = 0; i < 4; ++i )
+      jobs[i].input = "3000000";
+
+    auto const results = farm.run( jobs );
+
+    REQUIRE( std::any_of( results.begin(), results.begin() + 4, []( Farm::Result const &result ) { return result.stolen; } ) );
+    REQUIRE( std::none_of( results.begin(), results.end(), []( Farm::Result const &result ) { return result.failed; } ) );
+    REQUIRE( results[0].exit_value == std::uint32_t( 3000000ull * 3000001ull / 2 ) );
+  }
+}
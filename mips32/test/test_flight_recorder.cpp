@@ -0,0 +1,175 @@
+#include <catch.hpp>
+
+#include <mips32/machine.hpp>
+#include "../src/cpu.hpp"
+#include "../src/flight_recorder.hpp"
+
+#include "helpers/test_cpu_instructions.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace mips32;
+using namespace mips32::literals;
+
+using ui32 = std::uint32_t;
+
+// Stores a word, loads it misaligned, then raises RI, the handler of the exception breaks
+void write_faulting_program( MachineInspector &inspector )
+{
+  ui32 const program[] = {
+    "LUI"_cpu | 9_rt | 0x8000_imm16,
+    "ORI"_cpu | 8_rt | 7_imm16,
+    "SW"_cpu | 8_rt | 9_rs,
+    "LW"_cpu | 10_rt | 9_rs | 2_imm16,
+    "SIGRIE"_cpu,
+  };
+  inspector.RAM_write( 0xBFC0'0000, program, sizeof( program ) );
+
+  ui32 const handler = "BREAK"_cpu;
+  inspector.RAM_write( 0x8000'0180, &handler, 4 );
+}
+
+TEST_CASE( "The flight recorder ring keeps the last entries" )
+{
+  FlightRecorder ring;
+  REQUIRE_FALSE( ring.enabled() );
+  REQUIRE( ring.read().empty() );
+
+  ring.resize( 5 );
+  REQUIRE( ring.enabled() );
+  REQUIRE( ring.size() == 8 );
+
+  for ( ui32 i = 0; i < 3; ++i )
+    ring.push( i, i * 10 );
+
+  REQUIRE( ring.read() == std::vector<ui32>{ 0, 0, 1, 10, 2, 20 } );
+
+  for ( ui32 i = 3; i < 20; ++i )
+    ring.push( i, i * 10 );
+
+  auto const words = ring.read();
+  REQUIRE( words.size() == 16 );
+  REQUIRE( words.front() == 12 );
+  REQUIRE( words[words.size() - 2] == 19 );
+  REQUIRE( words.back() == 190 );
+
+  ring.resize( 0 );
+  REQUIRE_FALSE( ring.enabled() );
+  REQUIRE( ring.read().empty() );
+}
+
+TEST_CASE( "The flight recorder dumps the instructions before an exception" )
+{
+  Machine machine{ 1024 * 1024, nullptr, nullptr };
+  machine.reset();
+
+  auto inspector = machine.get_inspector();
+  write_faulting_program( inspector );
+
+  SECTION( "The last instructions are recorded by default" )
+  {
+    REQUIRE( machine.start() == CPU::EXCEPTION );
+
+    auto const record = inspector.CPU_flight_record();
+    REQUIRE( record.accesses.empty() );
+    REQUIRE( record.instructions.size() == 6 );
+
+    REQUIRE( record.instructions[0].pc == 0xBFC0'0000 );
+    REQUIRE( record.instructions[0].word == ( "LUI"_cpu | 9_rt | 0x8000_imm16 ) );
+
+    // The faulting instruction, then the handler
+    REQUIRE( record.instructions[3].word == ( "LW"_cpu | 10_rt | 9_rs | 2_imm16 ) );
+    REQUIRE( record.instructions[4].pc == 0xBFC0'0010 );
+    REQUIRE( record.instructions[4].word == "SIGRIE"_cpu );
+    REQUIRE( record.instructions[5].pc == 0x8000'0180 );
+    REQUIRE( record.instructions[5].word == "BREAK"_cpu );
+  }
+
+  SECTION( "The memory accesses are recorded if requested" )
+  {
+    inspector.CPU_flight_recorder( 2, 4 );
+
+    REQUIRE( machine.start() == CPU::EXCEPTION );
+
+    auto const record = inspector.CPU_flight_record();
+    REQUIRE( record.instructions.size() == 2 );
+    REQUIRE( record.instructions[0].pc == 0xBFC0'0010 );
+    REQUIRE( record.instructions[1].pc == 0x8000'0180 );
+
+    REQUIRE( record.accesses.size() == 2 );
+    REQUIRE( record.accesses[0].pc == 0xBFC0'0008 );
+    REQUIRE( record.accesses[0].address == 0x8000'0000 );
+    REQUIRE( record.accesses[0].store );
+    REQUIRE( record.accesses[1].pc == 0xBFC0'000C );
+    REQUIRE( record.accesses[1].address == 0x8000'0002 );
+    REQUIRE_FALSE( record.accesses[1].store );
+  }
+
+  SECTION( "The recording can be disabled" )
+  {
+    inspector.CPU_flight_recorder( 0 );
+
+    REQUIRE( machine.start() == CPU::EXCEPTION );
+
+    auto const record = inspector.CPU_flight_record();
+    REQUIRE( record.instructions.empty() );
+    REQUIRE( record.accesses.empty() );
+  }
+}
+
+TEST_CASE( "The flight record of a running Machine is read from another thread" )
+{
+  Machine machine{ 1024 * 1024, nullptr, nullptr };
+  machine.reset();
+
+  auto inspector = machine.get_inspector();
+  inspector.CPU_flight_recorder( 16, 16 );
+
+  // Stores $8, incremented, forever
+  ui32 const program[] = {
+    "LUI"_cpu | 9_rt | 0x8000_imm16,
+    "ADDIU"_cpu | 8_rt | 8_rs | 1_imm16,        // loop:
+    "SW"_cpu | 8_rt | 9_rs,
+    "BEQ"_cpu | 0xFFFD_imm16,                   // loop
+  };
+  inspector.RAM_write( 0xBFC0'0000, program, sizeof( program ) );
+
+  std::thread runner( [&machine] { machine.start(); } );
+
+  std::uint64_t instructions = 0;
+
+  for ( int i = 0; i < 1000 || instructions < 1000; ++i )
+  {
+    auto const record = inspector.CPU_flight_record();
+
+    // Every entry read is consistent, the ones overwritten while reading are dropped
+    for ( std::size_t j = 0; j < record.instructions.size(); ++j )
+    {
+      auto const &instruction = record.instructions[j];
+      REQUIRE( instruction.word == program[( instruction.pc - 0xBFC0'0000 ) / 4] );
+
+      if ( j && instruction.pc != 0xBFC0'0004 )
+        REQUIRE( instruction.pc == record.instructions[j - 1].pc + 4 );
+    }
+
+    for ( auto const &access : record.accesses )
+    {
+      REQUIRE( access.pc == 0xBFC0'0008 );
+      REQUIRE( access.address == 0x8000'0000 );
+      REQUIRE( access.store );
+    }
+
+    instructions += record.instructions.size();
+    std::this_thread::yield();
+  }
+
+  machine.stop();
+  runner.join();
+
+  auto const record = inspector.CPU_flight_record();
+  REQUIRE( record.instructions.size() == 16 );
+  REQUIRE( record.accesses.size() == 16 );
+}
@@ -0,0 +1,119 @@
+#include <catch.hpp>
+
+#include <mips32/machine.hpp>
+#include "../src/cpu.hpp"
+
+#include "helpers/test_cpu_instructions.hpp"
+
+#include <cstdint>
+#include <vector>
+
+using namespace mips32;
+using namespace mips32::literals;
+
+using ui32 = std::uint32_t;
+
+constexpr ui32 sigrie{ 0x0417'CCCC };
+constexpr ui32 input_address{ 0x1001'0000 };
+constexpr ui32 other_block{ 0x1002'0000 };
+constexpr ui32 fork_point{ 0xBFC0'0018 };
+
+ui32 word_at( MachineInspector &inspector, ui32 address )
+{
+  ui32 word{ 0 };
+  auto const bytes = inspector.RAM_read( address, 4 );
+  std::copy( bytes.begin(), bytes.end(), ( char * )&word );
+  return word;
+}
+
+void check_fork_server( ui32 ram_alloc_limit )
+{
+  Machine machine{ ram_alloc_limit, nullptr, nullptr };
+  machine.reset();
+
+  auto inspector = machine.get_inspector();
+
+  ui32 const program[] = {
+    "LUI"_cpu | 9_rt | 0x1001_imm16,
+    "ADDIU"_cpu | 8_rt | 7_imm16,
+    "SW"_cpu | 8_rt | 9_rs | 4_imm16,           // before the fork point
+    "ADDIU"_cpu | 2_rt | 9_imm16,               // sbrk
+    "ADDIU"_cpu | 4_rt | 16_imm16,
+    "SYSCALL"_cpu,
+    "LW"_cpu | 10_rt | 9_rs,                    // fork point: reads the input
+    "ADDU"_cpu | 11_rd | 10_rs | 8_rt,
+    "SW"_cpu | 11_rt | 9_rs | 4_imm16,
+    "LUI"_cpu | 12_rt | 0x1002_imm16,
+    "SW"_cpu | 10_rt | 12_rs,
+    "ADDIU"_cpu | 2_rt | 9_imm16,               // sbrk
+    "ADDIU"_cpu | 4_rt | 32_imm16,
+    "SYSCALL"_cpu,
+    "ADDIU"_cpu | 2_rt | 10_imm16,              // exit
+    "SYSCALL"_cpu,
+  };
+  inspector.RAM_write( 0xBFC0'0000, program, sizeof( program ) );
+
+  REQUIRE( machine.rewind() );
+  REQUIRE_FALSE( machine.capture( fork_point ) );
+
+  auto const golden = inspector.CPU_state();
+  REQUIRE( golden.pc == fork_point );
+  REQUIRE( golden.heap.program_break == golden.heap.begin + 16 );
+
+  for ( ui32 const input : { 1u, 100u, 0xFFFFu } )
+  {
+    inspector.RAM_write( input_address, &input, 4 );
+
+    REQUIRE( machine.start() == CPU::EXIT );
+    REQUIRE( word_at( inspector, input_address + 4 ) == input + 7 );
+    REQUIRE( word_at( inspector, other_block ) == input );
+    REQUIRE( inspector.CPU_heap_info().program_break == golden.heap.begin + 48 );
+
+    REQUIRE_FALSE( machine.rewind() );
+
+    // The injected input is rewound too
+    REQUIRE( word_at( inspector, input_address ) == sigrie );
+    REQUIRE( word_at( inspector, input_address + 4 ) == 7 );
+    REQUIRE( word_at( inspector, other_block ) == sigrie );
+
+    auto const state = inspector.CPU_state();
+    REQUIRE( state.pc == golden.pc );
+    REQUIRE( state.gpr == golden.gpr );
+    REQUIRE( state.heap.program_break == golden.heap.program_break );
+  }
+
+  // Loading a program discards the golden state
+  REQUIRE( machine.load( nullptr ) );
+  REQUIRE( machine.rewind() );
+}
+
+TEST_CASE( "A Machine rewinds to a captured state" )
+{
+  check_fork_server( 1_MB );
+}
+
+TEST_CASE( "A Machine rewinds to a captured state, while swapping blocks" )
+{
+  check_fork_server( 128_KB );
+}
+
+TEST_CASE( "A Machine doesn't capture a state it can't reach" )
+{
+  Machine machine{ 128_KB, nullptr, nullptr };
+  machine.reset();
+
+  auto inspector = machine.get_inspector();
+
+  ui32 const program[] = {
+    "ADDIU"_cpu | 2_rt | 10_imm16,              // exit
+    "SYSCALL"_cpu,
+  };
+  inspector.RAM_write( 0xBFC0'0000, program, sizeof( program ) );
+
+  REQUIRE( machine.capture( fork_point ) );
+  REQUIRE( inspector.CPU_read_exit_code() == CPU::EXIT );
+  REQUIRE( machine.rewind() );
+
+  Machine more_cores{ 128_KB, nullptr, nullptr, 2 };
+  REQUIRE( more_cores.capture( fork_point ) );
+}
@@ -0,0 +1,187 @@
+#include <catch.hpp>
+
+#include <mips32/machine.hpp>
+#include "../src/ram.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace mips32;
+using namespace mips32::literals;
+
+constexpr char const executable_name[] = { "test_loader.fama" };
+constexpr char const elf_name[] = { "test_loader.elf" };
+
+std::vector<char> make_fama( std::uint32_t data_addr, std::vector<char> const &data, std::uint32_t text_addr, std::vector<std::uint32_t> const &text )
+{
+  std::uint32_t const header[10] = {
+    0, 1,
+    ( std::uint32_t )data.size(), ( std::uint32_t )( text.size() * 4 ), 0, 0,
+    data_addr, text_addr, 0, 0,
+  };
+
+  std::vector<char> executable( sizeof( header ) );
+  std::memcpy( executable.data(), header, sizeof( header ) );
+  std::memcpy( executable.data(), "fama", 4 );
+
+  executable.insert( executable.end(), data.cbegin(), data.cend() );
+  executable.insert( executable.end(), ( char const * )text.data(), ( char const * )( text.data() + text.size() ) );
+
+  return executable;
+}
+
+void write_file( char const *name, std::vector<char> const &content )
+{
+  auto *file = std::fopen( name, "wb" );
+  REQUIRE( file );
+  REQUIRE( std::fwrite( content.data(), 1, content.size(), file ) == content.size() );
+  std::fclose( file );
+}
+
+TEST_CASE( "A Machine loads a fama executable" )
+{
+  Machine machine{ 128_KB, nullptr, nullptr };
+  auto inspector = machine.get_inspector();
+
+  std::vector<char> const data = { 'H', 'e', 'l', 'l', 'o', '\0', '!', '!' };
+
+  // Spans 3 blocks, 1 complete
+  std::vector<std::uint32_t> text( RAM::block_size / 4 + 64 );
+  for ( std::uint32_t i = 0; i < text.size(); ++i )
+    text[i] = i;
+
+  std::uint32_t const data_addr = 0x1001'0000;
+  std::uint32_t const text_addr = 0x0040'0000 - 32 * 4;
+
+  auto const executable = make_fama( data_addr, data, text_addr, text );
+
+  auto const check_ram = [&]() {
+    REQUIRE( inspector.CPU_pc() == text_addr );
+
+    auto const loaded_data = inspector.RAM_read( data_addr, ( std::uint32_t )data.size() );
+    REQUIRE( loaded_data == data );
+
+    auto const loaded_text = inspector.RAM_read( text_addr, ( std::uint32_t )text.size() * 4 );
+    REQUIRE( loaded_text.size() == text.size() * 4 );
+    REQUIRE_FALSE( std::memcmp( loaded_text.data(), text.data(), loaded_text.size() ) );
+  };
+
+  SECTION( "from memory" )
+  {
+    REQUIRE_FALSE( machine.load( executable.data() ) );
+    check_ram();
+  }
+
+  SECTION( "from a file, without modifying it" )
+  {
+    write_file( executable_name, executable );
+
+    REQUIRE_FALSE( machine.load_file( executable_name ) );
+    check_ram();
+
+    // Forces the blocks to be swapped, the complete one too
+    for ( std::uint32_t address = 0; address < 4 * RAM::block_size; address += RAM::block_size )
+      inspector.RAM_write( address, "block", 5 );
+
+    std::uint32_t const word = 0xFFFF'FFFF;
+    inspector.RAM_write( 0x0040'0000, &word, 4 );
+    REQUIRE( inspector.RAM_read( 0x0040'0000, 4 ) == std::vector<char>( 4, ( char )0xFF ) );
+
+    Machine other{ 128_KB, nullptr, nullptr };
+    REQUIRE_FALSE( other.load_file( executable_name ) );
+    REQUIRE_FALSE( std::memcmp( other.get_inspector().RAM_read( 0x0040'0000, 4 ).data(), &text[32], 4 ) );
+  }
+
+  SECTION( "not a valid executable" )
+  {
+    auto invalid = executable;
+    invalid[0] = 'F';
+
+    REQUIRE( machine.load( invalid.data() ) );
+    REQUIRE( machine.load_file( "test_loader.missing" ) );
+  }
+}
+
+TEST_CASE( "A Machine loads an ELF32 executable" )
+{
+  Machine machine{ 128_KB, nullptr, nullptr };
+  auto inspector = machine.get_inspector();
+
+  std::uint32_t const text_addr = 0x0040'0000;
+  std::uint32_t const text_size = RAM::block_size + 256;
+  std::uint32_t const data_addr = 0x1001'0000 - 8;
+  std::uint32_t const data_size = 16;
+  std::uint32_t const bss_size = 3 * RAM::block_size;
+  std::uint32_t const entry = text_addr + 0x40;
+
+  // ELF header, 2 program headers, text, data
+  std::vector<char> elf( 0x1000 + text_size + data_size );
+
+  std::uint8_t const ident[16] = { 0x7F, 'E', 'L', 'F', 1, 1, 1 };
+  std::memcpy( elf.data(), ident, sizeof( ident ) );
+
+  auto const put16 = [&]( std::size_t offset, std::uint16_t value ) { std::memcpy( elf.data() + offset, &value, 2 ); };
+  auto const put32 = [&]( std::size_t offset, std::uint32_t value ) { std::memcpy( elf.data() + offset, &value, 4 ); };
+
+  put16( 16, 2 );      // e_type, ET_EXEC
+  put16( 18, 8 );      // e_machine, EM_MIPS
+  put32( 20, 1 );      // e_version
+  put32( 24, entry );  // e_entry
+  put32( 28, 52 );     // e_phoff
+  put16( 40, 52 );     // e_ehsize
+  put16( 42, 32 );     // e_phentsize
+  put16( 44, 2 );      // e_phnum
+
+  std::uint32_t const segments[2][8] = {
+    { 1, 0x1000, text_addr, text_addr, text_size, text_size, 5, 0x1000 },
+    { 1, 0x1000 + text_size, data_addr, data_addr, data_size, data_size + bss_size, 6, 0x1000 },
+  };
+  std::memcpy( elf.data() + 52, segments, sizeof( segments ) );
+
+  for ( std::uint32_t i = 0; i < text_size / 4; ++i )
+    put32( 0x1000 + i * 4, i );
+  for ( std::uint32_t i = 0; i < data_size; ++i )
+    elf[0x1000 + text_size + i] = ( char )( i + 1 );
+
+  auto const check_ram = [&]() {
+    REQUIRE( inspector.CPU_pc() == entry );
+
+    auto const text = inspector.RAM_read( text_addr, text_size );
+    REQUIRE( text.size() == text_size );
+    REQUIRE_FALSE( std::memcmp( text.data(), elf.data() + 0x1000, text_size ) );
+
+    auto const data = inspector.RAM_read( data_addr, data_size );
+    REQUIRE_FALSE( std::memcmp( data.data(), elf.data() + 0x1000 + text_size, data_size ) );
+
+    auto const bss = inspector.RAM_read( data_addr + data_size, bss_size );
+    REQUIRE( bss == std::vector<char>( bss_size, 0 ) );
+
+    // The heap begins after the .bss
+    REQUIRE( inspector.CPU_heap_info().begin == data_addr + data_size + bss_size );
+
+    std::uint32_t const word = 0xAABB'CCDD;
+    inspector.RAM_write( 0x1002'0000, &word, 4 );
+    REQUIRE_FALSE( std::memcmp( inspector.RAM_read( 0x1002'0000, 4 ).data(), &word, 4 ) );
+  };
+
+  SECTION( "from memory" )
+  {
+    REQUIRE_FALSE( machine.load( elf.data() ) );
+    check_ram();
+  }
+
+  SECTION( "from a file" )
+  {
+    write_file( elf_name, elf );
+
+    REQUIRE_FALSE( machine.load_file( elf_name ) );
+    check_ram();
+  }
+
+  SECTION( "not for MIPS" )
+  {
+    put16( 18, 3 ); // EM_386
+    REQUIRE( machine.load( elf.data() ) );
+  }
+}
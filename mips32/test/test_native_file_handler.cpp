@@ -0,0 +1,111 @@
+#include <catch.hpp>
+
+#include <mips32/native_file_handler.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace mips32;
+
+constexpr char const file_name[] = { "test_native_file_handler.txt" };
+
+void check_transfers( NativeFileHandler &handler )
+{
+  std::uint32_t constexpr failure = 0xFFFF'FFFF;
+
+  SECTION( "The descriptors are reused" )
+  {
+    auto const a = handler.open( file_name, "w" );
+    auto const b = handler.open( file_name, "r" );
+    REQUIRE( a != failure );
+    REQUIRE( b != failure );
+    REQUIRE( a != b );
+
+    handler.close( a );
+    REQUIRE( handler.open( file_name, "r" ) == a );
+
+    REQUIRE( handler.open( "test_native_file_handler.missing", "r" ) == failure );
+    REQUIRE( handler.read( 1234, nullptr, 0 ) == failure );
+  }
+
+  SECTION( "Small writes and reads are buffered" )
+  {
+    // Spans several chunks, with writes straddling their borders
+    std::string expected;
+    for ( int i = 0; expected.size() < 700 * 1024; ++i )
+      expected += std::to_string( i ) + ',';
+
+    auto fd = handler.open( file_name, "w" );
+    std::size_t written = 0;
+    for ( std::size_t i = 0; i < expected.size(); i += 7 )
+    {
+      auto const count = ( std::uint32_t )std::min<std::size_t>( 7, expected.size() - i );
+      written += handler.write( fd, expected.data() + i, count );
+    }
+    REQUIRE( written == expected.size() );
+
+    // Too big to be coalesced
+    std::string const big( 200 * 1024, 'b' );
+    REQUIRE( handler.write( fd, big.data(), ( std::uint32_t )big.size() ) == big.size() );
+    expected += big;
+
+    handler.close( fd );
+
+    fd = handler.open( file_name, "r" );
+
+    std::string content( expected.size() + 100, '\0' );
+    std::size_t read = 0;
+
+    // Small reads first, then big ones
+    while ( read < 300 * 1024 )
+      read += handler.read( fd, &content[read], 13 );
+
+    std::uint32_t result;
+    while ( ( result = handler.read( fd, &content[read], 150 * 1024 ) ) != 0 )
+      read += result;
+
+    handler.close( fd );
+
+    REQUIRE( read == expected.size() );
+    content.resize( read );
+    REQUIRE( content == expected );
+  }
+
+  SECTION( "Appends go to the end of the file" )
+  {
+    auto fd = handler.open( file_name, "w" );
+    handler.write( fd, "Hello", 5 );
+    handler.close( fd );
+
+    fd = handler.open( file_name, "a+" );
+    handler.write( fd, ", ", 2 );
+    handler.write( fd, "World!", 6 );
+
+    // Written before mapping
+    REQUIRE( handler.native_handle( fd ) != -1 );
+    handler.close( fd );
+
+    auto *file = std::fopen( file_name, "rb" );
+    REQUIRE( file );
+    char content[32] = {};
+    REQUIRE( std::fread( content, 1, sizeof( content ), file ) == 13 );
+    std::fclose( file );
+
+    REQUIRE( std::string( content ) == "Hello, World!" );
+  }
+}
+
+TEST_CASE( "A NativeFileHandler transfers data with io_uring, if available" )
+{
+  NativeFileHandler handler;
+  check_transfers( handler );
+}
+
+TEST_CASE( "A NativeFileHandler transfers data with blocking calls" )
+{
+  NativeFileHandler handler{ false };
+  REQUIRE_FALSE( handler.uses_io_uring() );
+  check_transfers( handler );
+}
@@ -88,4 +88,35 @@ TEST_CASE( "A RAM object exists and can allocate 1 block only" )
     REQUIRE( inspector.RAM_swapped_addresses()[0] == RAM::block_size );
     REQUIRE( inspector.RAM_allocated_addresses()[0] == std::uint32_t( 0 ) );
   }
+
+  SECTION( "I count the faults" )
+  {
+    ram[0];
+    ram[4];
+    ram[RAM::block_size];
+    ram[0];
+
+    auto const faults = inspector.RAM_faults();
+    REQUIRE( faults.allocations == 2 );
+    REQUIRE( faults.swap_ins == 1 );
+    REQUIRE( faults.swap_outs == 2 );
+  }
+}
+
+TEST_CASE( "More RAM objects swap the same addresses" )
+{
+  RAM first{ 64_KB };
+  RAM second{ 64_KB };
+
+  first[0] = 1;
+  second[0] = 2;
+
+  // Swaps out the block 0 of both
+  first[RAM::block_size] = 3;
+  second[RAM::block_size] = 4;
+
+  REQUIRE( first[0] == 1 );
+  REQUIRE( second[0] == 2 );
+  REQUIRE( first[RAM::block_size] == 3 );
+  REQUIRE( second[RAM::block_size] == 4 );
 }
@@ -0,0 +1,131 @@
+#include <catch.hpp>
+
+#include <mips32/machine.hpp>
+#include "../src/cpu.hpp"
+
+#include "helpers/test_cpu_instructions.hpp"
+#include "helpers/Terminal.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace mips32;
+using namespace mips32::literals;
+
+using ui32 = std::uint32_t;
+
+// Blocks the guest on read_int, until released
+class BlockingTerminal : public Terminal
+{
+public:
+  void read_integer( std::uint32_t *value ) noexcept override
+  {
+    reading.store( true );
+
+    while ( !released.load() )
+      std::this_thread::yield();
+
+    *value = 0;
+  }
+
+  std::atomic<bool> reading{ false };
+  std::atomic<bool> released{ false };
+};
+
+TEST_CASE( "A running Machine is sampled from another thread" )
+{
+  Machine machine{ 128_KB, nullptr, nullptr };
+  machine.reset();
+
+  auto inspector = machine.get_inspector();
+
+  constexpr ui32 counter{ 0x8000'0000 };
+
+  // $8 is incremented and stored, $10 copies it
+  ui32 const program[] = {
+    "LUI"_cpu | 9_rt | 0x8000_imm16,
+    "ADDIU"_cpu | 8_rt | 8_rs | 1_imm16,        // loop:
+    "SW"_cpu | 8_rt | 9_rs,
+    "ADDIU"_cpu | 10_rt | 8_rs,
+    "BEQ"_cpu | 0xFFFC_imm16,                   // loop
+  };
+  inspector.RAM_write( 0xBFC0'0000, program, sizeof( program ) );
+
+  ui32 const zero = 0;
+  inspector.RAM_write( counter, &zero, 4 );
+  inspector.CPU_gpr_begin()[8] = 0;
+  inspector.CPU_gpr_begin()[10] = 0;
+
+  std::thread runner( [&machine] { machine.start(); } );
+
+  ui32 last = 0;
+
+  // Until the guest is surely running, it could be stopped before starting otherwise
+  for ( int i = 0; i < 200 || last < 1000; ++i )
+  {
+    MachineInspector::CPUSample sample;
+    REQUIRE_FALSE( inspector.CPU_sample( sample, counter, 4, 1000 ) );
+    REQUIRE( sample.memory.size() == 4 );
+
+    ui32 stored;
+    std::memcpy( &stored, sample.memory.data(), 4 );
+
+    auto const $8 = sample.gpr[8];
+    auto const $10 = sample.gpr[10];
+
+    // Taken between two instructions, never in the middle of one
+    bool const before_store = sample.pc == 0xBFC0'0008;
+    bool const before_copy = before_store || sample.pc == 0xBFC0'000C;
+
+    REQUIRE( stored == ( before_store ? $8 - 1 : $8 ) );
+    REQUIRE( $10 == ( before_copy ? $8 - 1 : $8 ) );
+    REQUIRE( $8 >= last );
+
+    last = $8;
+  }
+
+  machine.stop();
+  runner.join();
+
+  // Stopped, the sample is taken directly
+  MachineInspector::CPUSample sample;
+  REQUIRE_FALSE( inspector.CPU_sample( sample ) );
+  REQUIRE( sample.pc == inspector.CPU_pc() );
+  REQUIRE( sample.gpr[8] == inspector.CPU_gpr_begin()[8] );
+  REQUIRE( sample.memory.empty() );
+}
+
+TEST_CASE( "A Machine blocked by a syscall isn't sampled" )
+{
+  BlockingTerminal terminal;
+
+  Machine machine{ 128_KB, &terminal, nullptr };
+  machine.reset();
+
+  auto inspector = machine.get_inspector();
+
+  ui32 const program[] = {
+    "ADDIU"_cpu | 2_rt | 5_imm16, // read_int
+    "SYSCALL"_cpu,
+    "ADDIU"_cpu | 2_rt | 10_imm16, // exit
+    "SYSCALL"_cpu,
+  };
+  inspector.RAM_write( 0xBFC0'0000, program, sizeof( program ) );
+
+  std::thread runner( [&machine] { machine.start(); } );
+
+  while ( !terminal.reading.load() )
+    std::this_thread::yield();
+
+  MachineInspector::CPUSample sample;
+  REQUIRE( inspector.CPU_sample( sample, 0, 0, 20 ) );
+
+  terminal.released.store( true );
+  runner.join();
+
+  REQUIRE_FALSE( inspector.CPU_sample( sample ) );
+  REQUIRE( sample.gpr[2] == 10 );
+  REQUIRE( inspector.CPU_read_exit_code() == CPU::EXIT );
+}
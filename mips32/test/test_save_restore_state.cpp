@@ -4,7 +4,9 @@
 #include "../src/cpu.hpp"
 
 #include <algorithm>
+#include <cstdio>
 #include <cstring>
+#include <string>
 
 using namespace mips32;
 using namespace mips32::literals;
@@ -143,6 +145,135 @@ TEST_CASE( "A functional machine exists" )
       REQUIRE( ram[0x8000'0000 + i] == i );
   }
 
+  SECTION( "The restored RAM doesn't modify its snapshot" )
+  {
+    for ( int i = 0; i < RAM::block_size; i += 4 )
+    {
+      ram[0x0000'0000 + i] = i;
+      ram[0x8000'0000 + i] = ~i;
+    }
+    ram[0x0500'0000] = 0x0500'0000;
+    ram[0x0900'0000] = 0x0900'0000;
+
+    REQUIRE( inspector.RAM_info().swapped_blocks_no == 1 );
+
+    REQUIRE_FALSE( inspector.save_state( MachineInspector::Component::RAM, state_name ) );
+
+    for ( int pass = 0; pass < 2; ++pass )
+    {
+      REQUIRE_FALSE( inspector.restore_state( MachineInspector::Component::RAM, state_name ) );
+
+      for ( int i = 0; i < RAM::block_size; i += 4 )
+      {
+        REQUIRE( ram[0x0000'0000 + i] == i );
+        REQUIRE( ram[0x8000'0000 + i] == ~i );
+      }
+      REQUIRE( ram[0x0500'0000] == 0x0500'0000 );
+      REQUIRE( ram[0x0900'0000] == 0x0900'0000 );
+
+      // Swaps every block in and out
+      for ( int i = 0; i < RAM::block_size; i += 4 )
+      {
+        ram[0x0000'0000 + i] = 0xFFFF'FFFF;
+        ram[0x8000'0000 + i] = 0xFFFF'FFFF;
+      }
+      ram[0x0500'0000] = 0xFFFF'FFFF;
+      ram[0x0900'0000] = 0xFFFF'FFFF;
+    }
+  }
+
+  SECTION( "A corrupted RAM snapshot isn't restored" )
+  {
+    for ( int i = 0; i < RAM::block_size; i += 4 )
+      ram[0x0000'0000 + i] = i;  // RAW
+    ram[0x0500'0000] = 0x0500'0000; // RLE
+
+    REQUIRE_FALSE( inspector.save_state( MachineInspector::Component::RAM, state_name ) );
+
+    std::string const file_name = std::string( state_name ) + ".ram";
+
+    auto const corrupt = [&]( long offset_from_end ) {
+      auto * file = std::fopen( file_name.c_str(), "r+b" );
+      REQUIRE( file );
+      REQUIRE_FALSE( std::fseek( file, -offset_from_end, SEEK_END ) );
+
+      auto const byte = std::fgetc( file );
+      REQUIRE_FALSE( std::fseek( file, -1, SEEK_CUR ) );
+      std::fputc( byte ^ 0xFF, file );
+
+      std::fclose( file );
+    };
+
+    ram[0x0000'0000] = 0xFFFF'FFFF;
+
+    // Inside the last block
+    corrupt( 4 );
+    REQUIRE( inspector.restore_state( MachineInspector::Component::RAM, state_name ) );
+
+    // The RAM is untouched
+    REQUIRE( ram[0x0000'0000] == 0xFFFF'FFFF );
+    REQUIRE( ram[0x0500'0000] == 0x0500'0000 );
+
+    corrupt( 4 );
+    REQUIRE_FALSE( inspector.restore_state( MachineInspector::Component::RAM, state_name ) );
+    REQUIRE( ram[0x0000'0000] == 0 );
+  }
+
+  SECTION( "A corrupted RAW block swapped in the snapshot is reported when used, then used as a new block" )
+  {
+    for ( int i = 0; i < RAM::block_size; i += 4 )
+      ram[0x8000'0000 + i] = i; // RAW
+
+    // More accessed than the RAW block
+    for ( int i = 0; i <= RAM::block_size / 4; ++i )
+    {
+      ram[0x0500'0000] = 0x0500'0000;
+      ram[0x0900'0000] = 0x0900'0000;
+    }
+
+    ram[0x0000'0000] = 0; // The least accessed block is swapped out
+
+    REQUIRE( inspector.RAM_swapped_addresses() == std::vector<std::uint32_t>{ 0x8000'0000 } );
+    REQUIRE_FALSE( inspector.save_state( MachineInspector::Component::RAM, state_name ) );
+
+    // Inside the last block, the swapped one
+    std::string const file_name = std::string( state_name ) + ".ram";
+
+    auto * file = std::fopen( file_name.c_str(), "r+b" );
+    REQUIRE( file );
+    REQUIRE_FALSE( std::fseek( file, -4, SEEK_END ) );
+    std::fputc( 0xFF, file );
+    std::fclose( file );
+
+    REQUIRE_FALSE( inspector.restore_state( MachineInspector::Component::RAM, state_name ) );
+    REQUIRE( inspector.RAM_corrupted_addresses().empty() );
+
+    SECTION( "When first used" )
+    {
+      REQUIRE( ram[0x0500'0000] == 0x0500'0000 );
+      REQUIRE( inspector.RAM_corrupted_addresses().empty() );
+
+      REQUIRE( ram[0x8000'0000] == 0x0417'CCCC );
+      REQUIRE( ram[0x8000'0000 + RAM::block_size - 4] == 0x0417'CCCC );
+      REQUIRE( inspector.RAM_corrupted_addresses() == std::vector<std::uint32_t>{ 0x8000'0000 } );
+    }
+
+    SECTION( "When verified" )
+    {
+      REQUIRE( inspector.RAM_verify() );
+      REQUIRE( inspector.RAM_corrupted_addresses() == std::vector<std::uint32_t>{ 0x8000'0000 } );
+
+      // Once
+      REQUIRE( ram[0x8000'0000] == 0x0417'CCCC );
+      REQUIRE( inspector.RAM_corrupted_addresses().size() == 1 );
+    }
+
+    // A snapshot not corrupted
+    REQUIRE_FALSE( inspector.save_state( MachineInspector::Component::RAM, state_name ) );
+    REQUIRE_FALSE( inspector.restore_state( MachineInspector::Component::RAM, state_name ) );
+    REQUIRE_FALSE( inspector.RAM_verify() );
+  }
+
   SECTION( "I save and restore CPU" )
   {
     MachineInspector copy_inspector;
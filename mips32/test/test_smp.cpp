@@ -0,0 +1,106 @@
+#include <catch.hpp>
+
+#include <mips32/machine.hpp>
+#include "../src/cpu.hpp"
+
+#include "helpers/test_cpu_instructions.hpp"
+
+#include <cstdint>
+#include <vector>
+
+using namespace mips32;
+using namespace mips32::literals;
+
+using ui32 = std::uint32_t;
+
+// Every core starts from the reset vector
+constexpr ui32 reset_vector{ 0xBFC0'0000 };
+
+void load_program( MachineInspector &inspector, std::vector<ui32> const &program )
+{
+  inspector.RAM_write( reset_vector, program.data(), ( ui32 )( program.size() * 4 ) );
+}
+
+ui32 read_word( MachineInspector &inspector, ui32 address )
+{
+  ui32 word{ 0 };
+  auto const bytes = inspector.RAM_read( address, 4 );
+  std::copy( bytes.begin(), bytes.end(), ( char * )&word );
+  return word;
+}
+
+TEST_CASE( "A Machine runs more cores sharing the RAM" )
+{
+  Machine machine{ 128_KB, nullptr, nullptr, 4 };
+  machine.reset();
+
+  REQUIRE( machine.cores() == 4 );
+  REQUIRE( ( machine.get_inspector( 2 ).access_CP0().e_base & 0x3FF ) == 2 );
+
+  auto inspector = machine.get_inspector();
+
+  constexpr ui32 increments{ 1000 };
+  constexpr ui32 counter{ 0x8000'0000 };
+
+  // Every core increments the counter with LL/SC, then the first one waits for the others and exits
+  load_program( inspector, {
+    "LUI"_cpu | 8_rt | 0x8000_imm16,
+    "ADDIU"_cpu | 9_rt | increments,
+    "LL"_cpu | 10_rt | 8_rs,                    // retry:
+    "ADDIU"_cpu | 10_rt | 10_rs | 1_imm16,
+    "SC"_cpu | 10_rt | 8_rs,
+    "BEQ"_cpu | 10_rs | 0_rt | 0xFFFC_imm16,    // retry
+    "SYNC"_cpu,
+    "ADDIU"_cpu | 9_rt | 9_rs | 0xFFFF_imm16,
+    "BNE"_cpu | 9_rs | 0_rt | 0xFFF9_imm16,     // retry
+    "MFC0"_cpu | 11_rt | 15_rd | 1,             // EBase
+    "ANDI"_cpu | 11_rt | 11_rs | 0x3FF_imm16,
+    "BNE"_cpu | 11_rs | 0_rt | 5_imm16,         // spin
+    "ADDIU"_cpu | 12_rt | 4 * increments,
+    "LW"_cpu | 13_rt | 8_rs,                    // wait:
+    "BNE"_cpu | 13_rs | 12_rt | 0xFFFE_imm16,   // wait
+    "ADDIU"_cpu | 2_rt | 10_imm16,
+    "SYSCALL"_cpu,
+    "BEQ"_cpu | 0xFFFF_imm16,                   // spin:
+  } );
+
+  ui32 const zero = 0;
+  inspector.RAM_write( counter, &zero, 4 );
+
+  REQUIRE( machine.start() == CPU::EXIT );
+  REQUIRE( read_word( inspector, counter ) == 4 * increments );
+}
+
+TEST_CASE( "A core of a Machine interrupts another one" )
+{
+  Machine machine{ 128_KB, nullptr, nullptr, 2 };
+  machine.reset();
+
+  auto inspector = machine.get_inspector( 0 );
+
+  // The second core sends the IPI, the first one waits for it
+  load_program( inspector, {
+    "MFC0"_cpu | 11_rt | 15_rd | 1,             // EBase
+    "ANDI"_cpu | 11_rt | 11_rs | 0x3FF_imm16,
+    "BEQ"_cpu | 11_rs | 0_rt | 4_imm16,         // spin
+    "ADDIU"_cpu | 2_rt | 19_imm16,
+    "ADDIU"_cpu | 4_rt | 0_imm16,
+    "SYSCALL"_cpu,
+    "NOP"_cpu,
+    "BEQ"_cpu | 0xFFFF_imm16,                   // spin:
+  } );
+
+  // The handler exits
+  ui32 const handler[] = {
+    "ADDIU"_cpu | 2_rt | 10_imm16,
+    "SYSCALL"_cpu,
+  };
+  inspector.RAM_write( 0x8000'0180, handler, sizeof( handler ) );
+
+  auto &cp0 = inspector.access_CP0();
+  cp0.status = CPU::ipi_line | 1; // Kernel mode, IM2, IE
+
+  REQUIRE( machine.start() == CPU::EXIT );
+  REQUIRE( ( cp0.cause >> 2 & 0x1F ) == CPU::Int );
+  REQUIRE( ( cp0.cause & CPU::ipi_line ) );
+}
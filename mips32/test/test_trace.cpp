@@ -0,0 +1,281 @@
+#include <catch.hpp>
+
+#include <mips32/machine.hpp>
+#include <mips32/trace.hpp>
+#include "../src/cpu.hpp"
+#include "../src/trace.hpp"
+
+#include "helpers/test_cpu_instructions.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace mips32;
+using namespace mips32::literals;
+
+using ui32 = std::uint32_t;
+
+constexpr char const trace_file[] = { "test_trace.trace" };
+
+// Stores the counter, and its low byte, then decrements it down to 0
+void write_traced_program( MachineInspector &inspector, std::uint16_t iterations )
+{
+  ui32 const program[] = {
+    "LUI"_cpu | 9_rt | 0x1001_imm16,
+    "ORI"_cpu | 8_rt | ui32( iterations ),
+    "SW"_cpu | 8_rt | 9_rs,                     // loop:
+    "SB"_cpu | 8_rt | 9_rs | 5_imm16,
+    "ADDIU"_cpu | 8_rt | 8_rs | 0xFFFF_imm16,
+    "BNE"_cpu | 8_rs | 0_rt | 0xFFFC_imm16,     // loop
+    "MTC1"_cpu | 9_rt | 2_rd,
+    "ADDIU"_cpu | 2_rt | 10_imm16,              // exit
+    "SYSCALL"_cpu,
+  };
+  inspector.RAM_write( 0xBFC0'0000, program, sizeof( program ) );
+}
+
+std::vector<char> read_trace_file()
+{
+  std::vector<char> bytes;
+
+  auto *file = std::fopen( trace_file, "rb" );
+  REQUIRE( file );
+
+  char buffer[4096];
+  while ( auto const count = std::fread( buffer, 1, sizeof( buffer ), file ) )
+    bytes.insert( bytes.end(), buffer, buffer + count );
+
+  std::fclose( file );
+  return bytes;
+}
+
+void write_trace_file( std::vector<char> const &bytes )
+{
+  auto *file = std::fopen( trace_file, "wb" );
+  REQUIRE( file );
+
+  std::fwrite( bytes.data(), 1, bytes.size(), file );
+  std::fclose( file );
+}
+
+TEST_CASE( "The LZ77 of the trace blocks round-trips" )
+{
+  std::vector<std::uint8_t> raw( 64 * 1024 );
+  std::vector<std::uint8_t> compressed( raw.size() );
+  std::vector<std::uint8_t> decompressed( raw.size() );
+
+  std::mt19937 random{ 42 };
+
+  SECTION( "Repetitive bytes are compressed" )
+  {
+    for ( ui32 i = 0; i < raw.size(); ++i )
+      raw[i] = std::uint8_t( i % 7 == 0 ? random() : i / 100 );
+
+    auto const size = lz_compress( raw.data(), ( ui32 )raw.size(), compressed.data() );
+    REQUIRE( size );
+    REQUIRE( size < raw.size() );
+
+    REQUIRE_FALSE( lz_decompress( compressed.data(), size, decompressed.data(), ( ui32 )decompressed.size() ) );
+    REQUIRE( decompressed == raw );
+
+    // A size that doesn't match is refused
+    REQUIRE( lz_decompress( compressed.data(), size, decompressed.data(), ( ui32 )decompressed.size() - 1 ) );
+  }
+
+  SECTION( "Random bytes aren't" )
+  {
+    for ( auto &byte : raw )
+      byte = std::uint8_t( random() );
+
+    REQUIRE( lz_compress( raw.data(), ( ui32 )raw.size(), compressed.data() ) == 0 );
+  }
+}
+
+TEST_CASE( "A traced store doesn't change the instruction, if it swaps its block" )
+{
+  // The stores swap the block of the code, and the other way around
+  Machine machine{ 64_KB, nullptr, nullptr };
+  machine.reset();
+
+  auto inspector = machine.get_inspector();
+
+  ui32 const program[] = {
+    "LUI"_cpu | 13_rt | 0x1002_imm16,
+    "ADDIU"_cpu | 12_rt | 7_imm16,
+    "SW"_cpu | 12_rt | 13_rs,
+    "SW"_cpu | 12_rt | 13_rs | 4_imm16,
+    "ADDIU"_cpu | 2_rt | 10_imm16,              // exit
+    "SYSCALL"_cpu,
+  };
+  inspector.RAM_write( 0xBFC0'0000, program, sizeof( program ) );
+
+  // A wrong instruction could loop inside the exception handler
+  inspector.CPU_retire_limit() = 1000;
+
+  REQUIRE_FALSE( machine.trace( trace_file ) );
+  REQUIRE( machine.start() == CPU::EXIT );
+  REQUIRE_FALSE( machine.trace( nullptr ) );
+
+  TraceReader reader{ trace_file };
+
+  std::vector<TraceReader::Record> records;
+
+  TraceReader::Record record;
+  while ( !reader.read( record ) )
+    records.push_back( record );
+
+  REQUIRE_FALSE( reader.failed() );
+  REQUIRE( records.size() == 6 );
+
+  for ( ui32 i = 0; i < records.size(); ++i )
+    REQUIRE( records[i].word == program[i] );
+
+  REQUIRE( records[3].stores.size() == 1 );
+  REQUIRE( records[3].stores[0].address == 0x1002'0004 );
+  REQUIRE( records[3].stores[0].value == 7 );
+}
+
+TEST_CASE( "A trace records every instruction retired" )
+{
+  Machine machine{ 1024 * 1024, nullptr, nullptr };
+  machine.reset();
+
+  auto inspector = machine.get_inspector();
+
+  SECTION( "The registers and the memory changed are replayed" )
+  {
+    write_traced_program( inspector, 2 );
+    inspector.CPU_gpr_begin()[20] = 0xABCD;
+
+    REQUIRE_FALSE( machine.trace( trace_file ) );
+    REQUIRE( machine.start() == CPU::EXIT );
+    REQUIRE_FALSE( machine.trace( nullptr ) );
+
+    TraceReader reader{ trace_file };
+    REQUIRE_FALSE( reader.failed() );
+
+    auto const &initial = reader.initial_state();
+    REQUIRE( initial.pc == 0xBFC0'0000 );
+    REQUIRE( initial.gpr[20] == 0xABCD );
+
+    std::vector<TraceReader::Record> records;
+
+    TraceReader::Record record;
+    while ( !reader.read( record ) )
+      records.push_back( record );
+
+    REQUIRE_FALSE( reader.failed() );
+    REQUIRE( records.size() == 2 + 2 * 4 + 3 );
+    REQUIRE( records.size() == inspector.CPU_retired() );
+
+    REQUIRE( records[0].index == 0 );
+    REQUIRE( records[0].pc == 0xBFC0'0000 );
+    REQUIRE( records[0].word == ( "LUI"_cpu | 9_rt | 0x1001_imm16 ) );
+    REQUIRE( records[0].gpr_changed == 1u << 9 );
+    REQUIRE( records[0].gpr[9] == 0x1001'0000 );
+    REQUIRE( records[0].stores.empty() );
+
+    // SW, SB of the first iteration
+    REQUIRE( records[2].gpr_changed == 0 );
+    REQUIRE( records[2].stores.size() == 1 );
+    REQUIRE( records[2].stores[0].address == 0x1001'0000 );
+    REQUIRE( records[2].stores[0].value == 2 );
+
+    REQUIRE( records[3].stores.size() == 1 );
+    REQUIRE( records[3].stores[0].address == 0x1001'0004 );
+    REQUIRE( ( records[3].stores[0].value >> 8 & 0xFF ) == 2 );
+
+    // The branch taken, then the loop again, with the words recent
+    REQUIRE( records[6].pc == 0xBFC0'0008 );
+    REQUIRE( records[6].word == records[2].word );
+    REQUIRE( records[6].stores[0].value == 1 );
+
+    // MTC1
+    auto const &mtc1 = records[10];
+    REQUIRE( mtc1.pc == 0xBFC0'0018 );
+    REQUIRE( mtc1.fpr_changed == 1u << 2 );
+    REQUIRE( mtc1.fpr[2].i32 == 0x1001'0000 );
+
+    auto const &last = records.back();
+    REQUIRE( last.pc == 0xBFC0'0020 );
+    REQUIRE( std::equal( last.gpr.begin(), last.gpr.end(), inspector.CPU_gpr_begin() ) );
+    REQUIRE( last.gpr[20] == 0xABCD );
+  }
+
+  SECTION( "A long trace spans more blocks" )
+  {
+    write_traced_program( inspector, 0xFFFF );
+
+    REQUIRE_FALSE( machine.trace( trace_file ) );
+    REQUIRE( machine.start() == CPU::EXIT );
+    REQUIRE_FALSE( machine.trace( nullptr ) );
+
+    auto const bytes = read_trace_file();
+    auto const instructions = inspector.CPU_retired();
+
+    {
+      TraceReader reader{ trace_file };
+
+      TraceReader::Record record;
+      std::uint64_t records = 0;
+      std::uint32_t stores = 0;
+
+      while ( !reader.read( record ) )
+      {
+        ++records;
+        stores += ( ui32 )record.stores.size();
+      }
+
+      REQUIRE_FALSE( reader.failed() );
+      REQUIRE( records == instructions );
+      REQUIRE( stores == 2 * 0xFFFF );
+      REQUIRE( std::equal( record.gpr.begin(), record.gpr.end(), inspector.CPU_gpr_begin() ) );
+    }
+
+    SECTION( "A truncated trace is readable up to its last block" )
+    {
+      write_trace_file( std::vector<char>( bytes.begin(), bytes.begin() + bytes.size() / 2 ) );
+
+      TraceReader reader{ trace_file };
+
+      TraceReader::Record record;
+      std::uint64_t records = 0;
+
+      while ( !reader.read( record ) )
+        ++records;
+
+      REQUIRE( reader.failed() );
+      REQUIRE( records > 0 );
+      REQUIRE( records < instructions );
+    }
+
+    SECTION( "A corrupted block is detected" )
+    {
+      auto corrupted = bytes;
+      corrupted[corrupted.size() / 2] ^= 0x10;
+      write_trace_file( corrupted );
+
+      TraceReader reader{ trace_file };
+
+      TraceReader::Record record;
+      while ( !reader.read( record ) )
+        ;
+
+      REQUIRE( reader.failed() );
+    }
+  }
+
+  SECTION( "Only a machine with a single core is traced" )
+  {
+    Machine smp{ 1024 * 1024, nullptr, nullptr, 2 };
+    REQUIRE( smp.trace( trace_file ) );
+
+    REQUIRE_FALSE( machine.trace( nullptr ) ); // nothing to stop
+    REQUIRE( TraceReader{ "test_trace.missing" }.failed() );
+  }
+
+  std::remove( trace_file );
+}
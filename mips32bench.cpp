@@ -0,0 +1,500 @@
+#include "mips32/test/helpers/test_cp1_instructions.hpp"
+#include "mips32/test/helpers/test_cpu_instructions.hpp"
+
+#include <mips32/io_device.hpp>
+#include <mips32/literals.hpp>
+#include <mips32/machine.hpp>
+#include <mips32/machine_inspector.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace mips32::literals;
+
+namespace
+{
+// Returned by `Machine::start` when the guest called the exit syscall, see `CPU::EXIT`
+constexpr std::uint32_t exit_code_exit{ 4 };
+
+// The buffers of the kernels, in kseg0 as the data of a program
+constexpr std::uint32_t source_address{ 0x8010'0000 };
+constexpr std::uint32_t destination_address{ 0x8800'0000 };
+constexpr std::uint32_t result_address{ 0x9000'0000 };
+
+// The formats of COP1
+constexpr std::uint32_t fmt_s{ 0x10 << 21 };
+constexpr std::uint32_t fmt_d{ 0x11 << 21 };
+
+/*
+ * The words of a kernel, loaded at the reset vector.
+ *
+ * The loops branch back with the compact branches, without delay slot,
+ * to the index of a word returned by `here`.
+ */
+class Program
+{
+public:
+    std::uint32_t here() const { return std::uint32_t(words.size()); }
+
+    Program& operator<<(std::uint32_t word)
+    {
+        words.push_back(word);
+        return *this;
+    }
+
+    // The offset of a branch emitted now to the word `label`, for BNEC and BNEZC
+    std::uint32_t offset16(std::uint32_t label) const { return (label - here() - 1) & 0xFFFF; }
+    std::uint32_t offset21(std::uint32_t label) const { return (label - here() - 1) & 0x1F'FFFF; }
+
+    // LUI and ORI
+    void load_constant(std::uint32_t rt, std::uint32_t value)
+    {
+        *this << ("LUI"_cpu | rt << 16 | value >> 16);
+        *this << ("ORI"_cpu | rt << 16 | rt << 21 | (value & 0xFFFF));
+    }
+
+    // The exit syscall
+    void exit()
+    {
+        *this << ("ORI"_cpu | 2_rt | 10_imm16);
+        *this << "SYSCALL"_cpu;
+    }
+
+    void write(mips32::MachineInspector& inspector) const
+    {
+        inspector.RAM_write(0xBFC0'0000, words.data(), std::uint32_t(words.size() * 4));
+    }
+
+private:
+    std::vector<std::uint32_t> words;
+};
+
+// The output of the printer is formatted, as a terminal would, then discarded
+class NullIODevice : public mips32::IODevice
+{
+public:
+    void print_integer(std::uint32_t value) noexcept override { written += fmt::format_int(value).size(); }
+    void print_float(float value) noexcept override { written += fmt::formatted_size("{}", value); }
+    void print_double(double value) noexcept override { written += fmt::formatted_size("{}", value); }
+    void print_string(char const* string) noexcept override { written += string ? std::strlen(string) : 0; }
+    void print_string(char const*, std::uint32_t length) noexcept override { written += length; }
+
+    void read_integer(std::uint32_t* value) noexcept override { *value = 0; }
+    void read_float(float* value) noexcept override { *value = 0; }
+    void read_double(double* value) noexcept override { *value = 0; }
+    void read_string(char* string, std::uint32_t max_count) noexcept override
+    {
+        if (string && max_count)
+            string[0] = '\0';
+    }
+
+    std::uint64_t written = 0;
+};
+
+// Mixes the ALU instructions, `scale` millions of iterations
+void integer_loop(mips32::MachineInspector& inspector, std::uint32_t scale)
+{
+    Program program;
+    program.load_constant(8, scale * 1'000'000);
+
+    auto const loop = program.here();
+    program << ("ADDU"_cpu | 9_rd | 9_rs | 8_rt)
+            << ("XOR"_cpu | 10_rd | 10_rs | 9_rt)
+            << ("SLL"_cpu | 11_rd | 10_rt | 3_shamt)
+            << ("MUL"_cpu | 12_rd | 11_rs | 9_rt)
+            << ("SLTU"_cpu | 13_rd | 12_rs | 10_rt)
+            << ("ADDU"_cpu | 14_rd | 14_rs | 13_rt)
+            << ("ADDIU"_cpu | 8_rt | 8_rs | 0xFFFF_imm16);
+    program << ("BNEZC"_cpu | 8_rs | program.offset21(loop));
+
+    program.exit();
+    program.write(inspector);
+}
+
+// Sets a buffer of `size` bytes a word at a time, then copies it, `scale` times 4 MB in total
+void memcpy_memset(mips32::MachineInspector& inspector, std::uint32_t scale, std::uint32_t size)
+{
+    Program program;
+    program.load_constant(16, source_address);
+    program.load_constant(17, destination_address);
+    program.load_constant(18, size);
+    program.load_constant(19, scale * (4_MB / size));
+
+    auto const pass = program.here();
+    program << ("OR"_cpu | 8_rd | 16_rs)
+            << ("ADDU"_cpu | 9_rd | 16_rs | 18_rt);
+
+    auto const set = program.here();
+    program << ("SW"_cpu | 19_rt | 8_rs)
+            << ("ADDIU"_cpu | 8_rt | 8_rs | 4_imm16);
+    program << ("BNEC"_cpu | 8_rs | 9_rt | program.offset16(set));
+
+    program << ("OR"_cpu | 8_rd | 16_rs)
+            << ("OR"_cpu | 10_rd | 17_rs);
+
+    auto const copy = program.here();
+    program << ("LW"_cpu | 11_rt | 8_rs)
+            << ("SW"_cpu | 11_rt | 10_rs)
+            << ("ADDIU"_cpu | 8_rt | 8_rs | 4_imm16)
+            << ("ADDIU"_cpu | 10_rt | 10_rs | 4_imm16);
+    program << ("BNEC"_cpu | 8_rs | 9_rt | program.offset16(copy));
+
+    program << ("ADDIU"_cpu | 19_rt | 19_rs | 0xFFFF_imm16);
+    program << ("BNEZC"_cpu | 19_rs | program.offset21(pass));
+
+    program.exit();
+    program.write(inspector);
+}
+
+// Follows a random cycle of 16384 nodes, 256 bytes apart, `scale` millions of loads
+void pointer_chase(mips32::MachineInspector& inspector, std::uint32_t scale)
+{
+    constexpr std::uint32_t nodes{ 16384 };
+    constexpr std::uint32_t stride{ 256 };
+
+    // Sattolo's shuffle: a single cycle through every node
+    std::vector<std::uint32_t> order(nodes);
+    for (std::uint32_t i = 0; i < nodes; ++i)
+        order[i] = i;
+
+    std::uint32_t seed = 0x1234'5678;
+    for (std::uint32_t i = nodes - 1; i > 0; --i)
+    {
+        seed = seed * 1'664'525 + 1'013'904'223;
+        std::swap(order[i], order[seed % i]);
+    }
+
+    for (std::uint32_t i = 0; i < nodes; ++i)
+    {
+        std::uint32_t const next = source_address + order[(i + 1) % nodes] * stride;
+        inspector.RAM_write(source_address + order[i] * stride, &next, 4);
+    }
+
+    Program program;
+    program.load_constant(8, source_address);
+    program.load_constant(9, scale * 1'000'000);
+
+    auto const loop = program.here();
+    program << ("LW"_cpu | 8_rt | 8_rs)
+            << ("ADDIU"_cpu | 9_rt | 9_rs | 0xFFFF_imm16);
+    program << ("BNEZC"_cpu | 9_rs | program.offset21(loop));
+
+    program.exit();
+    program.write(inspector);
+}
+
+// C = A * B, 32 x 32, `scale` times 32 products
+template <typename Float>
+void matmul(mips32::MachineInspector& inspector, std::uint32_t scale)
+{
+    constexpr std::uint32_t n{ 32 };
+    constexpr bool single{ sizeof(Float) == 4 };
+    constexpr std::uint32_t element{ sizeof(Float) };
+    constexpr std::uint32_t fmt{ single ? fmt_s : fmt_d };
+    constexpr std::uint32_t load{ single ? "LWC1"_cpu : "LDC1"_cpu };
+    constexpr std::uint32_t store{ single ? "SWC1"_cpu : "SDC1"_cpu };
+
+    std::vector<Float> a(n * n), b(n * n);
+    for (std::uint32_t i = 0; i < n * n; ++i)
+    {
+        a[i] = Float(i % 7) * Float(0.25);
+        b[i] = Float(i % 5) * Float(0.5);
+    }
+
+    inspector.RAM_write(source_address, a.data(), n * n * element);
+    inspector.RAM_write(destination_address, b.data(), n * n * element);
+
+    Program program;
+    program.load_constant(16, source_address);
+    program.load_constant(17, destination_address);
+    program.load_constant(18, result_address);
+    program.load_constant(19, n);
+    program.load_constant(20, n * element); // A row
+    program.load_constant(21, scale * 32);
+
+    auto const product = program.here();
+    program << ("OR"_cpu | 10_rd | 16_rs)  // A row i
+            << ("OR"_cpu | 12_rd | 18_rs)  // C element
+            << ("OR"_cpu | 8_rd | 19_rs);  // i
+
+    auto const row = program.here();
+    program << ("OR"_cpu | 13_rd | 17_rs)  // B column j
+            << ("OR"_cpu | 9_rd | 19_rs);  // j
+
+    auto const column = program.here();
+    program << ("OR"_cpu | 14_rd | 10_rs)
+            << ("OR"_cpu | 15_rd | 13_rs)
+            << ("OR"_cpu | 11_rd | 19_rs)  // k
+            << ("SUB"_cp1 | fmt | 0_r1 | 0_r2 | 0_r3);
+
+    auto const dot = program.here();
+    program << (load | 2_rt | 14_rs)
+            << (load | 4_rt | 15_rs)
+            << ("MUL"_cp1 | fmt | 6_r1 | 2_r2 | 4_r3)
+            << ("ADD"_cp1 | fmt | 0_r1 | 0_r2 | 6_r3)
+            << ("ADDIU"_cpu | 14_rt | 14_rs | element)
+            << ("ADDU"_cpu | 15_rd | 15_rs | 20_rt)
+            << ("ADDIU"_cpu | 11_rt | 11_rs | 0xFFFF_imm16);
+    program << ("BNEZC"_cpu | 11_rs | program.offset21(dot));
+
+    program << (store | 0_rt | 12_rs)
+            << ("ADDIU"_cpu | 12_rt | 12_rs | element)
+            << ("ADDIU"_cpu | 13_rt | 13_rs | element)
+            << ("ADDIU"_cpu | 9_rt | 9_rs | 0xFFFF_imm16);
+    program << ("BNEZC"_cpu | 9_rs | program.offset21(column));
+
+    program << ("ADDU"_cpu | 10_rd | 10_rs | 20_rt)
+            << ("ADDIU"_cpu | 8_rt | 8_rs | 0xFFFF_imm16);
+    program << ("BNEZC"_cpu | 8_rs | program.offset21(row));
+
+    program << ("ADDIU"_cpu | 21_rt | 21_rs | 0xFFFF_imm16);
+    program << ("BNEZC"_cpu | 21_rs | program.offset21(product));
+
+    program.exit();
+    program.write(inspector);
+}
+
+// Prints an integer and a string, `scale` millions of times
+void syscall_printer(mips32::MachineInspector& inspector, std::uint32_t scale)
+{
+    char const line[] = " bottles of beer\n";
+    inspector.RAM_write(source_address, line, sizeof(line));
+
+    Program program;
+    program.load_constant(16, source_address);
+    program.load_constant(8, scale * 1'000'000);
+
+    auto const loop = program.here();
+    program << ("ORI"_cpu | 2_rt | 1_imm16)   // print int
+            << ("OR"_cpu | 4_rd | 8_rs)
+            << "SYSCALL"_cpu
+            << ("ORI"_cpu | 2_rt | 4_imm16)   // print string
+            << ("OR"_cpu | 4_rd | 16_rs)
+            << "SYSCALL"_cpu
+            << ("ADDIU"_cpu | 8_rt | 8_rs | 0xFFFF_imm16);
+    program << ("BNEZC"_cpu | 8_rs | program.offset21(loop));
+
+    program.exit();
+    program.write(inspector);
+}
+
+// The RAM is limited to 4 blocks
+constexpr std::uint32_t swap_alloc_limit{ 4 * 64_KB };
+
+// Loads a word every 256 bytes of 1 MB, `scale` times 256 passes: every block is swapped in on every pass
+void swap_scan(mips32::MachineInspector& inspector, std::uint32_t scale)
+{
+    Program program;
+    program.load_constant(16, source_address);
+    program.load_constant(17, source_address + 1_MB);
+    program.load_constant(19, scale * 256);
+
+    auto const pass = program.here();
+    program << ("OR"_cpu | 8_rd | 16_rs);
+
+    auto const scan = program.here();
+    program << ("LW"_cpu | 9_rt | 8_rs)
+            << ("ADDU"_cpu | 10_rd | 10_rs | 9_rt)
+            << ("ADDIU"_cpu | 8_rt | 8_rs | 256_imm16);
+    program << ("BNEC"_cpu | 8_rs | 17_rt | program.offset16(scan));
+
+    program << ("ADDIU"_cpu | 19_rt | 19_rs | 0xFFFF_imm16);
+    program << ("BNEZC"_cpu | 19_rs | program.offset21(pass));
+
+    program.exit();
+    program.write(inspector);
+}
+
+struct Kernel
+{
+    char const* name;
+    std::uint32_t alloc_limit; // Of the RAM, in bytes
+    void (*load)(mips32::MachineInspector& inspector, std::uint32_t scale);
+};
+
+Kernel const kernels[] = {
+    { "integer_loop", 512_MB, integer_loop },
+    { "memcpy_memset_256B", 512_MB, [](auto& inspector, auto scale) { memcpy_memset(inspector, scale, 256); } },
+    { "memcpy_memset_4KB", 512_MB, [](auto& inspector, auto scale) { memcpy_memset(inspector, scale, 4_KB); } },
+    { "memcpy_memset_64KB", 512_MB, [](auto& inspector, auto scale) { memcpy_memset(inspector, scale, 64_KB); } },
+    { "memcpy_memset_1MB", 512_MB, [](auto& inspector, auto scale) { memcpy_memset(inspector, scale, 1_MB); } },
+    { "pointer_chase", 512_MB, pointer_chase },
+    { "matmul_single", 512_MB, matmul<float> },
+    { "matmul_double", 512_MB, matmul<double> },
+    { "syscall_printer", 512_MB, syscall_printer },
+    { "swap_scan", swap_alloc_limit, swap_scan },
+};
+
+// Of a single run of a kernel, on a new Machine
+struct Run
+{
+    bool failed = false;
+    double seconds = 0;
+    std::uint64_t instructions = 0;
+    mips32::MachineInspector::RAMFaults faults{};
+};
+
+Run run(Kernel const& kernel, std::uint32_t scale, bool soft_float)
+{
+    NullIODevice device;
+    mips32::Machine machine{ kernel.alloc_limit, &device, nullptr };
+    machine.reset();
+
+    auto inspector = machine.get_inspector();
+    inspector.CP1_soft_float(soft_float);
+    kernel.load(inspector, scale);
+
+    // Only the faults of the guest
+    auto const before = inspector.RAM_faults();
+
+    auto const start = std::chrono::steady_clock::now();
+    auto const exit_code = machine.start();
+    auto const stop = std::chrono::steady_clock::now();
+
+    auto const after = inspector.RAM_faults();
+
+    Run result;
+    result.failed = exit_code != exit_code_exit;
+    result.seconds = std::chrono::duration<double>(stop - start).count();
+    result.instructions = inspector.CPU_retired();
+    result.faults = { after.allocations - before.allocations,
+                      after.swap_ins - before.swap_ins,
+                      after.swap_outs - before.swap_outs };
+    return result;
+}
+
+void usage(char const* program)
+{
+    fmt::print(stderr, "Usage: {} [--repetitions N] [--scale N] [--soft-float] [--list] [kernel...]\n", program);
+}
+} // namespace
+
+/*
+ * Runs the guest kernels on new Machines and prints, as JSON, the rates of the median run of each:
+ *
+ *  { "benchmarks": [ { "name": ..., "instructions": ..., "seconds": [ every run ... ],
+ *                      "median_seconds": ..., "mips": ..., "ns_per_instruction": ...,
+ *                      "ram": { "allocations": ..., "swap_ins": ..., "swap_outs": ...,
+ *                               "faults_per_million_instructions": ... } }, ... ] }
+ *
+ * Without names every kernel is run. With --soft-float CP1 computes in software, see `CP1::set_soft_float`.
+ * The swap files of `swap_scan` are written in the working directory.
+ */
+int main(int argc, char** argv)
+{
+    std::uint32_t repetitions = 5;
+    std::uint32_t scale = 1;
+    bool soft_float = false;
+    std::vector<std::string_view> names;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string_view const arg{ argv[i] };
+
+        if ((arg == "--repetitions" || arg == "--scale") && i + 1 < argc)
+        {
+            auto const value = std::strtoul(argv[++i], nullptr, 10);
+            if (value == 0)
+            {
+                usage(argv[0]);
+                return 1;
+            }
+
+            (arg == "--scale" ? scale : repetitions) = std::uint32_t(value);
+        }
+        else if (arg == "--soft-float")
+        {
+            soft_float = true;
+        }
+        else if (arg == "--list")
+        {
+            for (auto const& kernel : kernels)
+                fmt::print("{}\n", kernel.name);
+            return 0;
+        }
+        else if (arg.substr(0, 2) == "--")
+        {
+            usage(argv[0]);
+            return 1;
+        }
+        else
+        {
+            auto const found = std::find_if(std::begin(kernels), std::end(kernels),
+                                            [arg](Kernel const& kernel) { return arg == kernel.name; });
+            if (found == std::end(kernels))
+            {
+                fmt::print(stderr, "Unknown kernel '{}', see --list.\n", arg);
+                return 1;
+            }
+
+            names.push_back(arg);
+        }
+    }
+
+    std::string json = "{\n  \"benchmarks\": [";
+    bool first = true;
+
+    for (auto const& kernel : kernels)
+    {
+        if (!names.empty() && std::find(names.begin(), names.end(), kernel.name) == names.end())
+            continue;
+
+        std::vector<Run> runs;
+        for (std::uint32_t i = 0; i < repetitions; ++i)
+        {
+            runs.push_back(run(kernel, scale, soft_float));
+
+            if (runs.back().failed)
+            {
+                fmt::print(stderr, "The kernel '{}' didn't exit.\n", kernel.name);
+                return 1;
+            }
+        }
+
+        std::string seconds;
+        for (auto const& r : runs)
+            seconds += fmt::format("{}{:.6f}", seconds.empty() ? "" : ", ", r.seconds);
+
+        auto median = runs;
+        std::sort(median.begin(), median.end(), [](Run const& l, Run const& r) { return l.seconds < r.seconds; });
+        auto const& m = median[median.size() / 2];
+
+        auto const instructions = double(m.instructions);
+        auto const faults = m.faults.allocations + m.faults.swap_ins + m.faults.swap_outs;
+
+        json += fmt::format(
+            "{}\n    {{\n"
+            "      \"name\": \"{}\",\n"
+            "      \"instructions\": {},\n"
+            "      \"seconds\": [{}],\n"
+            "      \"median_seconds\": {:.6f},\n"
+            "      \"mips\": {:.3f},\n"
+            "      \"ns_per_instruction\": {:.3f},\n"
+            "      \"ram\": {{\n"
+            "        \"allocations\": {},\n"
+            "        \"swap_ins\": {},\n"
+            "        \"swap_outs\": {},\n"
+            "        \"faults_per_million_instructions\": {:.3f}\n"
+            "      }}\n"
+            "    }}",
+            first ? "" : ",", kernel.name, m.instructions, seconds, m.seconds,
+            instructions / m.seconds / 1e6, m.seconds * 1e9 / instructions,
+            m.faults.allocations, m.faults.swap_ins, m.faults.swap_outs, faults * 1e6 / instructions);
+
+        first = false;
+    }
+
+    json += "\n  ]\n}\n";
+    std::fputs(json.c_str(), stdout);
+
+    return 0;
+}
@@ -0,0 +1,580 @@
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#  include <direct.h>
+#else
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace
+{
+// A JSON value, as written by mips32-bench and mips32-ram-bench
+struct Value
+{
+    enum Type { NUL, BOOL, NUMBER, STRING, ARRAY, OBJECT };
+
+    Type type = NUL;
+    double number = 0;
+    std::string string;
+    std::vector<Value> elements;  // Of an array, or the values of an object
+    std::vector<std::string> keys; // Of an object
+
+    Value const* find(std::string_view key) const
+    {
+        for (std::size_t i = 0; i < keys.size(); ++i)
+        {
+            if (keys[i] == key)
+                return &elements[i];
+        }
+        return nullptr;
+    }
+};
+
+// Returns true on failure
+class Parser
+{
+public:
+    explicit Parser(std::string_view text) : p(text.data()), end(text.data() + text.size()) {}
+
+    bool parse(Value& value)
+    {
+        return parse_value(value) || (skip_spaces(), p != end);
+    }
+
+private:
+    void skip_spaces()
+    {
+        while (p != end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+            ++p;
+    }
+
+    bool expect(char c)
+    {
+        skip_spaces();
+        if (p == end || *p != c)
+            return true;
+        ++p;
+        return false;
+    }
+
+    bool parse_string(std::string& string)
+    {
+        if (expect('"'))
+            return true;
+
+        while (p != end && *p != '"')
+        {
+            if (*p == '\\')
+            {
+                if (++p == end)
+                    return true;
+
+                switch (*p)
+                {
+                case 'n': string += '\n'; break;
+                case 't': string += '\t'; break;
+                case 'r': string += '\r'; break;
+                case 'u': return true; // not written by the benchmarks
+                default: string += *p; break;
+                }
+            }
+            else
+            {
+                string += *p;
+            }
+            ++p;
+        }
+
+        return expect('"');
+    }
+
+    bool parse_value(Value& value)
+    {
+        skip_spaces();
+        if (p == end)
+            return true;
+
+        if (*p == '{')
+        {
+            ++p;
+            value.type = Value::OBJECT;
+
+            skip_spaces();
+            if (p != end && *p == '}')
+                return ++p, false;
+
+            do
+            {
+                value.keys.emplace_back();
+                value.elements.emplace_back();
+
+                if (parse_string(value.keys.back()) || expect(':') || parse_value(value.elements.back()))
+                    return true;
+            } while (!expect(','));
+
+            return expect('}');
+        }
+
+        if (*p == '[')
+        {
+            ++p;
+            value.type = Value::ARRAY;
+
+            skip_spaces();
+            if (p != end && *p == ']')
+                return ++p, false;
+
+            do
+            {
+                value.elements.emplace_back();
+                if (parse_value(value.elements.back()))
+                    return true;
+            } while (!expect(','));
+
+            return expect(']');
+        }
+
+        if (*p == '"')
+        {
+            value.type = Value::STRING;
+            return parse_string(value.string);
+        }
+
+        static struct
+        {
+            std::string_view word;
+            Value::Type type;
+            double number;
+        } const literals[] = { { "true", Value::BOOL, 1 }, { "false", Value::BOOL, 0 }, { "null", Value::NUL, 0 } };
+
+        for (auto const& literal : literals)
+        {
+            if (std::string_view(p, std::size_t(end - p)).substr(0, literal.word.size()) == literal.word)
+            {
+                p += literal.word.size();
+                value.type = literal.type;
+                value.number = literal.number;
+                return false;
+            }
+        }
+
+        // The text is NUL terminated, see `read_file`
+        char* number_end = nullptr;
+        value.type = Value::NUMBER;
+        value.number = std::strtod(p, &number_end);
+
+        if (number_end == p || number_end > end)
+            return true;
+
+        p = number_end;
+        return false;
+    }
+
+    char const* p;
+    char const* end;
+};
+
+// Returns true on failure
+bool read_file(std::string const& path, std::string& text)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return true;
+
+    text.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return false;
+}
+
+// Returns true on failure
+bool write_file(std::string const& path, std::string const& text)
+{
+    std::ofstream file(path, std::ios::binary);
+    return !file || !file.write(text.data(), std::streamsize(text.size()));
+}
+
+void make_directory(std::string const& path)
+{
+#ifdef _WIN32
+    ::_mkdir(path.c_str());
+#else
+    ::mkdir(path.c_str(), 0755);
+#endif
+}
+
+// The name of the host, its processor and its threads: runs are compared only on the same host
+std::string host_description()
+{
+    std::string name;
+    std::string processor;
+
+#ifdef _WIN32
+    if (auto const* computer = std::getenv("COMPUTERNAME"))
+        name = computer;
+    if (auto const* identifier = std::getenv("PROCESSOR_IDENTIFIER"))
+        processor = identifier;
+#else
+    char host[256]{};
+    if (!::gethostname(host, sizeof(host) - 1))
+        name = host;
+
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    for (std::string line; std::getline(cpuinfo, line);)
+    {
+        if (line.compare(0, 10, "model name") == 0)
+        {
+            processor = line.substr(line.find(':') + 2);
+            break;
+        }
+    }
+#endif
+
+    return fmt::format("{}; {}; {} threads", name, processor, std::thread::hardware_concurrency());
+}
+
+// The host name and the FNV-1a hash of its description, as a directory name
+std::string fingerprint(std::string const& description)
+{
+    std::uint64_t hash = 0xCBF2'9CE4'8422'2325;
+    for (unsigned char c : description)
+        hash = (hash ^ c) * 0x100'0000'01B3;
+
+    std::string name;
+    for (char c : description.substr(0, description.find(';')))
+        name += std::isalnum((unsigned char)c) || c == '-' || c == '_' ? c : '_';
+
+    return fmt::format("{}-{:016x}", name.empty() ? "host" : name, hash);
+}
+
+// The seconds of every run of every benchmark
+struct Result
+{
+    std::vector<std::string> names;
+    std::vector<std::vector<double>> seconds;
+
+    std::vector<double> const* find(std::string const& name) const
+    {
+        auto const found = std::find(names.begin(), names.end(), name);
+        return found == names.end() ? nullptr : &seconds[found - names.begin()];
+    }
+};
+
+// Returns true on failure
+bool parse_result(std::string const& text, Result& result)
+{
+    Value root;
+    if (Parser(text).parse(root))
+        return true;
+
+    auto const* benchmarks = root.find("benchmarks");
+    if (!benchmarks || benchmarks->type != Value::ARRAY)
+        return true;
+
+    for (auto const& benchmark : benchmarks->elements)
+    {
+        auto const* name = benchmark.find("name");
+        auto const* seconds = benchmark.find("seconds");
+
+        if (!name || name->type != Value::STRING || !seconds || seconds->type != Value::ARRAY || seconds->elements.empty())
+            return true;
+
+        result.names.push_back(name->string);
+        result.seconds.emplace_back();
+
+        for (auto const& run : seconds->elements)
+            result.seconds.back().push_back(run.number);
+    }
+
+    return false;
+}
+
+double median(std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    auto const n = values.size();
+    return n % 2 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+}
+
+/*
+ * The two-sided p-value of the Mann-Whitney U test: the probability that runs as different as
+ * `a` and `b` come from the same distribution. Exact without ties, up to 20 runs in total,
+ * otherwise normal with the correction for ties and for continuity.
+ */
+double mann_whitney(std::vector<double> const& a, std::vector<double> const& b)
+{
+    auto const n1 = a.size();
+    auto const n2 = b.size();
+
+    double u = 0;
+    bool ties = false;
+
+    for (auto const x : a)
+    {
+        for (auto const y : b)
+        {
+            u += x > y ? 1 : x == y ? 0.5 : 0;
+            ties = ties || x == y;
+        }
+    }
+
+    if (!ties && n1 + n2 <= 20)
+    {
+        // ways[n][k][u]: the orderings of n and k runs whose U is u, one table per n and k
+        auto const max_u = n1 * n2;
+        std::vector<std::vector<std::vector<double>>> ways(n1 + 1, std::vector<std::vector<double>>(n2 + 1, std::vector<double>(max_u + 1)));
+
+        for (std::size_t i = 0; i <= n1; ++i)
+        {
+            for (std::size_t j = 0; j <= n2; ++j)
+            {
+                if (!i || !j)
+                {
+                    ways[i][j][0] = 1;
+                    continue;
+                }
+
+                // The greatest run is of `a`, it beats the j of `b`, or it's of `b`
+                for (std::size_t k = 0; k <= i * j; ++k)
+                    ways[i][j][k] = (k >= j ? ways[i - 1][j][k - j] : 0) + ways[i][j - 1][k];
+            }
+        }
+
+        double total = 0, below = 0, above = 0;
+        for (std::size_t k = 0; k <= max_u; ++k)
+        {
+            total += ways[n1][n2][k];
+            below += double(k) <= u ? ways[n1][n2][k] : 0;
+            above += double(k) >= u ? ways[n1][n2][k] : 0;
+        }
+
+        return std::min(1.0, 2 * std::min(below, above) / total);
+    }
+
+    std::vector<double> all(a);
+    all.insert(all.end(), b.begin(), b.end());
+    std::sort(all.begin(), all.end());
+
+    double tie_sum = 0;
+    for (std::size_t i = 0; i < all.size();)
+    {
+        auto j = i;
+        while (j < all.size() && all[j] == all[i])
+            ++j;
+
+        auto const t = double(j - i);
+        tie_sum += t * t * t - t;
+        i = j;
+    }
+
+    auto const n = double(n1 + n2);
+    auto const mean = double(n1 * n2) / 2;
+    auto const variance = double(n1 * n2) / 12 * ((n + 1) - tie_sum / (n * (n - 1)));
+
+    if (variance <= 0)
+        return 1;
+
+    auto const z = std::max(0.0, std::abs(u - mean) - 0.5) / std::sqrt(variance);
+    return std::erfc(z / std::sqrt(2.0));
+}
+
+// A stored run, a file, or nothing
+std::string run_path(std::string const& history, std::string const& host, std::string const& commit)
+{
+    return history + '/' + host + '/' + commit + ".json";
+}
+
+int usage(char const* program)
+{
+    fmt::print(stderr,
+               "Usage: {0} store <history> <commit> <result.json>\n"
+               "       {0} compare <history> <base commit> <new commit> [--threshold %] [--alpha p] [--host fingerprint]\n"
+               "       {0} compare <base.json> <new.json> [--threshold %] [--alpha p]\n"
+               "       {0} host\n",
+               program);
+    return 1;
+}
+
+int store(char const* program, int argc, char** argv)
+{
+    if (argc != 5)
+        return usage(program);
+
+    std::string const history = argv[2];
+    std::string const commit = argv[3];
+
+    std::string text;
+    Result result;
+
+    if (read_file(argv[4], text) || parse_result(text, result))
+    {
+        fmt::print(stderr, "'{}' isn't the JSON of a benchmark.\n", argv[4]);
+        return 1;
+    }
+
+    auto const description = host_description();
+    auto const host = fingerprint(description);
+
+    make_directory(history);
+    make_directory(history + '/' + host);
+
+    // The host is described once, the runs are replaced
+    write_file(history + '/' + host + "/host.txt", description + '\n');
+
+    auto const path = run_path(history, host, commit);
+    if (write_file(path, text))
+    {
+        fmt::print(stderr, "Can't write '{}'.\n", path);
+        return 1;
+    }
+
+    fmt::print("{} benchmarks stored into '{}'.\n", result.names.size(), path);
+    return 0;
+}
+
+int compare(char const* program, int argc, char** argv)
+{
+    std::vector<std::string> operands;
+    double threshold = 5;
+    double alpha = 0.05;
+    std::string host = fingerprint(host_description());
+
+    for (int i = 2; i < argc; ++i)
+    {
+        std::string_view const arg{ argv[i] };
+
+        if ((arg == "--threshold" || arg == "--alpha" || arg == "--host") && i + 1 < argc)
+        {
+            if (arg == "--host")
+                host = argv[++i];
+            else
+                (arg == "--threshold" ? threshold : alpha) = std::strtod(argv[++i], nullptr);
+        }
+        else if (arg.substr(0, 2) == "--")
+        {
+            return usage(program);
+        }
+        else
+        {
+            operands.emplace_back(arg);
+        }
+    }
+
+    std::string base_path, new_path;
+
+    if (operands.size() == 3)
+    {
+        base_path = run_path(operands[0], host, operands[1]);
+        new_path = run_path(operands[0], host, operands[2]);
+    }
+    else if (operands.size() == 2)
+    {
+        base_path = operands[0];
+        new_path = operands[1];
+    }
+    else
+    {
+        return usage(program);
+    }
+
+    Result base, current;
+    std::string base_text, new_text;
+
+    if (read_file(base_path, base_text) || parse_result(base_text, base))
+    {
+        fmt::print(stderr, "Can't read the benchmarks of '{}'.\n", base_path);
+        return 1;
+    }
+
+    if (read_file(new_path, new_text) || parse_result(new_text, current))
+    {
+        fmt::print(stderr, "Can't read the benchmarks of '{}'.\n", new_path);
+        return 1;
+    }
+
+    std::size_t width = 9;
+    for (auto const& name : current.names)
+        width = std::max(width, name.size());
+
+    fmt::print("{:<{}}  {:>12}  {:>12}  {:>8}  {:>7}\n", "benchmark", width, "base (s)", "new (s)", "change", "p");
+
+    std::uint32_t regressions = 0;
+
+    for (std::size_t i = 0; i < current.names.size(); ++i)
+    {
+        auto const* before = base.find(current.names[i]);
+        if (!before)
+        {
+            fmt::print("{:<{}}  {:>12}  {:>12.6f}  new\n", current.names[i], width, "-", median(current.seconds[i]));
+            continue;
+        }
+
+        auto const& after = current.seconds[i];
+
+        auto const old_median = median(*before);
+        auto const new_median = median(after);
+        auto const change = old_median > 0 ? (new_median - old_median) / old_median * 100 : 0;
+        auto const p = mann_whitney(*before, after);
+
+        // Slower beyond the threshold, and unlikely to be noise
+        auto const significant = p < alpha && std::abs(change) > threshold;
+        auto const verdict = !significant ? "" : change > 0 ? "  REGRESSION" : "  improvement";
+
+        regressions += significant && change > 0;
+
+        fmt::print("{:<{}}  {:>12.6f}  {:>12.6f}  {:>+7.1f}%  {:>7.4f}{}\n", current.names[i], width, old_median,
+                   new_median, change, p, verdict);
+    }
+
+    if (regressions)
+        fmt::print("\n{} regression{} beyond {}%, at p < {}.\n", regressions, regressions > 1 ? "s" : "", threshold, alpha);
+
+    return regressions ? 2 : 0;
+}
+} // namespace
+
+/*
+ * Keeps the JSON written by mips32-bench and mips32-ram-bench, per host and commit, and compares two runs:
+ *
+ *  history/<host fingerprint>/host.txt       the host, its processor and its threads
+ *  history/<host fingerprint>/<commit>.json  a run, replaced if stored again
+ *
+ * A benchmark regressed if its median time grew beyond the threshold, 5% by default, and the Mann-Whitney test
+ * of the times of the runs tells it apart from noise at `alpha`, 0.05 by default. Exits with 2 on regressions.
+ * Comparisons need at least 4 runs per side to be significant at 0.05, mips32-bench runs 5 by default.
+ */
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+        return usage(argv[0]);
+
+    std::string_view const command{ argv[1] };
+
+    if (command == "store")
+        return store(argv[0], argc, argv);
+
+    if (command == "compare")
+        return compare(argv[0], argc, argv);
+
+    if (command == "host" && argc == 2)
+    {
+        auto const description = host_description();
+        fmt::print("{}\n{}\n", fingerprint(description), description);
+        return 0;
+    }
+
+    return usage(argv[0]);
+}
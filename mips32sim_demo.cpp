@@ -1,12 +1,15 @@
 ﻿#include "mips32/test/helpers/test_cpu_instructions.hpp"
 
+#include <mips32/disassembler.hpp>
 #include <mips32/machine.hpp>
 #include <mips32/literals.hpp>
+#include <mips32/native_file_handler.hpp>
 
 #include <fmt/format.h>
 
 #include <vector>
 #include <cstdio>
+#include <cstring>
 #include <stdexcept>
 #include <string>
 #include <memory>
@@ -35,19 +38,6 @@ struct ConsoleIODevice final : virtual public mips32::IODevice
     void read_string(char* string, std::uint32_t max_count) noexcept override;
 };
 
-struct CSTDIOFileHandler final : virtual public mips32::FileHandler
-{
-    CSTDIOFileHandler() noexcept;
-    ~CSTDIOFileHandler() override;
-
-    std::uint32_t open(char const* name, char const* flags) noexcept override;
-    std::uint32_t read(std::uint32_t fd, char * dst, std::uint32_t count) noexcept override;
-    std::uint32_t write(std::uint32_t fd, char const* src, std::uint32_t count) noexcept override;
-    void close(std::uint32_t fd) noexcept override;
-
-    std::vector<FILE*> files;
-};
-
 struct MachineDataPlotter
 {
     mips32::MachineInspector inspector;
@@ -118,7 +108,7 @@ int main()
     using namespace mips32::literals;
 
     auto iodevice = std::make_unique<ConsoleIODevice>();
-    auto filehandler = std::make_unique<CSTDIOFileHandler>();
+    auto filehandler = std::make_unique<mips32::NativeFileHandler>();
 
     mips32::Machine machine{ 512_MB, iodevice.get(), filehandler.get() };
     machine.reset();
@@ -143,61 +133,6 @@ int main()
     }
 }
 
-#pragma region File Handler Implementation
-CSTDIOFileHandler::CSTDIOFileHandler() noexcept
-{}
-
-CSTDIOFileHandler::~CSTDIOFileHandler()
-{
-    for (auto* file : files)
-        fclose(file);
-}
-
-std::uint32_t CSTDIOFileHandler::open(char const* name, char const* flags) noexcept
-{
-    files.emplace_back(fopen(name, flags));
-    return (std::uint32_t)files.size() - 1;
-}
-
-std::uint32_t CSTDIOFileHandler::read(std::uint32_t fd, char * dst, std::uint32_t count) noexcept
-{
-    try
-    {
-        return (std::uint32_t)fread(dst, 1, count, files.at(fd));
-    }
-    catch (std::out_of_range const&)
-    {
-        fprintf(stderr, "Requested to read from a file that doesn't exist!");
-        return 0;
-    }
-}
-
-std::uint32_t CSTDIOFileHandler::write(std::uint32_t fd, char const* src, std::uint32_t count) noexcept
-{
-    try
-    {
-        return (std::uint32_t)fwrite(src, 1, count, files[fd]);
-    }
-    catch (std::out_of_range const&)
-    {
-        fprintf(stderr, "Requested to write to a file that doesn't exist!");
-        return 0;
-    }
-}
-
-void CSTDIOFileHandler::close(std::uint32_t fd) noexcept
-{
-    try
-    {
-        fclose(files[fd]);
-    }
-    catch (std::out_of_range const&)
-    {
-        fprintf(stderr, "Requested to close a file that doesn't exist!");
-    }
-}
-#pragma endregion
-
 #pragma region IO Device Implementation
 ConsoleIODevice::ConsoleIODevice() noexcept
 {
@@ -307,6 +242,7 @@ void MachineDataPlotter::plot() noexcept
         "INTERRUPT",
         "EXCEPTION",
         "EXIT",
+        "LIMIT",
     };
 
     static char const* regs[] = {
@@ -326,6 +262,29 @@ void MachineDataPlotter::plot() noexcept
         
         fmt::print(" PC{} {:>#10X}{:14}| ", cur_pc != prev_pc ? '<' : ' ', cur_pc, "");
         fmt::print("Exit Code {:>18}\n", exit_code[cur_ec]);
+
+        char text[mips32::disassembly_max_size];
+
+        // The instructions leading to the exception, the last one raised it
+        if (exit_code[cur_ec] == std::string_view{ "EXCEPTION" })
+        {
+            for (auto const& instruction : inspector.CPU_flight_record().instructions)
+            {
+                mips32::disassemble(instruction.word, instruction.pc, text, sizeof(text));
+                fmt::print("   0x{:08X}:  0x{:08X}  {}\n", instruction.pc, instruction.word, text);
+            }
+        }
+
+        // The next instruction
+        auto const word = inspector.RAM_read(cur_pc, 4);
+        if (word.size() == 4)
+        {
+            std::uint32_t next;
+            std::memcpy(&next, word.data(), 4);
+
+            mips32::disassemble(next, cur_pc, text, sizeof(text));
+            fmt::print(" >  {}\n", text);
+        }
     }
     
     // Prints registers
@@ -0,0 +1,90 @@
+#include <mips32/disassembler.hpp>
+#include <mips32/trace.hpp>
+
+#include <fmt/format.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <string>
+
+/*
+ * Renders a trace written by `Machine::trace` as text, a line per instruction:
+ *
+ *  index  pc:  word  instruction  rN = value ... fN = value ... [address] = value ...
+ */
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        fmt::print(stderr, "Usage: {} <trace>\n", argv[0]);
+        return 1;
+    }
+
+    mips32::TraceReader reader{ argv[1] };
+
+    if (reader.failed())
+    {
+        fmt::print(stderr, "'{}' isn't a trace.\n", argv[1]);
+        return 1;
+    }
+
+    auto const& initial = reader.initial_state();
+
+    fmt::print("Initial state, PC 0x{:08X}\n", initial.pc);
+    for (std::uint32_t i = 0; i < 32; ++i)
+    {
+        if (initial.gpr[i])
+            fmt::print("  r{} = 0x{:08X}\n", i, initial.gpr[i]);
+    }
+    for (std::uint32_t i = 0; i < 32; ++i)
+    {
+        if (initial.fpr[i].i64)
+            fmt::print("  f{} = 0x{:016X}\n", i, initial.fpr[i].i64);
+    }
+
+    mips32::TraceReader::Record record;
+    std::uint64_t instructions = 0;
+    std::string line;
+    char instruction[mips32::disassembly_max_size];
+
+    while (!reader.read(record))
+    {
+        line.clear();
+        auto out = std::back_inserter(line);
+
+        mips32::disassemble(record.word, record.pc, instruction, sizeof(instruction));
+        fmt::format_to(out, "{:>10}  {:08X}:  {:08X}  {:<28}", record.index, record.pc, record.word, instruction);
+
+        for (std::uint32_t i = 0; i < 32; ++i)
+        {
+            if (record.gpr_changed >> i & 1)
+                fmt::format_to(out, "  r{} = 0x{:08X}", i, record.gpr[i]);
+        }
+
+        for (std::uint32_t i = 0; i < 32; ++i)
+        {
+            if (record.fpr_changed >> i & 1)
+                fmt::format_to(out, "  f{} = 0x{:016X}", i, record.fpr[i].i64);
+        }
+
+        for (auto const& store : record.stores)
+            fmt::format_to(out, "  [0x{:08X}] = 0x{:08X}", store.address, store.value);
+
+        while (line.back() == ' ') // the padding of the instruction
+            line.pop_back();
+
+        line += '\n';
+        std::fputs(line.c_str(), stdout);
+
+        ++instructions;
+    }
+
+    if (reader.failed())
+    {
+        fmt::print(stderr, "The trace is truncated, or corrupted, after {} instructions.\n", instructions);
+        return 2;
+    }
+
+    fmt::print("{} instructions.\n", instructions);
+}